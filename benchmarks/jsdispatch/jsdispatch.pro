@@ -0,0 +1,23 @@
+QT += webengine webenginewidgets widgets
+
+CONFIG += c++14 console
+CONFIG -= app_bundle
+
+INCLUDEPATH = ../../src
+
+SOURCES += \
+    main.cpp \
+    ../../tests/LogMock.cpp \
+    ../../src/qt_utilites/QRegister.cpp \
+    ../../src/qt_utilites/JsDispatcher.cpp
+
+
+HEADERS += \
+    ../../src/Log.h \
+    ../../src/qt_utilites/QRegister.h \
+    ../../src/qt_utilites/JsDispatcher.h
+
+QMAKE_LFLAGS += -rdynamic
+unix:!macx: include(../../libs-unix.pri)
+win32: include(../../libs-win.pri)
+macx: include(../../libs-macos.pri)
@@ -0,0 +1,95 @@
+#include <QApplication>
+#include <QWebEnginePage>
+#include <QEventLoop>
+#include <QDebug>
+
+#include <chrono>
+#include <functional>
+
+#include "qt_utilites/JsDispatcher.h"
+
+const int COUNT_SCRIPTS = 1000;
+
+static const QString SCRIPT = "window.counter = (window.counter || 0) + 1; document.title = String(window.counter);";
+
+struct Result {
+    size_t countRuns = 0;
+    long long mainThreadUs = 0;
+    long long totalMs = 0;
+};
+
+// Ждем, пока страница выполнит все отправленные скрипты
+static void waitPage(QWebEnginePage &page, int expected) {
+    QEventLoop loop;
+    std::function<void()> check;
+    check = [&]{
+        page.runJavaScript("window.counter || 0", [&](const QVariant &result) {
+            if (result.toInt() >= expected) {
+                loop.quit();
+            } else {
+                check();
+            }
+        });
+    };
+    check();
+    loop.exec();
+}
+
+static Result runDirect(QWebEnginePage &page) {
+    page.runJavaScript("window.counter = 0;");
+    Result result;
+    const auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < COUNT_SCRIPTS; i++) {
+        page.runJavaScript(SCRIPT);
+        result.countRuns++;
+    }
+    const auto endCalls = std::chrono::steady_clock::now();
+    waitPage(page, COUNT_SCRIPTS);
+    const auto end = std::chrono::steady_clock::now();
+    result.mainThreadUs = std::chrono::duration_cast<std::chrono::microseconds>(endCalls - begin).count();
+    result.totalMs = std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count();
+    return result;
+}
+
+static Result runDispatcher(QWebEnginePage &page) {
+    page.runJavaScript("window.counter = 0;");
+    Result result;
+    JsDispatcher dispatcher(16ms, [&](const QString &script) {
+        page.runJavaScript(script);
+        result.countRuns++;
+    });
+    const auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < COUNT_SCRIPTS; i++) {
+        dispatcher.push(SCRIPT);
+    }
+    const auto endCalls = std::chrono::steady_clock::now();
+    waitPage(page, COUNT_SCRIPTS);
+    const auto end = std::chrono::steady_clock::now();
+    result.mainThreadUs = std::chrono::duration_cast<std::chrono::microseconds>(endCalls - begin).count() + dispatcher.getMetrics().runTimeUs;
+    result.totalMs = std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count();
+    return result;
+}
+
+static void print(const QString &name, const Result &result) {
+    qDebug() << name << "runJavaScript calls" << result.countRuns << "main thread" << result.mainThreadUs << "us" << "total" << result.totalMs << "ms";
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication a(argc, argv);
+
+    QWebEnginePage page;
+    QEventLoop loadLoop;
+    QObject::connect(&page, &QWebEnginePage::loadFinished, &loadLoop, &QEventLoop::quit);
+    page.setHtml("<html><body></body></html>");
+    loadLoop.exec();
+
+    for (int i = 0; i < 3; i++) {
+        print("Direct", runDirect(page));
+        print("Dispatcher", runDispatcher(page));
+    }
+
+    qDebug() << "ok";
+
+    return 0;
+}
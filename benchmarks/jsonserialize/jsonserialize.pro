@@ -0,0 +1,26 @@
+QT -= gui
+
+CONFIG += c++14 console
+CONFIG -= app_bundle
+
+INCLUDEPATH = ../../src
+
+SOURCES += \
+    main.cpp \
+    ../../tests/LogMock.cpp \
+    ../../src/utilites/BigNumber.cpp \
+    ../../src/qt_utilites/JsonWriter.cpp
+
+
+HEADERS += \
+    ../../src/Log.h \
+    ../../src/utilites/BigNumber.h \
+    ../../src/qt_utilites/JsonWriter.h \
+    ../../src/qt_utilites/makeJsFunc.h \
+    ../../src/transactions/TransactionJson.h \
+    ../../src/Messenger/MessageJson.h
+
+QMAKE_LFLAGS += -rdynamic
+unix:!macx: include(../../libs-unix.pri)
+win32: include(../../libs-win.pri)
+macx: include(../../libs-macos.pri)
@@ -0,0 +1,150 @@
+#include <QCoreApplication>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QDebug>
+
+#include <chrono>
+#include <functional>
+
+#include "qt_utilites/makeJsFunc.h"
+#include "transactions/TransactionJson.h"
+#include "Messenger/MessageJson.h"
+
+using namespace transactions;
+using namespace messenger;
+
+const int COUNT_ROWS = 10000;
+const int COUNT_REPEATS = 20;
+
+// Старая схема из TransactionsJavascript.cpp
+static QJsonDocument txsToQJson(const std::vector<Transaction> &txs) {
+    QJsonArray arr;
+    for (const Transaction &tx: txs) {
+        QJsonObject txJson;
+        txJson.insert("id", tx.tx);
+        txJson.insert("from", tx.from);
+        txJson.insert("to", tx.to);
+        txJson.insert("value", tx.value);
+        txJson.insert("data", tx.data);
+        txJson.insert("timestamp", QString::fromStdString(std::to_string(tx.timestamp)));
+        txJson.insert("fee", tx.fee);
+        txJson.insert("nonce", QString::fromStdString(std::to_string(tx.nonce)));
+        txJson.insert("blockNumber", QString::fromStdString(std::to_string(tx.blockNumber)));
+        txJson.insert("blockIndex", QString::fromStdString(std::to_string(tx.blockIndex)));
+        txJson.insert("intStatus", tx.intStatus);
+        if (tx.type == Transaction::Type::DELEGATE) {
+            txJson.insert("isDelegate", tx.isDelegate);
+            txJson.insert("delegate_value", tx.delegateValue);
+            if (!tx.delegateHash.isEmpty()) {
+                txJson.insert("delegate_hash", tx.delegateHash);
+            }
+        }
+        txJson.insert("status", "ok");
+        txJson.insert("type", tx.type == Transaction::DELEGATE ? "delegate" : "simple");
+        arr.push_back(txJson);
+    }
+    return QJsonDocument(arr);
+}
+
+// Старая схема из MessengerJavascript.cpp
+static QJsonDocument messagesToQJson(const std::vector<Message> &messages) {
+    QJsonArray arr;
+    for (const Message &message: messages) {
+        QJsonObject messageJson;
+        messageJson.insert("collocutor", message.collocutor);
+        messageJson.insert("isInput", message.isInput);
+        messageJson.insert("timestamp", QString::fromStdString(std::to_string(message.timestamp)));
+        messageJson.insert("data", message.decryptedDataHex);
+        messageJson.insert("isDecrypter", message.isDecrypted);
+        messageJson.insert("counter", QString::fromStdString(std::to_string(message.counter)));
+        messageJson.insert("fee", QString::fromStdString(std::to_string(message.fee)));
+        messageJson.insert("isConfirmed", message.isConfirmed);
+        if (message.isChannel) {
+            messageJson.insert("channel", message.channel);
+        }
+        arr.push_back(messageJson);
+    }
+    return QJsonDocument(arr);
+}
+
+static std::vector<Transaction> makeTxs() {
+    std::vector<Transaction> txs;
+    for (int i = 0; i < COUNT_ROWS; i++) {
+        Transaction tx;
+        tx.tx = QString("d6c3bd0c1a3b0bf7b2ef9a4f0ae1c7c5e4b1a1e2a3b3c4d5e6f7a8b9c0d1e2f%1").arg(i);
+        tx.from = "0x00fa2a5f5a8d4c6f1d3b5e2c5b6a5d2e2c8c0d4a0b0f7e3c4";
+        tx.to = "0x00b7a8f9e5d3c2b1a0f0e9d8c7b6a5f4e3d2c1b0a9f8e7d6c5";
+        tx.value = QString::number(1000000 + i);
+        tx.data = i % 3 == 0 ? "\"quoted\" \\ data\n" : "";
+        tx.timestamp = 1550000000 + i;
+        tx.fee = "0";
+        tx.nonce = i;
+        tx.blockNumber = 100000 + i;
+        tx.blockIndex = i % 100;
+        tx.intStatus = 20;
+        tx.isDelegate = true;
+        tx.delegateValue = "500";
+        tx.type = i % 10 == 0 ? Transaction::DELEGATE : Transaction::SIMPLE;
+        txs.emplace_back(tx);
+    }
+    return txs;
+}
+
+static std::vector<Message> makeMessages() {
+    std::vector<Message> messages;
+    for (int i = 0; i < COUNT_ROWS; i++) {
+        Message message;
+        message.collocutor = "0x00fa2a5f5a8d4c6f1d3b5e2c5b6a5d2e2c8c0d4a0b0f7e3c4";
+        message.isInput = i % 2 == 0;
+        message.timestamp = 1550000000 + i;
+        message.decryptedDataHex = QString("Сообщение номер %1 с \"кавычками\"").arg(i).toUtf8().toHex();
+        message.isDecrypted = true;
+        message.counter = i;
+        message.fee = 0;
+        message.isChannel = i % 5 == 0;
+        message.channel = "channel";
+        messages.emplace_back(message);
+    }
+    return messages;
+}
+
+static void calcTime(const QString &name, const std::function<int()> &func) {
+    int size = 0;
+    const auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < COUNT_REPEATS; i++) {
+        size += func();
+    }
+    const auto end = std::chrono::steady_clock::now();
+    const auto d = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count() / COUNT_REPEATS;
+    qDebug() << name << QString::number(d / 1000., 'f', 3) << "ms" << size / COUNT_REPEATS << "chars";
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    const std::vector<Transaction> txs = makeTxs();
+    const std::vector<Message> messages = makeMessages();
+
+    // Оба пути должны давать одинаковый json с точностью до порядка ключей
+    CHECK(QJsonDocument::fromJson(toJsonString(txs).json) == txsToQJson(txs), "Transactions json differ");
+    CHECK(QJsonDocument::fromJson(toJsonString(messages).json) == messagesToQJson(messages), "Messages json differ");
+
+    calcTime("Transactions QJson", [&]{
+        return toJsString(txsToQJson(txs)).size();
+    });
+    calcTime("Transactions JsonWriter", [&]{
+        return toJsString(toJsonString(txs)).size();
+    });
+    calcTime("Messages QJson", [&]{
+        return toJsString(messagesToQJson(messages)).size();
+    });
+    calcTime("Messages JsonWriter", [&]{
+        return toJsString(toJsonString(messages)).size();
+    });
+
+    qDebug() << "ok";
+
+    return 0;
+}
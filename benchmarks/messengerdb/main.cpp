@@ -6,6 +6,7 @@
 #include <iostream>
 
 #include "MessengerDBStorage.h"
+#include "Message.h"
 
 const QString pragmaSyncOff = "PRAGMA synchronous=OFF";
 const QString pragmaSyncNormal = "PRAGMA synchronous=NORMAL";
@@ -18,18 +19,18 @@ const QString pragmaJournalWAL = "PRAGMA journal_mode=WAL";
 
 using TestFunction = std::function<void(messenger::MessengerDBStorage &)>;
 
-void calcTime(TestFunction func, const QStringList &pragmas = QStringList())
+void calcTime(TestFunction func, const QStringList &pragmas = QStringList(), int nmax = 20)
 {
     qDebug() << "Start test";
     for (const QString &sql: pragmas)
         qDebug() << sql;
-    const int nmax = 20;
     qreal time = 0.0;
     for (int n = 0; n < nmax; n++) {
         if (QFile::exists("messenger.db"))
             QFile::remove("messenger.db");
         messenger::MessengerDBStorage db;
         db.init();
+        db.getUserIdOrCreate("1234");
         for (const QString &sql: pragmas)
             db.execPragma(sql);
 
@@ -46,15 +47,29 @@ void calcTime(TestFunction func, const QStringList &pragmas = QStringList())
     qDebug() << QString::number(time, 'f', 6) << "s";
 }
 
+static messenger::Message makeMessage(qint64 n, bool isInput, const QString &collocutor)
+{
+    messenger::Message m;
+    m.username = "1234";
+    m.collocutor = collocutor;
+    m.isInput = isInput;
+    m.timestamp = 1000000 + n;
+    m.dataHex = QString("abcd%1").arg(n);
+    m.hash = QString("hash%1").arg(n);
+    m.counter = 4001 + n;
+    m.fee = 1;
+    return m;
+}
+
 void insert1Message(messenger::MessengerDBStorage &db)
 {
-    db.addMessage("1234", "3454", "abcd", 1000000, 4001, true, true, true, "asdfdf", 1);
+    db.addMessage(makeMessage(0, true, "3454"));
 }
 
 void insert1MessageTrans(messenger::MessengerDBStorage &db)
 {
     auto transactionGuard = db.beginTransaction();
-    db.addMessage("1234", "3454", "abcd", 1000000, 4001, true, true, true, "asdfdf", 1);
+    db.addMessage(makeMessage(0, true, "3454"));
     transactionGuard.commit();
 }
 
@@ -62,11 +77,189 @@ void insert1000Messages(messenger::MessengerDBStorage &db)
 {
     auto transactionGuard = db.beginTransaction();
     for (int n = 0; n < 1000; n++) {
-        db.addMessage("1234", "3454", "abcd", 1000000 + n, 4001 + n, true, true, true, "asdfdf", 1);
+        db.addMessage(makeMessage(n, true, "3454"));
     }
     transactionGuard.commit();
 }
 
+// Догрузка 10000 сообщений после входа: входящие от 50 собеседников и каждое десятое - свое исходящее,
+// половина исходящих уже лежит в базе неподтвержденной с другим счетчиком
+static const int CATCH_UP_COUNT = 10000;
+
+static std::vector<messenger::Message> prepareCatchUp(messenger::MessengerDBStorage &db)
+{
+    std::vector<messenger::Message> messages;
+    std::vector<messenger::Message> notConfirmedMessages;
+    messages.reserve(CATCH_UP_COUNT);
+    for (int n = 0; n < CATCH_UP_COUNT; n++) {
+        const bool isInput = n % 10 != 0;
+        messenger::Message m = makeMessage(n, isInput, QString("contact%1").arg(n % 50));
+        if (!isInput && n % 20 == 0) {
+            messenger::Message notConfirmed = m;
+            notConfirmed.isConfirmed = false;
+            notConfirmed.counter = m.counter - 1;
+            notConfirmedMessages.emplace_back(notConfirmed);
+        }
+        messages.emplace_back(m);
+    }
+    db.addMessages(notConfirmedMessages);
+    return messages;
+}
+
+// Прежняя обработка: каждое сообщение отдельными запросами без общей транзакции
+void catchUpPerMessage(messenger::MessengerDBStorage &db)
+{
+    const std::vector<messenger::Message> messages = prepareCatchUp(db);
+    for (const messenger::Message &m: messages) {
+        if (m.isInput) {
+            db.addMessage(m);
+            const messenger::Message::Counter savedPos = db.getLastReadCounterForUserContact(m.username, m.collocutor, false);
+            if (savedPos == -1) {
+                db.setLastReadCounterForUserContact(m.username, m.collocutor, -1, false);
+            }
+        } else {
+            const auto idPair = db.findFirstNotConfirmedMessageWithHash(m.username, m.hash);
+            if (idPair.first != -1) {
+                db.updateMessage(idPair.first, m.counter, true);
+                if (idPair.second != m.counter) {
+                    db.hasMessageWithCounter(m.username, idPair.second);
+                }
+            } else if (db.findFirstMessageWithHash(m.username, m.hash).first == -1) {
+                db.addMessage(m);
+            }
+        }
+    }
+}
+
+void catchUpBatch(messenger::MessengerDBStorage &db)
+{
+    const std::vector<messenger::Message> messages = prepareCatchUp(db);
+    db.ingestMessages("1234", "", messages);
+}
+
+// Проверки дублей при отправке и получении на истории из 200000 сообщений, по 1000 вызовов
+static const int LOOKUP_STORE_COUNT = 200000;
+
+static void fillLookupStore(messenger::MessengerDBStorage &db)
+{
+    const int CHUNK = 10000;
+    for (int begin = 0; begin < LOOKUP_STORE_COUNT; begin += CHUNK) {
+        std::vector<messenger::Message> messages;
+        messages.reserve(CHUNK);
+        for (int n = begin; n < begin + CHUNK; n++) {
+            messages.emplace_back(makeMessage(n, n % 10 != 0, QString("contact%1").arg(n % 100)));
+        }
+        db.ingestMessages("1234", "", messages);
+    }
+}
+
+void lookupHashes(messenger::MessengerDBStorage &db)
+{
+    fillLookupStore(db);
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    for (int n = 0; n < 1000; n++) {
+        const QString hash = QString("hash%1").arg(n * 197);
+        db.findFirstNotConfirmedMessageWithHash("1234", hash);
+        db.findFirstMessageWithHash("1234", hash);
+        db.hasUnconfirmedMessageWithHash("1234", hash);
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    qDebug() << "hash lookups" << QString::number(std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count() / 1000000.0, 'f', 6) << "s";
+}
+
+void lookupCounters(messenger::MessengerDBStorage &db)
+{
+    fillLookupStore(db);
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    for (int n = 0; n < 1000; n++) {
+        db.getMessageMaxCounter("1234");
+        db.getMessageMaxConfirmedCounter("1234");
+        db.hasMessageWithCounter("1234", 4001 + n * 197);
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    qDebug() << "counter lookups" << QString::number(std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count() / 1000000.0, 'f', 6) << "s";
+}
+
+// Поиск по 1000000 расшифрованных сообщений в 100 диалогах
+static const int SEARCH_STORE_COUNT = 1000000;
+
+static void fillSearchStore(messenger::MessengerDBStorage &db)
+{
+    const QStringList words = QString("привет как дела встреча завтра hello world meeting tomorrow transfer wallet address balance "
+                                      "block node torrent send receive key channel message token fee").split(' ');
+    const int CHUNK = 10000;
+    for (int begin = 0; begin < SEARCH_STORE_COUNT; begin += CHUNK) {
+        std::vector<messenger::Message> messages;
+        messages.reserve(CHUNK);
+        for (int n = begin; n < begin + CHUNK; n++) {
+            messenger::Message m = makeMessage(n, true, QString("contact%1").arg(n % 100));
+            QString text;
+            for (int w = 0; w < 8; w++) {
+                text += words[(n * 7 + w * 13 + n / (w + 1)) % words.size()] + " ";
+            }
+            text += QString("code%1").arg(n);
+            m.decryptedDataHex = QString(text.toUtf8().toHex());
+            m.isDecrypted = true;
+            messages.emplace_back(m);
+        }
+        db.ingestMessages("1234", "", messages);
+    }
+}
+
+// Прежний способ: страницы getMessagesForUserAndDest по каждому диалогу и фильтрация расшифрованного текста
+static size_t searchByScan(messenger::MessengerDBStorage &db, const QString &text)
+{
+    size_t found = 0;
+    for (int c = 0; c < 100; c++) {
+        const std::vector<messenger::Message> messages = db.getMessagesForUserAndDest("1234", QString("contact%1").arg(c), 0, 4001 + SEARCH_STORE_COUNT);
+        for (const messenger::Message &m: messages) {
+            if (QString::fromUtf8(QByteArray::fromHex(m.decryptedDataHex.toLatin1())).contains(text, Qt::CaseInsensitive)) {
+                found++;
+            }
+        }
+    }
+    return found;
+}
+
+static void searchBenchmark()
+{
+    if (QFile::exists("messenger.db"))
+        QFile::remove("messenger.db");
+    messenger::MessengerDBStorage db;
+    db.init();
+    db.getUserIdOrCreate("1234");
+    db.execPragma(pragmaSyncNormal);
+    db.execPragma(pragmaJournalWAL);
+
+    const auto measure = [](const QString &name, const std::function<size_t()> &func) {
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        const size_t count = func();
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        const auto d = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+        qDebug() << name << count << QString::number(d / 1000000.0, 'f', 6) << "s";
+    };
+
+    measure("fill store", [&db]{
+        fillSearchStore(db);
+        return size_t(SEARCH_STORE_COUNT);
+    });
+    measure("scan rare word", [&db]{
+        return searchByScan(db, "code777777");
+    });
+    measure("index rare word", [&db]{
+        return db.searchMessages("1234", "code777777", 0, 50).size();
+    });
+    measure("index two words, first page", [&db]{
+        return db.searchMessages("1234", "встреча wallet", 0, 50).size();
+    });
+    measure("index two words, page 100", [&db]{
+        return db.searchMessages("1234", "встреча wallet", 5000, 50).size();
+    });
+    measure("index prefix", [&db]{
+        return db.searchMessages("1234", "code7777", 0, 50).size();
+    });
+}
+
 int main(int argc, char *argv[])
 {
     //QCoreApplication a(argc, argv);
@@ -86,6 +279,18 @@ int main(int argc, char *argv[])
     calcTime(insert1Message, QStringList{pragmaJournalWAL});
     */
 
+    qDebug() << "Catch up 10000 messages";
+    calcTime(catchUpPerMessage, QStringList{pragmaSyncNormal, pragmaJournalWAL}, 3);
+    calcTime(catchUpBatch, QStringList{pragmaSyncNormal, pragmaJournalWAL}, 3);
+    calcTime(catchUpBatch, QStringList(), 3);
+
+    qDebug() << "Lookups in 200000 messages";
+    calcTime(lookupHashes, QStringList{pragmaSyncNormal, pragmaJournalWAL}, 1);
+    calcTime(lookupCounters, QStringList{pragmaSyncNormal, pragmaJournalWAL}, 1);
+
+    qDebug() << "Search in 1000000 messages";
+    searchBenchmark();
+
     qDebug() << "Insert one message";
     calcTime(insert1MessageTrans);
     calcTime(insert1MessageTrans, QStringList{pragmaSyncOff});
@@ -0,0 +1,89 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <QDir>
+
+#include "Wallets/Wallet.h"
+
+const int COUNT_SIGNS = 2000;
+
+const std::string PASSWORD = "123";
+
+// Ключ secp256r1, он остается на CryptoPP
+const std::string RAW_KEY_R1 = "0x307702010104201cfb36c121f0161295dc0cd721eb62151f0255bb471bd0c15d11628e3687da68a00a06082a8648ce3d030107a144034200044a9f9bb95b0e9229ef152a8ac12209f069c8e0f79c4de9cdcbffd175ffb636b1466a364bfeed15abc5e29449bb90f0574fc76c57650dd07f7c39f3948a7c1f3f";
+
+static double perSecond(int count, const std::chrono::steady_clock::time_point &begin) {
+    const auto time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count();
+    return count * 1000000. / std::max<long long>(time, 1);
+}
+
+static void bench(const std::string &name, const Wallet &wallet) {
+    std::vector<std::string> messages;
+    messages.reserve(COUNT_SIGNS);
+    for (int i = 0; i < COUNT_SIGNS; i++) {
+        messages.emplace_back("0037f57bab204dd99ebcc84ac9d46a23fa0561cd65c1782f24fbb01f3c0000" + std::to_string(i));
+    }
+
+    std::vector<std::string> signatures(COUNT_SIGNS);
+    std::string pubkey;
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < COUNT_SIGNS; i++) {
+        signatures[i] = wallet.sign(messages[i], pubkey);
+    }
+    std::cout << name << " sign: " << perSecond(COUNT_SIGNS, begin) << " per second" << std::endl;
+
+    begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < COUNT_SIGNS; i++) {
+        if (!Wallet::verify(messages[i], signatures[i], pubkey)) {
+            std::cout << name << " verify error" << std::endl;
+            exit(1);
+        }
+    }
+    std::cout << name << " verify: " << perSecond(COUNT_SIGNS, begin) << " per second" << std::endl;
+
+    const unsigned int countThreads = std::max(2u, std::thread::hardware_concurrency());
+    std::atomic<int> next{0};
+    std::atomic<bool> isError{false};
+    std::vector<std::thread> threads;
+    begin = std::chrono::steady_clock::now();
+    for (unsigned int t = 0; t < countThreads; t++) {
+        threads.emplace_back([&]{
+            for (int i = next++; i < COUNT_SIGNS; i = next++) {
+                if (!Wallet::verify(messages[i], signatures[i], pubkey)) {
+                    isError = true;
+                }
+            }
+        });
+    }
+    for (std::thread &thread: threads) {
+        thread.join();
+    }
+    if (isError) {
+        std::cout << name << " verify error" << std::endl;
+        exit(1);
+    }
+    std::cout << name << " verify " << countThreads << " threads: " << perSecond(COUNT_SIGNS, begin) << " per second" << std::endl;
+}
+
+int main() {
+    const QString folder = QDir::tempPath() + "/mhcsign_bench";
+    QDir(folder).removeRecursively();
+    QDir().mkpath(folder + "/mhc");
+
+    std::string tmp;
+    std::string addressK1;
+    Wallet::createWallet(folder.toStdString() + "/", true, PASSWORD, tmp, addressK1);
+    std::string addressR1;
+    Wallet::createWalletFromRaw(folder.toStdString() + "/", true, RAW_KEY_R1, PASSWORD, tmp, addressR1);
+
+    bench("secp256k1", Wallet(folder.toStdString() + "/", true, addressK1, PASSWORD));
+    bench("secp256r1", Wallet(folder.toStdString() + "/", true, addressR1, PASSWORD));
+
+    QDir(folder).removeRecursively();
+    return 0;
+}
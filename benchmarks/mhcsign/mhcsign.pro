@@ -0,0 +1,44 @@
+QT -= gui
+QT += widgets
+
+CONFIG += c++14 console
+CONFIG -= app_bundle
+CONFIG += static
+
+INCLUDEPATH = ../../src
+
+SOURCES += \
+    main.cpp \
+    ../../src/Wallets/Wallet.cpp \
+    ../../src/Wallets/EthWallet.cpp \
+    ../../src/Wallets/ethtx/scrypt/crypto_scrypt-nosse.cpp \
+    ../../src/Wallets/ethtx/scrypt/crypto_scrypt-sse.cpp \
+    ../../src/Wallets/ethtx/scrypt/crypto_scrypt-avx2.cpp \
+    ../../src/Wallets/ethtx/scrypt/sha256.cpp \
+    ../../src/Wallets/ethtx/cert.cpp \
+    ../../src/Wallets/ethtx/rlp.cpp \
+    ../../src/Wallets/ethtx/ethtx.cpp \
+    ../../src/Wallets/ethtx/cert2.cpp \
+    ../../src/Wallets/ethtx/scrypt/crypto_scrypt_saltgen.cpp \
+    ../../src/Wallets/ethtx/crossguid/Guid.cpp \
+    ../../src/Wallets/btctx/Base58.cpp \
+    ../../src/Wallets/btctx/btctx.cpp \
+    ../../src/Wallets/btctx/wif.cpp \
+    ../../src/Wallets/BtcWallet.cpp \
+    ../../src/Wallets/openssl_wrapper/openssl_wrapper.cpp \
+    ../../src/utilites/utils.cpp \
+    ../../src/utilites/LockedMemory.cpp \
+    ../../src/Wallets/ethtx/utils2.cpp \
+    ../../src/Wallets/WalletInfo.cpp \
+    ../../tests/LogMock.cpp
+
+
+HEADERS += \
+    ../../src/Wallets/Wallet.h
+
+DEFINES += CRYPTOPP_IMPORTS
+DEFINES += QUAZIP_STATIC
+
+unix:!macx: include(../../libs-unix.pri)
+win32: include(../../libs-win.pri)
+macx: include(../../libs-macos.pri)
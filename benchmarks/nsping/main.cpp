@@ -0,0 +1,130 @@
+#include <QCoreApplication>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QEventLoop>
+#include <QDebug>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <random>
+
+#include "Network/SimpleClient.h"
+#include "NsLookup/PingWindow.h"
+
+using namespace nslookup;
+
+const int COUNT_NODES = 1000;
+const int BATCH_SIZE = 10;
+const double DEAD_NODES_PART = 0.05;
+const milliseconds PING_TIMEOUT = 2s;
+
+// Локальный сервер, отвечающий на любой http запрос с заданной задержкой
+class FakeNode: public QTcpServer {
+public:
+
+    FakeNode(milliseconds latency)
+        : latency(latency)
+    {
+        listen(QHostAddress::LocalHost, 0);
+        connect(this, &QTcpServer::newConnection, this, &FakeNode::onNewConnection);
+    }
+
+private:
+
+    void onNewConnection() {
+        while (hasPendingConnections()) {
+            QTcpSocket *socket = nextPendingConnection();
+            connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+            connect(socket, &QTcpSocket::readyRead, socket, [this, socket]{
+                socket->readAll();
+                QTimer::singleShot(latency.count(), socket, [socket]{
+                    socket->write("HTTP/1.1 200 OK\r\nContent-Length: 2\r\nConnection: close\r\n\r\n{}");
+                    socket->disconnectFromHost();
+                });
+            });
+        }
+    }
+
+private:
+
+    const milliseconds latency;
+};
+
+static std::vector<std::unique_ptr<FakeNode>> makeFarm(int count) {
+    std::mt19937 gen(12345);
+    std::uniform_int_distribution<int> latencyDist(5, 300);
+    std::uniform_real_distribution<double> deadDist(0., 1.);
+    std::vector<std::unique_ptr<FakeNode>> farm;
+    for (int i = 0; i < count; i++) {
+        const milliseconds latency = deadDist(gen) < DEAD_NODES_PART ? milliseconds(5s) : milliseconds(latencyDist(gen));
+        farm.emplace_back(std::make_unique<FakeNode>(latency));
+    }
+    return farm;
+}
+
+static std::vector<QUrl> makeUrls(const std::vector<std::unique_ptr<FakeNode>> &farm) {
+    std::vector<QUrl> urls;
+    for (const auto &node: farm) {
+        urls.emplace_back(QUrl("http://127.0.0.1:" + QString::number(node->serverPort()) + "/"));
+    }
+    return urls;
+}
+
+// Старая схема: пачки по 10, следующая пачка только после завершения всей предыдущей
+static void runBatches(SimpleClient &client, const std::vector<QUrl> &urls, size_t from, const std::function<void()> &finish) {
+    if (from >= urls.size()) {
+        finish();
+        return;
+    }
+    const size_t to = std::min(urls.size(), from + BATCH_SIZE);
+    const std::vector<QUrl> current(urls.begin() + from, urls.begin() + to);
+    client.sendMessagesPost("bench", current, "", [&client, &urls, to, finish](const std::vector<SimpleClient::Response> &) {
+        runBatches(client, urls, to, finish);
+    }, PING_TIMEOUT);
+}
+
+static void calcTime(const QString &name, const std::function<void(const std::function<void()> &finish)> &func) {
+    QEventLoop loop;
+    const auto begin = std::chrono::steady_clock::now();
+    func([&loop]{
+        loop.quit();
+    });
+    loop.exec();
+    const auto end = std::chrono::steady_clock::now();
+    const auto d = std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count();
+    qDebug() << name << QString::number(d / 1000., 'f', 3) << "s";
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    const auto farm = makeFarm(COUNT_NODES);
+    const std::vector<QUrl> urls = makeUrls(farm);
+    qDebug() << "Fake nodes" << farm.size();
+
+    SimpleClient client;
+    QObject::connect(&client, &SimpleClient::callbackCall, [](SimpleClient::ReturnCallback callback) {
+        callback();
+    });
+
+    calcTime("Batches by 10", [&](const std::function<void()> &finish) {
+        runBatches(client, urls, 0, finish);
+    });
+
+    for (const size_t windowSize: {10, 32, 64}) {
+        for (const size_t rateLimit: {0, 500}) {
+            RateLimiter limiter(rateLimit);
+            calcTime(QString("Window %1, rate limit %2").arg(windowSize).arg(rateLimit), [&](const std::function<void()> &finish) {
+                const auto window = std::make_shared<PingWindow>(client, &client, limiter, windowSize);
+                window->start("bench", urls, "", PING_TIMEOUT, [](size_t, const SimpleClient::Response &) {}, finish);
+            });
+        }
+    }
+
+    qDebug() << "ok";
+
+    return 0;
+}
@@ -0,0 +1,30 @@
+QT -= gui
+QT += network widgets
+
+CONFIG += c++14 console
+CONFIG -= app_bundle
+
+INCLUDEPATH = ../../src
+
+SOURCES += \
+    main.cpp \
+    ../../tests/LogMock.cpp \
+    ../../src/TypedException.cpp \
+    ../../src/qt_utilites/QRegister.cpp \
+    ../../src/Network/SimpleClient.cpp \
+    ../../src/Network/ContentDecoder.cpp \
+    ../../src/NsLookup/PingWindow.cpp
+
+
+HEADERS += \
+    ../../src/Log.h \
+    ../../src/TypedException.h \
+    ../../src/qt_utilites/QRegister.h \
+    ../../src/Network/SimpleClient.h \
+    ../../src/Network/ContentDecoder.h \
+    ../../src/NsLookup/PingWindow.h
+
+QMAKE_LFLAGS += -rdynamic
+unix:!macx: include(../../libs-unix.pri)
+win32: include(../../libs-win.pri)
+macx: include(../../libs-macos.pri)
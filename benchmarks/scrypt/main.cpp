@@ -0,0 +1,69 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Wallets/ethtx/const.h"
+#include "Wallets/ethtx/scrypt/crypto_scrypt-smix.h"
+
+const int COUNT_REPEATS = 5;
+
+struct Params {
+    std::string name;
+    uint64_t n;
+    uint32_t r;
+    uint32_t p;
+};
+
+static const std::vector<std::pair<libscrypt_smix_impl, std::string>> IMPLS = {
+    {LIBSCRYPT_SMIX_NOSSE, "nosse"},
+    {LIBSCRYPT_SMIX_SSE2, "sse2"},
+    {LIBSCRYPT_SMIX_AVX2, "avx2"},
+    {LIBSCRYPT_SMIX_AUTO, "auto"},
+};
+
+int main() {
+    const std::string password = "Password 1";
+    const std::string salt(32, 'a');
+
+    const std::vector<Params> params = {
+        // Разблокировка и создание ключа eth
+        {"eth keystore", SCRYPT_DEFAULT_N, SCRYPT_DEFAULT_r, SCRYPT_DEFAULT_p},
+        // bip38 в Wallets/btctx/wif.cpp
+        {"bip38", 16384, 8, 8},
+    };
+
+    for (const Params &param: params) {
+        std::cout << param.name << " N=" << param.n << " r=" << param.r << " p=" << param.p << std::endl;
+        std::string reference;
+        for (const auto &impl: IMPLS) {
+            if (!libscrypt_smix_supported(impl.first)) {
+                std::cout << "  " << impl.second << ": not supported" << std::endl;
+                continue;
+            }
+            std::string result(32, 0);
+            long long best = 0;
+            for (int i = 0; i < COUNT_REPEATS; i++) {
+                const auto begin = std::chrono::steady_clock::now();
+                const int res = libscrypt_scrypt_impl(impl.first, (const uint8_t*)password.data(), password.size(), (const uint8_t*)salt.data(), salt.size(), param.n, param.r, param.p, (uint8_t*)&result[0], result.size());
+                const auto end = std::chrono::steady_clock::now();
+                if (res != 0) {
+                    std::cout << "  " << impl.second << ": error" << std::endl;
+                    return 1;
+                }
+                const long long time = std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count();
+                if (i == 0 || time < best) {
+                    best = time;
+                }
+            }
+            if (reference.empty()) {
+                reference = result;
+            } else if (reference != result) {
+                std::cout << "  " << impl.second << ": result differs" << std::endl;
+                return 1;
+            }
+            std::cout << "  " << impl.second << ": " << best << " ms" << std::endl;
+        }
+    }
+    return 0;
+}
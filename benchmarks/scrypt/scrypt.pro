@@ -0,0 +1,22 @@
+QT -= gui
+
+CONFIG += c++14 console
+CONFIG -= app_bundle
+
+INCLUDEPATH = ../../src
+
+SOURCES += \
+    main.cpp \
+    ../../src/Wallets/ethtx/scrypt/crypto_scrypt-nosse.cpp \
+    ../../src/Wallets/ethtx/scrypt/crypto_scrypt-sse.cpp \
+    ../../src/Wallets/ethtx/scrypt/crypto_scrypt-avx2.cpp \
+    ../../src/Wallets/ethtx/scrypt/sha256.cpp
+
+
+HEADERS += \
+    ../../src/Wallets/ethtx/const.h \
+    ../../src/Wallets/ethtx/scrypt/libscrypt.h \
+    ../../src/Wallets/ethtx/scrypt/crypto_scrypt-smix.h \
+    ../../src/Wallets/ethtx/scrypt/crypto_scrypt-sse.h \
+    ../../src/Wallets/ethtx/scrypt/sha256.h \
+    ../../src/Wallets/ethtx/scrypt/sysendian.h
@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <QDir>
+
+#include "Wallets/Wallet.h"
+#include "Wallets/EthWallet.h"
+#include "Wallets/BtcWallet.h"
+
+// Сравнение подписи с расшифровкой ключа на каждый вызов и подписи разблокированным ключом, как в сессии Wallets::unlockKey
+
+const int COUNT_COLD = 5;
+
+const int COUNT_UNLOCKED = 1000;
+
+const std::string PASSWORD = "123";
+
+static double latencyMs(int count, const std::function<void()> &func) {
+    const auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; i++) {
+        func();
+    }
+    const auto time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count();
+    return time / 1000. / count;
+}
+
+static void print(const std::string &name, double cold, double unlocked) {
+    std::cout << name << " decrypt and sign: " << cold << " ms, unlocked sign: " << unlocked << " ms, x" << cold / std::max(unlocked, 0.001) << std::endl;
+}
+
+static void benchMhc(const QString &folder) {
+    std::string tmp;
+    std::string address;
+    Wallet::createWallet(folder, true, PASSWORD, tmp, address);
+
+    const std::string tx = Wallet::genTx(address, 1000, 0, 1, "", true);
+    const double cold = latencyMs(COUNT_COLD, [&]{
+        Wallet wallet(folder, true, address, PASSWORD);
+        std::string pubkey;
+        wallet.sign(tx, pubkey);
+    });
+
+    const Wallet wallet(folder, true, address, PASSWORD);
+    const double unlocked = latencyMs(COUNT_UNLOCKED, [&]{
+        std::string pubkey;
+        wallet.sign(tx, pubkey);
+    });
+    print("mhc", cold, unlocked);
+}
+
+static void benchEth(const QString &folder) {
+    const std::string address = EthWallet::genPrivateKey(folder, PASSWORD);
+
+    const auto sign = [](EthWallet &wallet) {
+        wallet.SignTransaction("0x01", "0x6C088E200", "0x8208", "0x8D78B1Ab426dc9daa7427b7A60E64633f62E645F", "0x746A528800", "");
+    };
+    const double cold = latencyMs(COUNT_COLD, [&]{
+        EthWallet wallet(folder, address, PASSWORD);
+        sign(wallet);
+    });
+
+    EthWallet wallet(folder, address, PASSWORD);
+    const double unlocked = latencyMs(COUNT_UNLOCKED, [&]{
+        sign(wallet);
+    });
+    print("eth", cold, unlocked);
+}
+
+static void benchBtc(const QString &folder) {
+    const std::string address = BtcWallet::genPrivateKey(folder, QString::fromStdString(PASSWORD)).first;
+
+    std::vector<BtcInput> inputs(1);
+    inputs[0].spendtxid = "72ecdaf25a178f6879c4d879551a06b2f0344ca137de3e5afb7820cdb57722b8";
+    inputs[0].spendoutnum = 1;
+    inputs[0].scriptPubkey = "76a9145e05738474a2d065b554bd8564857e166031570688ac";
+    inputs[0].outBalance = 1990000;
+    const auto sign = [&inputs](BtcWallet &wallet) {
+        wallet.genTransaction(inputs, 1000000, 10000, "3FnoJdQLXto5GFUcf4xkBGnGZ1JvQQ6rDD", false);
+    };
+    const double cold = latencyMs(COUNT_COLD, [&]{
+        BtcWallet wallet(folder, address, QString::fromStdString(PASSWORD));
+        sign(wallet);
+    });
+
+    BtcWallet wallet(folder, address, QString::fromStdString(PASSWORD));
+    const double unlocked = latencyMs(COUNT_UNLOCKED, [&]{
+        sign(wallet);
+    });
+    print("btc", cold, unlocked);
+}
+
+int main() {
+    const QString folder = QDir::tempPath() + "/walletunlock_bench/";
+    QDir(folder).removeRecursively();
+    QDir().mkpath(folder + Wallet::chooseSubfolder(true));
+    QDir().mkpath(folder + EthWallet::subfolder());
+    QDir().mkpath(folder + BtcWallet::subfolder());
+
+    benchMhc(folder);
+    benchEth(folder);
+    benchBtc(folder);
+
+    QDir(folder).removeRecursively();
+    return 0;
+}
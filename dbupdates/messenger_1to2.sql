@@ -0,0 +1,2 @@
+CREATE INDEX IF NOT EXISTS messagesHashIdx ON messages(userid, hash);
+CREATE INDEX IF NOT EXISTS messagesConfirmedCounterIdx ON messages(userid, isConfirmed, morder)
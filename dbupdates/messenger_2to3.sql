@@ -0,0 +1 @@
+CREATE VIRTUAL TABLE IF NOT EXISTS messagessearch USING fts5(text, tokenize = 'unicode61')
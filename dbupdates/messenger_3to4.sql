@@ -0,0 +1,2 @@
+DROP INDEX IF EXISTS messagesConfirmedCounterIdx;
+CREATE INDEX IF NOT EXISTS messagesConfirmedCounterIdx ON messages(userid, channelid, isConfirmed, morder)
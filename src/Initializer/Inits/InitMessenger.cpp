@@ -60,6 +60,7 @@ InitMessenger::Return InitMessenger::initialize(SharedFuture<MainWindow> mainWin
         javascript->moveToThread(mainThread);
         database = std::make_unique<messenger::MessengerDBStorage>(getDbPath());
         database->init();
+        database->checkSearchIndex();
         manager = std::make_unique<messenger::Messenger>(*javascript, *database, *crypto, mainWindow.get());
         manager->start();
         javascript->setMessenger(*manager);
@@ -35,6 +35,7 @@ using namespace std::placeholders;
 #include "Paths.h"
 #include "qt_utilites/makeJsFunc.h"
 #include "qt_utilites/QRegister.h"
+#include "qt_utilites/JsDispatcher.h"
 
 #include "utilites/machine_uid.h"
 
@@ -51,6 +52,18 @@ SET_LOG_NAMESPACE("JSW");
 
 const QString JavascriptWrapper::defaultUsername = "_unregistered";
 
+// Ключи из каталога в формате адрес, путь. Watch кошельки не включаются
+static std::vector<std::pair<QString, QString>> keysToPairs(const std::vector<wallets::WalletInfo> &wallets) {
+    std::vector<std::pair<QString, QString>> result;
+    result.reserve(wallets.size());
+    for (const wallets::WalletInfo &info: wallets) {
+        if (info.type == wallets::WalletInfo::Type::Key) {
+            result.emplace_back(info.address, info.path);
+        }
+    }
+    return result;
+}
+
 static QString makeJsonWallets(const std::vector<std::pair<QString, QString>> &wallets) {
     QJsonArray jsonArray;
     for (const auto &r: wallets) {
@@ -368,7 +381,7 @@ END_SLOT_WRAPPER
 QString JavascriptWrapper::getAllMTHSWalletsAndPathsJson(bool isMhc, QString name) {
     try {
         CHECK(!walletPath.isNull() && !walletPath.isEmpty(), "Incorrect path to wallet: empty");
-        const std::vector<std::pair<QString, QString>> result = Wallet::getAllWalletsInFolder(walletPath, isMhc);
+        const std::vector<std::pair<QString, QString>> result = keysToPairs(wallets.getCatalogue().getWallets(walletPath, isMhc ? wallets::WalletCurrency::Mth : wallets::WalletCurrency::Tmh));
         const QString jsonStr = makeJsonWalletsAndPaths(result);
         LOG << PeriodicLog::make("w2_" + name.toStdString()) << "get " << name << " wallets json " << jsonStr << " " << walletPath;
         return jsonStr;
@@ -384,7 +397,7 @@ QString JavascriptWrapper::getAllMTHSWalletsAndPathsJson(bool isMhc, QString nam
 QString JavascriptWrapper::getAllMTHSWalletsJson(bool isMhc, QString name) {
     try {
         CHECK(!walletPath.isNull() && !walletPath.isEmpty(), "Incorrect path to wallet: empty");
-        const std::vector<std::pair<QString, QString>> result = Wallet::getAllWalletsInFolder(walletPath, isMhc);
+        const std::vector<std::pair<QString, QString>> result = keysToPairs(wallets.getCatalogue().getWallets(walletPath, isMhc ? wallets::WalletCurrency::Mth : wallets::WalletCurrency::Tmh));
         const QString jsonStr = makeJsonWallets(result);
         LOG << PeriodicLog::make("w_" + name.toStdString()) << "get " << name << " wallets json " << jsonStr << " " << walletPath;
         return jsonStr;
@@ -400,7 +413,7 @@ QString JavascriptWrapper::getAllMTHSWalletsJson(bool isMhc, QString name) {
 QString JavascriptWrapper::getAllMTHSWalletsInfoJson(bool isMhc, QString name) {
     try {
         CHECK(!walletPath.isNull() && !walletPath.isEmpty(), "Incorrect path to wallet: empty");
-        const std::vector<wallets::WalletInfo> result = Wallet::getAllWalletsInfoInFolder(walletPath, isMhc);
+        const std::vector<wallets::WalletInfo> result = wallets.getCatalogue().getWallets(walletPath, isMhc ? wallets::WalletCurrency::Mth : wallets::WalletCurrency::Tmh);
         const QString jsonStr = makeJsonWalletsInfo(result);
         LOG << PeriodicLog::make("w3_" + name.toStdString()) << "get " << name << " wallets json " << jsonStr << " " << walletPath;
         return jsonStr;
@@ -784,7 +797,7 @@ END_SLOT_WRAPPER
     });
 
     if (exception.numError != TypeErrors::NOT_ERROR) {
-        jsRunSig(JS_NAME_RESULT + "(" +
+        runJs(JS_NAME_RESULT + "(" +
             "\"" + requestId + "\", " +
             "\"" + "" + "\", " +
             QString::fromStdString(std::to_string(exception.numError)) + ", " +
@@ -797,7 +810,7 @@ END_SLOT_WRAPPER
 QString JavascriptWrapper::getAllEthWalletsJson() {
     try {
         CHECK(!walletPath.isEmpty(), "Incorrect path to wallet: empty");
-        const std::vector<std::pair<QString, QString>> result = EthWallet::getAllWalletsInFolder(walletPath);
+        const std::vector<std::pair<QString, QString>> result = keysToPairs(wallets.getCatalogue().getWallets(walletPath, wallets::WalletCurrency::Eth));
         const QString jsonStr = makeJsonWallets(result);
         LOG << PeriodicLog::make("w_eth") << "get eth wallets json " << jsonStr;
         return jsonStr;
@@ -819,7 +832,7 @@ QString JavascriptWrapper::getAllEthWalletsJson() {
 QString JavascriptWrapper::getAllEthWalletsAndPathsJson() {
     try {
         CHECK(!walletPath.isEmpty(), "Incorrect path to wallet: empty");
-        const std::vector<std::pair<QString, QString>> result = EthWallet::getAllWalletsInFolder(walletPath);
+        const std::vector<std::pair<QString, QString>> result = keysToPairs(wallets.getCatalogue().getWallets(walletPath, wallets::WalletCurrency::Eth));
         const QString jsonStr = makeJsonWalletsAndPaths(result);
         LOG << PeriodicLog::make("w2_eth") << "get eth wallets json " << jsonStr;
         return jsonStr;
@@ -1005,7 +1018,7 @@ END_SLOT_WRAPPER
 QString JavascriptWrapper::getAllBtcWalletsJson() {
     try {
         CHECK(!walletPath.isEmpty(), "Incorrect path to wallet: empty");
-        const std::vector<std::pair<QString, QString>> result = BtcWallet::getAllWalletsInFolder(walletPath);
+        const std::vector<std::pair<QString, QString>> result = keysToPairs(wallets.getCatalogue().getWallets(walletPath, wallets::WalletCurrency::Btc));
         const QString jsonStr = makeJsonWallets(result);
         LOG << PeriodicLog::make("w_btc") << "get btc wallets json " << jsonStr;
         return jsonStr;
@@ -1021,7 +1034,7 @@ QString JavascriptWrapper::getAllBtcWalletsJson() {
 QString JavascriptWrapper::getAllBtcWalletsAndPathsJson() {
     try {
         CHECK(!walletPath.isEmpty(), "Incorrect path to wallet: empty");
-        const std::vector<std::pair<QString, QString>> result = BtcWallet::getAllWalletsInFolder(walletPath);
+        const std::vector<std::pair<QString, QString>> result = keysToPairs(wallets.getCatalogue().getWallets(walletPath, wallets::WalletCurrency::Btc));
         const QString jsonStr = makeJsonWalletsAndPaths(result);
         LOG << PeriodicLog::make("w2_btc") << "get btc wallets json " << jsonStr;
         return jsonStr;
@@ -1346,6 +1359,7 @@ END_SLOT_WRAPPER
 void JavascriptWrapper::onDirChanged(const QString &dir) {
 BEGIN_SLOT_WRAPPER
     const QString JS_NAME_RESULT = "directoryChangedResultJs";
+    wallets.getCatalogue().invalidate(dir);
     const QDir d(dir);
     for (const FolderWalletInfo &folderInfo: folderWalletsInfos) {
         if (folderInfo.walletPath == d) {
@@ -1458,5 +1472,9 @@ END_SLOT_WRAPPER
 }
 
 void JavascriptWrapper::runJs(const QString &script) {
+    if (!JsDispatcher::isScriptComplete(script)) {
+        LOG << "Error: incorrect javascript " << script.left(100);
+        return;
+    }
     emit jsRunSig(script);
 }
@@ -0,0 +1,345 @@
+#include "MHUrlCache.h"
+
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
+#include <QDir>
+#include <QTimer>
+#include <QPointer>
+
+#include "check.h"
+#include "Log.h"
+#include "utilites/utils.h"
+#include "qt_utilites/SlotWrapper.h"
+
+SET_LOG_NAMESPACE("MW");
+
+static const quint32 CACHE_FILE_VERSION = 1;
+
+static const QString CACHE_FILE_SUFFIX = ".cache";
+
+static const size_t MAX_ENTRY_SIZE = 8 * 1024 * 1024;
+
+static const seconds MAX_HEURISTIC_FRESHNESS = 24h;
+
+static system_time_point fromDateTime(const QDateTime &dateTime) {
+    return intToSystemTimePoint(dateTime.toMSecsSinceEpoch());
+}
+
+// Возвращает false, если ответ запрещено сохранять
+static bool calcExpires(const QNetworkReply &reply, const system_time_point &now, system_time_point &expires) {
+    const QByteArray cacheControl = reply.rawHeader("Cache-Control").toLower();
+    bool isMaxAge = false;
+    for (const QByteArray &directiveRaw: cacheControl.split(',')) {
+        const QByteArray directive = directiveRaw.trimmed();
+        if (directive == "no-store") {
+            return false;
+        } else if (directive == "no-cache") {
+            expires = now;
+            return true;
+        } else if (directive.startsWith("max-age=")) {
+            bool isOk = false;
+            const long long maxAge = directive.mid(8).toLongLong(&isOk);
+            if (isOk) {
+                expires = now + seconds(std::max(0ll, maxAge));
+                isMaxAge = true;
+            }
+        }
+    }
+    if (isMaxAge) {
+        return true;
+    }
+
+    if (reply.hasRawHeader("Expires")) {
+        const QDateTime expiresDate = QDateTime::fromString(QString::fromLatin1(reply.rawHeader("Expires").trimmed()), Qt::RFC2822Date);
+        expires = expiresDate.isValid() ? fromDateTime(expiresDate) : now;
+        return true;
+    }
+
+    const QDateTime lastModified = reply.header(QNetworkRequest::LastModifiedHeader).toDateTime();
+    if (lastModified.isValid()) {
+        // Эвристика из RFC 7234: десятая часть возраста ресурса
+        const milliseconds age = std::chrono::duration_cast<milliseconds>(now - fromDateTime(lastModified));
+        expires = now + std::min(std::max(milliseconds(0), age / 10), milliseconds(MAX_HEURISTIC_FRESHNESS));
+        return true;
+    }
+
+    expires = now;
+    return true;
+}
+
+MHUrlCache::MHUrlCache(const QString &path, size_t maxMemoryBytes, size_t maxDiskBytes)
+    : path(path)
+    , maxMemoryBytes(maxMemoryBytes)
+    , maxDiskBytes(maxDiskBytes)
+    , ioContext(std::make_unique<QObject>())
+{
+    ioContext->moveToThread(&ioThread);
+    ioThread.start();
+    loadDiskIndex();
+}
+
+MHUrlCache::~MHUrlCache() {
+    ioThread.quit();
+    ioThread.wait();
+}
+
+bool MHUrlCache::isCacheableSize(qint64 size) {
+    return size >= 0 && (size_t)size <= MAX_ENTRY_SIZE;
+}
+
+void MHUrlCache::runIo(const std::function<void()> &func) {
+    QTimer::singleShot(0, ioContext.get(), [func]{
+    BEGIN_SLOT_WRAPPER
+        func();
+    END_SLOT_WRAPPER
+    });
+}
+
+void MHUrlCache::runOwner(const std::function<void()> &func) {
+    QTimer::singleShot(0, &ownerContext, [func]{
+    BEGIN_SLOT_WRAPPER
+        func();
+    END_SLOT_WRAPPER
+    });
+}
+
+QString MHUrlCache::fileNameForKey(const QString &key) const {
+    return QString(QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex()) + CACHE_FILE_SUFFIX;
+}
+
+void MHUrlCache::loadDiskIndex() {
+    runIo([this]{
+        createFolder(path);
+        const QFileInfoList files = QDir(path).entryInfoList(QStringList() << ("*" + CACHE_FILE_SUFFIX), QDir::Files, QDir::Time);
+        std::vector<std::pair<QString, size_t>> result;
+        result.reserve(files.size());
+        for (const QFileInfo &file: files) {
+            result.emplace_back(file.fileName(), file.size());
+        }
+        runOwner([this, result]{
+            onDiskIndexLoaded(result);
+        });
+    });
+}
+
+void MHUrlCache::onDiskIndexLoaded(const std::vector<std::pair<QString, size_t>> &files) {
+    // Записи, сохраненные до загрузки индекса, новее файлов с диска
+    for (const auto &file: files) {
+        if (disk.find(file.first) != disk.end()) {
+            continue;
+        }
+        diskLru.emplace_back(file.first);
+        DiskElement &element = disk[file.first];
+        element.size = file.second;
+        element.lruIter = std::prev(diskLru.end());
+        diskBytes += element.size;
+    }
+    trimDisk();
+    LOG << "Http cache loaded " << disk.size() << " entries, " << diskBytes << " bytes";
+}
+
+void MHUrlCache::putToMemory(const std::shared_ptr<const Entry> &entry) {
+    const auto found = memory.find(entry->key);
+    if (found != memory.end()) {
+        memoryBytes -= found->second.entry->body.size();
+        memoryLru.erase(found->second.lruIter);
+        memory.erase(found);
+    }
+
+    memoryLru.emplace_front(entry->key);
+    MemoryElement &element = memory[entry->key];
+    element.entry = entry;
+    element.lruIter = memoryLru.begin();
+    memoryBytes += entry->body.size();
+
+    while (memoryBytes > maxMemoryBytes && memoryLru.size() > 1) {
+        const auto last = memory.find(memoryLru.back());
+        CHECK(last != memory.end(), "Incorrect memory cache state");
+        memoryBytes -= last->second.entry->body.size();
+        memory.erase(last);
+        memoryLru.pop_back();
+    }
+}
+
+void MHUrlCache::removeFromDisk(const QString &fileName) {
+    const auto found = disk.find(fileName);
+    if (found == disk.end()) {
+        return;
+    }
+    diskBytes -= found->second.size;
+    diskLru.erase(found->second.lruIter);
+    disk.erase(found);
+    runIo([filePath=makePath(path, fileName)]{
+        removeFile(filePath);
+    });
+}
+
+void MHUrlCache::trimDisk() {
+    while (diskBytes > maxDiskBytes && diskLru.size() > 1) {
+        removeFromDisk(diskLru.back());
+    }
+}
+
+void MHUrlCache::putToDisk(const std::shared_ptr<const Entry> &entry) {
+    const QString fileName = fileNameForKey(entry->key);
+    removeFromDisk(fileName);
+
+    // Точный размер станет известен после записи
+    diskLru.emplace_front(fileName);
+    DiskElement &element = disk[fileName];
+    element.size = entry->body.size();
+    element.lruIter = diskLru.begin();
+    diskBytes += element.size;
+    trimDisk();
+
+    runIo([this, entry, fileName]{
+        QFile file(makePath(path, fileName));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            LOG << "Warn. Not open http cache file " << fileName;
+            return;
+        }
+        QDataStream stream(&file);
+        stream.setVersion(QDataStream::Qt_5_10);
+        stream << CACHE_FILE_VERSION << entry->key << entry->mime << entry->etag << entry->lastModified << static_cast<qint64>(systemTimePointToInt(entry->expires)) << entry->body;
+        const size_t size = file.size();
+        file.close();
+
+        runOwner([this, fileName, size]{
+            const auto found = disk.find(fileName);
+            if (found == disk.end()) {
+                return;
+            }
+            diskBytes = diskBytes - found->second.size + size;
+            found->second.size = size;
+            trimDisk();
+        });
+    });
+}
+
+void MHUrlCache::readFromDisk(const QString &key, QObject *context, const FindCallback &callback) {
+    const QString fileName = fileNameForKey(key);
+    if (disk.find(fileName) == disk.end()) {
+        callback(nullptr);
+        return;
+    }
+
+    runIo([this, key, fileName, context=QPointer<QObject>(context), callback]{
+        std::shared_ptr<Entry> entry;
+        QFile file(makePath(path, fileName));
+        if (file.open(QIODevice::ReadOnly)) {
+            QDataStream stream(&file);
+            stream.setVersion(QDataStream::Qt_5_10);
+            entry = std::make_shared<Entry>();
+            quint32 version = 0;
+            qint64 expires = 0;
+            stream >> version;
+            if (version == CACHE_FILE_VERSION) {
+                stream >> entry->key >> entry->mime >> entry->etag >> entry->lastModified >> expires >> entry->body;
+            }
+            // Время изменения файла используется как время последнего обращения при следующем запуске
+            file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+            file.close();
+            if (version != CACHE_FILE_VERSION || stream.status() != QDataStream::Ok || entry->key != key) {
+                entry = nullptr;
+            } else {
+                entry->expires = intToSystemTimePoint(expires);
+            }
+        }
+
+        runOwner([this, fileName, entry, context, callback]{
+            const auto found = disk.find(fileName);
+            if (entry == nullptr) {
+                removeFromDisk(fileName);
+            } else if (found != disk.end()) {
+                diskLru.splice(diskLru.begin(), diskLru, found->second.lruIter);
+                putToMemory(entry);
+            }
+            if (context != nullptr) {
+                callback(entry);
+            }
+        });
+    });
+}
+
+void MHUrlCache::find(const QString &key, QObject *context, const FindCallback &callback) {
+    const auto found = memory.find(key);
+    if (found != memory.end()) {
+        memoryLru.splice(memoryLru.begin(), memoryLru, found->second.lruIter);
+        callback(found->second.entry);
+        return;
+    }
+
+    readFromDisk(key, context, callback);
+}
+
+bool MHUrlCache::put(const QString &key, const QByteArray &mime, const QByteArray &body, const QNetworkReply &reply) {
+    if (!isCacheableSize(body.size())) {
+        return false;
+    }
+
+    auto entry = std::make_shared<Entry>();
+    entry->key = key;
+    entry->mime = mime;
+    entry->body = body;
+    entry->etag = reply.rawHeader("ETag");
+    entry->lastModified = reply.rawHeader("Last-Modified");
+    const system_time_point now = ::system_now();
+    if (!calcExpires(reply, now, entry->expires)) {
+        remove(key);
+        return false;
+    }
+    if (!entry->isFresh(now) && !entry->canRevalidate()) {
+        remove(key);
+        return false;
+    }
+
+    putToDisk(entry);
+    putToMemory(entry);
+    return true;
+}
+
+std::shared_ptr<const MHUrlCache::Entry> MHUrlCache::refresh(const std::shared_ptr<const Entry> &entry, const QNetworkReply &reply) {
+    auto updated = std::make_shared<Entry>(*entry);
+    if (reply.hasRawHeader("ETag")) {
+        updated->etag = reply.rawHeader("ETag");
+    }
+    if (reply.hasRawHeader("Last-Modified")) {
+        updated->lastModified = reply.rawHeader("Last-Modified");
+    }
+    if (!calcExpires(reply, ::system_now(), updated->expires)) {
+        remove(entry->key);
+        return updated;
+    }
+
+    putToDisk(updated);
+    putToMemory(updated);
+    return updated;
+}
+
+void MHUrlCache::remove(const QString &key) {
+    const auto found = memory.find(key);
+    if (found != memory.end()) {
+        memoryBytes -= found->second.entry->body.size();
+        memoryLru.erase(found->second.lruIter);
+        memory.erase(found);
+    }
+    removeFromDisk(fileNameForKey(key));
+}
+
+void MHUrlCache::addHit(size_t size) {
+    stats.hits++;
+    stats.bytesSaved += size;
+}
+
+void MHUrlCache::addRevalidated(size_t size) {
+    stats.revalidated++;
+    stats.bytesSaved += size;
+}
+
+void MHUrlCache::addMiss() {
+    stats.misses++;
+}
@@ -0,0 +1,156 @@
+#ifndef MHURLCACHE_H
+#define MHURLCACHE_H
+
+#include <QString>
+#include <QByteArray>
+#include <QObject>
+#include <QThread>
+
+#include <list>
+#include <memory>
+#include <map>
+#include <functional>
+
+#include "duration.h"
+
+class QNetworkReply;
+
+/*
+   Кеш ответов для схемы mh://. Ключ - исходный mh url, а не ip, на который ушел запрос.
+   Записи хранятся в памяти и на диске, оба уровня ограничены по размеру и вытесняются по LRU.
+   Время жизни записи определяется по Cache-Control/Expires/Last-Modified,
+   устаревшие записи с ETag или Last-Modified перепроверяются условным запросом.
+   Индексы обоих уровней живут в потоке владельца, чтение и запись файлов идут в отдельном потоке.
+   */
+class MHUrlCache {
+public:
+
+    struct Entry {
+        QString key;
+        QByteArray mime;
+        QByteArray etag;
+        QByteArray lastModified;
+        system_time_point expires;
+        QByteArray body;
+
+        bool isFresh(const system_time_point &now) const {
+            return now < expires;
+        }
+
+        bool canRevalidate() const {
+            return !etag.isEmpty() || !lastModified.isEmpty();
+        }
+    };
+
+    struct Stats {
+        size_t hits = 0;
+        size_t revalidated = 0;
+        size_t misses = 0;
+        size_t bytesSaved = 0;
+
+        double hitRate() const {
+            const size_t all = hits + revalidated + misses;
+            return all == 0 ? 0. : double(hits + revalidated) / all;
+        }
+    };
+
+    // nullptr, если записи нет
+    using FindCallback = std::function<void(const std::shared_ptr<const Entry> &entry)>;
+
+public:
+
+    MHUrlCache(const QString &path, size_t maxMemoryBytes, size_t maxDiskBytes);
+
+    ~MHUrlCache();
+
+    static bool isCacheableSize(qint64 size);
+
+    // Запись из памяти возвращается сразу, с диска - после чтения в потоке ввода-вывода.
+    // callback не вызывается, если context удален
+    void find(const QString &key, QObject *context, const FindCallback &callback);
+
+    // Сохраняет ответ 200, если он кешируемый. Возвращает false, если ответ кешировать нельзя
+    bool put(const QString &key, const QByteArray &mime, const QByteArray &body, const QNetworkReply &reply);
+
+    // Обновляет время жизни записи после ответа 304
+    std::shared_ptr<const Entry> refresh(const std::shared_ptr<const Entry> &entry, const QNetworkReply &reply);
+
+    void remove(const QString &key);
+
+    void addHit(size_t size);
+
+    void addRevalidated(size_t size);
+
+    void addMiss();
+
+    const Stats& getStats() const {
+        return stats;
+    }
+
+private:
+
+    struct MemoryElement {
+        std::shared_ptr<const Entry> entry;
+        std::list<QString>::iterator lruIter;
+    };
+
+    struct DiskElement {
+        size_t size;
+        std::list<QString>::iterator lruIter;
+    };
+
+private:
+
+    // func выполняется в потоке ввода-вывода, задачи выполняются по порядку
+    void runIo(const std::function<void()> &func);
+
+    // func выполняется в потоке владельца кеша
+    void runOwner(const std::function<void()> &func);
+
+    void loadDiskIndex();
+
+    void onDiskIndexLoaded(const std::vector<std::pair<QString, size_t>> &files);
+
+    void putToMemory(const std::shared_ptr<const Entry> &entry);
+
+    void putToDisk(const std::shared_ptr<const Entry> &entry);
+
+    void readFromDisk(const QString &key, QObject *context, const FindCallback &callback);
+
+    void removeFromDisk(const QString &fileName);
+
+    void trimDisk();
+
+    QString fileNameForKey(const QString &key) const;
+
+private:
+
+    const QString path;
+
+    const size_t maxMemoryBytes;
+
+    const size_t maxDiskBytes;
+
+    std::list<QString> memoryLru;
+
+    std::map<QString, MemoryElement> memory;
+
+    size_t memoryBytes = 0;
+
+    std::list<QString> diskLru;
+
+    std::map<QString, DiskElement> disk;
+
+    size_t diskBytes = 0;
+
+    Stats stats;
+
+    QObject ownerContext;
+
+    QThread ioThread;
+
+    std::unique_ptr<QObject> ioContext;
+
+};
+
+#endif // MHURLCACHE_H
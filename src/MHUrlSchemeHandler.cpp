@@ -4,11 +4,16 @@
 #include <QNetworkAccessManager>
 #include <QNetworkRequest>
 #include <QNetworkReply>
+#include <QBuffer>
+#include <QPointer>
+
+#include <deque>
 
 #include "MainWindow.h"
 #include "qt_utilites/SlotWrapper.h"
 #include "qt_utilites/QRegister.h"
 #include "check.h"
+#include "Paths.h"
 
 SET_LOG_NAMESPACE("MW");
 
@@ -16,6 +21,34 @@ const static QNetworkRequest::Attribute REQUEST_ID_FIELD = QNetworkRequest::Attr
 const static QNetworkRequest::Attribute TIME_BEGIN_FIELD = QNetworkRequest::Attribute(QNetworkRequest::User + 1);
 const static QNetworkRequest::Attribute TIMOUT_FIELD = QNetworkRequest::Attribute(QNetworkRequest::User + 2);
 const static QNetworkRequest::Attribute IGNORE_ERRORS_FIELD = QNetworkRequest::Attribute(QNetworkRequest::User + 3);
+const static QNetworkRequest::Attribute CACHE_KEY_FIELD = QNetworkRequest::Attribute(QNetworkRequest::User + 4);
+const static QNetworkRequest::Attribute REFETCH_FIELD = QNetworkRequest::Attribute(QNetworkRequest::User + 5);
+
+const static size_t CACHE_MEMORY_SIZE = 64 * 1024 * 1024;
+
+const static size_t CACHE_DISK_SIZE = 256 * 1024 * 1024;
+
+const static size_t CACHE_STATS_PERIOD = 100;
+
+const static size_t RACE_COUNT_IPS = 3;
+
+const static milliseconds RACE_STAGGER = 250ms;
+
+const static milliseconds RACE_TIMEOUT = 5s;
+
+// Состояние параллельных запросов к нескольким ip одной страницы
+struct MHUrlSchemeHandler::Race {
+    QWebEngineUrlRequestJob *job = nullptr;
+    MainWindow *win = nullptr;
+    QUrl url;
+    QString host;
+    std::shared_ptr<const MHUrlCache::Entry> cached;
+    std::set<QString> excludesIps;
+    std::deque<QString> pendingIps;
+    std::vector<QPointer<QNetworkReply>> replies;
+    size_t countInFlight = 0;
+    bool isFinished = false;
+};
 
 static void addRequestId(QNetworkRequest &request, const std::string &id) {
     request.setAttribute(REQUEST_ID_FIELD, QString::fromStdString(id));
@@ -71,10 +104,41 @@ static bool getIgnoreError(const QNetworkReply &reply) {
     return reply.request().attribute(IGNORE_ERRORS_FIELD).toBool();
 }
 
+static void addCacheKey(QNetworkRequest &request, const QString &key) {
+    request.setAttribute(CACHE_KEY_FIELD, key);
+}
+
+static bool isCacheKey(const QNetworkReply &reply) {
+    return reply.request().attribute(CACHE_KEY_FIELD).userType() == QMetaType::QString;
+}
+
+static QString getCacheKey(const QNetworkReply &reply) {
+    CHECK(isCacheKey(reply), "Cache key field not set");
+    return reply.request().attribute(CACHE_KEY_FIELD).toString();
+}
+
+static void addRefetch(QNetworkRequest &request) {
+    request.setAttribute(REFETCH_FIELD, true);
+}
+
+static bool isRefetch(const QNetworkReply &reply) {
+    return reply.request().attribute(REFETCH_FIELD).toBool();
+}
+
+static QByteArray getMime(const QNetworkReply &reply) {
+    QByteArray mime = reply.header(QNetworkRequest::ContentTypeHeader).toByteArray();
+    const int pos = mime.indexOf(';');
+    if (pos != -1) {
+        mime = mime.left(pos);
+    }
+    return mime;
+}
+
 MHUrlSchemeHandler::MHUrlSchemeHandler(QObject *parent)
     : QWebEngineUrlSchemeHandler(parent)
 {
     m_manager = new QNetworkAccessManager(this);
+    cache = std::make_unique<MHUrlCache>(getHttpCachePath(), CACHE_MEMORY_SIZE, CACHE_DISK_SIZE);
 
     Q_CONNECT(&timer, &QTimer::timeout, this, &MHUrlSchemeHandler::onTimerEvent);
     timer.setInterval(milliseconds(1s).count());
@@ -89,6 +153,64 @@ void MHUrlSchemeHandler::setFirstRun() {
     isFirstRun = true;
 }
 
+MHUrlCache::Stats MHUrlSchemeHandler::getCacheStats() const {
+    return cache->getStats();
+}
+
+void MHUrlSchemeHandler::logCacheStats() {
+    const MHUrlCache::Stats &stats = cache->getStats();
+    const size_t all = stats.hits + stats.revalidated + stats.misses;
+    if (all % CACHE_STATS_PERIOD == 0) {
+        LOG << "Http cache: hit rate " << stats.hitRate() << ", hits " << stats.hits << ", revalidated " << stats.revalidated << ", misses " << stats.misses << ", bytes saved " << stats.bytesSaved;
+    }
+}
+
+void MHUrlSchemeHandler::replyFromBuffer(QWebEngineUrlRequestJob *job, const QByteArray &mime, const QByteArray &body) {
+    QBuffer *buffer = new QBuffer(job);
+    buffer->setData(body);
+    buffer->open(QIODevice::ReadOnly);
+    job->reply(mime, buffer);
+}
+
+bool MHUrlSchemeHandler::replyStale(QWebEngineUrlRequestJob *job, const std::shared_ptr<const MHUrlCache::Entry> &cached) {
+    if (cached == nullptr) {
+        return false;
+    }
+    // Сервер недоступен, устаревшая запись лучше ошибки
+    LOG << "Http cache: serve stale " << cached->key;
+    cache->addHit(cached->body.size());
+    logCacheStats();
+    replyFromBuffer(job, cached->mime, cached->body);
+    return true;
+}
+
+bool MHUrlSchemeHandler::streamLargeReply(QNetworkReply *reply) {
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    const QVariant length = reply->header(QNetworkRequest::ContentLengthHeader);
+    if (status != 200 || !length.isValid() || MHUrlCache::isCacheableSize(length.toLongLong())) {
+        return false;
+    }
+    QWebEngineUrlRequestJob *job = qobject_cast<QWebEngineUrlRequestJob *>(reply->parent());
+    if (!job) {
+        return false;
+    }
+
+    // Тело не поместится в кеш, поэтому не буферизуется, а сразу отдается странице
+    if (isRequestId(*reply)) {
+        removeOnRequestId(getRequestId(*reply));
+    }
+    revalidations.erase(reply);
+    QObject::disconnect(reply, &QNetworkReply::finished, nullptr, nullptr);
+    QObject::disconnect(reply, &QNetworkReply::metaDataChanged, nullptr, nullptr);
+    if (isCacheKey(*reply)) {
+        cache->remove(getCacheKey(*reply));
+    }
+    cache->addMiss();
+    logCacheStats();
+    job->reply(getMime(*reply), reply);
+    return true;
+}
+
 void MHUrlSchemeHandler::onTimerEvent() {
 BEGIN_SLOT_WRAPPER
     const time_point timeEnd = ::now();
@@ -123,13 +245,7 @@ void MHUrlSchemeHandler::removeOnRequestId(const std::string &requestId) {
     }), requests.end());
 }
 
-void MHUrlSchemeHandler::processRequest(QWebEngineUrlRequestJob *job, MainWindow *win, const QUrl &url, const QString &host, const std::set<QString> &excludesIps) {
-    CHECK(win, "mainwin cast");
-    const QString ip = win->getServerIp(url.toString(), excludesIps);
-    if (ip.isEmpty()) {
-        job->fail(QWebEngineUrlRequestJob::UrlNotFound);
-        return;
-    }
+QNetworkReply* MHUrlSchemeHandler::sendRequest(QWebEngineUrlRequestJob *job, const QUrl &url, const QString &host, const QString &ip, const std::shared_ptr<const MHUrlCache::Entry> &cached, bool isTrackTimeout, bool isRefetch) {
     QUrl newurl(url);
     newurl.setScheme(QStringLiteral("http"));
     newurl.setHost(ip);
@@ -139,28 +255,39 @@ void MHUrlSchemeHandler::processRequest(QWebEngineUrlRequestJob *job, MainWindow
     }
     QNetworkRequest req(newurl);
     unsigned long reqId = 0;
-    if (isFirstRun) {
+    if (isTrackTimeout) {
         reqId = requestId++;
         addRequestId(req, std::to_string(reqId));
         addIgnoreError(req);
         const time_point time = ::now();
         addBeginTime(req, time);
-        addTimeout(req, 5s);
+        addTimeout(req, RACE_TIMEOUT);
     }
     req.setRawHeader(QByteArray("Host"), host.toUtf8());
+    addCacheKey(req, url.toString());
+    if (isRefetch) {
+        addRefetch(req);
+    }
+    const bool isRevalidate = cached != nullptr && cached->canRevalidate();
+    if (isRevalidate) {
+        if (!cached->etag.isEmpty()) {
+            req.setRawHeader(QByteArray("If-None-Match"), cached->etag);
+        }
+        if (!cached->lastModified.isEmpty()) {
+            req.setRawHeader(QByteArray("If-Modified-Since"), cached->lastModified);
+        }
+    }
     QNetworkReply *reply = m_manager->get(req);
     reply->setParent(job);
-    Q_CONNECT(reply, &QNetworkReply::finished, this, &MHUrlSchemeHandler::onRequestFinished);
-    if (isFirstRun) {
-        Q_CONNECT3(reply, QOverload<QNetworkReply::NetworkError>::of(&QNetworkReply::error), ([this, job, win, url, host, ip, excludesIps](QNetworkReply::NetworkError /*err*/) {
+    if (isRevalidate) {
+        revalidations[reply] = cached;
+        Q_CONNECT3(reply, &QNetworkReply::destroyed, ([this, reply]() {
         BEGIN_SLOT_WRAPPER
-            LOG << "Error request MHUrlSchemeHandler " << ip;
-            std::set<QString> copyExcludes = excludesIps;
-            copyExcludes.insert(ip);
-            processRequest(job, win, url, host, copyExcludes);
+            revalidations.erase(reply);
         END_SLOT_WRAPPER
         }));
-
+    }
+    if (isTrackTimeout) {
         requests.emplace_back(reply);
 
         Q_CONNECT3(job, &QWebEngineUrlRequestJob::destroyed, ([this, reqIdStr=std::to_string(reqId)]() {
@@ -169,15 +296,148 @@ void MHUrlSchemeHandler::processRequest(QWebEngineUrlRequestJob *job, MainWindow
         END_SLOT_WRAPPER
         }));
     }
-    isFirstRun = false;
+    return reply;
+}
+
+void MHUrlSchemeHandler::processRequest(QWebEngineUrlRequestJob *job, MainWindow *win, const QUrl &url, const QString &host, const std::shared_ptr<const MHUrlCache::Entry> &cached) {
+    CHECK(win, "mainwin cast");
+    const QString ip = win->getServerIp(url.toString(), {});
+    if (ip.isEmpty()) {
+        if (!replyStale(job, cached)) {
+            job->fail(QWebEngineUrlRequestJob::UrlNotFound);
+        }
+        return;
+    }
+    QNetworkReply *reply = sendRequest(job, url, host, ip, cached, false);
+    connectReply(reply);
+}
+
+void MHUrlSchemeHandler::connectReply(QNetworkReply *reply) {
+    Q_CONNECT(reply, &QNetworkReply::metaDataChanged, this, &MHUrlSchemeHandler::onRequestMetaDataChanged);
+    Q_CONNECT(reply, &QNetworkReply::finished, this, &MHUrlSchemeHandler::onRequestFinished);
+}
+
+void MHUrlSchemeHandler::raceRequest(QWebEngineUrlRequestJob *job, MainWindow *win, const QUrl &url, const QString &host, const std::set<QString> &excludesIps, const std::shared_ptr<const MHUrlCache::Entry> &cached) {
+    CHECK(win, "mainwin cast");
+    const std::vector<QString> ips = win->getServerIps(url.toString(), excludesIps, RACE_COUNT_IPS);
+    if (ips.empty()) {
+        if (!replyStale(job, cached)) {
+            job->fail(QWebEngineUrlRequestJob::UrlNotFound);
+        }
+        return;
+    }
+
+    const auto race = std::make_shared<Race>();
+    race->job = job;
+    race->win = win;
+    race->url = url;
+    race->host = host;
+    race->cached = cached;
+    race->excludesIps = excludesIps;
+    race->excludesIps.insert(ips.begin(), ips.end());
+    race->pendingIps.assign(ips.begin(), ips.end());
+
+    startNextRaceRequest(race);
+    for (size_t i = 1; i < ips.size(); i++) {
+        QTimer::singleShot(static_cast<int>(RACE_STAGGER.count() * i), job, [this, race]{
+        BEGIN_SLOT_WRAPPER
+            if (!race->isFinished) {
+                startNextRaceRequest(race);
+            }
+        END_SLOT_WRAPPER
+        });
+    }
+}
+
+void MHUrlSchemeHandler::startNextRaceRequest(const std::shared_ptr<Race> &race) {
+    if (race->pendingIps.empty()) {
+        return;
+    }
+    const QString ip = race->pendingIps.front();
+    race->pendingIps.pop_front();
+
+    QNetworkReply *reply = sendRequest(race->job, race->url, race->host, ip, race->cached, true);
+    race->replies.emplace_back(reply);
+    race->countInFlight++;
+    Q_CONNECT3(reply, &QNetworkReply::metaDataChanged, ([this, race, reply, ip]() {
+    BEGIN_SLOT_WRAPPER
+        if (!race->isFinished && streamLargeReply(reply)) {
+            race->countInFlight--;
+            finishRace(race, reply, ip);
+        }
+    END_SLOT_WRAPPER
+    }));
+    Q_CONNECT3(reply, &QNetworkReply::finished, ([this, race, reply, ip]() {
+    BEGIN_SLOT_WRAPPER
+        onRaceRequestFinished(race, reply, ip);
+    END_SLOT_WRAPPER
+    }));
+}
+
+void MHUrlSchemeHandler::onRaceRequestFinished(const std::shared_ptr<Race> &race, QNetworkReply *reply, const QString &ip) {
+    if (isRequestId(*reply)) {
+        removeOnRequestId(getRequestId(*reply));
+    }
+    race->countInFlight--;
+    if (race->isFinished) {
+        return;
+    }
+
+    if (reply->error()) {
+        LOG << "Error request MHUrlSchemeHandler " << ip;
+        if (!race->pendingIps.empty()) {
+            startNextRaceRequest(race);
+        } else if (race->countInFlight == 0) {
+            race->isFinished = true;
+            raceRequest(race->job, race->win, race->url, race->host, race->excludesIps, race->cached);
+        }
+        return;
+    }
+
+    finishRace(race, reply, ip);
+    processReply(reply);
+}
+
+void MHUrlSchemeHandler::finishRace(const std::shared_ptr<Race> &race, QNetworkReply *reply, const QString &ip) {
+    race->isFinished = true;
+    for (const QPointer<QNetworkReply> &other: race->replies) {
+        if (other != nullptr && other != reply && other->isRunning()) {
+            other->abort();
+        }
+    }
+    race->win->setFastestServerIp(race->url.toString(), ip);
 }
 
 void MHUrlSchemeHandler::requestStarted(QWebEngineUrlRequestJob *job) {
     const QUrl url = job->requestUrl();
     const QString host = url.host();
 
-    MainWindow *win = qobject_cast<MainWindow *>(parent());
-    processRequest(job, win, url, host, {});
+    cache->find(url.toString(), job, [this, job, url, host](const std::shared_ptr<const MHUrlCache::Entry> &cached) {
+        if (cached != nullptr && cached->isFresh(::system_now())) {
+            cache->addHit(cached->body.size());
+            logCacheStats();
+            replyFromBuffer(job, cached->mime, cached->body);
+            return;
+        }
+
+        MainWindow *win = qobject_cast<MainWindow *>(parent());
+        if (isFirstRun) {
+            isFirstRun = false;
+            raceRequest(job, win, url, host, {}, cached);
+        } else {
+            processRequest(job, win, url, host, cached);
+        }
+    });
+}
+
+void MHUrlSchemeHandler::onRequestMetaDataChanged() {
+BEGIN_SLOT_WRAPPER
+    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
+    if (!reply) {
+        return;
+    }
+    streamLargeReply(reply);
+END_SLOT_WRAPPER
 }
 
 void MHUrlSchemeHandler::onRequestFinished() {
@@ -186,7 +446,11 @@ BEGIN_SLOT_WRAPPER
     if (!reply) {
         return;
     }
+    processReply(reply);
+END_SLOT_WRAPPER
+}
 
+void MHUrlSchemeHandler::processReply(QNetworkReply *reply) {
     if (isRequestId(*reply)) {
         const auto requestId = getRequestId(*reply);
         removeOnRequestId(requestId);
@@ -196,21 +460,59 @@ BEGIN_SLOT_WRAPPER
     if (!job) {
         return;
     }
+
+    std::shared_ptr<const MHUrlCache::Entry> cached;
+    const auto foundRevalidation = revalidations.find(reply);
+    if (foundRevalidation != revalidations.end()) {
+        cached = foundRevalidation->second;
+        revalidations.erase(foundRevalidation);
+    }
+
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
     if (reply->error()) {
         if (isIgnoreError(*reply) && getIgnoreError(*reply)) {
             return;
         }
+        if ((status == 0 || status >= 500) && replyStale(job, cached)) {
+            return;
+        }
         job->fail(QWebEngineUrlRequestJob::UrlNotFound);
         return;
     }
 
-    QVariant contentMimeType = reply->header(QNetworkRequest::ContentTypeHeader);
-    QByteArray mime = contentMimeType.toByteArray();
-    const int pos = mime.indexOf(';');
-    if (pos != -1) {
-        mime = mime.left(pos);
+    if (status == 304) {
+        if (cached != nullptr) {
+            const std::shared_ptr<const MHUrlCache::Entry> updated = cache->refresh(cached, *reply);
+            cache->addRevalidated(updated->body.size());
+            logCacheStats();
+            replyFromBuffer(job, updated->mime, updated->body);
+            return;
+        }
+        if (isCacheKey(*reply) && !isRefetch(*reply)) {
+            // Проверяемой записи нет, запрашиваем заново без условных заголовков
+            const QUrl url(getCacheKey(*reply));
+            QNetworkReply *refetch = sendRequest(job, url, url.host(), reply->url().host(), nullptr, false, true);
+            connectReply(refetch);
+            return;
+        }
+        job->fail(QWebEngineUrlRequestJob::RequestFailed);
+        return;
+    }
+
+    const QByteArray mime = getMime(*reply);
+    if (status == 200 && isCacheKey(*reply)) {
+        cache->addMiss();
+        logCacheStats();
+        if (!MHUrlCache::isCacheableSize(reply->bytesAvailable())) {
+            cache->remove(getCacheKey(*reply));
+            job->reply(mime, reply);
+            return;
+        }
+        const QByteArray body = reply->readAll();
+        cache->put(getCacheKey(*reply), mime, body, *reply);
+        replyFromBuffer(job, mime, body);
+        return;
     }
 
     job->reply(mime, reply);
-END_SLOT_WRAPPER
 }
@@ -4,10 +4,14 @@
 #include <set>
 #include <unordered_map>
 #include <atomic>
+#include <map>
+#include <memory>
 
 #include <QTimer>
 #include <QWebEngineUrlSchemeHandler>
 
+#include "MHUrlCache.h"
+
 class QNetworkAccessManager;
 class QWebEngineUrlRequestJob;
 class MainWindow;
@@ -23,14 +27,44 @@ public:
 
     void setFirstRun();
 
+    MHUrlCache::Stats getCacheStats() const;
+
 private slots:
+    void onRequestMetaDataChanged();
+
     void onRequestFinished();
 
     void onTimerEvent();
 
 private:
 
-    void processRequest(QWebEngineUrlRequestJob *job, MainWindow *win, const QUrl &url, const QString &host, const std::set<QString> &excludesIps);
+    struct Race;
+
+    QNetworkReply* sendRequest(QWebEngineUrlRequestJob *job, const QUrl &url, const QString &host, const QString &ip, const std::shared_ptr<const MHUrlCache::Entry> &cached, bool isTrackTimeout, bool isRefetch = false);
+
+    void connectReply(QNetworkReply *reply);
+
+    void processRequest(QWebEngineUrlRequestJob *job, MainWindow *win, const QUrl &url, const QString &host, const std::shared_ptr<const MHUrlCache::Entry> &cached);
+
+    void raceRequest(QWebEngineUrlRequestJob *job, MainWindow *win, const QUrl &url, const QString &host, const std::set<QString> &excludesIps, const std::shared_ptr<const MHUrlCache::Entry> &cached);
+
+    void startNextRaceRequest(const std::shared_ptr<Race> &race);
+
+    void onRaceRequestFinished(const std::shared_ptr<Race> &race, QNetworkReply *reply, const QString &ip);
+
+    void finishRace(const std::shared_ptr<Race> &race, QNetworkReply *reply, const QString &ip);
+
+    void processReply(QNetworkReply *reply);
+
+    void replyFromBuffer(QWebEngineUrlRequestJob *job, const QByteArray &mime, const QByteArray &body);
+
+    // false, если записи нет
+    bool replyStale(QWebEngineUrlRequestJob *job, const std::shared_ptr<const MHUrlCache::Entry> &cached);
+
+    // Ответ 200 с Content-Length больше допустимого для кеша отдается странице потоком. false, если ответ не такой
+    bool streamLargeReply(QNetworkReply *reply);
+
+    void logCacheStats();
 
     void removeOnRequestId(const std::string &requestId);
 
@@ -47,6 +81,11 @@ private:
 
     std::atomic<size_t> requestId{0};
 
+    std::unique_ptr<MHUrlCache> cache;
+
+    // Запросы с условной перепроверкой и записи кеша, которые они проверяют
+    std::map<QNetworkReply*, std::shared_ptr<const MHUrlCache::Entry>> revalidations;
+
 };
 
 #endif // MHURLSCHEMEHANDLER_H
@@ -38,6 +38,8 @@
 #include "qt_utilites/SlotWrapper.h"
 #include "Paths.h"
 #include "qt_utilites/QRegister.h"
+#include "qt_utilites/JsDispatcher.h"
+#include "qt_utilites/WrapperJavascript.h"
 
 #include "TorUrlSchemeHandler.h"
 #include "TorProxy.h"
@@ -61,6 +63,9 @@ SET_LOG_NAMESPACE("MW");
 
 const static QString DEFAULT_USERNAME = "_unregistered";
 
+// Примерно один кадр
+const static milliseconds JS_DISPATCH_PERIOD = 16ms;
+
 bool EvFilter::eventFilter(QObject * watched, QEvent * event) {
     QToolButton * button = qobject_cast<QToolButton*>(watched);
     if (!button) {
@@ -184,6 +189,13 @@ MainWindow::MainWindow(initializer::InitializerJavascript &initializerJs, tor::T
 
     channel = std::make_unique<QWebChannel>(ui->webView);
     ui->webView->page()->setWebChannel(channel.get());
+    jsDispatcher = new JsDispatcher(JS_DISPATCH_PERIOD, [this](const QString &script) {
+        if (ui->webView->page()->webChannel()) {
+            ui->webView->page()->runJavaScript(script);
+        } else {
+            LOG << "Revert javascript";
+        }
+    }, this);
     registerWebChannel(QString("initializer"), &initializerJs);
 
     hardwareId = QString::fromStdString(::getMachineUid());
@@ -211,6 +223,7 @@ MainWindow::MainWindow(initializer::InitializerJavascript &initializerJs, tor::T
     //Q_CONNECT(ui->webView->page(), &QWebEnginePage::loadFinished, this, &MainWindow::onBrowserLoadFinished);
 
     Q_CONNECT(ui->webView, &WebView::urlChanged, this, &MainWindow::onUrlChanged);
+    Q_CONNECT(ui->webView->page(), &QWebEnginePage::loadStarted, this, &MainWindow::onLoadStarted);
 
     correctWindowSize(0);
 }
@@ -278,6 +291,15 @@ void MainWindow::loadPagesMappings() {
 void MainWindow::registerWebChannel(const QString &name, QObject *obj) {
     channel->registerObject(name, obj);
     registeredWebChannels.emplace_back(name, obj);
+    WrapperJavascript *wrapper = qobject_cast<WrapperJavascript*>(obj);
+    if (wrapper != nullptr) {
+        // Настройки, заданные страницей, не должны переживать ее перезагрузку
+        Q_CONNECT4(ui->webView->page(), &QWebEnginePage::loadStarted, wrapper, [wrapper]{
+            BEGIN_SLOT_WRAPPER
+            wrapper->resetPageState();
+            END_SLOT_WRAPPER
+        });
+    }
 }
 
 void MainWindow::unregisterAllWebChannels() {
@@ -285,6 +307,7 @@ void MainWindow::unregisterAllWebChannels() {
         return;
     }
     LOG << "Unregister all channels";
+    jsDispatcher->flush();
     ui->webView->page()->setWebChannel(nullptr);
 
     //for (const auto &pair: registeredWebChannels) {
@@ -901,6 +924,13 @@ BEGIN_SLOT_WRAPPER
 END_SLOT_WRAPPER
 }
 
+void MainWindow::onLoadStarted() {
+BEGIN_SLOT_WRAPPER
+    // Скрипты для предыдущей страницы новой странице не нужны
+    jsDispatcher->clear();
+END_SLOT_WRAPPER
+}
+
 void MainWindow::onSetCommandLineText(QString text) {
 BEGIN_SLOT_WRAPPER
     addElementToHistoryAndCommandLine(text, true, true);
@@ -934,7 +964,7 @@ void MainWindow::onJsRun(QString jsString) {
 BEGIN_SLOT_WRAPPER
     //if (isRegisteredWebChannels) {
     if (ui->webView->page()->webChannel()) {
-        ui->webView->page()->runJavaScript(jsString);
+        jsDispatcher->push(jsString);
     } else {
         LOG << "Revert javascript";
     }
@@ -967,6 +997,27 @@ QString MainWindow::getServerIp(const QString &text, const std::set<QString> &ex
     }
 }
 
+std::vector<QString> MainWindow::getServerIps(const QString &text, const std::set<QString> &excludesIps, size_t count) {
+    try {
+        std::vector<QString> result;
+        for (const QString &ip: pagesMappings.getIps(text, excludesIps, count)) {
+            result.emplace_back(QUrl(ip).host());
+        }
+        return result;
+    } catch (const Exception &e) {
+        LOG << "Error " << e;
+        return {};
+    }
+}
+
+void MainWindow::setFastestServerIp(const QString &text, const QString &ip) {
+    try {
+        pagesMappings.setDefaultIp(text, ip);
+    } catch (const Exception &e) {
+        LOG << "Error " << e;
+    }
+}
+
 LastHtmlVersion MainWindow::getCurrentHtmls() const {
     std::lock_guard<std::mutex> lock(mutLastHtmls);
     return last_htmls;
@@ -19,6 +19,7 @@ class QSystemTrayIcon;
 class WebSocketClient;
 class JavascriptWrapper;
 class MHUrlSchemeHandler;
+class JsDispatcher;
 class MHPayUrlSchemeHandler;
 
 namespace tor {
@@ -128,6 +129,10 @@ public:
 
     QString getServerIp(const QString &text, const std::set<QString> &excludesIps);
 
+    std::vector<QString> getServerIps(const QString &text, const std::set<QString> &excludesIps, size_t count);
+
+    void setFastestServerIp(const QString &text, const QString &ip);
+
     LastHtmlVersion getCurrentHtmls() const;
 
 public slots:
@@ -254,6 +259,8 @@ private slots:
 
     void onUrlChanged(const QUrl &url2);
 
+    void onLoadStarted();
+
     void onLogined(bool isInit, const QString &login);
 
 private:
@@ -270,6 +277,8 @@ private:
 
     MHUrlSchemeHandler *shemeHandler = nullptr;
 
+    JsDispatcher *jsDispatcher = nullptr;
+
     MHPayUrlSchemeHandler *shemeHandler2 = nullptr;
 
     std::unique_ptr<QWebChannel> channel;
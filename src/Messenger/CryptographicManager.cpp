@@ -1,5 +1,8 @@
 #include "CryptographicManager.h"
 
+#include "DecryptPool.h"
+#include "DecryptedCache.h"
+
 #include "Wallets/Wallet.h"
 #include "Wallets/WalletRsa.h"
 
@@ -9,14 +12,39 @@
 #include "utilites/utils.h"
 #include "qt_utilites/QRegister.h"
 #include "qt_utilites/ManagerWrapperImpl.h"
+#include "qt_utilites/StreamToken.h"
+
+#include <thread>
 
 SET_LOG_NAMESPACE("MSG");
 
 namespace messenger {
 
+// Меньшие пачки быстрее расшифровать в потоке менеджера, чем раздавать пулу
+static const size_t MIN_MESSAGES_FOR_POOL = 16;
+
+static const size_t MAX_DECRYPT_THREADS = 8;
+
+static const size_t MAX_DECRYPTED_CACHE_BYTES = 16 * 1024 * 1024;
+
+struct CryptographicManager::DecryptTask {
+    // Расшифровывается на месте и отдается в callback
+    std::vector<Message> messages;
+    // Индексы сообщений, которым нужен rsa
+    std::vector<size_t> encrypted;
+    std::shared_ptr<WalletRsa> walletRsa;
+    std::shared_ptr<StreamToken> token;
+    bool isThrow;
+    DecryptMessagesCallback callback;
+    std::shared_ptr<DecryptPool::Job> job;
+};
+
 CryptographicManager::CryptographicManager(QObject *parent)
     : TimerClass(1s, parent)
     , isSaveDecrypted_(false)
+    , walletToken(std::make_shared<StreamToken>())
+    , decryptPool(std::make_unique<DecryptPool>(std::max(size_t(1), std::min(size_t(std::thread::hardware_concurrency()), MAX_DECRYPT_THREADS))))
+    , decryptedCache(isSaveDecrypted_ ? nullptr : std::make_unique<DecryptedCache>(MAX_DECRYPTED_CACHE_BYTES))
 {
     Q_CONNECT(this, &CryptographicManager::decryptMessages, this, &CryptographicManager::onDecryptMessages);
     Q_CONNECT(this, &CryptographicManager::tryDecryptMessages, this, &CryptographicManager::onTryDecryptMessages);
@@ -29,6 +57,7 @@ CryptographicManager::CryptographicManager(QObject *parent)
     Q_CONNECT(this, &CryptographicManager::unlockWallet, this, &CryptographicManager::onUnlockWallet);
     Q_CONNECT(this, &CryptographicManager::lockWallet, this, &CryptographicManager::onLockWallet);
     Q_CONNECT(this, &CryptographicManager::remainingTime, this, &CryptographicManager::onRemainingTime);
+    Q_CONNECT(this, &CryptographicManager::decryptTaskFinished, this, &CryptographicManager::onDecryptTaskFinished);
 
     Q_REG(DecryptMessagesCallback, "DecryptMessagesCallback");
     Q_REG(std::vector<Message>, "std::vector<Message>");
@@ -49,6 +78,8 @@ CryptographicManager::CryptographicManager(QObject *parent)
 }
 
 CryptographicManager::~CryptographicManager() {
+    walletToken->cancel();
+    decryptPool.reset();
     TimerClass::exit();
 }
 
@@ -73,24 +104,30 @@ WalletRsa& CryptographicManager::getWalletRsa(const std::string &address) const
     return *walletRsa;
 }
 
-WalletRsa* CryptographicManager::getWalletRsaWithoutCheck(const std::string &address) const {
+std::shared_ptr<WalletRsa> CryptographicManager::getWalletRsaWithoutCheck(const std::string &address) const {
     if (walletRsa == nullptr) {
         return nullptr;
     }
     if (wallet->getAddress() != address) {
         return nullptr;
     }
-    return walletRsa.get();
+    return walletRsa;
 }
 
 void CryptographicManager::lockWalletImpl() {
     wallet = nullptr;
     walletRsa = nullptr;
+    walletToken->cancel();
+    walletToken = std::make_shared<StreamToken>();
+    if (decryptedCache != nullptr) {
+        decryptedCache->clear();
+    }
 }
 
 void CryptographicManager::unlockWalletImpl(const QString &folder, bool isMhc, const std::string &address, const std::string &password, const std::string &passwordRsa, const seconds &time_) {
+    lockWalletImpl();
     wallet = std::make_unique<Wallet>(folder, isMhc, address, password);
-    walletRsa = std::make_unique<WalletRsa>(folder, isMhc, address);
+    walletRsa = std::make_shared<WalletRsa>(folder, isMhc, address);
     walletRsa->unlock(passwordRsa);
 
     time = time_;
@@ -104,57 +141,147 @@ void CryptographicManager::timerMethod() {
 
         if (elapsedTime >= time && (wallet != nullptr || walletRsa != nullptr)) {
             LOG << "Reseted wallets";
-            wallet = nullptr;
-            walletRsa = nullptr;
+            lockWalletImpl();
         }
     }
 }
 
-static std::vector<Message> decryptMsg(const std::vector<Message> &messages, const WalletRsa *walletRsa, bool isThrow) {
-    std::vector<Message> result;
-    result.reserve(messages.size());
-    std::transform(messages.begin(), messages.end(), std::back_inserter(result), [walletRsa, isThrow](const Message &message) {
-        if (message.isDecrypted) {
-            return message;
+static bool isNeedRsa(const Message &message) {
+    return !message.isDecrypted && !message.isChannel && message.isCanDecrypted;
+}
+
+static void decryptMsg(Message &message, const WalletRsa *walletRsa, bool isThrow) {
+    if (message.isDecrypted) {
+        return;
+    }
+    const bool isEncrypted = !message.isChannel;
+    if (!isEncrypted) {
+        message.decryptedDataHex = message.dataHex;
+        message.isDecrypted = true;
+    } else {
+        if (message.isCanDecrypted) {
+            if (walletRsa == nullptr) {
+                if (isThrow) {
+                    throwErrTyped(TypeErrors::WALLET_NOT_UNLOCK, "Wallet rsa not unlock");
+                } else {
+                    return;
+                }
+            }
+            CHECK_TYPED(walletRsa != nullptr, TypeErrors::WALLET_NOT_UNLOCK, "Wallet rsa not unlock");
+            const std::string decryptedData = toHex(walletRsa->decryptMessage(message.dataHex.toStdString()));
+            message.decryptedDataHex = QString::fromStdString(decryptedData);
+            message.isDecrypted = true;
         }
-        Message result = message;
-        const bool isEncrypted = !result.isChannel;
-        if (!isEncrypted) {
-            result.decryptedDataHex = result.dataHex;
-            result.isDecrypted = true;
-        } else {
-            if (result.isCanDecrypted) {
-                if (walletRsa == nullptr) {
-                    if (isThrow) {
-                        throwErrTyped(TypeErrors::WALLET_NOT_UNLOCK, "Wallet rsa not unlock");
+    }
+}
+
+void CryptographicManager::addDecryptTask(const std::vector<Message> &messages, const QString &address, bool isThrow, const DecryptMessagesCallback &callback) {
+    const auto task = std::make_shared<DecryptTask>();
+    task->messages = messages;
+    task->walletRsa = getWalletRsaWithoutCheck(address.toStdString());
+    task->token = walletToken;
+    task->isThrow = isThrow;
+    task->callback = callback;
+    decryptTasks.emplace_back(task);
+    if (decryptTasks.size() == 1) {
+        runDecryptTasks();
+    }
+}
+
+bool CryptographicManager::findDecrypted(Message &message) {
+    if (decryptedCache == nullptr || message.hash.isEmpty()) {
+        return false;
+    }
+    if (!decryptedCache->find(message.hash, message.decryptedDataHex)) {
+        return false;
+    }
+    message.isDecrypted = true;
+    return true;
+}
+
+void CryptographicManager::saveDecrypted(const DecryptTask &task) {
+    // Кошелек блокировался во время расшифровки, кеш уже очищен
+    if (decryptedCache == nullptr || task.token != walletToken) {
+        return;
+    }
+    for (const size_t index: task.encrypted) {
+        const Message &message = task.messages[index];
+        if (message.isDecrypted && !message.hash.isEmpty()) {
+            decryptedCache->put(message.hash, message.decryptedDataHex);
+        }
+    }
+}
+
+void CryptographicManager::runDecryptTasks() {
+    while (!decryptTasks.empty()) {
+        const std::shared_ptr<DecryptTask> task = decryptTasks.front();
+        if (task->job == nullptr) {
+            bool isRunInPool = false;
+            runAndEmitErrorCallback([&, this] {
+                for (size_t i = 0; i < task->messages.size(); i++) {
+                    if (isNeedRsa(task->messages[i]) && task->walletRsa != nullptr) {
+                        if (!findDecrypted(task->messages[i])) {
+                            task->encrypted.emplace_back(i);
+                        }
                     } else {
-                        return result;
+                        decryptMsg(task->messages[i], task->walletRsa.get(), task->isThrow);
+                    }
+                }
+                if (task->encrypted.size() >= MIN_MESSAGES_FOR_POOL) {
+                    DecryptTask *t = task.get();
+                    task->job = std::make_shared<DecryptPool::Job>(task->encrypted.size(), task->token, [t](size_t index) {
+                        decryptMsg(t->messages[t->encrypted[index]], t->walletRsa.get(), true);
+                    }, [this](const DecryptPool::Job &) {
+                        emit decryptTaskFinished();
+                    });
+                    decryptPool->run(task->job);
+                    isRunInPool = true;
+                } else {
+                    for (const size_t index: task->encrypted) {
+                        decryptMsg(task->messages[index], task->walletRsa.get(), task->isThrow);
                     }
+                    saveDecrypted(*task);
+                    task->callback.emitFunc(TypedException(), task->messages);
                 }
-                CHECK_TYPED(walletRsa != nullptr, TypeErrors::WALLET_NOT_UNLOCK, "Wallet rsa not unlock");
-                const std::string decryptedData = toHex(walletRsa->decryptMessage(result.dataHex.toStdString()));
-                result.decryptedDataHex = QString::fromStdString(decryptedData);
-                result.isDecrypted = true;
+            }, task->callback);
+            if (isRunInPool) {
+                return;
             }
+        } else {
+            const DecryptPool::Job &job = *task->job;
+            runAndEmitCallback([&] {
+                if (job.error() != nullptr) {
+                    std::rethrow_exception(job.error());
+                }
+                if (!job.isCompleted()) {
+                    // Кошелек заблокирован во время расшифровки. Оставшиеся сообщения остаются нерасшифрованными
+                    CHECK_TYPED(!task->isThrow, TypeErrors::WALLET_NOT_UNLOCK, "Wallet rsa not unlock");
+                    LOG << "Decrypt interrupted " << task->encrypted.size();
+                }
+                saveDecrypted(*task);
+                return task->messages;
+            }, task->callback);
+            task->job = nullptr;
         }
-        return result;
-    });
-    return result;
+        decryptTasks.pop_front();
+    }
+}
+
+void CryptographicManager::onDecryptTaskFinished() {
+BEGIN_SLOT_WRAPPER
+    runDecryptTasks();
+END_SLOT_WRAPPER
 }
 
 void CryptographicManager::onDecryptMessages(const std::vector<Message> &messages, const QString &address, const DecryptMessagesCallback &callback) {
 BEGIN_SLOT_WRAPPER
-    runAndEmitCallback([&, this] {
-        return decryptMsg(messages, getWalletRsaWithoutCheck(address.toStdString()), true);
-    }, callback);
+    addDecryptTask(messages, address, true, callback);
 END_SLOT_WRAPPER
 }
 
 void CryptographicManager::onTryDecryptMessages(const std::vector<Message> &messages, const QString &address, const DecryptMessagesCallback &callback) {
 BEGIN_SLOT_WRAPPER
-    runAndEmitCallback([&, this] {
-        return decryptMsg(messages, getWalletRsaWithoutCheck(address.toStdString()), false);
-    }, callback);
+    addDecryptTask(messages, address, false, callback);
 END_SLOT_WRAPPER
 }
 
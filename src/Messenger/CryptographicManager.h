@@ -3,6 +3,9 @@
 
 #include <QObject>
 
+#include <deque>
+#include <memory>
+
 #include "qt_utilites/TimerClass.h"
 #include "qt_utilites/CallbackWrapper.h"
 
@@ -10,11 +13,15 @@
 
 class Wallet;
 class WalletRsa;
+class StreamToken;
 
 struct TypedException;
 
 namespace messenger {
 
+class DecryptPool;
+class DecryptedCache;
+
 class CryptographicManager : public QObject, public TimerClass {
     Q_OBJECT
 public:
@@ -79,6 +86,9 @@ signals:
 
     void remainingTime(const RemainingTimeCallback &callback);
 
+    // Из потоков пула расшифровки
+    void decryptTaskFinished();
+
 private slots:
 
     void onDecryptMessages(const std::vector<Message> &messages, const QString &address, const DecryptMessagesCallback &callback);
@@ -103,13 +113,25 @@ private slots:
 
     void onRemainingTime(const RemainingTimeCallback &callback);
 
+    void onDecryptTaskFinished();
+
 private:
 
+    struct DecryptTask;
+
     Wallet& getWallet(const std::string &address) const;
 
     WalletRsa& getWalletRsa(const std::string &address) const;
 
-    WalletRsa* getWalletRsaWithoutCheck(const std::string &address) const;
+    std::shared_ptr<WalletRsa> getWalletRsaWithoutCheck(const std::string &address) const;
+
+    void addDecryptTask(const std::vector<Message> &messages, const QString &address, bool isThrow, const DecryptMessagesCallback &callback);
+
+    void runDecryptTasks();
+
+    bool findDecrypted(Message &message);
+
+    void saveDecrypted(const DecryptTask &task);
 
     void unlockWalletImpl(const QString &folder, bool isMhc, const std::string &address, const std::string &password, const std::string &passwordRsa, const seconds &time_);
 
@@ -120,7 +142,19 @@ private:
     const bool isSaveDecrypted_;
 
     std::unique_ptr<Wallet> wallet;
-    std::unique_ptr<WalletRsa> walletRsa;
+    // Разделяется с потоками расшифровки, которые могут закончить текущее сообщение уже после блокировки
+    std::shared_ptr<WalletRsa> walletRsa;
+
+    // Отменяется при каждой блокировке кошелька
+    std::shared_ptr<StreamToken> walletToken;
+
+    std::unique_ptr<DecryptPool> decryptPool;
+
+    // Только если расшифрованное не сохраняется в базу. Очищается при блокировке кошелька
+    std::unique_ptr<DecryptedCache> decryptedCache;
+
+    // Задачи расшифровки выполняются по одной, чтобы ответы приходили в порядке запросов
+    std::deque<std::shared_ptr<DecryptTask>> decryptTasks;
 
     seconds time;
     time_point startTime;
@@ -0,0 +1,93 @@
+#include "DecryptPool.h"
+
+#include "check.h"
+
+#include <algorithm>
+
+namespace messenger {
+
+DecryptPool::Job::Job(size_t count, const std::shared_ptr<StreamToken> &token, const std::function<void(size_t index)> &process, const std::function<void(const Job &job)> &finish)
+    : count(count)
+    , token(token)
+    , process(process)
+    , finish(finish)
+{}
+
+DecryptPool::DecryptPool(size_t countThreads) {
+    CHECK(countThreads != 0, "Incorrect count threads");
+    threads.reserve(countThreads);
+    for (size_t i = 0; i < countThreads; i++) {
+        threads.emplace_back(&DecryptPool::work, this);
+    }
+}
+
+DecryptPool::~DecryptPool() {
+    {
+        std::lock_guard<std::mutex> lock(mut);
+        isStopped = true;
+        queue.clear();
+    }
+    cond.notify_all();
+    for (std::thread &thread: threads) {
+        thread.join();
+    }
+}
+
+void DecryptPool::run(const std::shared_ptr<Job> &job) {
+    if (job->count == 0) {
+        job->finish(*job);
+        return;
+    }
+    const size_t countWorkers = std::min(threads.size(), job->count);
+    job->activeWorkers = countWorkers;
+    {
+        std::lock_guard<std::mutex> lock(mut);
+        for (size_t i = 0; i < countWorkers; i++) {
+            queue.emplace_back(job);
+        }
+    }
+    cond.notify_all();
+}
+
+void DecryptPool::processJob(Job &job) {
+    while (!job.isStopped()) {
+        const size_t index = job.next++;
+        if (index >= job.count) {
+            break;
+        }
+        try {
+            job.process(index);
+            job.processed++;
+        } catch (...) {
+            bool expected = false;
+            if (job.isFailed.compare_exchange_strong(expected, true)) {
+                job.exception = std::current_exception();
+            }
+        }
+    }
+}
+
+void DecryptPool::work() {
+    while (true) {
+        std::shared_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(mut);
+            cond.wait(lock, [this]{
+                return isStopped || !queue.empty();
+            });
+            if (isStopped) {
+                return;
+            }
+            job = queue.front();
+            queue.pop_front();
+        }
+
+        processJob(*job);
+        // finish вызывается после выхода из задачи всех потоков, поэтому exception к этому моменту уже записан
+        if (--job->activeWorkers == 0) {
+            job->finish(*job);
+        }
+    }
+}
+
+}
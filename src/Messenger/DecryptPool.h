@@ -0,0 +1,103 @@
+#ifndef DECRYPTPOOL_H
+#define DECRYPTPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "qt_utilites/StreamToken.h"
+
+namespace messenger {
+
+/*
+   Ограниченный пул потоков для расшифровки сообщений.
+   Потоки разбирают элементы задачи по индексу, поэтому результат можно складывать на место исходного элемента.
+   */
+class DecryptPool {
+public:
+
+    class Job {
+        friend class DecryptPool;
+    public:
+
+        // process вызывается из потоков пула, finish - один раз из последнего освободившегося потока
+        Job(size_t count, const std::shared_ptr<StreamToken> &token, const std::function<void(size_t index)> &process, const std::function<void(const Job &job)> &finish);
+
+        bool isCompleted() const {
+            return processed.load() == count;
+        }
+
+        std::exception_ptr error() const {
+            return exception;
+        }
+
+    private:
+
+        bool isStopped() const {
+            return isFailed.load() || (token != nullptr && token->isCancelled());
+        }
+
+    private:
+
+        const size_t count;
+
+        const std::shared_ptr<StreamToken> token;
+
+        const std::function<void(size_t index)> process;
+
+        const std::function<void(const Job &job)> finish;
+
+        std::atomic<size_t> next{0};
+
+        std::atomic<size_t> processed{0};
+
+        std::atomic<size_t> activeWorkers{0};
+
+        std::atomic<bool> isFailed{false};
+
+        std::exception_ptr exception;
+
+    };
+
+public:
+
+    explicit DecryptPool(size_t countThreads);
+
+    ~DecryptPool();
+
+    void run(const std::shared_ptr<Job> &job);
+
+    size_t size() const {
+        return threads.size();
+    }
+
+private:
+
+    void work();
+
+    void processJob(Job &job);
+
+private:
+
+    std::vector<std::thread> threads;
+
+    std::mutex mut;
+
+    std::condition_variable cond;
+
+    // Каждый элемент - место одного потока в задаче
+    std::deque<std::shared_ptr<Job>> queue;
+
+    bool isStopped = false;
+
+};
+
+}
+
+#endif // DECRYPTPOOL_H
@@ -0,0 +1,59 @@
+#include "DecryptedCache.h"
+
+#include "check.h"
+
+namespace messenger {
+
+DecryptedCache::DecryptedCache(size_t maxBytes)
+    : maxBytes(maxBytes)
+{}
+
+size_t DecryptedCache::elementSize(const QString &hash, const QString &decryptedDataHex) {
+    return (hash.size() + decryptedDataHex.size()) * sizeof(QChar);
+}
+
+bool DecryptedCache::find(const QString &hash, QString &decryptedDataHex) {
+    const auto found = elements.find(hash);
+    if (found == elements.end()) {
+        return false;
+    }
+    lru.splice(lru.begin(), lru, found->second.lruIter);
+    decryptedDataHex = found->second.decryptedDataHex;
+    return true;
+}
+
+void DecryptedCache::put(const QString &hash, const QString &decryptedDataHex) {
+    const size_t size = elementSize(hash, decryptedDataHex);
+    if (size > maxBytes) {
+        return;
+    }
+
+    const auto found = elements.find(hash);
+    if (found != elements.end()) {
+        bytes -= elementSize(hash, found->second.decryptedDataHex);
+        lru.erase(found->second.lruIter);
+        elements.erase(found);
+    }
+
+    lru.emplace_front(hash);
+    Element &element = elements[hash];
+    element.decryptedDataHex = decryptedDataHex;
+    element.lruIter = lru.begin();
+    bytes += size;
+
+    while (bytes > maxBytes) {
+        const auto last = elements.find(lru.back());
+        CHECK(last != elements.end(), "Incorrect decrypted cache state");
+        bytes -= elementSize(last->first, last->second.decryptedDataHex);
+        elements.erase(last);
+        lru.pop_back();
+    }
+}
+
+void DecryptedCache::clear() {
+    elements.clear();
+    lru.clear();
+    bytes = 0;
+}
+
+}
@@ -0,0 +1,56 @@
+#ifndef DECRYPTEDCACHE_H
+#define DECRYPTEDCACHE_H
+
+#include <QString>
+
+#include <list>
+#include <map>
+
+namespace messenger {
+
+/*
+   Расшифрованные тексты сообщений, когда они не сохраняются в базу.
+   Ключ - хэш зашифрованного сообщения. Размер ограничен, вытесняются давно не запрошенные записи.
+   Класс не потокобезопасен, используется из потока CryptographicManager
+   */
+class DecryptedCache {
+public:
+
+    explicit DecryptedCache(size_t maxBytes);
+
+    bool find(const QString &hash, QString &decryptedDataHex);
+
+    void put(const QString &hash, const QString &decryptedDataHex);
+
+    void clear();
+
+    size_t size() const {
+        return elements.size();
+    }
+
+private:
+
+    struct Element {
+        QString decryptedDataHex;
+        std::list<QString>::iterator lruIter;
+    };
+
+private:
+
+    static size_t elementSize(const QString &hash, const QString &decryptedDataHex);
+
+private:
+
+    const size_t maxBytes;
+
+    std::list<QString> lru;
+
+    std::map<QString, Element> elements;
+
+    size_t bytes = 0;
+
+};
+
+}
+
+#endif // DECRYPTEDCACHE_H
@@ -0,0 +1,221 @@
+#include "GapTracker.h"
+
+#include <algorithm>
+
+#include "check.h"
+#include "Log.h"
+
+SET_LOG_NAMESPACE("MSG");
+
+namespace messenger {
+
+const Message::Counter GapTracker::END;
+
+GapTracker::GapTracker(Message::Counter maxSpan, const milliseconds &timeout, int maxAttempts)
+    : maxSpan(maxSpan)
+    , timeout(timeout)
+    , maxAttempts(maxAttempts)
+{
+    CHECK(maxSpan > 0, "Incorrect max span");
+}
+
+std::vector<GapTracker::Range> GapTracker::add(const Key &key, Message::Counter from, Message::Counter to) {
+    std::vector<Range> result;
+    if (from > to) {
+        return result;
+    }
+
+    const auto addUncovered = [this, &result](Message::Counter begin, Message::Counter end) {
+        if (end == END) {
+            result.emplace_back(begin, end);
+            return;
+        }
+        while (end - begin >= maxSpan) {
+            result.emplace_back(begin, begin + maxSpan - 1);
+            begin += maxSpan;
+        }
+        result.emplace_back(begin, end);
+    };
+
+    const auto found = gaps.find(key);
+    if (found == gaps.end()) {
+        addUncovered(from, to);
+        return result;
+    }
+    const Entries &entries = found->second;
+
+    Message::Counter current = from;
+    auto it = entries.upper_bound(from);
+    if (it != entries.begin()) {
+        const auto prev = std::prev(it);
+        if (prev->second.to >= to) {
+            return result;
+        }
+        if (prev->second.to >= from) {
+            current = prev->second.to + 1;
+        }
+    }
+    while (true) {
+        if (it == entries.end() || it->first > to) {
+            addUncovered(current, to);
+            break;
+        }
+        if (current < it->first) {
+            addUncovered(current, it->first - 1);
+        }
+        if (it->second.to >= to) {
+            break;
+        }
+        current = it->second.to + 1;
+        ++it;
+    }
+    return result;
+}
+
+void GapTracker::sent(const Key &key, const Range &range, size_t requestId, int attempt, const time_point &now) {
+    gaps[key].emplace(range.first, Entry{range.second, requestId, now, attempt});
+    requests[requestId] = key;
+}
+
+void GapTracker::removeRange(Entries &entries, Message::Counter from, Message::Counter to) {
+    auto it = entries.upper_bound(from);
+    if (it != entries.begin() && std::prev(it)->second.to >= from) {
+        --it;
+    }
+    while (it != entries.end() && it->first <= to) {
+        const Message::Counter begin = it->first;
+        const Entry entry = it->second;
+        it = entries.erase(it);
+        if (begin < from) {
+            Entry left = entry;
+            left.to = from - 1;
+            entries.emplace(begin, left);
+        }
+        if (entry.to > to) {
+            entries.emplace(to + 1, entry);
+            break;
+        }
+    }
+}
+
+void GapTracker::received(const Key &key, const std::vector<Message::Counter> &counters) {
+    const auto found = gaps.find(key);
+    if (found == gaps.end()) {
+        return;
+    }
+    for (const Range &range: toRanges(counters)) {
+        removeRange(found->second, range.first, range.second);
+    }
+    if (found->second.empty()) {
+        gaps.erase(found);
+    }
+}
+
+std::vector<GapTracker::Gap> GapTracker::done(size_t requestId, Message::Counter lastCounter, bool isEnd) {
+    std::vector<Gap> result;
+    const auto foundRequest = requests.find(requestId);
+    if (foundRequest == requests.end()) {
+        return result;
+    }
+    const auto found = gaps.find(foundRequest->second);
+    requests.erase(foundRequest);
+    if (found == gaps.end()) {
+        return result;
+    }
+    Entries &entries = found->second;
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (it->second.requestId != requestId) {
+            ++it;
+            continue;
+        }
+        // Хвост начинается после пришедших сообщений, поэтому повторный запрос - продолжение, а не еще одна попытка
+        if (!isEnd && it->first > lastCounter) {
+            result.push_back(Gap{found->first, Range(it->first, it->second.to), it->second.attempt});
+        }
+        it = entries.erase(it);
+    }
+    if (entries.empty()) {
+        gaps.erase(found);
+    }
+    return result;
+}
+
+template<class Predicate>
+std::vector<GapTracker::Gap> GapTracker::take(const Predicate &predicate) {
+    std::vector<Gap> result;
+    for (auto itKey = gaps.begin(); itKey != gaps.end();) {
+        Entries &entries = itKey->second;
+        bool isPrevTaken = false;
+        for (auto it = entries.begin(); it != entries.end();) {
+            if (!predicate(it->second)) {
+                isPrevTaken = false;
+                ++it;
+                continue;
+            }
+            const Message::Counter begin = it->first;
+            const Entry &entry = it->second;
+            requests.erase(entry.requestId);
+            // Соседние куски одного ключа отправляются одним запросом, если он не превышает maxSpan
+            if (isPrevTaken) {
+                Gap &prev = result.back();
+                if (prev.range.second + 1 == begin && (entry.to == END || entry.to - prev.range.first < maxSpan)) {
+                    prev.range.second = entry.to;
+                    prev.attempt = std::max(prev.attempt, entry.attempt);
+                    it = entries.erase(it);
+                    continue;
+                }
+            }
+            result.push_back(Gap{itKey->first, Range(begin, entry.to), entry.attempt});
+            isPrevTaken = entry.to != END;
+            it = entries.erase(it);
+        }
+        if (entries.empty()) {
+            itKey = gaps.erase(itKey);
+        } else {
+            ++itKey;
+        }
+    }
+    return result;
+}
+
+std::vector<GapTracker::Gap> GapTracker::takeExpired(const time_point &now) {
+    std::vector<Gap> result = take([this, &now](const Entry &entry) {
+        return now - entry.sentAt >= timeout;
+    });
+    const auto removed = std::remove_if(result.begin(), result.end(), [this](const Gap &gap) {
+        if (gap.attempt >= maxAttempts) {
+            LOG << "Gap dropped " << gap.key.first << " " << gap.key.second << " " << gap.range.first << " " << gap.range.second;
+            return true;
+        }
+        return false;
+    });
+    result.erase(removed, result.end());
+    return result;
+}
+
+std::vector<GapTracker::Gap> GapTracker::takeAll() {
+    return take([](const Entry &/*entry*/) {
+        return true;
+    });
+}
+
+void GapTracker::clear() {
+    gaps.clear();
+    requests.clear();
+}
+
+std::vector<GapTracker::Range> GapTracker::toRanges(std::vector<Message::Counter> counters) {
+    std::sort(counters.begin(), counters.end());
+    counters.erase(std::unique(counters.begin(), counters.end()), counters.end());
+    std::vector<Range> result;
+    for (const Message::Counter counter: counters) {
+        if (!result.empty() && result.back().second + 1 == counter) {
+            result.back().second = counter;
+        } else {
+            result.emplace_back(counter, counter);
+        }
+    }
+    return result;
+}
+
+}
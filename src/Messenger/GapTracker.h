@@ -0,0 +1,98 @@
+#ifndef GAPTRACKER_H
+#define GAPTRACKER_H
+
+#include <QString>
+
+#include <map>
+#include <vector>
+#include <limits>
+
+#include "duration.h"
+
+#include "Message.h"
+
+namespace messenger {
+
+/*
+   Диапазоны счетчиков, запрошенные у сервера и еще не полученные.
+   Ключ - адрес и канал, для личных сообщений канал пустой.
+   Перекрывающиеся запросы одного диапазона не отправляются повторно, пока на первый не пришел ответ.
+   Класс не потокобезопасен, используется из потока Messenger
+   */
+class GapTracker {
+public:
+
+    using Key = std::pair<QString, QString>;
+
+    // Границы включительно
+    using Range = std::pair<Message::Counter, Message::Counter>;
+
+    struct Gap {
+        Key key;
+        Range range;
+        int attempt;
+    };
+
+    // Открытый справа диапазон, сервер отдаст все до последнего сообщения
+    static const Message::Counter END = std::numeric_limits<Message::Counter>::max();
+
+    GapTracker(Message::Counter maxSpan, const milliseconds &timeout, int maxAttempts);
+
+    // Части [from, to], которые еще не запрошены, нарезанные по maxSpan. Каждую часть нужно отправить и вызвать sent
+    std::vector<Range> add(const Key &key, Message::Counter from, Message::Counter to);
+
+    // attempt - номер попытки для этого диапазона, начиная с 1
+    void sent(const Key &key, const Range &range, size_t requestId, int attempt, const time_point &now);
+
+    // Счетчики, пришедшие от сервера
+    void received(const Key &key, const std::vector<Message::Counter> &counters);
+
+    // Ответ на запрос пришел, вызывается после received. Пропуски до lastCounter - последнего счетчика ответа - на сервере отсутствуют.
+    // Хвост после lastCounter мог не поместиться в ответ, поэтому возвращается для повторного запроса,
+    // если только сервер не сообщил, что дальше сообщений нет (isEnd)
+    std::vector<Gap> done(size_t requestId, Message::Counter lastCounter, bool isEnd);
+
+    // Запросы без ответа дольше timeout. Забираются из трекера, соседние диапазоны склеиваются.
+    // Исчерпавшие maxAttempts выбрасываются
+    std::vector<Gap> takeExpired(const time_point &now);
+
+    // Все незакрытые диапазоны, например после переподключения, когда ответы на старые запросы уже не придут
+    std::vector<Gap> takeAll();
+
+    void clear();
+
+    static std::vector<Range> toRanges(std::vector<Message::Counter> counters);
+
+private:
+
+    struct Entry {
+        Message::Counter to;
+        size_t requestId;
+        time_point sentAt;
+        int attempt;
+    };
+
+    using Entries = std::map<Message::Counter, Entry>;
+
+    void removeRange(Entries &entries, Message::Counter from, Message::Counter to);
+
+    template<class Predicate>
+    std::vector<Gap> take(const Predicate &predicate);
+
+private:
+
+    const Message::Counter maxSpan;
+
+    const milliseconds timeout;
+
+    const int maxAttempts;
+
+    std::map<Key, Entries> gaps;
+
+    std::map<size_t, Key> requests;
+
+};
+
+}
+
+#endif // GAPTRACKER_H
@@ -0,0 +1,52 @@
+#ifndef MESSAGEJSON_H
+#define MESSAGEJSON_H
+
+#include "qt_utilites/JsonWriter.h"
+
+#include "Message.h"
+
+/*
+   Описание json представления сообщений и каналов для javascript.
+   Формат совпадает с прежним, собранным через QJsonObject
+   */
+
+template<>
+struct JsonFields<messenger::Message> {
+    using Msg = messenger::Message;
+
+    static bool isChannel(const Msg &message) {
+        return message.isChannel;
+    }
+
+    static constexpr auto fields() {
+        return std::make_tuple(
+            jsonField("collocutor", &Msg::collocutor),
+            jsonField("isInput", &Msg::isInput),
+            jsonFieldStr("timestamp", &Msg::timestamp),
+            jsonField("data", &Msg::decryptedDataHex),
+            jsonField("isDecrypter", &Msg::isDecrypted),
+            jsonFieldStr("counter", &Msg::counter),
+            jsonFieldStr("fee", &Msg::fee),
+            jsonField("isConfirmed", &Msg::isConfirmed),
+            jsonField("channel", &Msg::channel, &isChannel)
+        );
+    }
+};
+
+template<>
+struct JsonFields<messenger::ChannelInfo> {
+    using Channel = messenger::ChannelInfo;
+
+    static constexpr auto fields() {
+        return std::make_tuple(
+            jsonField("title", &Channel::title),
+            jsonField("titleSha", &Channel::titleSha),
+            jsonField("admin", &Channel::admin),
+            jsonField("isWriter", &Channel::isWriter),
+            jsonFieldStr("saved_pos", &Channel::counter),
+            jsonFieldStr("fee", &Channel::fee)
+        );
+    }
+};
+
+#endif // MESSAGEJSON_H
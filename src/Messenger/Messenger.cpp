@@ -32,6 +32,14 @@ SET_LOG_NAMESPACE("MSG");
 
 namespace messenger {
 
+// Ограничения запросов пропущенных сообщений
+static const Message::Counter MAX_GAP_SPAN = 1000;
+static const milliseconds GAP_TIMEOUT = 10s;
+static const int GAP_MAX_ATTEMPTS = 3;
+
+static const QString WSS_TAG = "messenger";
+static const QString WSS_TAG_MESSAGES = "messenger_messages_";
+
 static QString createHashMessage(const QString &message) {
     return QString(QCryptographicHash::hash(message.toUtf8(), QCryptographicHash::Sha512).toHex());
 }
@@ -113,6 +121,7 @@ Messenger::Messenger(MessengerJavascript &javascriptWrapper, MessengerDBStorage
     , javascriptWrapper(javascriptWrapper)
     , cryptManager(cryptManager)
     , wssClient(getWssServer())
+    , gaps(MAX_GAP_SPAN, GAP_TIMEOUT, GAP_MAX_ATTEMPTS)
 {
     QSettings settings(getSettingsPath(), QSettings::IniFormat);
     CHECK(settings.contains("messenger/saveDecryptedMessage"), "settings timeout not found");
@@ -121,6 +130,8 @@ Messenger::Messenger(MessengerJavascript &javascriptWrapper, MessengerDBStorage
     Q_CONNECT(this, &Messenger::showNotification, &mainWin, &MainWindow::showNotification);
 
     Q_CONNECT(&wssClient, &WebSocketClient::messageReceived, this, &Messenger::onWssMessageReceived);
+    Q_CONNECT(&wssClient, &WebSocketClient::closed, this, &Messenger::onWssClosed);
+    Q_CONNECT(&wssClient, &WebSocketClient::sendFailed, this, &Messenger::onWssSendFailed);
 
     Q_CONNECT(this, &Messenger::registerAddress, this, &Messenger::onRegisterAddress);
     Q_CONNECT(this, &Messenger::registerAddressFromBlockchain, this, &Messenger::onRegisterAddressFromBlockchain);
@@ -138,6 +149,8 @@ Messenger::Messenger(MessengerJavascript &javascriptWrapper, MessengerDBStorage
     Q_CONNECT(this, &Messenger::getHistoryAddress, this, &Messenger::onGetHistoryAddress);
     Q_CONNECT(this, &Messenger::getHistoryAddressAddress, this, &Messenger::onGetHistoryAddressAddress);
     Q_CONNECT(this, &Messenger::getHistoryAddressAddressCount, this, &Messenger::onGetHistoryAddressAddressCount);
+    Q_CONNECT(this, &Messenger::getHistoryAddressAddressStream, this, &Messenger::onGetHistoryAddressAddressStream);
+    Q_CONNECT(this, &Messenger::searchMessages, this, &Messenger::onSearchMessages);
     Q_CONNECT(this, &Messenger::createChannel, this, &Messenger::onCreateChannel);
     Q_CONNECT(this, &Messenger::addWriterToChannel, this, &Messenger::onAddWriterToChannel);
     Q_CONNECT(this, &Messenger::delWriterFromChannel, this, &Messenger::onDelWriterFromChannel);
@@ -151,6 +164,9 @@ Messenger::Messenger(MessengerJavascript &javascriptWrapper, MessengerDBStorage
     Q_REG2(uint64_t, "uint64_t", false);
     Q_REG(Message::Counter, "Message::Counter");
     Q_REG(GetMessagesCallback, "GetMessagesCallback");
+    Q_REG(GetMessagesChunkCallback, "GetMessagesChunkCallback");
+    Q_REG(GetMessagesStreamCallback, "GetMessagesStreamCallback");
+    Q_REG2(std::shared_ptr<StreamToken>, "std::shared_ptr<StreamToken>", false);
     Q_REG(SavePosCallback, "SavePosCallback");
     Q_REG(GetSavedPosCallback, "GetSavedPosCallback");
     Q_REG(GetSavedsPosCallback, "GetSavedsPosCallback");
@@ -208,7 +224,7 @@ std::vector<QString> Messenger::getAddresses() const {
     return result;
 }
 
-void Messenger::getMessagesFromAddressFromWss(const QString &fromAddress, Message::Counter from, Message::Counter to, bool missed) {
+size_t Messenger::getMessagesFromAddressFromWss(const QString &fromAddress, Message::Counter from, Message::Counter to, bool missed) {
     const QString pubkeyHex = db.getUserPublicKey(fromAddress);
     CHECK_TYPED(!pubkeyHex.isEmpty(), TypeErrors::INCOMPLETE_USER_INFO, "user pubkey not found " + fromAddress.toStdString());
     const QString signHex = getSignFromMethod(fromAddress, makeTextForGetMyMessagesRequest());
@@ -218,15 +234,34 @@ void Messenger::getMessagesFromAddressFromWss(const QString &fromAddress, Messag
         loginMessagesRetrieveReqs.insert(requestId);
     }
     const QString message = makeGetMyMessagesRequest(pubkeyHex, signHex, from, to, requestId);
-    emit wssClient.sendMessage(message);
+    // Повторный запрос того же диапазона заменяет еще не отправленный. Вытесненный запрос перезапросит GapTracker по таймауту
+    emit wssClient.sendMessageTagged(message, WSS_TAG_MESSAGES + fromAddress + "_" + QString::number(from) + "_" + QString::number(to), WebSocketClient::QueuePolicy::KeepLast);
+    return requestId;
 }
 
-void Messenger::getMessagesFromChannelFromWss(const QString &fromAddress, const QString &channelSha, Message::Counter from, Message::Counter to) {
+size_t Messenger::getMessagesFromChannelFromWss(const QString &fromAddress, const QString &channelSha, Message::Counter from, Message::Counter to) {
     const QString pubkeyHex = db.getUserPublicKey(fromAddress);
     CHECK_TYPED(!pubkeyHex.isEmpty(), TypeErrors::INCOMPLETE_USER_INFO, "user pubkey not found " + fromAddress.toStdString());
     const QString signHex = getSignFromMethod(fromAddress, makeTextForGetChannelRequest());
-    const QString message = makeGetChannelRequest(channelSha, from, to, pubkeyHex, signHex, id.get());
-    emit wssClient.sendMessage(message);
+    const size_t requestId = id.get();
+    const QString message = makeGetChannelRequest(channelSha, from, to, pubkeyHex, signHex, requestId);
+    emit wssClient.sendMessageTagged(message, WSS_TAG_MESSAGES + fromAddress + "_" + channelSha + "_" + QString::number(from) + "_" + QString::number(to), WebSocketClient::QueuePolicy::KeepLast);
+    return requestId;
+}
+
+void Messenger::requestMessagesFromWss(const QString &address, const QString &channelSha, Message::Counter from, Message::Counter to, bool missed, int attempt) {
+    const GapTracker::Key key(address, channelSha);
+    const std::vector<GapTracker::Range> ranges = gaps.add(key, from, to == -1 ? GapTracker::END : to);
+    for (const GapTracker::Range &range: ranges) {
+        const Message::Counter rangeTo = range.second == GapTracker::END ? -1 : range.second;
+        size_t requestId;
+        if (channelSha.isEmpty()) {
+            requestId = getMessagesFromAddressFromWss(address, range.first, rangeTo, missed);
+        } else {
+            requestId = getMessagesFromChannelFromWss(address, channelSha, range.first, rangeTo);
+        }
+        gaps.sent(key, range, requestId, attempt, ::now());
+    }
 }
 
 void Messenger::clearAddressesToMonitored() {
@@ -244,12 +279,12 @@ void Messenger::addAddressToMonitored(const QString &address) {
     const QString signHexChannels = getSignFromMethod(address, makeTextForGetMyChannelsRequest());
     const QString messageGetMyChannels = makeGetMyChannelsRequest(pubkeyHex, signHexChannels, id.get());
     emit wssClient.addHelloString(messageGetMyChannels, "Messenger");
-    emit wssClient.sendMessage(messageGetMyChannels);
+    emit wssClient.sendMessageTagged(messageGetMyChannels, WSS_TAG, WebSocketClient::QueuePolicy::Keep);
 
     const QString signHex = getSignFromMethod(address, makeTextForMsgAppendKeyOnlineRequest());
     const QString message = makeAppendKeyOnlineRequest(pubkeyHex, signHex, id.get());
     emit wssClient.addHelloString(message, "Messenger");
-    emit wssClient.sendMessage(message);
+    emit wssClient.sendMessageTagged(message, WSS_TAG, WebSocketClient::QueuePolicy::Keep);
 }
 
 void Messenger::processMyChannels(const QString &address, const std::vector<ChannelInfo> &channels) {
@@ -269,7 +304,7 @@ void Messenger::processMyChannels(const QString &address, const std::vector<Chan
     for (const ChannelInfo &channel: channels) {
         const Message::Counter counter = db.getMessageMaxCounter(address, channel.titleSha);
         if (counter < channel.counter) {
-            getMessagesFromChannelFromWss(address, channel.titleSha, counter + 1, channel.counter);
+            requestMessagesFromWss(address, channel.titleSha, counter + 1, channel.counter);
         }
     }
 }
@@ -286,7 +321,7 @@ void Messenger::processAddOrDeleteInChannel(const QString &address, const Channe
         db.addChannel(userId, channel.title, channel.titleSha, channel.admin == address, channel.admin, false, true, false);
         const Message::Counter cnt = channel.counter;
         if (cnt != -1) {
-            getMessagesFromChannelFromWss(address, channel.titleSha, 0, cnt);
+            requestMessagesFromWss(address, channel.titleSha, 0, cnt);
         }
         emit javascriptWrapper.addedToChannelSig(address, channel.title, channel.titleSha, channel.admin, channel.counter);
         MessengerAddedFromChannelVariant event(address, channel.title, channel.titleSha, channel.admin, channel.counter);
@@ -358,6 +393,16 @@ void Messenger::startMethod() {
 }
 
 void Messenger::timerMethod() {
+    for (const GapTracker::Gap &gap: gaps.takeExpired(::now())) {
+        LOG << "Retry messages " << gap.key.first << " " << gap.key.second << " " << gap.range.first << " " << gap.range.second << " " << gap.attempt;
+        const TypedException exception = apiVrapper2([&, this]{
+            requestMessagesFromWss(gap.key.first, gap.key.second, gap.range.first, gap.range.second == GapTracker::END ? -1 : gap.range.second, false, gap.attempt + 1);
+        });
+        if (exception.isSet()) {
+            LOG << "Retry messages exception: " << exception.description;
+        }
+    }
+
     for (auto &pairDeferred: deferredMessages) {
         const QString &address = pairDeferred.first.first;
         const QString &channel = pairDeferred.first.second;
@@ -422,20 +467,22 @@ void Messenger::processMessages(const QString &address, const std::vector<NewMes
             emit showNotification(tr("Retrivied %1 messages").arg(retrievedMissed), QStringLiteral(""));
         }
     }
-    if (messages.empty())
+    if (messages.empty()) {
+        // Пустой ответ - в запрошенном диапазоне больше ничего нет
+        gaps.done(requestId, -1, true);
         return;
+    }
 
 
-    const auto nextProcess = [this, isChannel, address, showNotifies](const std::vector<Message> &messages) {
+    const auto nextProcess = [this, isChannel, address, showNotifies, requestId](const std::vector<Message> &messages) {
         CHECK(!messages.empty(), "Empty messages");
         const QString channel = isChannel ? messages.front().channel : "";
 
-        const Message::Counter currConfirmedCounter = db.getMessageMaxConfirmedCounter(address);
+        const Message::Counter currConfirmedCounter = db.getMessageMaxConfirmedCounter(address, channel);
         CHECK(std::is_sorted(messages.begin(), messages.end()), "Messages not sorted");
         const Message::Counter minCounterInServer = messages.front().counter;
         const Message::Counter maxCounterInServer = messages.back().counter;
 
-        bool deffer = false;
         for (const Message &m: messages) {
             if (!isChannel) {
                 CHECK(!m.isChannel, "Message is channel");
@@ -453,37 +500,27 @@ void Messenger::processMessages(const QString &address, const std::vector<NewMes
                         emit showNotification(tr("Message from %1").arg(m.collocutor), QStringLiteral(""));
                     }
                 }
-                db.addMessage(m);
-                const QString collocutorOrChannel = isChannel ? channel : m.collocutor;
-                const Message::Counter savedPos = db.getLastReadCounterForUserContact(m.username, collocutorOrChannel, isChannel); // TODO вместо метода get сделать метод is
-                if (savedPos == -1) {
-                    db.setLastReadCounterForUserContact(m.username, collocutorOrChannel, -1, isChannel); // TODO подумать нужен ли этот вызов
-                }
-            } else {
-                const auto idPair = db.findFirstNotConfirmedMessageWithHash(m.username, m.hash, channel);
-                const auto idDb = idPair.first;
-                const Message::Counter counter = idPair.second;
-                if (idDb != -1) {
-                    LOG << "Update message " << m.username << " " << channel << " " << m.counter;
-                    db.updateMessage(idDb, m.counter, true);
-                    if (counter != m.counter && !db.hasMessageWithCounter(m.username, counter, channel)) {
-                        if (!isChannel) {
-                            getMessagesFromAddressFromWss(m.username, counter, counter);
-                        } else {
-                            getMessagesFromChannelFromWss(m.username, channel, counter, counter);
-                        }
-                        deffer = true;
-                    }
-                } else {
-                    const auto idPair2 = db.findFirstMessageWithHash(m.username, m.hash, channel);
-                    if (idPair2.first == -1) {
-                        LOG << "Insert new output message " << m.username << " " << channel << " " << m.counter << " " << m.hash;
-                        db.addMessage(m);
-                    }
-                }
             }
         }
 
+        const std::vector<Message::Counter> missedCounters = db.ingestMessages(address, channel, messages);
+
+        std::vector<Message::Counter> receivedCounters;
+        receivedCounters.reserve(messages.size());
+        std::transform(messages.begin(), messages.end(), std::back_inserter(receivedCounters), [](const Message &m) {
+            return m.counter;
+        });
+        gaps.received(std::make_pair(address, channel), receivedCounters);
+        for (const GapTracker::Gap &gap: gaps.done(requestId, maxCounterInServer, false)) {
+            LOG << "Request tail " << gap.key.first << " " << gap.key.second << " " << gap.range.first << " " << gap.range.second;
+            requestMessagesFromWss(gap.key.first, gap.key.second, gap.range.first, gap.range.second == GapTracker::END ? -1 : gap.range.second, false, gap.attempt);
+        }
+
+        for (const GapTracker::Range &range: GapTracker::toRanges(missedCounters)) {
+            requestMessagesFromWss(address, channel, range.first, range.second);
+        }
+        const bool deffer = !missedCounters.empty();
+
         const auto deferrPair = std::make_pair(address, channel);
         if (deffer) {
             LOG << "Deffer message0 " << address << " " << channel;
@@ -491,11 +528,7 @@ void Messenger::processMessages(const QString &address, const std::vector<NewMes
         } else if (minCounterInServer > currConfirmedCounter + 1) {
             LOG << "Deffer message " << address << " " << channel << " " << minCounterInServer << " " << currConfirmedCounter << " " << maxCounterInServer;
             deferredMessages[deferrPair].setDeferred(2s);
-            if (!isChannel) {
-                getMessagesFromAddressFromWss(address, currConfirmedCounter + 1, minCounterInServer);
-            } else {
-                getMessagesFromChannelFromWss(address, channel, currConfirmedCounter + 1, minCounterInServer);
-            }
+            requestMessagesFromWss(address, channel, currConfirmedCounter + 1, minCounterInServer);
         } else {
             if (!deferredMessages[deferrPair].isDeferred()) {
                 if (!isChannel) {
@@ -518,6 +551,35 @@ void Messenger::processMessages(const QString &address, const std::vector<NewMes
     }
 }
 
+void Messenger::onWssClosed() {
+BEGIN_SLOT_WRAPPER
+    // Ответы на отправленные запросы потеряны, незакрытые диапазоны встают в очередь и уйдут после переподключения
+    for (const GapTracker::Gap &gap: gaps.takeAll()) {
+        LOG << "Rerequest messages " << gap.key.first << " " << gap.key.second << " " << gap.range.first << " " << gap.range.second;
+        requestMessagesFromWss(gap.key.first, gap.key.second, gap.range.first, gap.range.second == GapTracker::END ? -1 : gap.range.second, false, gap.attempt);
+    }
+END_SLOT_WRAPPER
+}
+
+void Messenger::onWssSendFailed(QString message, QString tag, const TypedException &exception) {
+BEGIN_SLOT_WRAPPER
+    if (!tag.startsWith(WSS_TAG)) {
+        return;
+    }
+    LOG << "Messenger wss send failed " << tag << " " << exception.description;
+    if (tag.startsWith(WSS_TAG_MESSAGES)) {
+        // Диапазон остался в GapTracker и будет перезапрошен по таймауту
+        return;
+    }
+    const QJsonDocument messageJson = QJsonDocument::fromJson(message.toUtf8());
+    bool isOk = false;
+    const size_t requestId = messageJson.object().value("request_id").toString().toULongLong(&isOk);
+    if (isOk && callbacks.find(requestId) != callbacks.end()) {
+        invokeCallback(requestId, exception);
+    }
+END_SLOT_WRAPPER
+}
+
 void Messenger::onWssMessageReceived(QString message) {
 BEGIN_SLOT_WRAPPER
     const QJsonDocument messageJson = QJsonDocument::fromJson(message.toUtf8());
@@ -559,7 +621,7 @@ BEGIN_SLOT_WRAPPER
         const Message::Counter messagesInServer = parseCountMessagesResponse(messageJson);
         if (currCounter < messagesInServer) {
             LOG << "Read missing messages " << responseType.address << " " << currCounter + 1 << " " << messagesInServer;
-            getMessagesFromAddressFromWss(responseType.address, currCounter + 1, messagesInServer);
+            requestMessagesFromWss(responseType.address, "", currCounter + 1, messagesInServer);
         } else {
             LOG << "Count messages " << responseType.address << " " << currCounter << " " << messagesInServer;
         }
@@ -662,7 +724,7 @@ BEGIN_SLOT_WRAPPER
             callback.emitFunc(exception, isNew);
         };
         callbacks[idRequest] = callbackWrap;
-        emit wssClient.sendMessage(message);
+        emit wssClient.sendMessageTagged(message, WSS_TAG, WebSocketClient::QueuePolicy::Keep);
     }, callback);
 END_SLOT_WRAPPER
 }
@@ -687,7 +749,7 @@ BEGIN_SLOT_WRAPPER
             callback.emitFunc(exception, isNew);
         };
         callbacks[idRequest] = callbackWrap;
-        emit wssClient.sendMessage(message);
+        emit wssClient.sendMessageTagged(message, WSS_TAG, WebSocketClient::QueuePolicy::Keep);
     }, callback);
 END_SLOT_WRAPPER
 }
@@ -729,7 +791,7 @@ BEGIN_SLOT_WRAPPER
         const size_t idRequest = id.get();
         const QString message = makeGetPubkeyRequest(address, pubkeyHex, signHex, idRequest);
         callbacks[idRequest] = std::bind(callback, _1, isNew);
-        emit wssClient.sendMessage(message);
+        emit wssClient.sendMessageTagged(message, WSS_TAG, WebSocketClient::QueuePolicy::Keep);
     }, callback);
 END_SLOT_WRAPPER
 }
@@ -790,7 +852,7 @@ BEGIN_SLOT_WRAPPER
             message = makeSendToChannelRequest(channel, dataHex, fee, timestamp, pubkeyHex, signHex, idRequest);
         }
         callbacks[idRequest] = callback;
-        emit wssClient.sendMessage(message);
+        emit wssClient.sendMessageTagged(message, WSS_TAG, WebSocketClient::QueuePolicy::Keep);
     }, callback);
 END_SLOT_WRAPPER
 }
@@ -858,6 +920,14 @@ BEGIN_SLOT_WRAPPER
 END_SLOT_WRAPPER
 }
 
+void Messenger::onSearchMessages(QString address, const QString &text, qint64 offset, qint64 count, const GetMessagesCallback &callback) {
+BEGIN_SLOT_WRAPPER
+    runAndEmitCallback([&, this] {
+        return db.searchMessages(address, text, offset, count);
+    }, callback);
+END_SLOT_WRAPPER
+}
+
 void Messenger::onGetHistoryAddressAddressCount(QString address, bool isChannel, const QString &collocutorOrChannel, Message::Counter count, Message::Counter to, const GetMessagesCallback &callback) {
 BEGIN_SLOT_WRAPPER
     runAndEmitCallback([&, this] {
@@ -866,6 +936,57 @@ BEGIN_SLOT_WRAPPER
 END_SLOT_WRAPPER
 }
 
+void Messenger::onGetHistoryAddressAddressStream(QString address, bool isChannel, const QString &collocutorOrChannel, Message::Counter from, Message::Counter to, int chunkSize, const std::shared_ptr<StreamToken> &token, const GetMessagesChunkCallback &chunkCallback, const GetMessagesStreamCallback &callback) {
+BEGIN_SLOT_WRAPPER
+    runAndEmitErrorCallback([&, this] {
+        CHECK(chunkSize > 0, "Incorrect chunk size");
+        const auto stream = std::make_shared<MessagesStream>();
+        stream->address = address;
+        stream->isChannel = isChannel;
+        stream->collocutorOrChannel = collocutorOrChannel;
+        stream->from = from;
+        stream->to = to;
+        stream->chunkSize = chunkSize;
+        stream->token = token;
+        stream->chunkCallback = chunkCallback;
+        stream->callback = callback;
+        readMessagesChunk(stream);
+    }, callback);
+END_SLOT_WRAPPER
+}
+
+void Messenger::readMessagesChunk(const std::shared_ptr<MessagesStream> &stream) {
+    const TypedException exception = apiVrapper2([&, this] {
+        if (stream->token->isCancelled()) {
+            stream->callback.emitCallback(stream->sent, true);
+            return;
+        }
+
+        // Порции выбираются по (counter, id), а не по offset, чтобы не пересчитывать уже выданные строки и не терять сообщения с одинаковым counter
+        const std::vector<Message> messages = db.getMessagesForUserAndDestPage(stream->address, stream->collocutorOrChannel, stream->from, stream->lastId, stream->to, stream->chunkSize, stream->isChannel);
+        stream->sent += messages.size();
+        if (!messages.empty()) {
+            stream->from = messages.back().counter;
+            stream->chunkCallback(messages);
+        }
+
+        if ((int)messages.size() < stream->chunkSize) {
+            stream->callback.emitCallback(stream->sent, false);
+            return;
+        }
+
+        QTimer::singleShot(0, this, [this, stream]{
+            BEGIN_SLOT_WRAPPER
+            readMessagesChunk(stream);
+            END_SLOT_WRAPPER
+        });
+    });
+
+    if (exception.isSet()) {
+        stream->callback.emitException(exception);
+    }
+}
+
 void Messenger::onCreateChannel(const QString &address, const QString &title, const QString &titleSha, const QString &pubkeyHex, const QString &signHex, uint64_t fee, const CreateChannelCallback &callback) {
 BEGIN_SLOT_WRAPPER
     runAndEmitErrorCallback([&, this] {
@@ -881,7 +1002,7 @@ BEGIN_SLOT_WRAPPER
             callback.emitFunc(exception);
         };
         callbacks[idRequest] = callbackWrap;
-        emit wssClient.sendMessage(message);
+        emit wssClient.sendMessageTagged(message, WSS_TAG, WebSocketClient::QueuePolicy::Keep);
     }, callback);
 END_SLOT_WRAPPER
 }
@@ -892,7 +1013,7 @@ BEGIN_SLOT_WRAPPER
         const size_t idRequest = id.get();
         const QString message = makeChannelAddWriterRequest(titleSha, address, pubkeyHex, signHex, idRequest);
         callbacks[idRequest] = std::bind(callback, _1);
-        emit wssClient.sendMessage(message);
+        emit wssClient.sendMessageTagged(message, WSS_TAG, WebSocketClient::QueuePolicy::Keep);
     }, callback);
 END_SLOT_WRAPPER
 }
@@ -903,7 +1024,7 @@ BEGIN_SLOT_WRAPPER
         const size_t idRequest = id.get();
         const QString message = makeChannelDelWriterRequest(titleSha, address, pubkeyHex, signHex, idRequest);
         callbacks[idRequest] = std::bind(callback, _1);
-        emit wssClient.sendMessage(message);
+        emit wssClient.sendMessageTagged(message, WSS_TAG, WebSocketClient::QueuePolicy::Keep);
     }, callback);
 END_SLOT_WRAPPER
 }
@@ -925,22 +1046,49 @@ BEGIN_SLOT_WRAPPER
     runAndEmitErrorCallback([&, this] {
         const auto notDecryptedMessagesPair = db.getNotDecryptedMessage(address);
         CHECK(notDecryptedMessagesPair.first.size() == notDecryptedMessagesPair.second.size(), "Incorrect db.getNotDecryptedMessage");
+        const std::vector<DBStorage::DbId> &ids = notDecryptedMessagesPair.first;
         const std::vector<Message> &notDecryptedMessages = notDecryptedMessagesPair.second;
-        cryptManager.tryDecryptMessages(notDecryptedMessages, address, CryptographicManager::DecryptMessagesCallback([this, ids=notDecryptedMessagesPair.first, callback](const std::vector<Message> &answer) {
-            CHECK(ids.size() == answer.size(), "Incorrect tryDecryptMessages");
-            std::vector<std::tuple<MessengerDBStorage::DbId, bool, QString>> result;
-            result.reserve(ids.size());
-            for (size_t i = 0; i < ids.size(); i++) {
-                result.emplace_back(ids[i], answer[i].isDecrypted, answer[i].decryptedDataHex);
-            }
-            db.updateDecryptedMessage(result);
+        if (notDecryptedMessages.empty()) {
+            callback.emitCallback();
+            return;
+        }
 
-            LOG << "Decrypted " << result.size() << " messages";
+        // Пачки расшифровываются по порядку, каждая сразу сохраняется в базу
+        const size_t DECRYPT_BATCH_SIZE = 256;
+        struct State {
+            size_t pending = 0;
+            size_t decrypted = 0;
+            bool isError = false;
+        };
+        const auto state = std::make_shared<State>();
+        for (size_t begin = 0; begin < notDecryptedMessages.size(); begin += DECRYPT_BATCH_SIZE) {
+            const size_t end = std::min(notDecryptedMessages.size(), begin + DECRYPT_BATCH_SIZE);
+            const std::vector<DBStorage::DbId> batchIds(ids.begin() + begin, ids.begin() + end);
+            const std::vector<Message> batch(notDecryptedMessages.begin() + begin, notDecryptedMessages.begin() + end);
+            state->pending++;
+            emit cryptManager.tryDecryptMessages(batch, address, CryptographicManager::DecryptMessagesCallback([this, batchIds, state, callback](const std::vector<Message> &answer) {
+                CHECK(batchIds.size() == answer.size(), "Incorrect tryDecryptMessages");
+                std::vector<std::tuple<MessengerDBStorage::DbId, bool, QString>> result;
+                result.reserve(batchIds.size());
+                for (size_t i = 0; i < batchIds.size(); i++) {
+                    result.emplace_back(batchIds[i], answer[i].isDecrypted, answer[i].decryptedDataHex);
+                }
+                db.updateDecryptedMessage(result);
 
-            callback.emitCallback();
-        }, [callback](const TypedException &exception) {
-            callback.emitException(exception);
-        }, std::bind(&Messenger::callbackCall, this, _1), true));
+                state->decrypted += result.size();
+                state->pending--;
+                if (state->pending == 0 && !state->isError) {
+                    LOG << "Decrypted " << state->decrypted << " messages";
+                    callback.emitCallback();
+                }
+            }, [state, callback](const TypedException &exception) {
+                state->pending--;
+                if (!state->isError) {
+                    state->isError = true;
+                    callback.emitException(exception);
+                }
+            }, std::bind(&Messenger::callbackCall, this, _1), true));
+        }
     }, callback);
 END_SLOT_WRAPPER
 }
@@ -968,17 +1116,18 @@ BEGIN_SLOT_WRAPPER
 
         const QString messageGetMyChannels = makeAddAllKeysRequest(addresses, size_t(-1));
         emit wssClient.addHelloString(messageGetMyChannels, "Messenger");
-        emit wssClient.sendMessage(messageGetMyChannels);
+        emit wssClient.sendMessageTagged(messageGetMyChannels, WSS_TAG, WebSocketClient::QueuePolicy::Keep);
         // Get missed messages
         messageRetrieves.clear();
         loginMessagesRetrieveReqs.clear();
+        gaps.clear();
         retrievedMissed = 0;
         for (const QString &address: addresses) {
             const QString pubkeyHex = db.getUserPublicKey(address);
             if (pubkeyHex.isEmpty())
                 continue;
             const Message::Counter currCounter = db.getMessageMaxConfirmedCounter(address);
-            getMessagesFromAddressFromWss(address, currCounter + 1, -1, true);
+            requestMessagesFromWss(address, "", currCounter + 1, -1, true);
         }
     }, callback);
 END_SLOT_WRAPPER
@@ -990,7 +1139,7 @@ BEGIN_SLOT_WRAPPER
         const size_t idRequest = id.get();
         const QString message = makeWantToTalkRequest(address, pubkey, sign, idRequest);
         callbacks[idRequest] = std::bind(callback, _1);
-        emit wssClient.sendMessage(message);
+        emit wssClient.sendMessageTagged(message, WSS_TAG, WebSocketClient::QueuePolicy::Keep);
     }, callback);
 END_SLOT_WRAPPER
 }
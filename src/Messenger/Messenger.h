@@ -9,9 +9,11 @@
 
 #include "utilites/RequestId.h"
 #include "Message.h"
+#include "GapTracker.h"
 
 #include "qt_utilites/CallbackWrapper.h"
 #include "qt_utilites/ManagerWrapper.h"
+#include "qt_utilites/StreamToken.h"
 
 #include <map>
 #include <set>
@@ -142,6 +144,11 @@ public:
 
     using GetMessagesCallback = CallbackWrapper<void(const std::vector<Message> &messages)>;
 
+    // Вызывается в потоке Messenger для каждой прочитанной порции
+    using GetMessagesChunkCallback = std::function<void(const std::vector<Message> &messages)>;
+
+    using GetMessagesStreamCallback = CallbackWrapper<void(size_t count, bool isCancelled)>;
+
     using SavePosCallback = CallbackWrapper<void()>;
 
     using GetSavedPosCallback = CallbackWrapper<void(const Message::Counter &pos)>;
@@ -260,6 +267,10 @@ signals:
 
     void getHistoryAddressAddressCount(QString address, bool isChannel, const QString &collocutorOrChannel, Message::Counter count, Message::Counter to, const GetMessagesCallback &callback);
 
+    void getHistoryAddressAddressStream(QString address, bool isChannel, const QString &collocutorOrChannel, Message::Counter from, Message::Counter to, int chunkSize, const std::shared_ptr<StreamToken> &token, const GetMessagesChunkCallback &chunkCallback, const GetMessagesStreamCallback &callback);
+
+    void searchMessages(QString address, const QString &text, qint64 offset, qint64 count, const GetMessagesCallback &callback);
+
 
     void createChannel(const QString &address, const QString &title, const QString &titleSha, const QString &pubkeyHex, const QString &signHex, uint64_t fee, const CreateChannelCallback &callback);
 
@@ -317,6 +328,10 @@ private slots:
 
     void onGetHistoryAddressAddressCount(QString address, bool isChannel, const QString &collocutorOrChannel, Message::Counter count, Message::Counter to, const GetMessagesCallback &callback);
 
+    void onGetHistoryAddressAddressStream(QString address, bool isChannel, const QString &collocutorOrChannel, Message::Counter from, Message::Counter to, int chunkSize, const std::shared_ptr<StreamToken> &token, const GetMessagesChunkCallback &chunkCallback, const GetMessagesStreamCallback &callback);
+
+    void onSearchMessages(QString address, const QString &text, qint64 offset, qint64 count, const GetMessagesCallback &callback);
+
 
     void onCreateChannel(const QString &address, const QString &title, const QString &titleSha, const QString &pubkeyHex, const QString &signHex, uint64_t fee, const CreateChannelCallback &callback);
 
@@ -343,11 +358,18 @@ private slots:
 
     void onWssMessageReceived(QString message);
 
+    void onWssClosed();
+
+    void onWssSendFailed(QString message, QString tag, const TypedException &exception);
+
 private:
 
-    void getMessagesFromAddressFromWss(const QString &fromAddress, Message::Counter from, Message::Counter to, bool missed = false);
+    size_t getMessagesFromAddressFromWss(const QString &fromAddress, Message::Counter from, Message::Counter to, bool missed = false);
+
+    size_t getMessagesFromChannelFromWss(const QString &fromAddress, const QString &channelSha, Message::Counter from, Message::Counter to);
 
-    void getMessagesFromChannelFromWss(const QString &fromAddress, const QString &channelSha, Message::Counter from, Message::Counter to);
+    // Запрос еще не запрошенных частей диапазона. to == -1 - до последнего сообщения на сервере
+    void requestMessagesFromWss(const QString &address, const QString &channelSha, Message::Counter from, Message::Counter to, bool missed = false, int attempt = 1);
 
     void clearAddressesToMonitored();
 
@@ -367,6 +389,22 @@ private:
 
     void processAddOrDeleteInChannel(const QString &address, const ChannelInfo &channel, bool isAdd);
 
+    struct MessagesStream {
+        QString address;
+        bool isChannel;
+        QString collocutorOrChannel;
+        Message::Counter from;
+        qint64 lastId = -1;
+        Message::Counter to;
+        int chunkSize;
+        size_t sent = 0;
+        std::shared_ptr<StreamToken> token;
+        GetMessagesChunkCallback chunkCallback;
+        GetMessagesStreamCallback callback;
+    };
+
+    void readMessagesChunk(const std::shared_ptr<MessagesStream> &stream);
+
 private:
 
     bool isDecryptDataSave = false;
@@ -389,6 +427,8 @@ private:
 
     std::map<std::pair<QString, QString>, DeferredMessage> deferredMessages;
 
+    GapTracker gaps;
+
     RequestId id;
 
     using ResponseCallbacks = std::function<void(const TypedException &exception)>;
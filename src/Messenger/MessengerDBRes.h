@@ -7,7 +7,7 @@ namespace messenger {
 
 static const QString databaseName = "messenger";
 static const QString databaseFileName = "messenger.db";
-static const int databaseVersion = 1;
+static const int databaseVersion = 4;
 
 static const QString createMsgUsersTable = "CREATE TABLE users ( "
                                            "id INTEGER PRIMARY KEY NOT NULL, "
@@ -80,6 +80,11 @@ static const QString createMsgMessageUniqueIndex2 = "CREATE UNIQUE INDEX message
 
 static const QString createMsgMessageCounterIndex = "CREATE INDEX messagesCounterIdx ON messages(morder)";
 
+static const QString createMsgMessageHashIndex = "CREATE INDEX messagesHashIdx ON messages(userid, hash)";
+
+// channelid после userid: у личных сообщений он NULL, поэтому индекс обслуживает и личную переписку, и каждый канал
+static const QString createMsgMessageConfirmedCounterIndex = "CREATE INDEX messagesConfirmedCounterIdx ON messages(userid, channelid, isConfirmed, morder)";
+
 static const QString createMsgLastReadMessageTable = "CREATE TABLE lastreadmessage ( "
                                                         "id INTEGER PRIMARY KEY NOT NULL, "
                                                         "userid  INTEGER NOT NULL, "
@@ -109,14 +114,14 @@ static const QString insertMsgMessages = "INSERT OR IGNORE INTO messages "
 
 static const QString selectMsgMaxCounter = "SELECT IFNULL(MAX(m.morder), -1) AS max "
                                            "FROM messages m "
-                                           "INNER JOIN users u ON u.id = m.userid %1 "
-                                           "WHERE u.username = :user %2";
+                                           "INNER JOIN users u ON u.id = m.userid "
+                                           "WHERE u.username = :user %1";
 
 static const QString selectMsgMaxConfirmedCounter = "SELECT IFNULL(MAX(m.morder), -1) AS max "
                                                     "FROM messages m "
                                                     "INNER JOIN users u ON u.id = m.userid "
                                                     "WHERE m.isConfirmed = 1 "
-                                                    "AND u.username = :user";
+                                                    "AND u.username = :user %1";
 
 static QString selectMsgMessagesForUser = "SELECT u.username AS user, du.username AS dest, m.isIncoming, m.text, m.decryptedText, m.isDecrypted, "
                                                 "m.morder, m.dt, m.fee, m.canDecrypted, m.isConfirmed, m.hash "
@@ -145,6 +150,27 @@ static const QString selectMsgMessagesForUserAndChannel = "SELECT u.username AS
                                                              "AND u.username = :user AND c.shaName = :shaName "
                                                              "ORDER BY m.morder";
 
+// Постраничная выборка по ключу (morder, id): morder не уникален, поэтому одного counter недостаточно
+static const QString selectMsgMessagesForUserAndDestPage = "SELECT m.id AS id, u.username AS user, c.username AS dest, m.isIncoming, m.text, m.decryptedText, m.isDecrypted, "
+                                                           "m.morder, m.dt, m.fee, m.canDecrypted, m.isConfirmed, m.hash "
+                                                           "FROM messages m "
+                                                           "INNER JOIN users u ON u.id = m.userid "
+                                                           "INNER JOIN contacts c ON c.id = m.contactid "
+                                                           "WHERE (m.morder > :ob OR (m.morder = :ob AND m.id > :lastid)) AND m.morder <= :oe "
+                                                           "AND u.username = :user AND c.username = :duser "
+                                                           "ORDER BY m.morder, m.id "
+                                                           "LIMIT :num";
+
+static const QString selectMsgMessagesForUserAndChannelPage = "SELECT m.id AS id, u.username AS user, c.shaName AS dest, m.isIncoming, m.text, m.decryptedText, m.isDecrypted, "
+                                                              "m.morder, m.dt, m.fee, m.canDecrypted, m.isConfirmed, m.hash "
+                                                              "FROM messages m "
+                                                              "INNER JOIN users u ON u.id = m.userid "
+                                                              "INNER JOIN channels c ON c.id = m.channelid "
+                                                              "WHERE (m.morder > :ob OR (m.morder = :ob AND m.id > :lastid)) AND m.morder <= :oe "
+                                                              "AND u.username = :user AND c.shaName = :shaName "
+                                                              "ORDER BY m.morder, m.id "
+                                                              "LIMIT :num";
+
 static const QString selectMsgMessagesForUserAndDestNum = "SELECT u.username AS user, c.username AS dest, m.isIncoming, m.text, m.decryptedText, m.isDecrypted, "
                                                           "m.morder, m.dt, m.fee, m.canDecrypted, m.isConfirmed, m.hash "
                                                           "FROM messages m "
@@ -187,7 +213,7 @@ static const QString selectMsgCountMessagesForUserAndDest = "SELECT COUNT(*) AS
 
 
 static const QString selectCountNotConfirmedMessagesWithHash = "SELECT (COUNT(*) > 0) AS res "
-                                                        "FROM messages m "
+                                                        "FROM messages m INDEXED BY messagesHashIdx "
                                                         "INNER JOIN users u ON u.id = m.userid "
                                                         "WHERE m.isConfirmed = 0 "
                                                         "AND m.hash = :hash "
@@ -195,36 +221,47 @@ static const QString selectCountNotConfirmedMessagesWithHash = "SELECT (COUNT(*)
 
 static const QString selectCountMessagesWithCounter = "SELECT (COUNT(*) > 0) AS res "
                                                         "FROM messages m "
-                                                        "INNER JOIN users u ON u.id = m.userid %1 "
+                                                        "INNER JOIN users u ON u.id = m.userid "
                                                         "WHERE m.morder = :counter "
-                                                        "AND u.username = :user %2 ";
+                                                        "AND u.username = :user %1 ";
 
 
 static const QString selectFirstNotConfirmedMessage = "SELECT m.id, m.morder "
                                                         "FROM messages m "
                                                         "INNER JOIN users u ON u.id = m.userid "
                                                         "WHERE m.isConfirmed = 0 "
-                                                        "AND u.username = :user "
+                                                        "AND u.username = :user %1 "
                                                         "ORDER BY m.morder "
                                                         "LIMIT 1";
 
 static const QString selectFirstNotConfirmedMessageWithHash = "SELECT m.id, m.morder "
-                                                        "FROM messages m "
-                                                        "INNER JOIN users u ON u.id = m.userid %1 "
+                                                        "FROM messages m INDEXED BY messagesHashIdx "
+                                                        "INNER JOIN users u ON u.id = m.userid "
                                                         "WHERE m.isConfirmed = 0 "
                                                         "AND m.hash = :hash "
-                                                        "AND u.username = :user %2 "
+                                                        "AND u.username = :user %1 "
                                                         "ORDER BY m.morder "
                                                         "LIMIT 1";
 
 static const QString selectFirstMessageWithHash = "SELECT m.id, m.morder "
-                                                        "FROM messages m "
-                                                        "INNER JOIN users u ON u.id = m.userid %1 "
+                                                        "FROM messages m INDEXED BY messagesHashIdx "
+                                                        "INNER JOIN users u ON u.id = m.userid "
                                                         "WHERE m.hash = :hash "
-                                                        "AND u.username = :user %2 "
+                                                        "AND u.username = :user %1 "
                                                         "ORDER BY m.morder "
                                                         "LIMIT 1";
 
+static const QString selectMessagesWithHashes = "SELECT m.id, m.morder, m.hash, m.isConfirmed "
+                                                        "FROM messages m INDEXED BY messagesHashIdx "
+                                                        "WHERE m.userid = :userid %1 "
+                                                        "AND m.hash IN (%2) "
+                                                        "ORDER BY m.morder";
+
+static const QString selectExistMessagesCounters = "SELECT DISTINCT m.morder "
+                                                        "FROM messages m "
+                                                        "WHERE m.userid = :userid %1 "
+                                                        "AND m.morder IN (%2)";
+
 static const QString updateMessageQuery = "UPDATE messages "
                                         "SET isConfirmed = :isConfirmed, morder = :counter "
                                         "WHERE id = :id";
@@ -317,7 +354,8 @@ static const QString updateChannelIsWriterForUserShaName = "UPDATE channels "
 
 //static const QString selectWhereIsChannel = "AND m.channelid IS NOT NULL";
 static const QString selectWhereIsNotChannel = "AND m.channelid IS NULL";
-static const QString selectJoinChannel = "INNER JOIN channels c ON c.id = m.channelid AND c.shaName = :channelSha";
+// Условие, а не join с channels, чтобы выборка шла по индексу messages без перебора сообщений пользователя
+static const QString selectWhereChannel = "AND m.channelid IN (SELECT id FROM channels WHERE shaName = :channelSha)";
 
 static const QString removeDecryptedDataQuery = "UPDATE messages "
                                         "SET isDecrypted = 0, decryptedText = \'\' "
@@ -347,6 +385,52 @@ static const QString updateDecryptedMessageQuery = "UPDATE messages "
                                         "SET isDecrypted = :isDecrypted, decryptedText = :decryptedText "
                                         "WHERE id = :id";
 
+static const QString createMsgSearchTable = "CREATE VIRTUAL TABLE IF NOT EXISTS messagessearch "
+                                        "USING fts5(text, tokenize = 'unicode61')";
+
+static const QString selectFts5Available = "SELECT sqlite_compileoption_used('ENABLE_FTS5')";
+
+static const QString selectMsgSearchTableExists = "SELECT name FROM sqlite_master WHERE type = 'table' AND name = 'messagessearch'";
+
+static const QString insertMsgSearchQuery = "INSERT OR REPLACE INTO messagessearch (rowid, text) VALUES (:id, :text)";
+
+static const QString deleteMsgSearchQuery = "DELETE FROM messagessearch WHERE rowid = :id";
+
+static const QString deleteAllMsgSearchQuery = "DELETE FROM messagessearch";
+
+static const QString selectDecryptedMessagesTextQuery = "SELECT id, decryptedText FROM messages WHERE isDecrypted = 1";
+
+static const QString selectMessagesFieldsForSearch = "SELECT m.id, u.username AS user, c.username AS contact, ch.shaName AS channel, m.isIncoming, m.text, m.decryptedText, m.isDecrypted, "
+                                                  "m.morder, m.dt, m.fee, m.canDecrypted, m.isConfirmed, m.hash ";
+
+static const QString selectSearchMessagesQuery = selectMessagesFieldsForSearch +
+                                                        "FROM messagessearch "
+                                                        "INNER JOIN messages m ON m.id = messagessearch.rowid "
+                                                        "INNER JOIN users u ON u.id = m.userid "
+                                                        "LEFT JOIN contacts c ON c.id = m.contactid "
+                                                        "LEFT JOIN channels ch ON ch.id = m.channelid "
+                                                        "WHERE messagessearch MATCH :query "
+                                                        "AND u.username = :user "
+                                                        "ORDER BY messagessearch.rank, m.morder DESC "
+                                                        "LIMIT :count OFFSET :offset";
+
+// Постраничный перебор расшифрованных текстов пользователя от новых к старым по ключу (morder, id)
+static const QString selectDecryptedTextsForUserPageQuery = "SELECT m.id, m.morder, m.decryptedText "
+                                                        "FROM messages m "
+                                                        "INNER JOIN users u ON u.id = m.userid "
+                                                        "WHERE m.isDecrypted = 1 "
+                                                        "AND u.username = :user "
+                                                        "AND (m.morder < :ob OR (m.morder = :ob AND m.id < :lastid)) "
+                                                        "ORDER BY m.morder DESC, m.id DESC "
+                                                        "LIMIT :num";
+
+static const QString selectMessageForSearchQuery = selectMessagesFieldsForSearch +
+                                                        "FROM messages m "
+                                                        "INNER JOIN users u ON u.id = m.userid "
+                                                        "LEFT JOIN contacts c ON c.id = m.contactid "
+                                                        "LEFT JOIN channels ch ON ch.id = m.channelid "
+                                                        "WHERE m.id = :id";
+
 
 }
 
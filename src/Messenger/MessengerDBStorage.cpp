@@ -7,9 +7,16 @@
 #include "Log.h"
 
 #include <iostream>
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <set>
+#include <limits>
 
 SET_LOG_NAMESPACE("MSG");
 
+static const qint64 SEARCH_FALLBACK_PAGE_SIZE = 1000;
+
 namespace messenger {
 
 
@@ -36,34 +43,61 @@ void MessengerDBStorage::addMessage(const QString &user, const QString &duser, c
     if (channelSha.isEmpty()) {
         CHECK(!duser.isEmpty(), "No contact or channel");
         contactid = getContactIdOrCreate(duser);
+        CHECK(contactid != not_found, "Contact not created");
     } else {
         channelid = getChannelForUserShaName(user, channelSha);
+        CHECK(channelid != not_found, "Channel not found " + channelSha.toStdString());
     }
 
+    Message message;
+    message.dataHex = text;
+    message.decryptedDataHex = decryptedText;
+    message.isDecrypted = isDecrypted;
+    message.timestamp = timestamp;
+    message.counter = counter;
+    message.isInput = isIncoming;
+    message.isCanDecrypted = canDecrypted;
+    message.isConfirmed = isConfirmed;
+    message.hash = hash;
+    message.fee = fee;
+
     QSqlQuery query(database());
     CHECK(query.prepare(insertMsgMessages), query.lastError().text().toStdString());
+    QSqlQuery searchQuery(database());
+    prepareSearchInsert(searchQuery);
+    insertMessage(query, searchQuery, userid, contactid, channelid, message);
+    addLastReadRecord(userid, contactid, channelid);
+}
+
+void MessengerDBStorage::prepareSearchInsert(QSqlQuery &searchQuery) {
+    if (hasSearchIndex()) {
+        CHECK(searchQuery.prepare(insertMsgSearchQuery), searchQuery.lastError().text().toStdString());
+    }
+}
+
+void MessengerDBStorage::insertMessage(QSqlQuery &query, QSqlQuery &searchQuery, DbId userid, DbId contactid, DbId channelid, const Message &message) {
     query.bindValue(":userid", userid);
-    if (channelSha.isEmpty()) {
-        CHECK(contactid != not_found, "Contact not created");
+    if (channelid == -1) {
         query.bindValue(":contactid", contactid);
         query.bindValue(":channelid", QVariant());
     } else {
-        CHECK(channelid != not_found, "Channel not found " + channelSha.toStdString());
         query.bindValue(":channelid", channelid);
         query.bindValue(":contactid", QVariant());
     }
-    query.bindValue(":order", counter);
-    query.bindValue(":dt", static_cast<qint64>(timestamp));
-    query.bindValue(":text", text);
-    query.bindValue(":decryptedText", decryptedText);
-    query.bindValue(":isDecrypted", isDecrypted);
-    query.bindValue(":isIncoming", isIncoming);
-    query.bindValue(":canDecrypted", canDecrypted);
-    query.bindValue(":isConfirmed", isConfirmed);
-    query.bindValue(":hash", hash);
-    query.bindValue(":fee", fee);
+    query.bindValue(":order", message.counter);
+    query.bindValue(":dt", static_cast<qint64>(message.timestamp));
+    query.bindValue(":text", message.dataHex);
+    query.bindValue(":decryptedText", message.decryptedDataHex);
+    query.bindValue(":isDecrypted", message.isDecrypted);
+    query.bindValue(":isIncoming", message.isInput);
+    query.bindValue(":canDecrypted", message.isCanDecrypted);
+    query.bindValue(":isConfirmed", message.isConfirmed);
+    query.bindValue(":hash", message.hash);
+    query.bindValue(":fee", static_cast<qint64>(message.fee));
     CHECK(query.exec(), query.lastError().text().toStdString());
-    addLastReadRecord(userid, contactid, channelid);
+    if (hasSearchIndex() && message.isDecrypted && query.numRowsAffected() > 0) {
+        addToSearchIndex(searchQuery, query.lastInsertId().toLongLong(), message.decryptedDataHex);
+    }
 }
 
 void MessengerDBStorage::addMessage(const Message &message) {
@@ -81,6 +115,141 @@ void MessengerDBStorage::addMessages(const std::vector<Message> &messages) {
     transactionGuard.commit();
 }
 
+static QString whereChannel(const QString &channelSha) {
+    return channelSha.isEmpty() ? selectWhereIsNotChannel : selectWhereChannel;
+}
+
+// Запрос с IN (...) по частям, чтобы не упереться в лимит параметров sqlite
+template<typename T, typename Func>
+static void selectInChunks(const QSqlDatabase &db, const QString &sqlTemplate, DBStorage::DbId userid, const QString &channelSha, const std::vector<T> &values, const Func &processRow) {
+    const size_t CHUNK_SIZE = 500;
+    for (size_t begin = 0; begin < values.size(); begin += CHUNK_SIZE) {
+        const size_t end = std::min(values.size(), begin + CHUNK_SIZE);
+        QStringList placeholders;
+        for (size_t i = begin; i < end; i++) {
+            placeholders.append(QStringLiteral(":v%1").arg(i - begin));
+        }
+        const QString sql = sqlTemplate
+            .arg(whereChannel(channelSha))
+            .arg(placeholders.join(QStringLiteral(", ")));
+        QSqlQuery query(db);
+        CHECK(query.prepare(sql), query.lastError().text().toStdString());
+        query.bindValue(":userid", userid);
+        if (!channelSha.isEmpty()) {
+            query.bindValue(":channelSha", channelSha);
+        }
+        for (size_t i = begin; i < end; i++) {
+            query.bindValue(placeholders[static_cast<int>(i - begin)], values[i]);
+        }
+        CHECK(query.exec(), query.lastError().text().toStdString());
+        while (query.next()) {
+            processRow(query);
+        }
+    }
+}
+
+std::vector<Message::Counter> MessengerDBStorage::ingestMessages(const QString &user, const QString &channelSha, const std::vector<Message> &messages) {
+    auto transactionGuard = beginTransaction();
+
+    const DbId userid = getUserId(user);
+    CHECK(userid != not_found, "User not created: " + user.toStdString());
+    DbId channelid = -1;
+    if (!channelSha.isEmpty()) {
+        channelid = getChannelForUserShaName(user, channelSha);
+        CHECK(channelid != not_found, "Channel not found " + channelSha.toStdString());
+    }
+
+    std::vector<QString> outputHashes;
+    for (const Message &m: messages) {
+        if (!m.isInput) {
+            outputHashes.emplace_back(m.hash);
+        }
+    }
+    std::sort(outputHashes.begin(), outputHashes.end());
+    outputHashes.erase(std::unique(outputHashes.begin(), outputHashes.end()), outputHashes.end());
+
+    // Для каждого хэша неподтвержденные сообщения по возрастанию счетчика, как их выбирал findFirstNotConfirmedMessageWithHash
+    std::map<QString, std::deque<IdCounterPair>> notConfirmed;
+    std::set<QString> existHashes;
+    selectInChunks(database(), selectMessagesWithHashes, userid, channelSha, outputHashes, [&](const QSqlQuery &query) {
+        const QString hash = query.value("hash").toString();
+        existHashes.insert(hash);
+        if (!query.value("isConfirmed").toBool()) {
+            notConfirmed[hash].emplace_back(query.value("id").toLongLong(), query.value("morder").toLongLong());
+        }
+    });
+
+    QSqlQuery insertQuery(database());
+    CHECK(insertQuery.prepare(insertMsgMessages), insertQuery.lastError().text().toStdString());
+    QSqlQuery searchQuery(database());
+    prepareSearchInsert(searchQuery);
+    QSqlQuery updateQuery(database());
+    CHECK(updateQuery.prepare(updateMessageQuery), updateQuery.lastError().text().toStdString());
+
+    std::map<QString, DbId> contacts;
+    bool isChannelLastReadAdded = false;
+    const auto insert = [&](const Message &m) {
+        DbId contactid = -1;
+        if (channelid == -1) {
+            CHECK(!m.collocutor.isEmpty(), "No contact or channel");
+            auto found = contacts.find(m.collocutor);
+            if (found == contacts.end()) {
+                contactid = getContactIdOrCreate(m.collocutor);
+                CHECK(contactid != not_found, "Contact not created");
+                addLastReadRecord(userid, contactid, channelid);
+                contacts.emplace(m.collocutor, contactid);
+            } else {
+                contactid = found->second;
+            }
+        } else if (!isChannelLastReadAdded) {
+            addLastReadRecord(userid, contactid, channelid);
+            isChannelLastReadAdded = true;
+        }
+        insertMessage(insertQuery, searchQuery, userid, contactid, channelid, m);
+        existHashes.insert(m.hash);
+    };
+
+    std::vector<Message::Counter> oldCounters;
+    for (const Message &m: messages) {
+        if (m.isInput) {
+            insert(m);
+            continue;
+        }
+        auto found = notConfirmed.find(m.hash);
+        if (found != notConfirmed.end() && !found->second.empty()) {
+            const IdCounterPair idCounter = found->second.front();
+            found->second.pop_front();
+            LOG << "Update message " << m.username << " " << channelSha << " " << m.counter;
+            updateQuery.bindValue(":id", idCounter.first);
+            updateQuery.bindValue(":counter", m.counter);
+            updateQuery.bindValue(":isConfirmed", true);
+            CHECK(updateQuery.exec(), updateQuery.lastError().text().toStdString());
+            if (idCounter.second != m.counter) {
+                oldCounters.emplace_back(idCounter.second);
+            }
+        } else if (existHashes.find(m.hash) == existHashes.end()) {
+            LOG << "Insert new output message " << m.username << " " << channelSha << " " << m.counter << " " << m.hash;
+            insert(m);
+        }
+    }
+
+    // Наличие старых счетчиков проверяется по состоянию после всей пачки
+    std::sort(oldCounters.begin(), oldCounters.end());
+    oldCounters.erase(std::unique(oldCounters.begin(), oldCounters.end()), oldCounters.end());
+    std::set<Message::Counter> existCounters;
+    selectInChunks(database(), selectExistMessagesCounters, userid, channelSha, oldCounters, [&](const QSqlQuery &query) {
+        existCounters.insert(query.value("morder").toLongLong());
+    });
+
+    transactionGuard.commit();
+
+    std::vector<Message::Counter> missedCounters;
+    std::copy_if(oldCounters.begin(), oldCounters.end(), std::back_inserter(missedCounters), [&existCounters](Message::Counter counter) {
+        return existCounters.find(counter) == existCounters.end();
+    });
+    return missedCounters;
+}
+
 DBStorage::DbId MessengerDBStorage::getUserId(const QString &username) {
     QSqlQuery query(database());
     CHECK(query.prepare(selectMsgUsersForName), query.lastError().text().toStdString());
@@ -230,8 +399,7 @@ void MessengerDBStorage::setContactPublicKey(const QString &username, const QStr
 Message::Counter MessengerDBStorage::getMessageMaxCounter(const QString &user, const QString &channelSha) {
     QSqlQuery query(database());
     const QString sql = selectMsgMaxCounter
-            .arg(channelSha.isEmpty() ? QStringLiteral("") : selectJoinChannel)
-            .arg(channelSha.isEmpty() ? selectWhereIsNotChannel : QStringLiteral(""));
+            .arg(whereChannel(channelSha));
     CHECK(query.prepare(sql), query.lastError().text().toStdString());
     query.bindValue(":user", user);
     if (!channelSha.isEmpty())
@@ -243,10 +411,14 @@ Message::Counter MessengerDBStorage::getMessageMaxCounter(const QString &user, c
     return -1;
 }
 
-Message::Counter MessengerDBStorage::getMessageMaxConfirmedCounter(const QString &user) {
+Message::Counter MessengerDBStorage::getMessageMaxConfirmedCounter(const QString &user, const QString &channelSha) {
     QSqlQuery query(database());
-    CHECK(query.prepare(selectMsgMaxConfirmedCounter), query.lastError().text().toStdString());
+    const QString sql = selectMsgMaxConfirmedCounter
+            .arg(whereChannel(channelSha));
+    CHECK(query.prepare(sql), query.lastError().text().toStdString());
     query.bindValue(":user", user);
+    if (!channelSha.isEmpty())
+        query.bindValue(":channelSha", channelSha);
     CHECK(query.exec(), query.lastError().text().toStdString());
     if (query.next()) {
         return query.value("max").toLongLong();
@@ -288,6 +460,32 @@ std::vector<Message> MessengerDBStorage::getMessagesForUserAndDest(const QString
     return res;
 }
 
+std::vector<Message> MessengerDBStorage::getMessagesForUserAndDestPage(const QString &user, const QString &channelOrContact, qint64 from, DbId &lastId, qint64 to, qint64 limit, bool isChannel) {
+    std::vector<Message> res;
+    QSqlQuery query(database());
+    if (isChannel) {
+        CHECK(query.prepare(selectMsgMessagesForUserAndChannelPage), query.lastError().text().toStdString());
+    } else {
+        CHECK(query.prepare(selectMsgMessagesForUserAndDestPage), query.lastError().text().toStdString());
+    }
+    query.bindValue(":user", user);
+    if (isChannel)
+        query.bindValue(":shaName", channelOrContact);
+    else
+        query.bindValue(":duser", channelOrContact);
+    query.bindValue(":ob", from);
+    query.bindValue(":lastid", lastId);
+    query.bindValue(":oe", to);
+    query.bindValue(":num", limit);
+    CHECK(query.exec(), query.lastError().text().toStdString());
+    std::vector<DbId> ids;
+    createMessagesList(query, res, ids, true, isChannel, false);
+    if (!ids.empty()) {
+        lastId = ids.back();
+    }
+    return res;
+}
+
 std::vector<Message> MessengerDBStorage::getMessagesForUserAndDestNum(const QString &user, const QString &channelOrContact, qint64 to, qint64 num, bool isChannel) {
     std::vector<Message> res;
     QSqlQuery query(database());
@@ -326,8 +524,7 @@ qint64 MessengerDBStorage::getMessagesCountForUserAndDest(const QString &user, c
 bool MessengerDBStorage::hasMessageWithCounter(const QString &username, Message::Counter counter, const QString &channelSha) {
     QSqlQuery query(database());
     const QString sql = selectCountMessagesWithCounter
-            .arg(channelSha.isEmpty() ? QStringLiteral("") : selectJoinChannel)
-            .arg(channelSha.isEmpty() ? selectWhereIsNotChannel : QStringLiteral(""));
+            .arg(whereChannel(channelSha));
     CHECK(query.prepare(sql), query.lastError().text().toStdString());
     query.bindValue(":user", username);
     query.bindValue(":counter", counter);
@@ -355,8 +552,7 @@ bool MessengerDBStorage::hasUnconfirmedMessageWithHash(const QString &username,
 MessengerDBStorage::IdCounterPair MessengerDBStorage::findFirstNotConfirmedMessageWithHash(const QString &username, const QString &hash, const QString &channelSha) {
     QSqlQuery query(database());
     const QString sql = selectFirstNotConfirmedMessageWithHash
-    .arg(channelSha.isEmpty() ? QStringLiteral("") : selectJoinChannel)
-    .arg(channelSha.isEmpty() ? selectWhereIsNotChannel : QStringLiteral(""));
+            .arg(whereChannel(channelSha));
     CHECK(query.prepare(sql), query.lastError().text().toStdString());
     query.bindValue(":user", username);
     query.bindValue(":hash", hash);
@@ -373,8 +569,7 @@ MessengerDBStorage::IdCounterPair MessengerDBStorage::findFirstNotConfirmedMessa
 MessengerDBStorage::IdCounterPair MessengerDBStorage::findFirstMessageWithHash(const QString &username, const QString &hash, const QString &channelSha) {
     QSqlQuery query(database());
     const QString sql = selectFirstMessageWithHash
-    .arg(channelSha.isEmpty() ? QStringLiteral("") : selectJoinChannel)
-    .arg(channelSha.isEmpty() ? selectWhereIsNotChannel : QStringLiteral(""));
+            .arg(whereChannel(channelSha));
     CHECK(query.prepare(sql), query.lastError().text().toStdString());
     query.bindValue(":user", username);
     query.bindValue(":hash", hash);
@@ -388,10 +583,14 @@ MessengerDBStorage::IdCounterPair MessengerDBStorage::findFirstMessageWithHash(c
     return MessengerDBStorage::IdCounterPair(-1, -1);
 }
 
-DBStorage::DbId MessengerDBStorage::findFirstNotConfirmedMessage(const QString &username) {
+DBStorage::DbId MessengerDBStorage::findFirstNotConfirmedMessage(const QString &username, const QString &channelSha) {
     QSqlQuery query(database());
-    CHECK(query.prepare(selectFirstNotConfirmedMessage), query.lastError().text().toStdString());
+    const QString sql = selectFirstNotConfirmedMessage
+            .arg(whereChannel(channelSha));
+    CHECK(query.prepare(sql), query.lastError().text().toStdString());
     query.bindValue(":user", username);
+    if (!channelSha.isEmpty())
+        query.bindValue(":channelSha", channelSha);
     CHECK(query.exec(), query.lastError().text().toStdString());
     if (query.next()) {
         return query.value("id").toLongLong();
@@ -565,9 +764,15 @@ void MessengerDBStorage::setChannelIsWriterForUserShaName(const QString &user, c
 }
 
 void MessengerDBStorage::removeDecryptedData() {
+    auto transactionGuard = beginTransaction();
     QSqlQuery query(database());
     CHECK(query.prepare(removeDecryptedDataQuery), query.lastError().text().toStdString());
     CHECK(query.exec(), query.lastError().text().toStdString());
+    if (hasSearchIndex()) {
+        CHECK(query.prepare(deleteAllMsgSearchQuery), query.lastError().text().toStdString());
+        CHECK(query.exec(), query.lastError().text().toStdString());
+    }
+    transactionGuard.commit();
 }
 
 std::pair<std::vector<MessengerDBStorage::DbId>, std::vector<Message>> MessengerDBStorage::getNotDecryptedMessage(const QString &user) {
@@ -604,15 +809,196 @@ std::pair<std::vector<MessengerDBStorage::DbId>, std::vector<Message>> Messenger
 
 void MessengerDBStorage::updateDecryptedMessage(const std::vector<std::tuple<DbId, bool, QString>> &messages) {
     auto transactionGuard = beginTransaction();
+    QSqlQuery query(database());
+    CHECK(query.prepare(updateDecryptedMessageQuery), query.lastError().text().toStdString());
+    QSqlQuery insertSearchQuery(database());
+    QSqlQuery deleteSearchQuery(database());
+    if (hasSearchIndex()) {
+        CHECK(insertSearchQuery.prepare(insertMsgSearchQuery), insertSearchQuery.lastError().text().toStdString());
+        CHECK(deleteSearchQuery.prepare(deleteMsgSearchQuery), deleteSearchQuery.lastError().text().toStdString());
+    }
     for (const auto &messageTuple: messages) {
-        QSqlQuery query(database());
-        CHECK(query.prepare(updateDecryptedMessageQuery), query.lastError().text().toStdString());
         query.bindValue(":id", std::get<0>(messageTuple));
         query.bindValue(":isDecrypted", std::get<1>(messageTuple));
         query.bindValue(":decryptedText", std::get<2>(messageTuple));
         query.exec();
+        if (hasSearchIndex()) {
+            if (std::get<1>(messageTuple)) {
+                addToSearchIndex(insertSearchQuery, std::get<0>(messageTuple), std::get<2>(messageTuple));
+            } else {
+                deleteSearchQuery.bindValue(":id", std::get<0>(messageTuple));
+                CHECK(deleteSearchQuery.exec(), deleteSearchQuery.lastError().text().toStdString());
+            }
+        }
+    }
+    transactionGuard.commit();
+}
+
+// decryptedText хранится в hex, в индекс кладется сам текст
+static QString searchTextFromHex(const QString &decryptedText) {
+    return QString::fromUtf8(QByteArray::fromHex(decryptedText.toLatin1()));
+}
+
+// Каждое слово запроса ищется как префикс, слова объединяются по И.
+// Слова берутся в кавычки, чтобы спецсимволы fts5 в запросе пользователя не разбирались как синтаксис
+static QString makeSearchQuery(const QStringList &words) {
+    QStringList terms;
+    for (const QString &word: words) {
+        QString escaped = word;
+        escaped.replace(QStringLiteral("\""), QStringLiteral("\"\""));
+        terms.append(QStringLiteral("\"") + escaped + QStringLiteral("\"*"));
+    }
+    return terms.join(QStringLiteral(" "));
+}
+
+bool MessengerDBStorage::isFts5Available() {
+    QSqlQuery query(database());
+    CHECK(query.prepare(selectFts5Available), query.lastError().text().toStdString());
+    CHECK(query.exec(), query.lastError().text().toStdString());
+    return query.next() && query.value(0).toBool();
+}
+
+bool MessengerDBStorage::hasSearchIndex() {
+    if (searchIndexState == SearchIndexState::Unknown) {
+        QSqlQuery query(database());
+        CHECK(query.prepare(selectMsgSearchTableExists), query.lastError().text().toStdString());
+        CHECK(query.exec(), query.lastError().text().toStdString());
+        searchIndexState = query.next() ? SearchIndexState::Exist : SearchIndexState::NotExist;
+    }
+    return searchIndexState == SearchIndexState::Exist;
+}
+
+void MessengerDBStorage::fillSearchIndex() {
+    QSqlQuery query(database());
+    query.setForwardOnly(true);
+    CHECK(query.prepare(selectDecryptedMessagesTextQuery), query.lastError().text().toStdString());
+    CHECK(query.exec(), query.lastError().text().toStdString());
+    QSqlQuery insertQuery(database());
+    CHECK(insertQuery.prepare(insertMsgSearchQuery), insertQuery.lastError().text().toStdString());
+    size_t count = 0;
+    while (query.next()) {
+        addToSearchIndex(insertQuery, query.value("id").toLongLong(), query.value("decryptedText").toString());
+        count++;
+    }
+    LOG << "Search index filled " << count;
+}
+
+void MessengerDBStorage::updateToNewVersion(int vcur, int vnew) {
+    if (vnew == 3 && !isFts5Available()) {
+        // Индекс создаст checkSearchIndex, когда sqlite будет с fts5
+        LOG << "Search index not available: sqlite without fts5";
+        return;
+    }
+    DBStorage::updateToNewVersion(vcur, vnew);
+    if (vnew == 3) {
+        searchIndexState = SearchIndexState::Exist;
+        fillSearchIndex();
+    }
+}
+
+void MessengerDBStorage::checkSearchIndex() {
+    if (hasSearchIndex() || !isFts5Available()) {
+        return;
     }
+    LOG << "Create search index";
+    auto transactionGuard = beginTransaction();
+    QSqlQuery query(database());
+    CHECK(query.prepare(createMsgSearchTable), query.lastError().text().toStdString());
+    CHECK(query.exec(), query.lastError().text().toStdString());
+    fillSearchIndex();
     transactionGuard.commit();
+    searchIndexState = SearchIndexState::Exist;
+}
+
+std::vector<Message> MessengerDBStorage::searchMessages(const QString &user, const QString &text, qint64 offset, qint64 count) {
+    std::vector<Message> result;
+    const QStringList words = text.split(QRegExp(QStringLiteral("\\s+")), QString::SkipEmptyParts);
+    if (words.isEmpty() || count <= 0) {
+        return result;
+    }
+    QSqlQuery query(database());
+    query.setForwardOnly(true);
+    if (hasSearchIndex()) {
+        CHECK(query.prepare(selectSearchMessagesQuery), query.lastError().text().toStdString());
+        query.bindValue(":query", makeSearchQuery(words));
+        query.bindValue(":user", user);
+        query.bindValue(":count", count);
+        query.bindValue(":offset", std::max(offset, qint64(0)));
+        CHECK(query.exec(), query.lastError().text().toStdString());
+        readSearchResult(query, result);
+        return result;
+    }
+
+    // Без fts5 - перебор расшифрованных сообщений порциями с теми же правилами: слово запроса - префикс слова сообщения,
+    // релевантность - число совпавших слов сообщения, при равной релевантности новые раньше.
+    // В памяти держатся только offset + count лучших совпадений
+    const QRegularExpression separators(QStringLiteral("[^\\p{L}\\p{N}]+"));
+    const QStringList queryWords = text.split(separators, QString::SkipEmptyParts);
+    if (queryWords.isEmpty()) {
+        return result;
+    }
+    struct Found {
+        size_t score;
+        size_t order; // порядковый номер в переборе от новых к старым
+        DbId id;
+    };
+    const auto isBetter = [](const Found &first, const Found &second) {
+        return first.score > second.score || (first.score == second.score && first.order < second.order);
+    };
+    const size_t limit = static_cast<size_t>(std::max(offset, qint64(0)) + count);
+    // Куча с худшим совпадением в начале
+    std::vector<Found> found;
+    CHECK(query.prepare(selectDecryptedTextsForUserPageQuery), query.lastError().text().toStdString());
+    qint64 lastMorder = std::numeric_limits<qint64>::max();
+    DbId lastId = std::numeric_limits<DbId>::max();
+    size_t order = 0;
+    while (true) {
+        query.bindValue(":user", user);
+        query.bindValue(":ob", lastMorder);
+        query.bindValue(":lastid", lastId);
+        query.bindValue(":num", SEARCH_FALLBACK_PAGE_SIZE);
+        CHECK(query.exec(), query.lastError().text().toStdString());
+        qint64 countRows = 0;
+        while (query.next()) {
+            countRows++;
+            lastId = query.value("id").toLongLong();
+            lastMorder = query.value("morder").toLongLong();
+            const QStringList messageWords = searchTextFromHex(query.value("decryptedText").toString()).split(separators, QString::SkipEmptyParts);
+            size_t score = 0;
+            const bool isFound = std::all_of(queryWords.begin(), queryWords.end(), [&messageWords, &score](const QString &word) {
+                const auto matched = std::count_if(messageWords.begin(), messageWords.end(), [&word](const QString &messageWord) {
+                    return messageWord.startsWith(word, Qt::CaseInsensitive);
+                });
+                score += matched;
+                return matched != 0;
+            });
+            if (isFound) {
+                const Found f{score, order, lastId};
+                if (found.size() < limit) {
+                    found.emplace_back(f);
+                    std::push_heap(found.begin(), found.end(), isBetter);
+                } else if (isBetter(f, found.front())) {
+                    std::pop_heap(found.begin(), found.end(), isBetter);
+                    found.back() = f;
+                    std::push_heap(found.begin(), found.end(), isBetter);
+                }
+            }
+            order++;
+        }
+        if (countRows < SEARCH_FALLBACK_PAGE_SIZE) {
+            break;
+        }
+    }
+    std::sort_heap(found.begin(), found.end(), isBetter);
+
+    QSqlQuery messageQuery(database());
+    CHECK(messageQuery.prepare(selectMessageForSearchQuery), messageQuery.lastError().text().toStdString());
+    for (size_t i = std::min(static_cast<size_t>(std::max(offset, qint64(0))), found.size()); i < found.size(); i++) {
+        messageQuery.bindValue(":id", found[i].id);
+        CHECK(messageQuery.exec(), messageQuery.lastError().text().toStdString());
+        readSearchResult(messageQuery, result);
+    }
+    return result;
 }
 
 void messenger::MessengerDBStorage::createDatabase() {
@@ -629,10 +1015,20 @@ void messenger::MessengerDBStorage::createDatabase() {
     createIndex(createMsgMessageUniqueIndex1);
     createIndex(createMsgMessageUniqueIndex2);
     createIndex(createMsgMessageCounterIndex);
+    createIndex(createMsgMessageHashIndex);
+    createIndex(createMsgMessageConfirmedCounterIndex);
     createIndex(createChannelsUniqueIndex);
 
     createIndex(createLastReadMessageUniqueIndex1);
     createIndex(createLastReadMessageUniqueIndex2);
+
+    if (isFts5Available()) {
+        createTable(QStringLiteral("messagessearch"), createMsgSearchTable);
+        searchIndexState = SearchIndexState::Exist;
+    } else {
+        LOG << "Search index not available: sqlite without fts5";
+        searchIndexState = SearchIndexState::NotExist;
+    }
 }
 
 void MessengerDBStorage::createMessagesList(QSqlQuery &query, std::vector<Message> &messages, std::vector<DbId> &ids, bool isIds, bool isChannel, bool reverse) {
@@ -669,6 +1065,39 @@ void MessengerDBStorage::createMessagesList(QSqlQuery &query, std::vector<Messag
     }
 }
 
+void MessengerDBStorage::addToSearchIndex(QSqlQuery &query, DbId id, const QString &decryptedText) {
+    query.bindValue(":id", id);
+    query.bindValue(":text", searchTextFromHex(decryptedText));
+    CHECK(query.exec(), query.lastError().text().toStdString());
+}
+
+void MessengerDBStorage::readSearchResult(QSqlQuery &query, std::vector<Message> &messages) {
+    while (query.next()) {
+        Message msg;
+        msg.username = query.value("user").toString();
+        const QVariant channel = query.value("channel");
+        msg.isChannel = !channel.isNull();
+        if (msg.isChannel) {
+            msg.channel = channel.toString();
+            msg.collocutor = QString("");
+        } else {
+            msg.collocutor = query.value("contact").toString();
+            msg.channel = QString("");
+        }
+        msg.isInput = query.value("isIncoming").toBool();
+        msg.dataHex = query.value("text").toString();
+        msg.decryptedDataHex = query.value("decryptedText").toString();
+        msg.isDecrypted = query.value("isDecrypted").toBool();
+        msg.counter = query.value("morder").toLongLong();
+        msg.timestamp = static_cast<quint64>(query.value("dt").toLongLong());
+        msg.fee = query.value("fee").toLongLong();
+        msg.isCanDecrypted = query.value("canDecrypted").toBool();
+        msg.isConfirmed = query.value("isConfirmed").toBool();
+        msg.hash = query.value("hash").toString();
+        messages.emplace_back(msg);
+    }
+}
+
 void MessengerDBStorage::addLastReadRecord(DBStorage::DbId userid, DBStorage::DbId contactid, DBStorage::DbId channelid) {
     QSqlQuery query(database());
     CHECK(query.prepare(insertLastReadMessageRecord), query.lastError().text().toStdString());
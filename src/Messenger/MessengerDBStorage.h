@@ -26,6 +26,11 @@ public:
 
     void addMessages(const std::vector<Message> &messages);
 
+    // Сохранение пачки сообщений от сервера одной транзакцией.
+    // Входящие добавляются, исходящие подтверждают свои неподтвержденные копии или добавляются, если копии нет.
+    // Возвращает старые счетчики подтвержденных сообщений, которых после сохранения нет в базе
+    std::vector<Message::Counter> ingestMessages(const QString &user, const QString &channelSha, const std::vector<Message> &messages);
+
     DbId getUserId(const QString &username);
     DbId getUserIdOrCreate(const QString &username);
     QStringList getUsersList();
@@ -44,11 +49,14 @@ public:
     void setContactPublicKey(const QString &username, const QString &publickey, const QString &txHash, const QString &blockchainName);
 
     Message::Counter getMessageMaxCounter(const QString &user, const QString &channelSha = QString());
-    Message::Counter getMessageMaxConfirmedCounter(const QString &user);
+    // Счетчики личных сообщений и каждого канала независимы, поэтому максимум берется по одному из них
+    Message::Counter getMessageMaxConfirmedCounter(const QString &user, const QString &channelSha = QString());
 
     std::vector<Message> getMessagesForUser(const QString &user, qint64 from, qint64 to);
     std::vector<Message> getMessagesForUserAndDest(const QString &user, const QString &channelOrContact, qint64 from, qint64 tos, bool isChannel = false);
     std::vector<Message> getMessagesForUserAndDestNum(const QString &user, const QString &channelOrContact, qint64 to, qint64 num, bool isChannel = false);
+    // Порция сообщений после (from, lastId) в порядке (morder, id). lastId обновляется на id последнего сообщения порции
+    std::vector<Message> getMessagesForUserAndDestPage(const QString &user, const QString &channelOrContact, qint64 from, DbId &lastId, qint64 to, qint64 limit, bool isChannel = false);
     qint64 getMessagesCountForUserAndDest(const QString &user, const QString &duser, qint64 from);
 
     bool hasMessageWithCounter(const QString &username, Message::Counter counter, const QString &channelSha = QString());
@@ -56,7 +64,7 @@ public:
 
     IdCounterPair findFirstNotConfirmedMessageWithHash(const QString &username, const QString &hash, const QString &channelSha = QString());
     IdCounterPair findFirstMessageWithHash(const QString &username, const QString &hash, const QString &channelSha = QString());
-    DbId findFirstNotConfirmedMessage(const QString &username);
+    DbId findFirstNotConfirmedMessage(const QString &username, const QString &channelSha = QString());
     void updateMessage(DbId id, Message::Counter newCounter, bool confirmed);
 
     Message::Counter getLastReadCounterForUserContact(const QString &username, const QString &channelOrContact, bool isChannel = false);
@@ -80,12 +88,36 @@ public:
 
     void updateDecryptedMessage(const std::vector<std::tuple<DbId, bool, QString>> &messages);
 
+    // Полнотекстовый индекс по расшифрованным сообщениям создается вместе с базой. Если sqlite собран без fts5, поиск работает перебором
+    // Сначала наиболее подходящие, при равной релевантности - более новые
+    std::vector<Message> searchMessages(const QString &user, const QString &text, qint64 offset, qint64 count);
+
+    // Вызывается после init. Создает и заполняет индекс, если база обновлялась, когда sqlite был без fts5, а теперь fts5 есть
+    void checkSearchIndex();
+
 protected:
     virtual void createDatabase() final;
 
+    void updateToNewVersion(int vcur, int vnew) override;
+
 private:
+    void insertMessage(QSqlQuery &query, QSqlQuery &searchQuery, DbId userid, DbId contactid, DbId channelid, const Message &message);
+    void prepareSearchInsert(QSqlQuery &searchQuery);
     void createMessagesList(QSqlQuery &query, std::vector<Message> &messages, std::vector<DbId> &ids, bool isIDs, bool isChannel, bool reverse);
     void addLastReadRecord(DbId userid, DbId contactid, DBStorage::DbId channelid);
+    void addToSearchIndex(QSqlQuery &query, DbId id, const QString &decryptedText);
+    void readSearchResult(QSqlQuery &query, std::vector<Message> &messages);
+    bool isFts5Available();
+    bool hasSearchIndex();
+    // Заполнение индекса сообщениями, расшифрованными до его появления
+    void fillSearchIndex();
+
+private:
+    enum class SearchIndexState {
+        Unknown, Exist, NotExist
+    };
+
+    SearchIndexState searchIndexState = SearchIndexState::Unknown;
 };
 
 }
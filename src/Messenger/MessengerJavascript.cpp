@@ -10,6 +10,7 @@
 
 #include "CryptographicManager.h"
 #include "Messenger.h"
+#include "MessageJson.h"
 
 #include <QJsonArray>
 #include <QJsonValue>
@@ -57,26 +58,8 @@ void MessengerJavascript::setMessenger(Messenger &m) {
     setPathsImpl();
 }
 
-static QJsonDocument messagesToJson(const std::vector<Message> &messages) {
-    QJsonArray messagesArrJson;
-    for (const Message &message: messages) {
-        QJsonObject messageJson;
-
-        messageJson.insert("collocutor", message.collocutor);
-        messageJson.insert("isInput", message.isInput);
-        messageJson.insert("timestamp", QString::fromStdString(std::to_string(message.timestamp)));
-        messageJson.insert("data", message.decryptedDataHex);
-        messageJson.insert("isDecrypter", message.isDecrypted);
-        messageJson.insert("counter", QString::fromStdString(std::to_string(message.counter)));
-        messageJson.insert("fee", QString::fromStdString(std::to_string(message.fee)));
-        messageJson.insert("isConfirmed", message.isConfirmed);
-        if (message.isChannel) {
-            messageJson.insert("channel", message.channel);
-        }
-
-        messagesArrJson.push_back(messageJson);
-    }
-    return QJsonDocument(messagesArrJson);
+static JsonString messagesToJson(const std::vector<Message> &messages) {
+    return toJsonString(messages);
 }
 
 static QJsonDocument contactInfoToJson(bool complete, const ContactInfo &info) {
@@ -88,20 +71,8 @@ static QJsonDocument contactInfoToJson(bool complete, const ContactInfo &info) {
     return QJsonDocument(result);
 }
 
-static QJsonDocument channelListToJson(const std::vector<ChannelInfo> &channels) {
-    QJsonArray messagesArrJson;
-    for (const ChannelInfo &channel: channels) {
-        QJsonObject messageJson;
-
-        messageJson.insert("title", channel.title);
-        messageJson.insert("titleSha", channel.titleSha);
-        messageJson.insert("admin", channel.admin);
-        messageJson.insert("isWriter", channel.isWriter);
-        messageJson.insert("saved_pos", QString::fromStdString(std::to_string(channel.counter)));
-        messageJson.insert("fee", QString::fromStdString(std::to_string(channel.fee)));
-        messagesArrJson.push_back(messageJson);
-    }
-    return QJsonDocument(messagesArrJson);
+static JsonString channelListToJson(const std::vector<ChannelInfo> &channels) {
+    return toJsonString(channels);
 }
 
 static QJsonDocument allPosToJson(const std::vector<std::pair<QString, Message::Counter>> &pos) {
@@ -123,7 +94,7 @@ BEGIN_SLOT_WRAPPER
 
     LOG << "get messages " << address << " " << from << " " << to;
 
-    const auto makeFunc = makeJavascriptReturnAndErrorFuncs(JS_NAME_RESULT, JsTypeReturn<QString>(address), JsTypeReturn<QJsonDocument>(QJsonDocument()));
+    const auto makeFunc = makeJavascriptReturnAndErrorFuncs(JS_NAME_RESULT, JsTypeReturn<QString>(address), JsTypeReturn<JsonString>(JsonString()));
 
     wrapOperation([&, this](){
         bool isValid;
@@ -150,7 +121,7 @@ BEGIN_SLOT_WRAPPER
 
     LOG << "get messages " << address << " " << collocutor << " " << from << " " << to;
 
-    const auto makeFunc = makeJavascriptReturnAndErrorFuncs(JS_NAME_RESULT, JsTypeReturn<QString>(address), JsTypeReturn<QString>(collocutor), JsTypeReturn<QJsonDocument>(QJsonDocument()));
+    const auto makeFunc = makeJavascriptReturnAndErrorFuncs(JS_NAME_RESULT, JsTypeReturn<QString>(address), JsTypeReturn<QString>(collocutor), JsTypeReturn<JsonString>(JsonString()));
 
     wrapOperation([&, this](){
         bool isValid;
@@ -175,7 +146,7 @@ BEGIN_SLOT_WRAPPER
 
     const QString JS_NAME_RESULT = "msgGetHistoryAddressAddressCountJs";
 
-    const auto makeFunc = makeJavascriptReturnAndErrorFuncs(JS_NAME_RESULT, JsTypeReturn<QString>(address), JsTypeReturn<QString>(collocutor), JsTypeReturn<QJsonDocument>(QJsonDocument()));
+    const auto makeFunc = makeJavascriptReturnAndErrorFuncs(JS_NAME_RESULT, JsTypeReturn<QString>(address), JsTypeReturn<QString>(collocutor), JsTypeReturn<JsonString>(JsonString()));
 
     LOG << "get messagesC " << address << " " << collocutor << " " << count << " " << to;
 
@@ -196,6 +167,106 @@ BEGIN_SLOT_WRAPPER
 END_SLOT_WRAPPER
 }
 
+void MessengerJavascript::searchMessages(QString address, QString text, QString offset, QString count) {
+BEGIN_SLOT_WRAPPER
+    CHECK(messenger != nullptr, "Messenger not set");
+
+    const QString JS_NAME_RESULT = "msgSearchMessagesJs";
+
+    const auto makeFunc = makeJavascriptReturnAndErrorFuncs(JS_NAME_RESULT, JsTypeReturn<QString>(address), JsTypeReturn<QString>(text), JsTypeReturn<JsonString>(JsonString()));
+
+    LOG << "search messages " << address << " " << offset << " " << count;
+
+    wrapOperation([&, this](){
+        bool isValid;
+        const qint64 offsetC = offset.toLongLong(&isValid);
+        CHECK(isValid, "offset field incorrect");
+        const qint64 countC = count.toLongLong(&isValid);
+        CHECK(isValid, "count field incorrect");
+
+        // В индексе только расшифрованные сообщения, поэтому повторная расшифровка не нужна
+        emit messenger->searchMessages(address, text, offsetC, countC, Messenger::GetMessagesCallback([address, text, makeFunc](const std::vector<Message> &messages) {
+            LOG << "search messages ok " << address << " " << messages.size();
+            makeFunc.func(TypedException(), address, text, messagesToJson(messages));
+        }, makeFunc.error, signalFunc));
+    }, makeFunc.error);
+END_SLOT_WRAPPER
+}
+
+void MessengerJavascript::getHistoryStream(const QString &jsNameChunk, const QString &jsNameResult, const QString &requestId, const QString &address, bool isChannel, const QString &collocutorOrChannel, const QString &from, const QString &to, int chunkSize) {
+    CHECK(messenger != nullptr, "Messenger not set");
+
+    LOG << "get messages stream " << requestId << " " << address << " " << collocutorOrChannel << " " << from << " " << to << " " << chunkSize;
+
+    const auto makeFunc = makeJavascriptReturnAndErrorFuncs(jsNameResult, JsTypeReturn<QString>(requestId), JsTypeReturn<QString>(address), JsTypeReturn<QString>(collocutorOrChannel), JsTypeReturn<size_t>(0), JsTypeReturn<bool>(false));
+
+    const std::shared_ptr<StreamToken> token = streamTokens.create(requestId);
+
+    // Порции расшифровываются асинхронно, поэтому финальный ответ отдается только после последней расшифрованной порции.
+    // Состояние меняется только в потоке MessengerJavascript
+    struct State {
+        size_t pending = 0;
+        bool isFinished = false;
+        bool isError = false;
+        size_t count = 0;
+        bool isCancelled = false;
+    };
+    const auto state = std::make_shared<State>();
+
+    const auto tryFinish = [this, state, requestId, address, collocutorOrChannel, token, makeFunc] {
+        if (state->isError || !state->isFinished || state->pending != 0) {
+            return;
+        }
+        LOG << "get messages stream ok " << requestId << " " << state->count << " " << state->isCancelled;
+        streamTokens.remove(requestId, token);
+        makeFunc.func(TypedException(), requestId, address, collocutorOrChannel, state->count, state->isCancelled);
+    };
+
+    const auto errorFunc = [this, state, requestId, token, makeFunc](const TypedException &exception) {
+        if (state->isError) {
+            return;
+        }
+        state->isError = true;
+        token->cancel();
+        streamTokens.remove(requestId, token);
+        makeFunc.error(exception);
+    };
+
+    const auto chunkCallback = [this, state, requestId, address, collocutorOrChannel, jsNameChunk, tryFinish, errorFunc](const std::vector<Message> &messages) {
+        signalFunc([this, state, requestId, address, collocutorOrChannel, jsNameChunk, tryFinish, errorFunc, messages] {
+            state->pending++;
+            emit cryptoManager.decryptMessages(messages, address, CryptographicManager::DecryptMessagesCallback([this, state, requestId, address, collocutorOrChannel, jsNameChunk, tryFinish](const std::vector<Message> &messages) {
+                state->pending--;
+                if (!state->isError) {
+                    makeAndRunJsFuncParams(jsNameChunk, TypedException(), requestId, address, collocutorOrChannel, messagesToJson(messages));
+                }
+                tryFinish();
+            }, errorFunc, signalFunc));
+        });
+    };
+
+    wrapOperation([&, this](){
+        bool isValid;
+        const Message::Counter fromC = from.toLongLong(&isValid);
+        CHECK(isValid, "from field incorrect");
+        const Message::Counter toC = to.toLongLong(&isValid);
+        CHECK(isValid, "to field incorrect");
+
+        emit messenger->getHistoryAddressAddressStream(address, isChannel, collocutorOrChannel, fromC, toC, chunkSize, token, chunkCallback, Messenger::GetMessagesStreamCallback([state, tryFinish](size_t count, bool isCancelled) {
+            state->isFinished = true;
+            state->count = count;
+            state->isCancelled = isCancelled;
+            tryFinish();
+        }, errorFunc, signalFunc));
+    }, errorFunc);
+}
+
+void MessengerJavascript::getHistoryAddressAddressStream(QString requestId, QString address, QString collocutor, QString from, QString to, int chunkSize) {
+BEGIN_SLOT_WRAPPER
+    getHistoryStream("msgGetHistoryAddressAddressStreamChunkJs", "msgGetHistoryAddressAddressStreamFinishJs", requestId, address, false, collocutor, from, to, chunkSize);
+END_SLOT_WRAPPER
+}
+
 void MessengerJavascript::sendPubkeyAddressToBlockchain(QString address, QString feeStr, QString paramsJson) {
 BEGIN_SLOT_WRAPPER
     CHECK(messenger != nullptr, "Messenger not set");
@@ -617,14 +688,14 @@ BEGIN_SLOT_WRAPPER
 
     const QString JS_NAME_RESULT = "msgGetChannelListJs";
 
-    const auto makeFunc = makeJavascriptReturnAndErrorFuncs(JS_NAME_RESULT, JsTypeReturn<QString>(address), JsTypeReturn<QJsonDocument>(QJsonDocument()));
+    const auto makeFunc = makeJavascriptReturnAndErrorFuncs(JS_NAME_RESULT, JsTypeReturn<QString>(address), JsTypeReturn<JsonString>(JsonString()));
 
     LOG << "getChannelList " << " " << address;
 
     wrapOperation([&, this](){
         emit messenger->getChannelList(address, Messenger::GetChannelListCallback([makeFunc, address](const std::vector<ChannelInfo> &channels) {
             LOG << "getChannelList ok " << address << " " << channels.size();
-            const QJsonDocument channelsJson = channelListToJson(channels);
+            const JsonString channelsJson = channelListToJson(channels);
             makeFunc.func(TypedException(), address, channelsJson);
         }, makeFunc.error, signalFunc));
     }, makeFunc.error);
@@ -697,7 +768,7 @@ BEGIN_SLOT_WRAPPER
 
     const QString JS_NAME_RESULT = "msgGetHistoryAddressChannelJs";
 
-    const auto makeFunc = makeJavascriptReturnAndErrorFuncs(JS_NAME_RESULT, JsTypeReturn<QString>(address), JsTypeReturn<QString>(titleSha), JsTypeReturn<QJsonDocument>(QJsonDocument()));
+    const auto makeFunc = makeJavascriptReturnAndErrorFuncs(JS_NAME_RESULT, JsTypeReturn<QString>(address), JsTypeReturn<QString>(titleSha), JsTypeReturn<JsonString>(JsonString()));
 
     LOG << "get messages channel " << address << " " << titleSha << " " << from << " " << to;
 
@@ -723,7 +794,7 @@ BEGIN_SLOT_WRAPPER
 
     const QString JS_NAME_RESULT = "msgGetHistoryAddressChannelCountJs";
 
-    const auto makeFunc = makeJavascriptReturnAndErrorFuncs(JS_NAME_RESULT, JsTypeReturn<QString>(address), JsTypeReturn<QString>(titleSha), JsTypeReturn<QJsonDocument>(QJsonDocument()));
+    const auto makeFunc = makeJavascriptReturnAndErrorFuncs(JS_NAME_RESULT, JsTypeReturn<QString>(address), JsTypeReturn<QString>(titleSha), JsTypeReturn<JsonString>(JsonString()));
 
     LOG << "get messagesCC " << address << " " << titleSha << " " << count << " " << to;
 
@@ -804,6 +875,18 @@ void MessengerJavascript::setPathsImpl() {
     }, signalFunc));
 }
 
+void MessengerJavascript::getHistoryAddressChannelStream(QString requestId, QString address, QString titleSha, QString from, QString to, int chunkSize) {
+BEGIN_SLOT_WRAPPER
+    getHistoryStream("msgGetHistoryAddressChannelStreamChunkJs", "msgGetHistoryAddressChannelStreamFinishJs", requestId, address, true, titleSha, from, to, chunkSize);
+END_SLOT_WRAPPER
+}
+
+void MessengerJavascript::cancelStream(QString requestId) {
+BEGIN_SLOT_WRAPPER
+    LOG << "cancel messages stream " << requestId << " " << streamTokens.cancel(requestId);
+END_SLOT_WRAPPER
+}
+
 void MessengerJavascript::setMhcType(bool isMhc_) {
 BEGIN_SLOT_WRAPPER
     LOG << "Set mhc type: " << (isMhc ? "Mhc" : "Tmh");
@@ -8,6 +8,7 @@
 #include "Message.h"
 
 #include "qt_utilites/WrapperJavascript.h"
+#include "qt_utilites/StreamToken.h"
 
 namespace auth {
 class Auth;
@@ -76,6 +77,10 @@ public slots:
 
     Q_INVOKABLE void getHistoryAddressAddressCount(QString address, QString collocutor, QString count, QString to);
 
+    Q_INVOKABLE void getHistoryAddressAddressStream(QString requestId, QString address, QString collocutor, QString from, QString to, int chunkSize);
+
+    Q_INVOKABLE void searchMessages(QString address, QString text, QString offset, QString count);
+
     Q_INVOKABLE void sendPubkeyAddressToBlockchain(QString address, QString feeStr, QString paramsJson);
 
     Q_INVOKABLE void registerAddress(bool isForcibly, QString address, QString feeStr);
@@ -121,6 +126,10 @@ public slots:
 
     Q_INVOKABLE void getHistoryAddressChannelCount(QString address, QString titleSha, QString count, QString to);
 
+    Q_INVOKABLE void getHistoryAddressChannelStream(QString requestId, QString address, QString titleSha, QString from, QString to, int chunkSize);
+
+    Q_INVOKABLE void cancelStream(QString requestId);
+
 
     Q_INVOKABLE void setMhcType(bool isMhc);
 
@@ -137,6 +146,8 @@ private:
 
     void setPathsImpl();
 
+    void getHistoryStream(const QString &jsNameChunk, const QString &jsNameResult, const QString &requestId, const QString &address, bool isChannel, const QString &collocutorOrChannel, const QString &from, const QString &to, int chunkSize);
+
     void doRegisterAddress(const QString &address, bool isNew, bool isForcibly, const std::function<void(const TypedException &exception, const QString &result)> &makeFunc, const std::function<void(const TypedException &exception)> &errorFunc);
 
 private:
@@ -157,6 +168,8 @@ private:
 
     bool isMhc;
 
+    StreamTokens streamTokens;
+
 };
 
 }
@@ -0,0 +1,131 @@
+#include "ContentDecoder.h"
+
+#include <algorithm>
+#include <cctype>
+
+#include <zlib.h>
+
+const char * const ContentDecoder::ACCEPT_ENCODING = "gzip, deflate";
+
+static const size_t CHUNK_SIZE = 16 * 1024;
+
+static const int MAX_WINDOW_BITS = 15;
+
+static const int GZIP_WINDOW_BITS = MAX_WINDOW_BITS + 16;
+
+static std::string trim(const std::string &str) {
+    const auto begin = std::find_if_not(str.begin(), str.end(), [](unsigned char c) { return std::isspace(c); });
+    const auto end = std::find_if_not(str.rbegin(), str.rend(), [](unsigned char c) { return std::isspace(c); }).base();
+    if (begin >= end) {
+        return "";
+    }
+    return std::string(begin, end);
+}
+
+ContentDecoder::Encoding ContentDecoder::parseEncoding(const std::string &headerValue) {
+    std::string value = trim(headerValue);
+    std::transform(value.begin(), value.end(), value.begin(), [](unsigned char c) { return std::tolower(c); });
+    if (value.empty() || value == "identity") {
+        return Encoding::Identity;
+    } else if (value == "gzip" || value == "x-gzip") {
+        return Encoding::Gzip;
+    } else if (value == "deflate") {
+        return Encoding::Deflate;
+    } else {
+        return Encoding::Unknown;
+    }
+}
+
+ContentDecoder::ContentDecoder(Encoding encoding)
+    : encoding_(encoding)
+    , stream(new z_stream_s())
+{
+    if (encoding_ == Encoding::Unknown) {
+        setError("Unsupported content encoding");
+    }
+}
+
+ContentDecoder::~ContentDecoder() {
+    if (isInited) {
+        inflateEnd(stream.get());
+    }
+}
+
+double ContentDecoder::ratio() const {
+    if (encodedSize_ == 0) {
+        return 1.0;
+    }
+    return double(decodedSize_) / double(encodedSize_);
+}
+
+void ContentDecoder::setError(const std::string &err) {
+    isError_ = true;
+    error = err;
+}
+
+void ContentDecoder::initStream(int windowBits) {
+    stream->zalloc = Z_NULL;
+    stream->zfree = Z_NULL;
+    stream->opaque = Z_NULL;
+    stream->next_in = Z_NULL;
+    stream->avail_in = 0;
+    const int res = inflateInit2(stream.get(), windowBits);
+    if (res != Z_OK) {
+        setError("inflateInit error " + std::to_string(res));
+        return;
+    }
+    isInited = true;
+}
+
+void ContentDecoder::inflateChunk(const char *data, size_t size) {
+    stream->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    stream->avail_in = static_cast<uInt>(size);
+    while (stream->avail_in != 0 && !isFinished) {
+        const size_t oldSize = result.size();
+        result.resize(oldSize + CHUNK_SIZE);
+        stream->next_out = reinterpret_cast<Bytef*>(&result[oldSize]);
+        stream->avail_out = static_cast<uInt>(CHUNK_SIZE);
+        const int res = inflate(stream.get(), Z_NO_FLUSH);
+        result.resize(oldSize + CHUNK_SIZE - stream->avail_out);
+        if (res == Z_STREAM_END) {
+            isFinished = true;
+        } else if (res != Z_OK && res != Z_BUF_ERROR) {
+            setError("inflate error " + std::to_string(res) + (stream->msg != nullptr ? std::string(" ") + stream->msg : std::string()));
+            return;
+        }
+    }
+}
+
+void ContentDecoder::append(const char *data, size_t size) {
+    if (isError_ || size == 0) {
+        return;
+    }
+    encodedSize_ += size;
+    if (encoding_ == Encoding::Identity) {
+        result.append(data, size);
+        decodedSize_ = result.size();
+        return;
+    }
+    if (!isInited) {
+        int windowBits = GZIP_WINDOW_BITS;
+        if (encoding_ == Encoding::Deflate) {
+            // Часть серверов отдает deflate без zlib заголовка
+            const unsigned char cmf = static_cast<unsigned char>(data[0]);
+            const bool isZlibHeader = (cmf & 0x0F) == Z_DEFLATED && (cmf >> 4) + 8 <= MAX_WINDOW_BITS && (size < 2 || ((cmf << 8) + static_cast<unsigned char>(data[1])) % 31 == 0);
+            windowBits = isZlibHeader ? MAX_WINDOW_BITS : -MAX_WINDOW_BITS;
+        }
+        initStream(windowBits);
+        if (isError_) {
+            return;
+        }
+    }
+    inflateChunk(data, size);
+    decodedSize_ = result.size();
+}
+
+std::string ContentDecoder::finish() {
+    if (encoding_ != Encoding::Identity && isInited && !isFinished && !isError_) {
+        setError("Compressed stream truncated");
+    }
+    return std::move(result);
+}
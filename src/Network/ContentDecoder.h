@@ -0,0 +1,93 @@
+#ifndef CONTENTDECODER_H
+#define CONTENTDECODER_H
+
+#include <string>
+#include <memory>
+
+struct z_stream_s;
+
+/*
+   Потоковая распаковка тела http ответа (Content-Encoding: gzip, deflate).
+   Данные подаются кусками по мере прихода, распакованный результат накапливается.
+   */
+class ContentDecoder {
+public:
+
+    enum class Encoding {
+        Identity, Gzip, Deflate, Unknown
+    };
+
+    static const char * const ACCEPT_ENCODING;
+
+public:
+
+    static Encoding parseEncoding(const std::string &headerValue);
+
+    explicit ContentDecoder(Encoding encoding);
+
+    ~ContentDecoder();
+
+    ContentDecoder(const ContentDecoder &) = delete;
+    ContentDecoder& operator=(const ContentDecoder &) = delete;
+
+    void append(const char *data, size_t size);
+
+    void append(const std::string &data) {
+        append(data.data(), data.size());
+    }
+
+    std::string finish();
+
+    Encoding encoding() const {
+        return encoding_;
+    }
+
+    bool isError() const {
+        return isError_;
+    }
+
+    const std::string& errorString() const {
+        return error;
+    }
+
+    size_t encodedSize() const {
+        return encodedSize_;
+    }
+
+    size_t decodedSize() const {
+        return decodedSize_;
+    }
+
+    double ratio() const;
+
+private:
+
+    void initStream(int windowBits);
+
+    void inflateChunk(const char *data, size_t size);
+
+    void setError(const std::string &err);
+
+private:
+
+    Encoding encoding_;
+
+    std::unique_ptr<z_stream_s> stream;
+
+    bool isInited = false;
+
+    bool isFinished = false;
+
+    bool isError_ = false;
+
+    std::string error;
+
+    std::string result;
+
+    size_t encodedSize_ = 0;
+
+    size_t decodedSize_ = 0;
+
+};
+
+#endif // CONTENTDECODER_H
@@ -5,6 +5,7 @@ using namespace std::placeholders;
 
 #include "check.h"
 #include "Log.h"
+#include "ContentDecoder.h"
 #include "qt_utilites/SlotWrapper.h"
 #include "qt_utilites/QRegister.h"
 
@@ -214,6 +215,11 @@ QByteArray AbstractSocket::getReply() const
     return m_reply;
 }
 
+size_t AbstractSocket::wireSize() const
+{
+    return m_wireSize;
+}
+
 void HttpSocket::onConnected()
 {
 BEGIN_SLOT_WRAPPER
@@ -244,10 +250,7 @@ BEGIN_SLOT_WRAPPER
     }
     if (m_headerParsed) {
         if (m_contentLength != -1) {
-            if (m_data.length() >= m_contentLength) {
-                m_reply = m_data.left(m_contentLength);
-                emit finished();
-            }
+            processBody();
         } else {
             m_error = true;
             abort();
@@ -268,6 +271,8 @@ HttpSocket::HttpSocket(const QUrl &url, const QString &message, QObject *parent)
     Q_CONNECT(this, &QIODevice::readyRead, this, &HttpSocket::onReadyRead);
 }
 
+HttpSocket::~HttpSocket() = default;
+
 void HttpSocket::start()
 {
     connectToHost(m_url.host(), m_url.port(80));
@@ -281,7 +286,7 @@ QByteArray HttpSocket::getHttpPostHeader() const
     data += QStringLiteral("Host: ") + m_url.host() + QStringLiteral(":") + QString::number(m_url.port(80)) + QStringLiteral("\r\n");
     data += QStringLiteral("Content-Type: application/x-www-form-urlencoded\r\n");
     data += QStringLiteral("Accept: */*\r\n");
-    data += QStringLiteral("Accept-Encoding: identity\r\n");
+    data += QStringLiteral("Accept-Encoding: %1\r\n").arg(ContentDecoder::ACCEPT_ENCODING);
     data += QStringLiteral("Content-Length: %1\r\n").arg(m_message.toLatin1().length());
     data += QStringLiteral("\r\n");
 
@@ -315,10 +320,42 @@ void HttpSocket::parseResponseHeader()
             if (s.endsWith('\r'))
                 s = s.left(s.length() - 1);
             m_contentLength = s.toInt();
+        } else if (s.toLower().startsWith("content-encoding:")) {
+            s = s.mid(17).trimmed();
+            m_contentEncoding = s.toStdString();
         }
     }
 }
 
+void HttpSocket::processBody()
+{
+    if (m_decoder == nullptr) {
+        m_decoder = std::make_unique<ContentDecoder>(ContentDecoder::parseEncoding(m_contentEncoding));
+    }
+    const int toRead = std::min(m_data.length(), m_contentLength - m_bodyReceived);
+    m_decoder->append(m_data.constData(), toRead);
+    m_bodyReceived += toRead;
+    m_data.clear();
+    if (m_bodyReceived < m_contentLength) {
+        return;
+    }
+
+    const std::string content = m_decoder->finish();
+    m_wireSize = m_decoder->encodedSize();
+    if (m_decoder->isError()) {
+        LOG << "Decompress error " << m_decoder->errorString() << " " << m_url.toString();
+        m_error = true;
+        abort();
+        emit finished();
+        return;
+    }
+    if (m_decoder->encoding() != ContentDecoder::Encoding::Identity) {
+        LOG << PeriodicLog::make("hs_gz") << "Response compressed " << m_wireSize << " -> " << content.size() << " ratio " << m_decoder->ratio();
+    }
+    m_reply = QByteArray(content.data(), static_cast<int>(content.size()));
+    emit finished();
+}
+
 PingSocket::PingSocket(const QUrl &url, QObject *parent)
     : AbstractSocket(parent)
     , m_url(url)
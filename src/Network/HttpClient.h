@@ -14,6 +14,7 @@
 #include "duration.h"
 
 struct TypedException;
+class ContentDecoder;
 
 class AbstractSocket: public QTcpSocket {
     Q_OBJECT
@@ -46,6 +47,8 @@ public:
 
     QByteArray getReply() const;
 
+    size_t wireSize() const;
+
     int errorC() const {
         return errorCode;
     }
@@ -60,6 +63,8 @@ protected:
 
     QByteArray m_reply;
 
+    size_t m_wireSize = 0;
+
     bool m_error = false;
     int errorCode = 0;
 };
@@ -70,6 +75,8 @@ class HttpSocket : public AbstractSocket
 public:
     explicit HttpSocket(const QUrl &url, const QString &message, QObject *parent = nullptr);
 
+    ~HttpSocket() override;
+
     void start();
 
 private slots:
@@ -80,12 +87,16 @@ private slots:
 private:
     QByteArray getHttpPostHeader() const;
     void parseResponseHeader();
+    void processBody();
 
     QUrl m_url;
     QString m_message;
     QByteArray m_data;
     bool m_headerParsed = false;
     int m_contentLength = -1;
+    int m_bodyReceived = 0;
+    std::string m_contentEncoding;
+    std::unique_ptr<ContentDecoder> m_decoder;
     bool m_firstHeaderStringParsed = false;
 };
 
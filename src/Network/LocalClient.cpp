@@ -1,8 +1,10 @@
 #include "LocalClient.h"
 
 #include <QLocalSocket>
-
-using namespace std::placeholders;
+#include <QTimer>
+#include <QtEndian>
+#include <QJsonDocument>
+#include <QJsonObject>
 
 #include "check.h"
 #include "Log.h"
@@ -10,100 +12,258 @@ using namespace std::placeholders;
 #include "qt_utilites/SlotWrapper.h"
 #include "qt_utilites/QRegister.h"
 
+#include <algorithm>
+
+SET_LOG_NAMESPACE("LCL");
+
+static const size_t COUNT_ATTEMPTS = 2;
+
+static const int RECONNECT_TIMEOUT_MS = 100;
+
+static const quint32 NULL_BYTE_ARRAY_SIZE = 0xFFFFFFFF;
+
+static const milliseconds TIMER_INTERVAL = 1s;
+
 LocalClient::LocalClient(const QString &localServerName, QObject *parent)
     : QObject(parent)
     , localServerName(localServerName)
+    , socket(new QLocalSocket(this))
+    , timer(new QTimer(this))
 {
     Q_REG(LocalClient::ReturnCallback, "LocalClient::ReturnCallback");
-}
 
-void LocalClient::sendRequest(const QByteArray &request, const LocalClient::ClientCallback &callback) {
-    const size_t currId = id.get();
-    callbacks[currId] = callback;
+    timer->setInterval(TIMER_INTERVAL.count());
+    Q_CONNECT(timer, &QTimer::timeout, this, &LocalClient::onTimerEvent);
 
-    QLocalSocket *socket = new QLocalSocket(this);
+    Q_CONNECT(socket, &QLocalSocket::connected, this, &LocalClient::onConnected);
+    Q_CONNECT(socket, &QLocalSocket::readyRead, this, &LocalClient::onReadyRead);
+    Q_CONNECT(socket, QOverload<QLocalSocket::LocalSocketError>::of(&QLocalSocket::error), this, &LocalClient::onErrorMessageReceived);
+}
+
+void LocalClient::sendRequest(const QByteArray &request, const LocalClient::ClientCallback &callback, milliseconds timeout, bool isIdempotent) {
+    const QJsonDocument requestJson = QJsonDocument::fromJson(request);
+    CHECK(requestJson.isObject(), "Incorrect request json");
+    QJsonObject requestObj = requestJson.object();
+    const size_t requestId = id.get();
+    requestObj.insert(QStringLiteral("id"), static_cast<qint64>(requestId));
+    const QByteArray message = QJsonDocument(requestObj).toJson(QJsonDocument::Compact);
 
-    Q_CONNECT(socket, &QLocalSocket::readyRead, this, std::bind(&LocalClient::onTextMessageReceived, this, currId));
-    Q_CONNECT(socket, QOverload<QLocalSocket::LocalSocketError>::of(&QLocalSocket::error), this, std::bind(&LocalClient::onErrorMessageReceived, this, currId, _1));
+    PendingRequest pending;
+    pending.callback = callback;
+    pending.attemptsLeft = COUNT_ATTEMPTS;
+    pending.isIdempotent = isIdempotent;
+    pending.beginTime = ::now();
+    pending.timeout = timeout;
 
-    QDataStream &outStream = buffers[currId].dataStream;
+    QDataStream outStream(&pending.frame, QIODevice::WriteOnly);
     outStream.setVersion(QDataStream::Qt_5_10);
-    outStream.setDevice(socket);
+    outStream << static_cast<quint32>(message.size());
+    outStream << message;
 
-    socket->connectToServer(localServerName);
-    if (socket->isValid()) {
-        QByteArray block;
-        QDataStream outStream(&block, QIODevice::WriteOnly);
-        outStream.setVersion(QDataStream::Qt_5_10);
-        outStream << static_cast<quint32>(request.size());
-        outStream << request;
-        socket->write(block);
-        socket->flush();
+    requests.emplace(requestId, std::move(pending));
+
+    if (!timer->isActive()) {
+        timer->start();
     }
-}
 
-template<typename... Message>
-void LocalClient::runCallback(size_t id, Message&&... messages) {
-    const auto foundCallback = callbacks.find(id);
-    CHECK(foundCallback != callbacks.end(), "not found callback on id " + std::to_string(id));
-    const auto callback = std::bind(foundCallback->second, std::forward<Message>(messages)...);
-    emit callbackCall(callback);
-    callbacks.erase(foundCallback);
-    buffers.erase(id);
+    if (socket->state() == QLocalSocket::ConnectedState) {
+        writePending();
+    } else if (socket->state() == QLocalSocket::UnconnectedState) {
+        connectToServer();
+    }
 }
 
-void LocalClient::onTextMessageReceived(size_t id) {
-BEGIN_SLOT_WRAPPER
-    QLocalSocket *socket = qobject_cast<QLocalSocket *>(sender());
+void LocalClient::connectToServer() {
+    currentSize = 0;
+    isSizeRead = false;
+    socket->connectToServer(localServerName);
+}
 
-    CHECK(buffers.find(id) != buffers.end(), "Incorrect response");
-    Buffer &currentBuffer = buffers[id];
+void LocalClient::writePending() {
+    bool isWritten = false;
+    for (auto &pair: requests) {
+        PendingRequest &request = pair.second;
+        if (!request.isSent) {
+            socket->write(request.frame);
+            request.isSent = true;
+            request.attemptsLeft--;
+            isWritten = true;
+        }
+    }
+    if (isWritten) {
+        socket->flush();
+    }
+}
 
-    if (currentBuffer.size == 0) {
+bool LocalClient::readResponse(QByteArray &response) {
+    // Кадр: quint32 размер, затем QByteArray в формате QDataStream (quint32 длина + данные)
+    if (!isSizeRead) {
         if (socket->bytesAvailable() < (qint64)sizeof(quint32)) {
-            return;
+            return false;
         }
+        quint32 size;
+        CHECK(socket->read(reinterpret_cast<char*>(&size), sizeof(size)) == sizeof(size), "Incorrect read size");
+        currentSize = qFromBigEndian(size);
+        isSizeRead = true;
+    }
 
-        currentBuffer.dataStream >> currentBuffer.size;
+    if (socket->bytesAvailable() < (qint64)sizeof(quint32)) {
+        return false;
+    }
+    quint32 dataSize;
+    CHECK(socket->peek(reinterpret_cast<char*>(&dataSize), sizeof(dataSize)) == sizeof(dataSize), "Incorrect read size");
+    dataSize = qFromBigEndian(dataSize);
+    if (dataSize == NULL_BYTE_ARRAY_SIZE) {
+        dataSize = 0;
+    }
+    if (socket->bytesAvailable() < (qint64)(sizeof(quint32) + dataSize)) {
+        return false;
     }
 
-    if (socket->bytesAvailable() < currentBuffer.size || currentBuffer.dataStream.atEnd()) {
-        return;
+    socket->skip(sizeof(quint32));
+    response = socket->read(dataSize);
+    CHECK(response.size() == (int)dataSize, "Incorrect response size");
+    if (currentSize != dataSize) {
+        LOG << "Warn. Response size mismatch " << currentSize << " " << dataSize;
     }
+    isSizeRead = false;
+    currentSize = 0;
+    return true;
+}
 
-    Response resp;
-    resp.response.resize(currentBuffer.size);
-    currentBuffer.dataStream >> resp.response;
+std::map<size_t, LocalClient::PendingRequest>::iterator LocalClient::findRequest(const QByteArray &response) {
+    const QJsonDocument responseJson = QJsonDocument::fromJson(response);
+    if (responseJson.isObject() && responseJson.object().contains(QLatin1String("id"))) {
+        const QJsonValue idJson = responseJson.object().value(QLatin1String("id"));
+        if (!idJson.isDouble()) {
+            return requests.end();
+        }
+        const auto found = requests.find(static_cast<size_t>(idJson.toVariant().toLongLong()));
+        if (found == requests.end() || !found->second.isSent) {
+            return requests.end();
+        }
+        return found;
+    }
+    // Сервис не вернул id: сервер отвечает по порядку, поэтому это самый старый отправленный запрос
+    return std::find_if(requests.begin(), requests.end(), [](const auto &pair) {
+        return pair.second.isSent;
+    });
+}
+
+void LocalClient::runCallback(const ClientCallback &callback, const Response &response) {
+    emit callbackCall(std::bind(callback, response));
+}
 
-    runCallback(id, resp);
+void LocalClient::failAll(const ServerException &exception) {
+    std::map<size_t, PendingRequest> failed;
+    failed.swap(requests);
+    timer->stop();
+    Response resp;
+    resp.exception = exception;
+    for (const auto &pair: failed) {
+        runCallback(pair.second.callback, resp);
+    }
+}
 
-    socket->deleteLater();
+void LocalClient::onConnected() {
+BEGIN_SLOT_WRAPPER
+    writePending();
 END_SLOT_WRAPPER
 }
 
-void LocalClient::onErrorMessageReceived(size_t id, QLocalSocket::LocalSocketError socketError) {
+void LocalClient::onReadyRead() {
 BEGIN_SLOT_WRAPPER
-    QLocalSocket *socket = qobject_cast<QLocalSocket *>(sender());
+    Response resp;
+    while (readResponse(resp.response)) {
+        const auto found = findRequest(resp.response);
+        if (found == requests.end()) {
+            LOG << "Warn. Response without request";
+            continue;
+        }
+        const ClientCallback callback = found->second.callback;
+        requests.erase(found);
+        runCallback(callback, resp);
+    }
+    if (requests.empty()) {
+        timer->stop();
+    }
+END_SLOT_WRAPPER
+}
 
+void LocalClient::onTimerEvent() {
+BEGIN_SLOT_WRAPPER
+    const time_point now = ::now();
     Response resp;
+    resp.exception = ServerException(5, "Timeout");
+    for (auto iter = requests.begin(); iter != requests.end();) {
+        const PendingRequest &request = iter->second;
+        if (now - request.beginTime >= request.timeout) {
+            LOG << PeriodicLog::make("lc_tm") << "Timeout request " << iter->first;
+            runCallback(request.callback, resp);
+            iter = requests.erase(iter);
+        } else {
+            iter++;
+        }
+    }
+    if (requests.empty()) {
+        timer->stop();
+    }
+END_SLOT_WRAPPER
+}
 
+void LocalClient::onErrorMessageReceived(QLocalSocket::LocalSocketError socketError) {
+BEGIN_SLOT_WRAPPER
+    ServerException exception;
     switch (socketError) {
     case QLocalSocket::ServerNotFoundError: {
-        resp.exception = ServerException(1, "Server not found");
+        exception = ServerException(1, "Server not found");
         break;
     } case QLocalSocket::ConnectionRefusedError: {
-        resp.exception = ServerException(2, "Connection refused");
+        exception = ServerException(2, "Connection refused");
         break;
     } case QLocalSocket::PeerClosedError: {
-        resp.exception = ServerException(3, "Peer closed");
+        exception = ServerException(3, "Peer closed");
         break;
     } default: {
-        resp.exception = ServerException(4, socket->errorString().toStdString());
+        exception = ServerException(4, socket->errorString().toStdString());
     }
     }
 
-    runCallback(id, resp);
+    socket->abort();
+    currentSize = 0;
+    isSizeRead = false;
 
-    socket->deleteLater();
+    if (socketError != QLocalSocket::PeerClosedError) {
+        failAll(exception);
+        return;
+    }
+
+    // Сервер закрыл соединение: повторно отправляем только идемпотентные запросы, остальные могли быть уже выполнены
+    for (auto iter = requests.begin(); iter != requests.end();) {
+        PendingRequest &request = iter->second;
+        if (request.isSent && (!request.isIdempotent || request.attemptsLeft == 0)) {
+            Response resp;
+            resp.exception = exception;
+            runCallback(request.callback, resp);
+            iter = requests.erase(iter);
+        } else {
+            request.isSent = false;
+            iter++;
+        }
+    }
+    if (requests.empty()) {
+        timer->stop();
+    }
+
+    if (!requests.empty()) {
+        LOG << "Reconnect to " << localServerName << ". Pending requests " << requests.size();
+        QTimer::singleShot(RECONNECT_TIMEOUT_MS, this, [this]{
+            BEGIN_SLOT_WRAPPER
+            if (!requests.empty() && socket->state() == QLocalSocket::UnconnectedState) {
+                connectToServer();
+            }
+            END_SLOT_WRAPPER
+        });
+    }
 END_SLOT_WRAPPER
 }
@@ -6,10 +6,20 @@
 #include <QDataStream>
 
 #include <functional>
-#include <unordered_map>
+#include <map>
 
 #include "utilites/RequestId.h"
+#include "duration.h"
 
+class QTimer;
+
+/*
+   Одно постоянное соединение с локальным сервисом. Запросы отправляются друг за другом без ожидания ответов.
+   В каждый запрос (json объект) добавляется поле id, ответ сопоставляется с запросом по этому полю.
+   Ответ без id считается ответом на самый старый отправленный запрос.
+   При разрыве соединение переустанавливается, и повторно отправляются только идемпотентные запросы.
+   Остальные запросы без ответа, как и запросы с истекшим timeout, завершаются ошибкой.
+   */
 class LocalClient: public QObject {
     Q_OBJECT
 public:
@@ -53,7 +63,7 @@ public:
 
 public:
 
-    void sendRequest(const QByteArray &request, const LocalClient::ClientCallback &callback);
+    void sendRequest(const QByteArray &request, const LocalClient::ClientCallback &callback, milliseconds timeout, bool isIdempotent);
 
 signals:
 
@@ -61,29 +71,54 @@ signals:
 
 private slots:
 
-    void onTextMessageReceived(size_t id);
+    void onConnected();
 
-    void onErrorMessageReceived(size_t id, QLocalSocket::LocalSocketError socketError);
+    void onReadyRead();
 
-private:
+    void onErrorMessageReceived(QLocalSocket::LocalSocketError socketError);
 
-    template<typename... Message>
-    void runCallback(size_t id, Message&&... messages);
+    void onTimerEvent();
 
 private:
 
-    struct Buffer {
-        QDataStream dataStream;
-        quint32 size = 0;
+    struct PendingRequest {
+        QByteArray frame;
+        ClientCallback callback;
+        size_t attemptsLeft;
+        bool isIdempotent;
+        bool isSent = false;
+        time_point beginTime;
+        milliseconds timeout;
     };
 
+private:
+
+    void connectToServer();
+
+    void writePending();
+
+    bool readResponse(QByteArray &response);
+
+    std::map<size_t, PendingRequest>::iterator findRequest(const QByteArray &response);
+
+    void runCallback(const ClientCallback &callback, const Response &response);
+
+    void failAll(const ServerException &exception);
+
 private:
 
     QString localServerName;
 
-    std::unordered_map<size_t, ClientCallback> callbacks;
+    QLocalSocket *socket;
+
+    QTimer *timer;
+
+    // Ключ - id запроса, поэтому запросы упорядочены по времени добавления
+    std::map<size_t, PendingRequest> requests;
+
+    quint32 currentSize = 0;
 
-    std::unordered_map<size_t, Buffer> buffers;
+    bool isSizeRead = false;
 
     RequestId id;
 };
@@ -7,6 +7,8 @@ using namespace std::placeholders;
 #include "check.h"
 #include "Log.h"
 
+#include "ContentDecoder.h"
+
 #include "qt_utilites/SlotWrapper.h"
 #include "qt_utilites/QRegister.h"
 
@@ -176,6 +178,8 @@ void SimpleClient::sendMessageInternal(
 
     QNetworkRequest request(url);
     request.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
+    // Явно заданный заголовок отключает автоматическую распаковку в qt, распаковываем сами, чтобы знать размер на проводе
+    request.setRawHeader("Accept-Encoding", ContentDecoder::ACCEPT_ENCODING);
     const time_point time = ::now();
     Request r;
     r.beginTime = time;
@@ -197,6 +201,7 @@ void SimpleClient::sendMessageInternal(
     if (isQueuedConnection) {
         connType = Qt::QueuedConnection;
     }
+    Q_CONNECT2(reply, &QNetworkReply::readyRead, this, std::bind(&SimpleClient::onReadyRead, this, requestId), connType);
     Q_CONNECT2(reply, &QNetworkReply::finished, this, std::bind(&SimpleClient::onTextMessageReceived, this, requestId), connType);
     requests[requestId] = r;
 }
@@ -248,32 +253,71 @@ void SimpleClient::runCallback(size_t id, Message&&... messages) {
     requests.erase(foundCallback);
 }
 
+void SimpleClient::readToDecoder(QNetworkReply *reply, Request &request) {
+    if (!reply->isReadable()) {
+        return;
+    }
+    if (request.decoder == nullptr) {
+        const QByteArray encoding = reply->rawHeader("Content-Encoding");
+        request.decoder = std::make_shared<ContentDecoder>(ContentDecoder::parseEncoding(encoding.toStdString()));
+    }
+    const QByteArray chunk = reply->readAll();
+    request.decoder->append(chunk.data(), chunk.size());
+}
+
+void SimpleClient::onReadyRead(size_t id) {
+BEGIN_SLOT_WRAPPER
+    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
+    const auto found = requests.find(id);
+    if (found == requests.end()) {
+        return;
+    }
+    readToDecoder(reply, found->second);
+END_SLOT_WRAPPER
+}
+
 void SimpleClient::onTextMessageReceived(size_t id) {
 BEGIN_SLOT_WRAPPER
     QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
 
-    const Request &request = requests.at(id);
+    Request &request = requests.at(id);
     const time_point timeBegin = request.beginTime;
     const time_point timeEnd = ::now();
     const milliseconds duration = std::chrono::duration_cast<milliseconds>(timeEnd - timeBegin);
 
-    if (reply->error() == QNetworkReply::NoError) {
-        QByteArray content;
-        if (reply->isReadable()) {
-            content = reply->readAll();
+    readToDecoder(reply, request);
+    std::string content;
+    size_t wireSize = 0;
+    bool isDecodeError = false;
+    if (request.decoder != nullptr) {
+        content = request.decoder->finish();
+        wireSize = request.decoder->encodedSize();
+        isDecodeError = request.decoder->isError();
+        if (isDecodeError) {
+            LOG << "Decompress error " << request.decoder->errorString() << " " << reply->url().toString();
+        } else if (request.decoder->encoding() != ContentDecoder::Encoding::Identity) {
+            LOG << PeriodicLog::make("cl_gz") << "Response compressed " << wireSize << " -> " << content.size() << " ratio " << request.decoder->ratio();
         }
+    }
+
+    if (reply->error() == QNetworkReply::NoError && !isDecodeError) {
         Response resp;
-        resp.response = std::string(content.data(), content.size());
+        resp.response = std::move(content);
         resp.time = duration;
+        resp.wireSize = wireSize;
+        runCallback(id, resp);
+    } else if (reply->error() == QNetworkReply::NoError) {
+        Response resp;
+        resp.time = duration;
+        resp.wireSize = wireSize;
+        resp.exception = ServerException(reply->url().toString().toStdString(), ServerException::BAD_REQUEST_ERROR, "Incorrect compressed content", "");
         runCallback(id, resp);
     } else {
-        std::string errorStr;
-        if (reply->isReadable()) {
-            errorStr = QString(reply->readAll()).toStdString();
-        }
+        const std::string errorStr = content;
 
         Response resp;
         resp.time = duration;
+        resp.wireSize = wireSize;
         if (request.isTimeout) {
             resp.exception = ServerException(reply->url().toString().toStdString(), QNetworkReply::TimeoutError, "Timeout", errorStr);
         } else {
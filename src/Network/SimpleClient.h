@@ -14,6 +14,7 @@
 class QNetworkAccessManager;
 class QTimer;
 class QNetworkReply;
+class ContentDecoder;
 
 /*
    На каждый поток должен быть один экземпляр класса.
@@ -60,6 +61,11 @@ public:
         std::string response;
         ServerException exception;
         milliseconds time;
+        size_t wireSize = 0;
+
+        double compressionRatio() const {
+            return wireSize == 0 ? 1.0 : double(response.size()) / double(wireSize);
+        }
     };
 
 public:
@@ -96,6 +102,8 @@ Q_SIGNALS:
 private Q_SLOTS:
     void onTextMessageReceived(size_t id);
 
+    void onReadyRead(size_t id);
+
     void onTimerEvent();
 
 private:
@@ -107,6 +115,7 @@ private:
         milliseconds timeout;
         time_point beginTime;
         bool isTimeout = false;
+        std::shared_ptr<ContentDecoder> decoder;
     };
 
 private:
@@ -131,6 +140,8 @@ private:
 
     void startTimer1();
 
+    static void readToDecoder(QNetworkReply *reply, Request &request);
+
 private:
     QNetworkAccessManager *manager;
 
@@ -2,6 +2,9 @@
 
 #include <QNetworkDatagram>
 
+#include <limits>
+#include <random>
+
 #include "Log.h"
 #include "check.h"
 #include "duration.h"
@@ -10,13 +13,14 @@
 
 UdpSocketClient::UdpSocketClient(QObject *parent)
     : QObject(parent)
+    , lastTransactionId(static_cast<quint16>(std::random_device()()))
 {
     Q_CONNECT(&socket, &QUdpSocket::readyRead, this, &UdpSocketClient::onReadyRead);
     Q_CONNECT(&socket, QOverload<QAbstractSocket::SocketError>::of(&QUdpSocket::error), this, &UdpSocketClient::onSocketError);
 
     Q_CONNECT(&timer, &QTimer::timeout, this, &UdpSocketClient::onTimerEvent);
 
-    timer.setInterval(milliseconds(1s).count());
+    timer.setInterval(milliseconds(200ms).count());
 }
 
 UdpSocketClient::~UdpSocketClient()
@@ -45,59 +49,121 @@ void UdpSocketClient::startTm() {
 
 void UdpSocketClient::onTimerEvent() {
 BEGIN_SLOT_WRAPPER
-    if (isCurrentRequest) {
-        const time_point now = ::now();
-        if (now - beginTime >= timeout) {
-            socket.abort();
-            processResponse(std::vector<char>(), SocketException(1000, "Timeout"));
+    const time_point now = ::now();
+    std::vector<quint16> expired;
+    for (const auto &pair: requests) {
+        if (now - pair.second.beginTime >= pair.second.timeout) {
+            expired.emplace_back(pair.first);
         }
     }
+    for (const quint16 transactionId: expired) {
+        repeatOrFail(transactionId, SocketException(1000, "Timeout"));
+    }
 END_SLOT_WRAPPER
 }
 
-void UdpSocketClient::sendRequest(const QHostAddress &address, int port, const std::vector<char> &request, const UdpSocketCallback &responseCallback, milliseconds timeout) {
-    CHECK(isTimerStarted, "Timer not started");
-    CHECK(!isCurrentRequest, "Request already running");
+quint16 UdpSocketClient::generateTransactionId() {
+    CHECK(requests.size() < std::numeric_limits<quint16>::max(), "Too many udp requests");
+    do {
+        lastTransactionId++;
+    } while (requests.find(lastTransactionId) != requests.end());
+    return lastTransactionId;
+}
 
-    beginTime = ::now();
-    this->timeout = timeout;
+bool UdpSocketClient::writeRequest(Request &request) {
+    request.beginTime = ::now();
+    CHECK(request.attemptsLeft != 0, "Incorrect attempts count");
+    request.attemptsLeft--;
+    const auto result = socket.writeDatagram(request.datagram.data(), request.datagram.size(), request.address, request.port);
+    return result != -1;
+}
 
-    currentCallback = responseCallback;
-    isCurrentRequest = true;
-    const auto result = socket.writeDatagram(request.data(), request.size(), address, port);
-    if (result == -1) {
-        isCurrentRequest = false;
+void UdpSocketClient::sendRequest(const QHostAddress &address, int port, const std::vector<char> &request, const UdpSocketCallback &responseCallback, milliseconds timeout, size_t countAttempts) {
+    CHECK(isTimerStarted, "Timer not started");
+    CHECK(request.size() >= 2, "Incorrect udp request");
+    CHECK(countAttempts != 0, "Incorrect attempts count");
+
+    const quint16 transactionId = generateTransactionId();
+
+    Request r;
+    r.address = address;
+    r.port = port;
+    r.datagram = request;
+    r.datagram[0] = static_cast<char>(transactionId >> 8);
+    r.datagram[1] = static_cast<char>(transactionId & 0xFF);
+    r.callback = responseCallback;
+    r.timeout = timeout;
+    r.attemptsLeft = countAttempts;
+
+    if (!writeRequest(r)) {
         throwErr("Write udp request error");
     }
+    requests.emplace(transactionId, r);
+}
+
+size_t UdpSocketClient::countCurrentRequests() const {
+    return requests.size();
 }
 
 void UdpSocketClient::closeSock() {
     socket.abort();
+    requests.clear();
+}
+
+bool UdpSocketClient::repeatOrFail(quint16 transactionId, const SocketException &exception) {
+    const auto found = requests.find(transactionId);
+    if (found == requests.end()) {
+        // Уже обработан во вложенном вызове
+        return false;
+    }
+    Request &request = found->second;
+    if (request.attemptsLeft != 0) {
+        LOG << PeriodicLog::make("udp_rp") << "Repeat udp request " << transactionId << ". Attempts left " << request.attemptsLeft << ". " << exception.toString();
+        if (writeRequest(request)) {
+            return true;
+        }
+    }
+    processResponse(transactionId, std::vector<char>(), exception);
+    return false;
 }
 
-void UdpSocketClient::processResponse(const std::vector<char> &response, const SocketException &exception) {
-    CHECK(isCurrentRequest, "callback not set");
-    const UdpSocketCallback copyCallback = currentCallback; // Копируем
-    isCurrentRequest = false;
-    currentCallback = nullptr;
+void UdpSocketClient::processResponse(quint16 transactionId, const std::vector<char> &response, const SocketException &exception) {
+    const auto found = requests.find(transactionId);
+    CHECK(found != requests.end(), "callback not set");
+    const UdpSocketCallback copyCallback = found->second.callback; // Копируем
+    requests.erase(found);
     emit callbackCall(std::bind(copyCallback, response, exception));
 }
 
 void UdpSocketClient::onReadyRead() {
 BEGIN_SLOT_WRAPPER
-    std::vector<char> response;
     while (socket.hasPendingDatagrams()) {
         const QNetworkDatagram datagram = socket.receiveDatagram();
-        const auto data = datagram.data();
-        response.insert(response.end(), data.begin(), data.end());
+        const QByteArray data = datagram.data();
+        if (data.size() < 2) {
+            LOG << "Incorrect udp response size " << data.size();
+            continue;
+        }
+        const quint16 transactionId = (quint16(static_cast<unsigned char>(data[0])) << 8) | quint16(static_cast<unsigned char>(data[1]));
+        if (requests.find(transactionId) == requests.end()) {
+            LOG << PeriodicLog::make("udp_un") << "Udp response for unknown request " << transactionId;
+            continue;
+        }
+        processResponse(transactionId, std::vector<char>(data.begin(), data.end()), SocketException());
     }
-
-    processResponse(response, SocketException());
 END_SLOT_WRAPPER
 }
 
 void UdpSocketClient::onSocketError(QAbstractSocket::SocketError socketError) {
 BEGIN_SLOT_WRAPPER
-    processResponse(std::vector<char>(), SocketException(socketError, socket.errorString().toStdString()));
+    // Ошибка относится ко всему сокету, понять к какому запросу она пришла нельзя
+    const SocketException exception(socketError, socket.errorString().toStdString());
+    std::vector<quint16> current;
+    for (const auto &pair: requests) {
+        current.emplace_back(pair.first);
+    }
+    for (const quint16 transactionId: current) {
+        repeatOrFail(transactionId, exception);
+    }
 END_SLOT_WRAPPER
 }
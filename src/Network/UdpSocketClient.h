@@ -7,11 +7,17 @@
 #include <QTimer>
 
 #include <functional>
+#include <map>
 
 #include "duration.h"
 
 struct TypedException;
 
+/*
+   Первые 2 байта датаграммы считаются идентификатором транзакции (как в dns).
+   Клиент сам проставляет уникальный идентификатор каждому запросу и по нему сопоставляет ответы,
+   поэтому одновременно может выполняться несколько запросов.
+   */
 class UdpSocketClient : public QObject {
     Q_OBJECT
 public:
@@ -53,7 +59,9 @@ public:
 
     void mvToThread(QThread *thread);
 
-    void sendRequest(const QHostAddress &address, int port, const std::vector<char> &request, const UdpSocketCallback &responseCallback, milliseconds timeout);
+    void sendRequest(const QHostAddress &address, int port, const std::vector<char> &request, const UdpSocketCallback &responseCallback, milliseconds timeout, size_t countAttempts = 1);
+
+    size_t countCurrentRequests() const;
 
     void startTm();
 
@@ -73,7 +81,25 @@ private slots:
 
 private:
 
-    void processResponse(const std::vector<char> &response, const SocketException &exception);
+    struct Request {
+        QHostAddress address;
+        int port;
+        std::vector<char> datagram;
+        UdpSocketCallback callback;
+        time_point beginTime;
+        milliseconds timeout;
+        size_t attemptsLeft;
+    };
+
+private:
+
+    quint16 generateTransactionId();
+
+    bool writeRequest(Request &request);
+
+    bool repeatOrFail(quint16 transactionId, const SocketException &exception);
+
+    void processResponse(quint16 transactionId, const std::vector<char> &response, const SocketException &exception);
 
 private:
 
@@ -85,13 +111,9 @@ private:
 
     bool isTimerStarted = false;
 
-    UdpSocketCallback currentCallback;
-
-    bool isCurrentRequest = false;
-
-    time_point beginTime;
+    std::map<quint16, Request> requests;
 
-    milliseconds timeout;
+    quint16 lastTransactionId;
 
 };
 
@@ -11,14 +11,22 @@
 #include <QTimer>
 
 #include <thread>
+#include <algorithm>
+#include <functional>
 SET_LOG_NAMESPACE("WSS");
 
+static const size_t MAX_QUEUE_SIZE = 5000;
+
+static const size_t MAX_QUEUE_BYTES = 32 * 1024 * 1024;
+
 WebSocketClient::WebSocketClient(const QString &url, QObject *parent)
     : TimerClass(1min, parent)
     , m_webSocket(new QWebSocket(QString(), QWebSocketProtocol::VersionLatest, this))
 {
     Q_REG2(QAbstractSocket::SocketState, "QAbstractSocket::SocketState", false);
     Q_REG2(std::vector<QString>, "std::vector<QString>", false);
+    Q_REG(WebSocketClient::QueuePolicy, "WebSocketClient::QueuePolicy");
+    Q_REG2(TypedException, "TypedException", false);
 
     m_url = url;
     if (!QSslSocket::supportsSsl()) {
@@ -27,6 +35,7 @@ WebSocketClient::WebSocketClient(const QString &url, QObject *parent)
 
     Q_CONNECT(this, &WebSocketClient::sendMessage, this, &WebSocketClient::onSendMessage);
     Q_CONNECT(this, &WebSocketClient::sendMessages, this, &WebSocketClient::onSendMessages);
+    Q_CONNECT(this, &WebSocketClient::sendMessageTagged, this, &WebSocketClient::onSendMessageTagged);
     Q_CONNECT(this, (QOverload<QString, QString>::of(&WebSocketClient::setHelloString)), this, (QOverload<QString, QString>::of(&WebSocketClient::onSetHelloString)));
     Q_CONNECT(this, (QOverload<const std::vector<QString>&, QString>::of(&WebSocketClient::setHelloString)), this, (QOverload<const std::vector<QString>&, QString>::of(&WebSocketClient::onSetHelloString)));
     Q_CONNECT(this, &WebSocketClient::addHelloString, this, &WebSocketClient::onAddHelloString);
@@ -37,6 +46,7 @@ WebSocketClient::WebSocketClient(const QString &url, QObject *parent)
     Q_CONNECT(m_webSocket, &QWebSocket::connected, this, &WebSocketClient::onConnected);
     Q_CONNECT(m_webSocket, &QWebSocket::pong, this, &WebSocketClient::onPong);
     Q_CONNECT(m_webSocket, &QWebSocket::textMessageReceived, this, &WebSocketClient::onTextMessageReceived);
+    Q_CONNECT(m_webSocket, &QWebSocket::bytesWritten, this, &WebSocketClient::onBytesWritten);
     Q_CONNECT3(m_webSocket, &QWebSocket::disconnected, [this]{
         BEGIN_SLOT_WRAPPER
         LOG << "Wss client disconnected. Url " << m_url.toString();
@@ -45,6 +55,7 @@ WebSocketClient::WebSocketClient(const QString &url, QObject *parent)
             QTimer::singleShot(milliseconds(10s).count(), this, &WebSocketClient::onStarted);
         }
         isConnected = false;
+        emit closed();
         END_SLOT_WRAPPER
     });
 
@@ -69,7 +80,8 @@ void WebSocketClient::startMethod() {
 }
 
 void WebSocketClient::timerMethod() {
-    LOG << "Wss check ping " << m_url.toString();
+    const Metrics m = getMetrics();
+    LOG << "Wss check ping " << m_url.toString() << ". Queue " << m.queueDepth << " (" << m.queueBytes << " bytes, max " << m.maxQueueDepth << "). Sent " << m.framesSent << " frames in " << m.batchesSent << " batches, " << m.bytesOnWire << " bytes. Received " << m.bytesReceived << " bytes. Dropped " << m.dropped << ", merged " << m.merged;
     const time_point now = ::now();
     if (std::chrono::duration_cast<seconds>(now - prevPongTime) >= 3min) {
         LOG << "Wss close " << m_url.toString();
@@ -110,20 +122,111 @@ BEGIN_SLOT_WRAPPER
 END_SLOT_WRAPPER
 }
 
-void WebSocketClient::sendMessagesInternal() {
-    if (isConnected.load()) {
-        for (const QString &m: messageQueue) {
-            m_webSocket->sendTextMessage(m);
+WebSocketClient::Metrics WebSocketClient::getMetrics() const {
+    std::lock_guard<std::mutex> lock(metricsMut);
+    return metrics;
+}
+
+void WebSocketClient::updateQueueMetrics() {
+    std::lock_guard<std::mutex> lock(metricsMut);
+    metrics.queueDepth = messageQueue.size();
+    metrics.queueBytes = messageQueueBytes;
+    metrics.maxQueueDepth = std::max(metrics.maxQueueDepth, messageQueue.size());
+}
+
+void WebSocketClient::enqueue(QueuedMessage &&message, QueuePolicy policy) {
+    if (policy == QueuePolicy::KeepLast && !message.tag.isEmpty()) {
+        const auto found = std::find_if(messageQueue.begin(), messageQueue.end(), [&tag=message.tag](const QueuedMessage &m) {
+            return m.tag == tag;
+        });
+        if (found != messageQueue.end()) {
+            messageQueueBytes -= found->size();
+            messageQueue.erase(found);
+            std::lock_guard<std::mutex> lock(metricsMut);
+            metrics.merged++;
+        }
+    }
+
+    message.isDroppable = policy == QueuePolicy::KeepLast;
+
+    const auto isOverflow = [this](size_t addSize) {
+        return messageQueue.size() + 1 > MAX_QUEUE_SIZE || messageQueueBytes + addSize > MAX_QUEUE_BYTES;
+    };
+    while (isOverflow(message.size())) {
+        const auto found = std::find_if(messageQueue.begin(), messageQueue.end(), std::mem_fn(&QueuedMessage::isDroppable));
+        if (found == messageQueue.end()) {
+            break;
         }
-        messageQueue.clear();
+        LOG << PeriodicLog::make("w_drp") << "Wss queue overflow. Drop message " << found->tag << " " << m_url.toString();
+        messageQueueBytes -= found->size();
+        messageQueue.erase(found);
+        std::lock_guard<std::mutex> lock(metricsMut);
+        metrics.dropped++;
+    }
+
+    if (isOverflow(message.size()) && !messageQueue.empty()) {
+        LOG << PeriodicLog::make("w_rjc") << "Wss queue overflow. Reject message " << message.tag << " " << m_url.toString();
+        {
+            std::lock_guard<std::mutex> lock(metricsMut);
+            metrics.rejected++;
+        }
+        emit sendFailed(message.text, message.tag, TypedException(TypeErrors::CLIENT_ERROR, "Wss queue overflow"));
+        return;
+    }
+
+    messageQueueBytes += message.size();
+    messageQueue.emplace_back(std::move(message));
+
+    updateQueueMetrics();
+}
+
+void WebSocketClient::sendMessagesInternal() {
+    if (isConnected.load() && !isFlushScheduled && !messageQueue.empty()) {
+        // Все сообщения, пришедшие за один проход цикла событий, уходят одной пачкой
+        isFlushScheduled = true;
+        QTimer::singleShot(0, this, [this]{
+            BEGIN_SLOT_WRAPPER
+            isFlushScheduled = false;
+            flushQueue();
+            END_SLOT_WRAPPER
+        });
     }
 }
 
+void WebSocketClient::flushQueue() {
+    if (!isConnected.load() || messageQueue.empty()) {
+        return;
+    }
+    const size_t count = messageQueue.size();
+    for (const QueuedMessage &m: messageQueue) {
+        m_webSocket->sendTextMessage(m.text);
+    }
+    messageQueue.clear();
+    messageQueueBytes = 0;
+    m_webSocket->flush();
+
+    {
+        std::lock_guard<std::mutex> lock(metricsMut);
+        metrics.framesSent += count;
+        metrics.batchesSent++;
+    }
+    updateQueueMetrics();
+}
+
+void WebSocketClient::onBytesWritten(qint64 bytes) {
+BEGIN_SLOT_WRAPPER
+    std::lock_guard<std::mutex> lock(metricsMut);
+    metrics.bytesOnWire += bytes;
+END_SLOT_WRAPPER
+}
+
 void WebSocketClient::onSendMessage(QString message) {
 BEGIN_SLOT_WRAPPER
     //LOG << m_url.toString() << " WSS SEND MESSAGE'" << message << "'";
     if (!message.isNull() && !message.isEmpty()) {
-        messageQueue.emplace_back(message);
+        QueuedMessage m;
+        m.text = message;
+        enqueue(std::move(m), QueuePolicy::Keep);
     }
 
     sendMessagesInternal();
@@ -132,7 +235,24 @@ END_SLOT_WRAPPER
 
 void WebSocketClient::onSendMessages(const std::vector<QString> &messages) {
 BEGIN_SLOT_WRAPPER
-    messageQueue.insert(messageQueue.end(), messages.begin(), messages.end());
+    for (const QString &message: messages) {
+        QueuedMessage m;
+        m.text = message;
+        enqueue(std::move(m), QueuePolicy::Keep);
+    }
+
+    sendMessagesInternal();
+END_SLOT_WRAPPER
+}
+
+void WebSocketClient::onSendMessageTagged(QString message, QString tag, WebSocketClient::QueuePolicy policy) {
+BEGIN_SLOT_WRAPPER
+    if (!message.isNull() && !message.isEmpty()) {
+        QueuedMessage m;
+        m.text = message;
+        m.tag = tag;
+        enqueue(std::move(m), policy);
+    }
 
     sendMessagesInternal();
 END_SLOT_WRAPPER
@@ -161,6 +281,10 @@ void WebSocketClient::onTextMessageReceived(QString message) {
 BEGIN_SLOT_WRAPPER
     LOG << "Wss received size: " << message.size();
     //LOG << m_url.toString() << " WSS GET: '" << message << "'";
+    {
+        std::lock_guard<std::mutex> lock(metricsMut);
+        metrics.bytesReceived += message.size();
+    }
     emit messageReceived(message);
 END_SLOT_WRAPPER
 }
@@ -4,20 +4,51 @@
 #include <QObject>
 #include <QThread>
 #include <map>
+#include <deque>
 #include <QtWebSockets/QWebSocket>
 
 #include "qt_utilites/TimerClass.h"
 
+#include <mutex>
+
 struct TypedException;
 
+/*
+   Исходящие сообщения копятся в ограниченной очереди и отправляются пачкой один раз за проход цикла событий.
+   Для сообщений с тегом можно задать политику: KeepLast оставляет в очереди только последнее сообщение с этим тегом.
+   При переполнении вытесняются только сообщения KeepLast. Если вытеснять нечего, новое сообщение не ставится в очередь и возвращается через sendFailed.
+   Тег сообщения приходит в sendFailed, по нему отправитель узнает свои сообщения.
+   permessage-deflate не поддерживается QWebSocket, поэтому сжатие не согласовывается.
+   */
 class WebSocketClient : public QObject, public TimerClass
 {
     Q_OBJECT
+public:
+
+    enum class QueuePolicy {
+        Keep, KeepLast
+    };
+
+    struct Metrics {
+        size_t queueDepth = 0;
+        size_t queueBytes = 0;
+        size_t maxQueueDepth = 0;
+        uint64_t bytesOnWire = 0;
+        uint64_t bytesReceived = 0;
+        uint64_t framesSent = 0;
+        uint64_t batchesSent = 0;
+        uint64_t dropped = 0;
+        uint64_t rejected = 0;
+        uint64_t merged = 0;
+    };
+
 public:
     explicit WebSocketClient(const QString &url, QObject *parent = nullptr);
 
     ~WebSocketClient() override;
 
+    Metrics getMetrics() const;
+
 protected:
 
     void startMethod() override;
@@ -34,6 +65,8 @@ signals:
 
     void sendMessages(const std::vector<QString> &messages);
 
+    void sendMessageTagged(QString message, QString tag, WebSocketClient::QueuePolicy policy);
+
     void setHelloString(QString message, QString tag);
 
     void setHelloString(const std::vector<QString> &messages, QString tag);
@@ -42,6 +75,8 @@ signals:
 
     void connectedSock(const TypedException &exception);
 
+    void sendFailed(QString message, QString tag, const TypedException &exception);
+
 signals:
 
     void messageReceived(QString message);
@@ -55,6 +90,8 @@ public slots:
 
     void onSendMessages(const std::vector<QString> &messages);
 
+    void onSendMessageTagged(QString message, QString tag, WebSocketClient::QueuePolicy policy);
+
     void onSetHelloString(QString message, QString tag);
 
     void onSetHelloString(const std::vector<QString> &messages, QString tag);
@@ -67,10 +104,30 @@ private slots:
 
     void onStarted();
 
+    void onBytesWritten(qint64 bytes);
+
+private:
+
+    struct QueuedMessage {
+        QString text;
+        bool isDroppable = false;
+        QString tag;
+
+        size_t size() const {
+            return text.size() * sizeof(QChar);
+        }
+    };
+
 private:
 
+    void enqueue(QueuedMessage &&message, QueuePolicy policy);
+
     void sendMessagesInternal();
 
+    void flushQueue();
+
+    void updateQueueMetrics();
+
 private:
 
     QWebSocket *m_webSocket;
@@ -80,7 +137,15 @@ private:
 
     std::atomic<bool> isConnected{false};
 
-    std::vector<QString> messageQueue;
+    std::deque<QueuedMessage> messageQueue;
+
+    size_t messageQueueBytes = 0;
+
+    bool isFlushScheduled = false;
+
+    mutable std::mutex metricsMut;
+
+    Metrics metrics;
 
     std::map<QString, std::vector<QString>> helloStrings;
 
@@ -10,6 +10,8 @@
 
 #include <QSettings>
 
+#include <set>
+
 #include "dns/dnspacket.h"
 #include "check.h"
 #include "utilites/utils.h"
@@ -48,6 +50,12 @@ const static milliseconds UPDATE_PERIOD = days(1);
 
 const static size_t ACCEPTABLE_COUNT_ADDRESSES = 3;
 
+const static size_t DEFAULT_PING_WINDOW = 32;
+
+const static size_t DEFAULT_PING_RATE_LIMIT = 100;
+
+const static milliseconds PING_TIMEOUT = 2s;
+
 static QString makeAddress(const QString &ipAndPort) {
     return "http://" + ipAndPort;
 }
@@ -66,14 +74,18 @@ static QString getAddressWithoutHttp(const QString &address) {
 NsLookup::NsLookup(InfrastructureNsLookup &infrastructureNsl)
     : TimerClass(1s, nullptr)
     , infrastructureNsl(infrastructureNsl)
+    , pingWindowSize(DEFAULT_PING_WINDOW)
+    , pingRateLimiter(DEFAULT_PING_RATE_LIMIT)
 {
     Q_CONNECT(this, &NsLookup::getStatus, this, &NsLookup::onGetStatus);
     Q_CONNECT(this, &NsLookup::rejectServer, this, &NsLookup::onRejectServer);
+    Q_CONNECT(this, &NsLookup::serverResult, this, &NsLookup::onServerResult);
     Q_CONNECT(this, &NsLookup::getRandomServersWithoutHttp, this, &NsLookup::onGetRandomServersWithoutHttp);
     Q_CONNECT(this, &NsLookup::getRandomServers, this, &NsLookup::onGetRandomServers);
 
     Q_REG(GetStatusCallback, "GetStatusCallback");
     Q_REG(GetServersCallback, "GetServersCallback");
+    Q_REG2(size_t, "size_t", false);
 
     QSettings settings(getSettingsPath(), QSettings::IniFormat);
     const int size = settings.beginReadArray("nodes");
@@ -107,6 +119,12 @@ NsLookup::NsLookup(InfrastructureNsLookup &infrastructureNsl)
     dnsServerName = settings.value("ns_lookup/dns_server").toString();
     CHECK(settings.contains("ns_lookup/dns_server_port"), "settings ns_lookup/dns_server_port field not found");
     dnsServerPort = settings.value("ns_lookup/dns_server_port").toInt();
+    if (settings.contains("ns_lookup/pingWindow")) {
+        pingWindowSize = std::max(1, settings.value("ns_lookup/pingWindow").toInt());
+    }
+    if (settings.contains("ns_lookup/pingRateLimitPerSecond")) {
+        pingRateLimiter.setRate(std::max(0, settings.value("ns_lookup/pingRateLimitPerSecond").toInt()));
+    }
 
     savedNodesPath = makePath(getNsLookupPath(), FILL_NODES_PATH);
     const system_time_point lastFill = fillNodesFromFile(savedNodesPath, nodes);
@@ -258,20 +276,20 @@ void NsLookup::finalizeLookup(const NodeType::Node &node, const std::vector<Node
     defectiveTorrents.clear();
 }
 
-bool NsLookup::repeatResolveDns(
-    const QString &dnsServerName,
-    int dnsServerPort,
-    const QByteArray &byteArray,
-    std::map<QString, NodeType>::const_iterator node,
-    time_point now,
-    size_t countRepeat,
-    std::vector<QString> &ipsTemp,
-    const std::function<void()> &beginPing
-) {
-    if (countRepeat == 0) {
-        return false;
+void NsLookup::clearDnsCacheIfExpired(const time_point &now) {
+    if (now - cacheDns.lastUpdate >= 1h) {
+        cacheDns.cache.clear();
     }
-    udpClient.sendRequest(QHostAddress(dnsServerName), dnsServerPort, std::vector<char>(byteArray.begin(), byteArray.end()), [this, &ipsTemp, beginPing, node, now, dnsServerName, dnsServerPort, byteArray, countRepeat](const std::vector<char> &response, const UdpSocketClient::SocketException &exception) {
+}
+
+void NsLookup::resolveDns(std::map<QString, NodeType>::const_iterator node, const std::function<void(const TypedException &exception)> &callback) {
+    DnsPacket requestPacket;
+    requestPacket.addQuestion(DnsQuestion::getIp(node->second.node.str()));
+    requestPacket.setFlags(DnsFlag::MyFlag);
+    const auto byteArray = requestPacket.toByteArray();
+    LOG << "Dns " << node->second.type << ".";
+    const time_point now = ::now();
+    udpClient.sendRequest(QHostAddress(dnsServerName), dnsServerPort, std::vector<char>(byteArray.begin(), byteArray.end()), [this, node, now, callback](const std::vector<char> &response, const UdpSocketClient::SocketException &exception) {
         DnsPacket packet;
         const TypedException except = apiVrapper2([&](){
             CHECK(!exception.isSet(), "Dns exception: " + exception.toString());
@@ -281,33 +299,66 @@ bool NsLookup::repeatResolveDns(
             LOG << "Dns ok " << node->second.type << ". " << packet.answers().size();
         });
 
-        if (except.isSet()) {
-            LOG << "Dns repeat number " << countRepeat - 1;
-            const bool res = repeatResolveDns(dnsServerName, dnsServerPort, byteArray, node, now, countRepeat - 1, ipsTemp, beginPing);
-            if (!res) {
-                dnsErrorDetails.dnsName = dnsServerName;
-                throw except;
-            } else {
-                return;
+        if (!except.isSet()) {
+            std::vector<QString> ips;
+            for (const auto &record : packet.answers()) {
+                ips.emplace_back(::makeAddress(record.toString(), node->second.port));
             }
-        }
 
-        ipsTemp.clear();
-        for (const auto &record : packet.answers()) {
-            ipsTemp.emplace_back(::makeAddress(record.toString(), node->second.port));
+            cacheDns.cache[node->second.node.str()] = ips;
+            cacheDns.lastUpdate = now;
         }
 
-        cacheDns.cache[node->second.node.str()] = ipsTemp;
-        cacheDns.lastUpdate = now;
+        callback(except);
+    }, timeoutRequestNodes, 3);
+}
 
-        beginPing();
-    }, timeoutRequestNodes);
+void NsLookup::resolveAllDns(const std::map<NodeType::Node, std::vector<NodeInfo>> &allNodesForTypesNew, const std::function<void()> &callback) {
+    dnsErrors.clear();
+    clearDnsCacheIfExpired(::now());
 
-    return true;
+    std::vector<std::map<QString, NodeType>::const_iterator> toResolve;
+    std::set<QString> uniqueNodes;
+    for (auto node = nodes.cbegin(); node != nodes.cend(); node++) {
+        const QString nodeStr = node->second.node.str();
+        if (allNodesForTypesNew.find(node->second.node) != allNodesForTypesNew.end()) {
+            continue;
+        }
+        const auto foundCache = cacheDns.cache.find(nodeStr);
+        if (foundCache != cacheDns.cache.end() && !foundCache->second.empty()) {
+            continue;
+        }
+        if (uniqueNodes.insert(nodeStr).second) {
+            toResolve.emplace_back(node);
+        }
+    }
+
+    if (toResolve.empty()) {
+        callback();
+        return;
+    }
+
+    // Все запросы уходят одновременно, ответы сопоставляются по идентификатору транзакции
+    const auto countLeft = std::make_shared<size_t>(toResolve.size());
+    Timer timer;
+    for (const auto node: toResolve) {
+        resolveDns(node, [this, node, countLeft, callback, timer](const TypedException &exception) mutable {
+            if (exception.isSet()) {
+                dnsErrors[node->second.node.str()] = exception;
+            }
+            (*countLeft)--;
+            if (*countLeft == 0) {
+                LOG << "Dns resolved all. Time " << timer.countMs() << ". Errors " << dnsErrors.size();
+                callback();
+            }
+        });
+    }
 }
 
 void NsLookup::beginResolve(std::map<NodeType::Node, std::vector<NodeInfo>> &allNodesForTypesNew, std::vector<QString> &ipsTemp, const std::function<void()> &finalizeLookup, const std::function<void(std::map<QString, NodeType>::const_iterator node)> &beginPing) {
-    continueResolve(std::begin(nodes), allNodesForTypesNew, ipsTemp, finalizeLookup, beginPing);
+    resolveAllDns(allNodesForTypesNew, [this, &allNodesForTypesNew, &ipsTemp, finalizeLookup, beginPing]{
+        continueResolve(std::begin(nodes), allNodesForTypesNew, ipsTemp, finalizeLookup, beginPing);
+    });
 }
 
 void NsLookup::continueResolve(std::map<QString, NodeType>::const_iterator node, std::map<NodeType::Node, std::vector<NodeInfo>> &allNodesForTypesNew, std::vector<QString> &ipsTemp, const std::function<void()> &finalizeLookup, const std::function<void(std::map<QString, NodeType>::const_iterator node)> &beginPing) {
@@ -321,22 +372,31 @@ void NsLookup::continueResolve(std::map<QString, NodeType>::const_iterator node,
         return;
     }
 
-    const time_point now = ::now();
-    if (now - cacheDns.lastUpdate >= 1h) {
-        cacheDns.cache.clear();
-    }
+    clearDnsCacheIfExpired(::now());
     ipsTemp = cacheDns.cache[node->second.node.str()];
     const auto bPing = std::bind(beginPing, node);
-    if (ipsTemp.empty()) {
-        DnsPacket requestPacket;
-        requestPacket.addQuestion(DnsQuestion::getIp(node->second.node.str()));
-        requestPacket.setFlags(DnsFlag::MyFlag);
-        const auto byteArray = requestPacket.toByteArray();
-        LOG << "Dns " << node->second.type << ".";
-        repeatResolveDns(dnsServerName, dnsServerPort, byteArray, node, now, 3, ipsTemp, bPing);
-    } else {
+    if (!ipsTemp.empty()) {
         bPing();
+        return;
     }
+
+    const auto processError = [this](const TypedException &exception) {
+        dnsErrorDetails.dnsName = dnsServerName;
+        throw exception;
+    };
+
+    const auto foundError = dnsErrors.find(node->second.node.str());
+    if (foundError != dnsErrors.end()) {
+        processError(foundError->second);
+    }
+
+    resolveDns(node, [this, node, &ipsTemp, bPing, processError](const TypedException &exception) {
+        if (exception.isSet()) {
+            processError(exception);
+        }
+        ipsTemp = cacheDns.cache[node->second.node.str()];
+        bPing();
+    });
 }
 
 static NodeInfo preParseNodeInfo(const QString &address, const SimpleClient::Response &response, size_t updateNumber) {
@@ -370,13 +430,9 @@ void NsLookup::continuePing(std::vector<QString>::const_iterator ipsIter, const
         return;
     }
 
-    const auto distance = std::distance(ipsIter, ipsTemp.cend());
-    const auto countSteps = std::min(decltype(distance)(10), distance);
+    const std::vector<QString> currentIps(ipsIter, ipsTemp.cend());
 
-    CHECK(countSteps != 0, "Incorrect countSteps");
-    std::vector<QString> currentIps(ipsIter, ipsIter + countSteps);
-
-    emit infrastructureNsl.getRequestFornode(node.type, InfrastructureNsLookup::GetFormatRequestCallback([this, currentIps, &allNodesForTypesNew, &ipsTemp, continueResolve, node, ipsIter, countSteps](bool found, const QString &get, const QString &post, const std::function<NodeResponse(const std::string &response, const std::string &error)> &processResponse){
+    emit infrastructureNsl.getRequestFornode(node.type, InfrastructureNsLookup::GetFormatRequestCallback([this, currentIps, &allNodesForTypesNew, continueResolve, node](bool found, const QString &get, const QString &post, const std::function<NodeResponse(const std::string &response, const std::string &error)> &processResponse){
         std::function<NodeResponse(const std::string &response, const std::string &error)> pResponse = found ? processResponse : defaultResponseParser;
         std::vector<QUrl> getRequests;
         getRequests.reserve(currentIps.size());
@@ -385,27 +441,18 @@ void NsLookup::continuePing(std::vector<QString>::const_iterator ipsIter, const
             getRequest.setPath(get);
             return getRequest;
         });
-        client.sendMessagesPost(node.node.str().toStdString(), getRequests, post, [this, &allNodesForTypesNew, &ipsTemp, continueResolve, node, currentIps, ipsIter, countSteps, pResponse](const std::vector<SimpleClient::Response> &results) {
-            const TypedException exception = apiVrapper2([&]{
-                CHECK(currentIps.size() == results.size(), "Incorrect results");
-                for (size_t i = 0; i < results.size(); i++) {
-                    const SimpleClient::Response &result = results[i];
-                    const QString &ip = currentIps[i];
-                    NodeInfo nodeInfo = preParseNodeInfo(ip, result, updateNumber);
-                    const NodeResponse r = pResponse(result.response, result.exception.content);
-                    if (!r.isSuccess) {
-                        nodeInfo.isTimeout = true;
-                        nodeInfo.ping = MAX_PING;
-                    }
-                    allNodesForTypesNew[node.node].emplace_back(nodeInfo);
-                }
-            });
-
-            if (exception.isSet()) {
-                LOG << "Exception"; // Ошибка логгируется внутри apiVrapper2;
+        const auto pingWindow = std::make_shared<PingWindow>(client, this, pingRateLimiter, pingWindowSize);
+        pingWindow->start(node.node.str().toStdString(), getRequests, post, PING_TIMEOUT, [this, &allNodesForTypesNew, node, currentIps, pResponse](size_t index, const SimpleClient::Response &result) {
+            CHECK(index < currentIps.size(), "Incorrect results");
+            const QString &ip = currentIps[index];
+            NodeInfo nodeInfo = preParseNodeInfo(ip, result, updateNumber);
+            const NodeResponse r = pResponse(result.response, result.exception.content);
+            if (!r.isSuccess) {
+                nodeInfo.isTimeout = true;
+                nodeInfo.ping = MAX_PING;
             }
-            continuePing(std::next(ipsIter, countSteps), node, allNodesForTypesNew, ipsTemp, continueResolve);
-        }, 2s);
+            allNodesForTypesNew[node.node].emplace_back(nodeInfo);
+        }, continueResolve);
     }, [](const TypedException &exception) {
         LOG << "Error: " << exception.description;
     }, signalFunc));
@@ -477,7 +524,7 @@ void NsLookup::continuePingSafe(const NodeType &node, const std::vector<QString>
                 LOG << "Exception"; // Ошибка логгируется внутри apiVrapper2;
             }
             continueResolve();
-        }, 2s);
+        }, PING_TIMEOUT);
     }, [](const TypedException &exception) {
         LOG << "Error: " << exception.description;
     }, signalFunc));
@@ -667,7 +714,7 @@ void NsLookup::saveToFile(const QString &file, const system_time_point &tp, cons
     writeToFile(file, content, false);
 }
 
-std::vector<QString> NsLookup::getRandom(const QString &type, size_t limit, size_t count, const std::function<QString(const NodeInfo &node)> &process) const {
+std::vector<QString> NsLookup::getRandom(const QString &type, size_t limit, size_t count, const std::function<QString(const NodeInfo &node)> &process) {
     CHECK(count <= limit, "Incorrect count value");
 
     const auto foundType = nodes.find(type);
@@ -686,7 +733,10 @@ std::vector<QString> NsLookup::getRandom(const QString &type, size_t limit, size
     std::copy_if(nodes.begin(), nodes.end(), std::back_inserter(filterNodes), [](const NodeInfo &node) {
         return !node.isTimeout;
     });
-    return ::getRandom<QString>(filterNodes, limit, count, process);
+    const std::vector<NodeInfo> selected = serverSelector.select(filterNodes, limit, count);
+    std::vector<QString> result;
+    std::transform(selected.begin(), selected.end(), std::back_inserter(result), process);
+    return result;
 }
 
 void NsLookup::resetFile() {
@@ -717,8 +767,15 @@ BEGIN_SLOT_WRAPPER
 END_SLOT_WRAPPER
 }
 
+void NsLookup::onServerResult(const QString &server, size_t timeMs, bool isError) {
+BEGIN_SLOT_WRAPPER
+    serverSelector.addResult(server, milliseconds(timeMs), isError);
+END_SLOT_WRAPPER
+}
+
 void NsLookup::onRejectServer(const QString &server) {
 BEGIN_SLOT_WRAPPER
+    // Ошибка уже учтена в serverSelector через serverResult
     bool isFound = false;
     QString address;
     for (auto &defective: defectiveTorrents) {
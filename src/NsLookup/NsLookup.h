@@ -22,6 +22,8 @@
 #include "TaskManager.h"
 
 #include "NsLookupStructs.h"
+#include "PingWindow.h"
+#include "ServerSelector.h"
 
 struct TypedException;
 
@@ -98,6 +100,14 @@ public slots:
 
     void onRejectServer(const QString &server);
 
+signals:
+
+    void serverResult(const QString &server, size_t timeMs, bool isError);
+
+public slots:
+
+    void onServerResult(const QString &server, size_t timeMs, bool isError);
+
 signals:
 
     void finished();
@@ -157,18 +167,13 @@ private:
 
     void saveToFile(const QString &file, const system_time_point &tp, const std::map<QString, NodeType> &expectedNodes);
 
-    std::vector<QString> getRandom(const QString &type, size_t limit, size_t count, const std::function<QString(const NodeInfo &node)> &process) const;
+    std::vector<QString> getRandom(const QString &type, size_t limit, size_t count, const std::function<QString(const NodeInfo &node)> &process);
 
-    bool repeatResolveDns(
-        const QString &dnsServerName,
-        int dnsServerPort,
-        const QByteArray &byteArray,
-        std::map<QString, NodeType>::const_iterator node,
-        time_point now,
-        size_t countRepeat,
-        std::vector<QString> &ipsTemp,
-        const std::function<void()> &beginPing
-    );
+    void resolveDns(std::map<QString, NodeType>::const_iterator node, const std::function<void(const TypedException &exception)> &callback);
+
+    void resolveAllDns(const std::map<NodeType::Node, std::vector<NodeInfo>> &allNodesForTypesNew, const std::function<void()> &callback);
+
+    void clearDnsCacheIfExpired(const time_point &now);
 
     std::vector<NodeTypeStatus> getNodesStatus() const;
 
@@ -196,6 +201,8 @@ private:
 
     CacheDns cacheDns;
 
+    std::map<QString, TypedException> dnsErrors;
+
     seconds timeoutRequestNodes;
 
     QString dnsServerName;
@@ -209,6 +216,12 @@ private:
     size_t updateNumber = 0;
 
     nslookup::TaskManager taskManager;
+
+    size_t pingWindowSize;
+
+    nslookup::RateLimiter pingRateLimiter;
+
+    nslookup::ServerSelector serverSelector;
 };
 
 #endif // NSLOOKUP_H
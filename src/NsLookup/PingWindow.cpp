@@ -0,0 +1,115 @@
+#include "PingWindow.h"
+
+#include <QObject>
+#include <QTimer>
+
+#include <cmath>
+
+#include "check.h"
+#include "Log.h"
+#include "qt_utilites/SlotWrapper.h"
+
+SET_LOG_NAMESPACE("NSL");
+
+namespace nslookup {
+
+RateLimiter::RateLimiter(size_t requestsPerSecond)
+    : requestsPerSecond(requestsPerSecond)
+    , tokens(requestsPerSecond)
+    , lastRefill(::now())
+{}
+
+void RateLimiter::setRate(size_t requestsPerSecond) {
+    this->requestsPerSecond = requestsPerSecond;
+    tokens = std::min(tokens, double(requestsPerSecond));
+}
+
+void RateLimiter::refill(const time_point &now) {
+    const double passedMs = std::chrono::duration_cast<microseconds>(now - lastRefill).count() / 1000.;
+    tokens = std::min(double(requestsPerSecond), tokens + passedMs * requestsPerSecond / 1000.);
+    lastRefill = now;
+}
+
+milliseconds RateLimiter::acquire() {
+    if (requestsPerSecond == 0) {
+        return 0ms;
+    }
+    refill(::now());
+    if (tokens >= 1.) {
+        tokens -= 1.;
+        return 0ms;
+    }
+    const double waitMs = (1. - tokens) * 1000. / requestsPerSecond;
+    return milliseconds(std::max(1ll, static_cast<long long>(std::ceil(waitMs))));
+}
+
+PingWindow::PingWindow(SimpleClient &client, QObject *context, RateLimiter &rateLimiter, size_t windowSize)
+    : client(client)
+    , context(context)
+    , rateLimiter(rateLimiter)
+    , windowSize(windowSize)
+{
+    CHECK(windowSize != 0, "Incorrect window size");
+}
+
+PingWindow::~PingWindow() {
+    if (!isFinished) {
+        LOG << "Warn. Ping window not finished " << printedName << ". " << countFinished << "/" << urls.size();
+    }
+}
+
+void PingWindow::start(const std::string &printedName, const std::vector<QUrl> &urls, const QString &message, milliseconds timeout, const ResultCallback &resultCallback, const FinishCallback &finishCallback) {
+    this->printedName = printedName;
+    this->urls = urls;
+    this->message = message;
+    this->timeout = timeout;
+    this->resultCallback = resultCallback;
+    this->finishCallback = finishCallback;
+    timer.reset();
+    fill();
+}
+
+void PingWindow::fill() {
+    while (countInFlight < windowSize && nextIndex < urls.size()) {
+        const milliseconds wait = rateLimiter.acquire();
+        if (wait != 0ms) {
+            if (!isWaitRate) {
+                isWaitRate = true;
+                QTimer::singleShot(wait.count(), context, [self=shared_from_this()]{
+                    BEGIN_SLOT_WRAPPER
+                    self->isWaitRate = false;
+                    self->fill();
+                    END_SLOT_WRAPPER
+                });
+            }
+            return;
+        }
+
+        const size_t index = nextIndex++;
+        countInFlight++;
+        client.sendMessagePost(urls[index], message, [self=shared_from_this(), index](const SimpleClient::Response &response) {
+            self->onResult(index, response);
+        }, timeout);
+    }
+
+    if (countInFlight == 0 && nextIndex == urls.size() && !isFinished) {
+        isFinished = true;
+        LOG << "Ping window finished " << printedName << ". Count " << urls.size() << ". Time " << timer.countMs();
+        finishCallback();
+    }
+}
+
+void PingWindow::onResult(size_t index, const SimpleClient::Response &response) {
+    CHECK(countInFlight != 0, "Incorrect ping window state");
+    countInFlight--;
+    countFinished++;
+    const TypedException exception = apiVrapper2([&]{
+        resultCallback(index, response);
+    });
+    if (exception.isSet()) {
+        LOG << "Exception"; // Ошибка логгируется внутри apiVrapper2;
+    }
+    fill();
+}
+
+} // namespace nslookup
@@ -0,0 +1,111 @@
+#ifndef PINGWINDOW_H
+#define PINGWINDOW_H
+
+#include <QString>
+#include <QUrl>
+
+#include <vector>
+#include <memory>
+#include <functional>
+
+#include "duration.h"
+
+#include "Network/SimpleClient.h"
+
+class QObject;
+
+namespace nslookup {
+
+/*
+   Ограничение общего числа запросов в секунду (token bucket).
+   Один экземпляр разделяется всеми окнами пинга.
+   */
+class RateLimiter {
+public:
+
+    explicit RateLimiter(size_t requestsPerSecond);
+
+    void setRate(size_t requestsPerSecond);
+
+    // Возвращает 0, если запрос можно отправить сейчас, иначе время ожидания
+    milliseconds acquire();
+
+private:
+
+    void refill(const time_point &now);
+
+private:
+
+    size_t requestsPerSecond;
+
+    double tokens;
+
+    time_point lastRefill;
+
+};
+
+/*
+   Скользящее окно запросов: одновременно в работе не более windowSize запросов,
+   новый запрос отправляется сразу после завершения любого из текущих.
+   Колбеки вызываются в потоке context.
+   */
+class PingWindow: public std::enable_shared_from_this<PingWindow> {
+public:
+
+    using ResultCallback = std::function<void(size_t index, const SimpleClient::Response &response)>;
+
+    using FinishCallback = std::function<void()>;
+
+public:
+
+    PingWindow(SimpleClient &client, QObject *context, RateLimiter &rateLimiter, size_t windowSize);
+
+    ~PingWindow();
+
+    void start(const std::string &printedName, const std::vector<QUrl> &urls, const QString &message, milliseconds timeout, const ResultCallback &resultCallback, const FinishCallback &finishCallback);
+
+private:
+
+    void fill();
+
+    void onResult(size_t index, const SimpleClient::Response &response);
+
+private:
+
+    SimpleClient &client;
+
+    QObject *context;
+
+    RateLimiter &rateLimiter;
+
+    const size_t windowSize;
+
+    std::string printedName;
+
+    std::vector<QUrl> urls;
+
+    QString message;
+
+    milliseconds timeout;
+
+    ResultCallback resultCallback;
+
+    FinishCallback finishCallback;
+
+    size_t nextIndex = 0;
+
+    size_t countInFlight = 0;
+
+    size_t countFinished = 0;
+
+    bool isWaitRate = false;
+
+    bool isFinished = false;
+
+    Timer timer;
+
+};
+
+} // namespace nslookup
+
+#endif // PINGWINDOW_H
@@ -0,0 +1,135 @@
+#include "ServerSelector.h"
+
+#include <QUrl>
+
+#include <algorithm>
+
+#include "check.h"
+
+namespace nslookup {
+
+static const double EWMA_ALPHA = 0.3;
+
+static const double MAX_ERROR_RATE = 0.95;
+
+static const size_t POOL_MULTIPLIER = 2;
+
+static const hours STAT_EXPIRE = 1h;
+
+static QString normalizeAddress(const QString &address) {
+    if (!address.startsWith("http")) {
+        return address;
+    }
+    const QUrl url(address);
+    const int defaultPort = url.scheme() == "https" ? 443 : 80;
+    return url.host() + ":" + QString::number(url.port(defaultPort));
+}
+
+ServerSelector::ServerSelector()
+    : gen(std::random_device()())
+{}
+
+void ServerSelector::addResult(const QString &server, const milliseconds &time, bool isError) {
+    ServerStat &stat = stats[normalizeAddress(server)];
+    if (isError) {
+        stat.errorRate = EWMA_ALPHA + (1. - EWMA_ALPHA) * stat.errorRate;
+    } else {
+        stat.errorRate = (1. - EWMA_ALPHA) * stat.errorRate;
+        const double timeMs = time.count();
+        if (stat.countSamples == 0) {
+            stat.latencyMs = timeMs;
+        } else {
+            stat.latencyMs = EWMA_ALPHA * timeMs + (1. - EWMA_ALPHA) * stat.latencyMs;
+        }
+        stat.countSamples++;
+    }
+    stat.lastUpdate = ::now();
+}
+
+void ServerSelector::clear() {
+    stats.clear();
+}
+
+void ServerSelector::decayOld(const time_point &now) {
+    for (auto iter = stats.begin(); iter != stats.end();) {
+        if (now - iter->second.lastUpdate >= STAT_EXPIRE) {
+            iter = stats.erase(iter);
+        } else {
+            iter++;
+        }
+    }
+}
+
+const ServerSelector::ServerStat* ServerSelector::findStat(const NodeInfo &node) const {
+    const auto found = stats.find(normalizeAddress(node.address));
+    if (found == stats.end()) {
+        return nullptr;
+    }
+    return &found->second;
+}
+
+double ServerSelector::pingToLatencyRatio(const std::vector<NodeInfo> &nodes) const {
+    double sum = 0.;
+    size_t count = 0;
+    for (const NodeInfo &node: nodes) {
+        const ServerStat *stat = findStat(node);
+        if (stat != nullptr && stat->countSamples != 0 && node.ping.count() > 0) {
+            sum += stat->latencyMs / node.ping.count();
+            count++;
+        }
+    }
+    if (count == 0) {
+        return 1.;
+    }
+    return sum / count;
+}
+
+double ServerSelector::score(const NodeInfo &node, double pingRatio) const {
+    // Пинг и задержка полного запроса в разных масштабах, поэтому пинг приводится к задержке запроса
+    double latency = node.ping.count() * pingRatio;
+    double errorRate = 0.;
+    const ServerStat *stat = findStat(node);
+    if (stat != nullptr) {
+        if (stat->countSamples != 0) {
+            latency = stat->latencyMs;
+        }
+        errorRate = std::min(stat->errorRate, MAX_ERROR_RATE);
+    }
+    return (latency + 1.) / (1. - errorRate);
+}
+
+std::vector<NodeInfo> ServerSelector::select(const std::vector<NodeInfo> &nodes, size_t limit, size_t count) {
+    CHECK(count <= limit, "Incorrect count value");
+
+    decayOld(::now());
+
+    const double pingRatio = pingToLatencyRatio(nodes);
+    std::vector<std::pair<double, size_t>> scored;
+    scored.reserve(nodes.size());
+    for (size_t i = 0; i < nodes.size(); i++) {
+        scored.emplace_back(score(nodes[i], pingRatio), i);
+    }
+    std::stable_sort(scored.begin(), scored.end(), [](const auto &first, const auto &second) {
+        return first.first < second.first;
+    });
+    scored.resize(std::min(scored.size(), limit * POOL_MULTIPLIER));
+
+    std::vector<NodeInfo> result;
+    while (result.size() < count && !scored.empty()) {
+        size_t chosen = 0;
+        if (scored.size() > 1) {
+            std::uniform_int_distribution<size_t> dist(0, scored.size() - 1);
+            const size_t first = dist(gen);
+            size_t second = dist(gen);
+            while (second == first) {
+                second = dist(gen);
+            }
+            chosen = scored[first].first <= scored[second].first ? first : second;
+        }
+        result.emplace_back(nodes[scored[chosen].second]);
+        scored.erase(scored.begin() + chosen);
+    }
+    return result;
+}
+
+} // namespace nslookup
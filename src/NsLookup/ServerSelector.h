@@ -0,0 +1,63 @@
+#ifndef SERVERSELECTOR_H
+#define SERVERSELECTOR_H
+
+#include <QString>
+
+#include <map>
+#include <vector>
+#include <random>
+
+#include "duration.h"
+
+#include "NsLookupStructs.h"
+
+namespace nslookup {
+
+/*
+   Выбор серверов с учетом реального трафика.
+   Для каждого сервера хранится экспоненциально сглаженная задержка и доля ошибок,
+   выбор делается по схеме power of two choices среди лучших кандидатов.
+   */
+class ServerSelector {
+private:
+
+    struct ServerStat {
+        double latencyMs = 0.;
+        double errorRate = 0.;
+        size_t countSamples = 0;
+        time_point lastUpdate;
+    };
+
+public:
+
+    ServerSelector();
+
+    void addResult(const QString &server, const milliseconds &time, bool isError);
+
+    // nodes должны быть без таймаутов и отсортированы по результатам пинга
+    std::vector<NodeInfo> select(const std::vector<NodeInfo> &nodes, size_t limit, size_t count);
+
+    void clear();
+
+private:
+
+    const ServerStat* findStat(const NodeInfo &node) const;
+
+    // Среднее отношение задержки запроса к пингу по серверам с трафиком
+    double pingToLatencyRatio(const std::vector<NodeInfo> &nodes) const;
+
+    double score(const NodeInfo &node, double pingRatio) const;
+
+    void decayOld(const time_point &now);
+
+private:
+
+    std::map<QString, ServerStat> stats;
+
+    std::mt19937 gen;
+
+};
+
+} // namespace nslookup
+
+#endif // SERVERSELECTOR_H
@@ -400,6 +400,28 @@ QString PagesMappings::getIp(const QString &text, const std::set<QString> &exclu
     return ip;
 }
 
+std::vector<QString> PagesMappings::getIps(const QString &text, const std::set<QString> &excludes, size_t count) const {
+    const PageInfo pageInfo = find(text);
+    if (pageInfo.ips.empty()) {
+        if (defaultMhIp.isEmpty() || excludes.find(QUrl(defaultMhIp).host()) != excludes.end()) {
+            return {};
+        }
+        return {defaultMhIp};
+    }
+    return pageInfo.getIps(excludes, count);
+}
+
+void PagesMappings::setDefaultIp(const QString &text, const QString &host) {
+    const PageInfo pageInfo = find(text);
+    const auto foundIp = std::find_if(pageInfo.ips.begin(), pageInfo.ips.end(), [&host](const QString &ip) {
+        return QUrl(ip).host() == host;
+    });
+    if (foundIp == pageInfo.ips.end()) {
+        return;
+    }
+    setDefaultIpPage(pageInfo.printedName, *foundIp);
+}
+
 PageInfo PagesMappings::find(const QString &text) const {
     auto isFullUrl = [](const QString &text) {
         if (text.size() != 52) {
@@ -455,3 +477,23 @@ QString PageInfo::getIp(const std::set<QString> &excludes) const {
 
     return  ::getRandom(copyIps);;
 }
+
+std::vector<QString> PageInfo::getIps(const std::set<QString> &excludes, size_t count) const {
+    std::vector<QString> result;
+    if (!defaultIp.isEmpty() && excludes.find(QUrl(defaultIp).host()) == excludes.end()) {
+        result.emplace_back(defaultIp);
+    }
+    std::vector<QString> copyIps = ips;
+    copyIps.erase(std::remove_if(copyIps.begin(), copyIps.end(), [this, &excludes](const QString &element) {
+        return element == defaultIp || excludes.find(QUrl(element).host()) != excludes.end();
+    }), copyIps.end());
+
+    const std::vector<QString> randomIps = ::getRandom<QString>(copyIps, copyIps.size(), copyIps.size(), [](const QString &element) {return element;});
+    for (const QString &ip: randomIps) {
+        if (result.size() >= count) {
+            break;
+        }
+        result.emplace_back(ip);
+    }
+    return result;
+}
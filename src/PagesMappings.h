@@ -56,6 +56,9 @@ struct PageInfo {
     std::vector<QString> ips;
     QString getIp(const std::set<QString> &excludes) const;
 
+    // Ip по умолчанию идет первым, остальные в случайном порядке
+    std::vector<QString> getIps(const std::set<QString> &excludes, size_t count) const;
+
     void changeDefaultIp(const QString &ip);
 
     PageInfo() = default;
@@ -122,6 +125,11 @@ public:
 
     QString getIp(const QString &text, const std::set<QString> &excludes={});
 
+    std::vector<QString> getIps(const QString &text, const std::set<QString> &excludes, size_t count) const;
+
+    // Делает ip с хостом host ip по умолчанию для страницы text, если он есть в ее списке
+    void setDefaultIp(const QString &text, const QString &host);
+
     static QString getHost(const QString &url);
 
 private:
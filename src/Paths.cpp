@@ -47,6 +47,10 @@ const static QString TORDATA_PATH = QLatin1String("data/");
 
 const static QString TORCONFIG_NAME = QLatin1String("torrc");
 
+const static QString HTTP_CACHE_PATH = "httpcache/";
+
+const static QString WALLETS_CATALOGUE_NAME = "wallets_catalogue.dat";
+
 static bool isInitializePagesPath = false;
 
 static bool isInitializeSettingsPath = false;
@@ -255,6 +259,18 @@ QString getTorDataPath()
     return res;
 }
 
+QString getHttpCachePath() {
+    const QString res = makePath(getCommonMetagatePath(), HTTP_CACHE_PATH);
+    createFolder(res);
+    return res;
+}
+
+QString getWalletsCataloguePath() {
+    const QString res = getCommonMetagatePath();
+    createFolder(res);
+    return makePath(res, WALLETS_CATALOGUE_NAME);
+}
+
 void clearAutoupdatersPath() {
     auto remove = [](const QString &dirPath) {
         QDir dir(dirPath);
@@ -33,6 +33,10 @@ QString getTorConfigPath();
 
 QString getTorDataPath();
 
+QString getHttpCachePath();
+
+QString getWalletsCataloguePath();
+
 void clearAutoupdatersPath();
 
 void initializeAllPaths();
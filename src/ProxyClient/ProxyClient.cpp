@@ -18,6 +18,8 @@ SET_LOG_NAMESPACE("PXC");
 
 namespace proxy_client {
 
+static const milliseconds REQUEST_TIMEOUT = 10s;
+
 ProxyClient::ProxyClient(metagate::MetaGate &metagate, QObject *parent)
     : TimerClass(20s, parent)
     , proxyClient(new LocalClient(getLocalServerPath(), this))
@@ -86,7 +88,7 @@ BEGIN_SLOT_WRAPPER
             });
             callback.emitFunc(exception, status);
             END_SLOT_WRAPPER
-        });
+        }, REQUEST_TIMEOUT, true);
     }, callback);
 END_SLOT_WRAPPER
 }
@@ -102,7 +104,7 @@ BEGIN_SLOT_WRAPPER
                 CHECK_TYPED(!result.error, TypeErrors::PROXY_RESTART_ERROR, result.text.toStdString());
             });
             callback.emitFunc(exception);
-        });
+        }, REQUEST_TIMEOUT, false);
     }, callback);
 END_SLOT_WRAPPER
 }
@@ -126,7 +128,7 @@ BEGIN_SLOT_WRAPPER
                 CHECK_TYPED(!response.exception.isSet(), TypeErrors::PROXY_SERVER_ERROR, response.exception.toString());
                 const ProxyResponse result = parseProxyResponse(response.response);
                 CHECK_TYPED(!result.error, TypeErrors::PROXY_RESTART_ERROR, result.text.toStdString());
-    });
+    }, REQUEST_TIMEOUT, false);
 END_SLOT_WRAPPER
 }
 
@@ -163,7 +165,7 @@ BEGIN_SLOT_WRAPPER
                 LOG << "Proxy status changed: " << mhProxyActive;
             }
         }
-    });
+    }, REQUEST_TIMEOUT, true);
 END_SLOT_WRAPPER
 }
 
@@ -6,6 +6,7 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QSettings>
+#include <QTimer>
 
 #include "Log.h"
 #include "qt_utilites/QRegister.h"
@@ -37,6 +38,11 @@ const QString WALLET_CURRENCY_MTH = "mth";
 const QString WALLET_CURRENCY_BTC = "btc";
 const QString WALLET_CURRENCY_ETH = "eth";
 
+static const QString WSS_TAG = "wallet_names";
+static const QString WSS_TAG_SET_WALLETS = "wallet_names_set_wallets_";
+
+static const milliseconds WSS_RESEND_TIMEOUT = 10s;
+
 WalletNames::WalletNames(WalletNamesDbStorage &db, auth::Auth &authManager, WebSocketClient &client, wallets::Wallets &wallets)
     : TimerClass(5min, nullptr)
     , db(db)
@@ -50,6 +56,7 @@ WalletNames::WalletNames(WalletNamesDbStorage &db, auth::Auth &authManager, WebS
     timeout = seconds(settings.value("timeouts_sec/uploader").toInt());
 
     Q_CONNECT(&client, &WebSocketClient::messageReceived, this, &WalletNames::onWssMessageReceived);
+    Q_CONNECT(&client, &WebSocketClient::sendFailed, this, &WalletNames::onWssSendFailed);
     Q_CONNECT(&authManager, &auth::Auth::logined2, this, &WalletNames::onLogined);
 
     Q_CONNECT(this, &WalletNames::addOrUpdateWallets, this, &WalletNames::onAddOrUpdateWallets);
@@ -102,7 +109,7 @@ void WalletNames::getAllWallets() {
     LOG << "Sync wallets2";
     const QString message = makeGetWalletsMessage(id.get(), token, hwid);
     stateRequest = StateRequest::Requested;
-    emit client.sendMessage(message);
+    emit client.sendMessageTagged(message, WSS_TAG, WebSocketClient::QueuePolicy::Keep);
 }
 
 void WalletNames::getAllWalletsApps() {
@@ -160,7 +167,7 @@ BEGIN_SLOT_WRAPPER
         if (stateRequest == StateRequest::Requested) {
             stateRequest = StateRequest::Intercepted;
         }
-        emit client.sendMessage(message);
+        emit client.sendMessageTagged(message, WSS_TAG, WebSocketClient::QueuePolicy::Keep);
 
         const QString message2 = makeRenameMessageHttp(address, name, WALLET_CURRENCY_MTH, id.get(), token, hwid);
         emit httpClient.sendMessagePost(serverName, message2, [](const SimpleClient::Response &response) {
@@ -337,13 +344,27 @@ void WalletNames::sendAllWallets() {
         emit wallets.getListWallets(type, wallets::Wallets::WalletsListCallback([this, type, processWallets](const QString &userName, const std::vector<wallets::WalletInfo> &walletAddresses) mutable {
             const std::vector<WalletInfo> wallets = processWallets(type, userName, walletAddresses);
             const QString message = makeSetWalletsMessage(wallets, id.get(), token, hwid);
-            client.sendMessage(message);
+            // При частых обновлениях в очереди остается только последний список кошельков этого типа
+            emit client.sendMessageTagged(message, WSS_TAG_SET_WALLETS + walletCurrencyToStr(type), WebSocketClient::QueuePolicy::KeepLast);
         }, [](const TypedException &e) {
             LOG << "Error: " << e.description;
         }, signalFunc));
     }
 }
 
+void WalletNames::onWssSendFailed(QString message, QString tag, const TypedException &exception) {
+BEGIN_SLOT_WRAPPER
+    if (!tag.startsWith(WSS_TAG)) {
+        return;
+    }
+    LOG << "Wss send failed " << tag << " " << exception.description << ". Resend";
+    const WebSocketClient::QueuePolicy policy = tag.startsWith(WSS_TAG_SET_WALLETS) ? WebSocketClient::QueuePolicy::KeepLast : WebSocketClient::QueuePolicy::Keep;
+    QTimer::singleShot(WSS_RESEND_TIMEOUT.count(), this, [this, message, tag, policy]{
+        emit client.sendMessageTagged(message, tag, policy);
+    });
+END_SLOT_WRAPPER
+}
+
 void WalletNames::onWssMessageReceived(QString message) {
 BEGIN_SLOT_WRAPPER
     const QJsonDocument messageJson = QJsonDocument::fromJson(message.toUtf8());
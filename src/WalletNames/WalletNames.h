@@ -82,6 +82,8 @@ private slots:
 
     void onWssMessageReceived(QString message);
 
+    void onWssSendFailed(QString message, QString tag, const TypedException &exception);
+
     void onLogined(bool isInit, const QString &login, const QString &token);
 
 private slots:
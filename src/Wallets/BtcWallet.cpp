@@ -6,6 +6,7 @@
 
 #include "check.h"
 #include "utilites/utils.h"
+#include "utilites/LockedMemory.h"
 #include "Log.h"
 
 const std::string BtcWallet::PREFIX_ONE_KEY = "btc:";
@@ -116,6 +117,11 @@ BtcWallet::BtcWallet(const std::string &decryptedWif)
     CHECK_TYPED(decryptedWif.substr(0, 2) != "6P", TypeErrors::PRIVATE_KEY_ERROR, "Incorrect encrypted wif");
 }
 
+BtcWallet::~BtcWallet() {
+    // wif уходит в btctx как std::string, поэтому не закреплен в памяти, но затирается
+    secureZeroMemory(&wif[0], wif.size());
+}
+
 const std::string& BtcWallet::getAddress() const {
     return address;
 }
@@ -292,27 +298,36 @@ std::string BtcWallet::calcHashNotWitness(const std::string &txHex) {
     return toHex(calcHashTxNotWitness(fromHex(txHex)));
 }
 
+bool BtcWallet::getWalletInfoFromFile(const QString &folder, const QString &file, wallets::WalletInfo &info) {
+    try {
+        const std::string address = getWifAndAddress(folder, file.toStdString(), true).second;
+        if (address.empty()) {
+            return false;
+        }
+        if (!isAddressBase56(address)) {
+            return false;
+        }
+        info = wallets::WalletInfo(QString::fromStdString(address), getFullPath(folder, address), wallets::WalletInfo::Type::Key);
+        return true;
+    } catch (const TypedException &error) {
+        LOG << "Error: " << file << " " << error.description;
+    } catch (const Exception &e) {
+        LOG << "Error: " << file << " " << e;
+    } catch (...) {
+        LOG << "Error: " << file << " " << " Unknown error";
+    }
+    return false;
+}
+
 std::vector<std::pair<QString, QString>> BtcWallet::getAllWalletsInFolder(const QString &folder) {
     std::vector<std::pair<QString, QString>> result;
 
     const QDir dir(makePath(folder, FOLDER));
     const QStringList allFiles = dir.entryList(QDir::NoDotAndDotDot | QDir::System | QDir::Hidden  | QDir::AllDirs | QDir::Files, QDir::DirsFirst);
     for (const QString &file: allFiles) {
-        try {
-            const std::string address = getWifAndAddress(folder, file.toStdString(), true).second;
-            if (address.empty()) {
-                continue;
-            }
-            if (!isAddressBase56(address)) {
-                continue;
-            }
-            result.emplace_back(QString::fromStdString(address), getFullPath(folder, address));
-        } catch (const TypedException &error) {
-            LOG << "Error: " << file << " " << error.description;
-        } catch (const Exception &e) {
-            LOG << "Error: " << file << " " << e;
-        } catch (...) {
-            LOG << "Error: " << file << " " << " Unknown error";
+        wallets::WalletInfo info;
+        if (getWalletInfoFromFile(folder, file, info)) {
+            result.emplace_back(info.address, info.path);
         }
     }
 
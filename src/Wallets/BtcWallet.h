@@ -7,6 +7,8 @@
 
 #include <QString>
 
+#include "WalletInfo.h"
+
 struct BtcInput {
     std::string spendtxid;
     uint32_t spendoutnum;
@@ -42,6 +44,8 @@ public:
 
     BtcWallet(const std::string &decryptedWif);
 
+    ~BtcWallet();
+
     std::string genTransaction(const std::vector<BtcInput> &inputs, uint64_t transferAmount, uint64_t fee, const std::string &receiveAddress, bool isTestnet);
 
     static std::vector<BtcInput> reduceInputs(const std::vector<BtcInput> &inputs, const std::set<std::string> &usedTxs);
@@ -58,6 +62,9 @@ public:
 
     static std::vector<std::pair<QString, QString>> getAllWalletsInFolder(const QString &folder);
 
+    // Разбор одного файла из папки кошельков. false, если файл не является ключом
+    static bool getWalletInfoFromFile(const QString &folder, const QString &fileName, wallets::WalletInfo &info);
+
     const std::string& getAddress() const;
 
     static std::string getOneKey(const QString &folder, const std::string &address);
@@ -82,25 +82,34 @@ std::string EthWallet::genPrivateKey(const QString &folder, const std::string &p
     return address;
 }
 
+bool EthWallet::getWalletInfoFromFile(const QString &folder, const QString &file, wallets::WalletInfo &info) {
+    try {
+        const std::string fileName = file.toStdString();
+        if (isHex(fileName)) {
+            const std::string addressPart = fileName.substr(2);
+            const std::string address = "0x" + MixedCaseEncoding(HexStringToDump(addressPart));
+            info = wallets::WalletInfo(QString::fromStdString(address), getFullPath(folder, address), wallets::WalletInfo::Type::Key);
+            return true;
+        }
+    } catch (const TypedException &error) {
+        LOG << "Error: " << file << " " << error.description;
+    } catch (const Exception &e) {
+        LOG << "Error: " << file << " " << e;
+    } catch (...) {
+        LOG << "Error: " << file << " " << " Unknown error";
+    }
+    return false;
+}
+
 std::vector<std::pair<QString, QString>> EthWallet::getAllWalletsInFolder(const QString &folder) {
     std::vector<std::pair<QString, QString>> result;
 
     const QDir dir(makePath(folder, ::FOLDER));
     const QStringList allFiles = dir.entryList(QDir::NoDotAndDotDot | QDir::System | QDir::Hidden  | QDir::AllDirs | QDir::Files, QDir::DirsFirst);
     for (const QString &file: allFiles) {
-        try {
-            const std::string fileName = file.toStdString();
-            if (isHex(fileName)) {
-                const std::string addressPart = fileName.substr(2);
-                const std::string address = "0x" + MixedCaseEncoding(HexStringToDump(addressPart));
-                result.emplace_back(QString::fromStdString(address), getFullPath(folder, address));
-            }
-        } catch (const TypedException &error) {
-            LOG << "Error: " << file << " " << error.description;
-        } catch (const Exception &e) {
-            LOG << "Error: " << file << " " << e;
-        } catch (...) {
-            LOG << "Error: " << file << " " << " Unknown error";
+        wallets::WalletInfo info;
+        if (getWalletInfoFromFile(folder, file, info)) {
+            result.emplace_back(info.address, info.path);
         }
     }
 
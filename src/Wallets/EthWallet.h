@@ -6,6 +6,9 @@
 
 #include <QString>
 
+#include "WalletInfo.h"
+#include "utilites/LockedMemory.h"
+
 class EthWallet {
 public:
 
@@ -48,6 +51,9 @@ public:
 
     static std::vector<std::pair<QString, QString>> getAllWalletsInFolder(const QString &folder);
 
+    // Разбор одного файла из папки кошельков. false, если файл не является ключом
+    static bool getWalletInfoFromFile(const QString &folder, const QString &fileName, wallets::WalletInfo &info);
+
     static std::string makeErc20Data(const std::string &valueHex, const std::string &address);
 
     static std::string getOneKey(const QString &folder, const std::string &address);
@@ -62,7 +68,7 @@ private:
 
 private:
 
-    std::vector<uint8_t> rawprivkey;
+    SecureBytes rawprivkey;
 
     std::string address;
 
@@ -0,0 +1,194 @@
+#include "KeysImporter.h"
+
+#include <algorithm>
+
+#include "check.h"
+#include "Log.h"
+#include "utilites/utils.h"
+
+SET_LOG_NAMESPACE("WLTS");
+
+namespace wallets {
+
+static const size_t PROGRESS_STEP = 100;
+
+static std::vector<QString> listFiles(const QString &path) {
+    std::vector<QString> result;
+    if (isDirectory(path)) {
+        const QStringList files = getFilesForDir(path);
+        result.reserve(files.size());
+        for (const QString &fileName: files) {
+            result.emplace_back(makePath(path, fileName));
+        }
+    } else {
+        result.emplace_back(path);
+    }
+    return result;
+}
+
+KeysImporter::KeysImporter(size_t countThreads, size_t minFilesForParallel)
+    : minFilesForParallel(minFilesForParallel)
+{
+    CHECK(countThreads != 0, "Incorrect count threads");
+    threads.reserve(countThreads);
+    for (size_t i = 0; i < countThreads; i++) {
+        threads.emplace_back(&KeysImporter::work, this);
+    }
+}
+
+KeysImporter::~KeysImporter() {
+    {
+        std::lock_guard<std::mutex> lock(mut);
+        isStopped = true;
+        queue.clear();
+    }
+    cond.notify_all();
+    for (std::thread &thread: threads) {
+        thread.join();
+    }
+}
+
+void KeysImporter::run(const QString &path, const CheckFunc &check, const ProcessFunc &process, const ProgressFunc &progress, const FinishFunc &finish) {
+    const std::shared_ptr<Job> job = std::make_shared<Job>();
+    job->path = path;
+    job->check = check;
+    job->process = process;
+    job->progress = progress;
+    job->finish = finish;
+    {
+        std::lock_guard<std::mutex> lock(mut);
+        queue.push_back(Task{job, true});
+    }
+    cond.notify_one();
+}
+
+KeysImporter::Summary KeysImporter::runSerial(const QString &path, const CheckFunc &check, const ProcessFunc &process, std::vector<QString> &keys) {
+    const std::vector<QString> files = listFiles(path);
+    Summary summary;
+    summary.countFiles = files.size();
+    for (const QString &filePath: files) {
+        if (check(filePath)) {
+            keys.emplace_back(process(filePath));
+        }
+    }
+    summary.countKeys = keys.size();
+    return summary;
+}
+
+void KeysImporter::work() {
+    while (true) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(mut);
+            cond.wait(lock, [this]{
+                return isStopped || !queue.empty();
+            });
+            if (isStopped) {
+                return;
+            }
+            task = queue.front();
+            queue.pop_front();
+        }
+
+        if (task.isList) {
+            startJob(task.job);
+        } else {
+            processJob(*task.job);
+            if (--task.job->activeWorkers == 0) {
+                finishJob(*task.job);
+            }
+        }
+    }
+}
+
+void KeysImporter::startJob(const std::shared_ptr<Job> &job) {
+    try {
+        job->files = listFiles(job->path);
+    } catch (...) {
+        job->exception = std::current_exception();
+        finishJob(*job);
+        return;
+    }
+    job->isKeys.resize(job->files.size(), 0);
+    job->results.resize(job->files.size());
+
+    // На маленьких папках запуск потоков дороже самой проверки
+    size_t countWorkers = 1;
+    if (job->files.size() >= minFilesForParallel) {
+        countWorkers = std::max(size_t(1), std::min(threads.size(), job->files.size()));
+    }
+    job->activeWorkers = countWorkers;
+    if (countWorkers > 1) {
+        {
+            std::lock_guard<std::mutex> lock(mut);
+            for (size_t i = 1; i < countWorkers; i++) {
+                queue.push_back(Task{job, false});
+            }
+        }
+        cond.notify_all();
+    }
+
+    processJob(*job);
+    if (--job->activeWorkers == 0) {
+        finishJob(*job);
+    }
+}
+
+void KeysImporter::processJob(Job &job) {
+    while (!job.isFailed.load() && !isStopped.load()) {
+        const size_t index = job.next++;
+        if (index >= job.files.size()) {
+            break;
+        }
+        try {
+            const QString &filePath = job.files[index];
+            if (job.check(filePath)) {
+                job.results[index] = job.process(filePath);
+                job.isKeys[index] = 1;
+            }
+            reportProgress(job, ++job.processed);
+        } catch (...) {
+            bool expected = false;
+            if (job.isFailed.compare_exchange_strong(expected, true)) {
+                job.exception = std::current_exception();
+            }
+        }
+    }
+}
+
+void KeysImporter::reportProgress(Job &job, size_t processed) {
+    const size_t total = job.files.size();
+    if (processed % PROGRESS_STEP != 0 && processed != total) {
+        return;
+    }
+    // Потоки приходят сюда не по порядку, назад прогресс не откатывается
+    std::lock_guard<std::mutex> lock(job.progressMut);
+    if (processed <= job.reportedProgress) {
+        return;
+    }
+    job.reportedProgress = processed;
+    job.progress(processed, total);
+}
+
+void KeysImporter::finishJob(Job &job) {
+    if (isStopped.load()) {
+        return;
+    }
+    if (job.exception != nullptr) {
+        job.finish(Summary(), {}, job.exception);
+        return;
+    }
+    std::vector<QString> keys;
+    for (size_t i = 0; i < job.files.size(); i++) {
+        if (job.isKeys[i] != 0) {
+            keys.emplace_back(job.results[i]);
+        }
+    }
+    Summary summary;
+    summary.countFiles = job.files.size();
+    summary.countKeys = keys.size();
+    LOG << "Keys imported " << job.path << " " << summary.countKeys << " of " << summary.countFiles;
+    job.finish(summary, keys, nullptr);
+}
+
+} // namespace wallets
@@ -0,0 +1,115 @@
+#ifndef KEYSIMPORTER_H
+#define KEYSIMPORTER_H
+
+#include <QString>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace wallets {
+
+/*
+   Импорт ключей из папки в пуле потоков.
+   Один поток пула читает папку, затем файлы проверяются и копируются всеми потоками.
+   Маленькие папки и одиночный файл обрабатываются одним потоком.
+   Поток Wallets только ставит задачу, progress и finish вызываются из потоков пула
+   */
+class KeysImporter {
+public:
+
+    struct Summary {
+        // Файлов в папке
+        size_t countFiles = 0;
+        // Из них ключей
+        size_t countKeys = 0;
+    };
+
+    // Является ли файл ключом
+    using CheckFunc = std::function<bool(const QString &filePath)>;
+
+    // Обработка ключа. Возвращает имя ключа для итогового списка
+    using ProcessFunc = std::function<QString(const QString &filePath)>;
+
+    using ProgressFunc = std::function<void(size_t processed, size_t total)>;
+
+    // keys в порядке файлов в папке. При ошибке error не пустой, остальные поля не заполнены
+    using FinishFunc = std::function<void(const Summary &summary, const std::vector<QString> &keys, const std::exception_ptr &error)>;
+
+public:
+
+    KeysImporter(size_t countThreads, size_t minFilesForParallel);
+
+    ~KeysImporter();
+
+    void run(const QString &path, const CheckFunc &check, const ProcessFunc &process, const ProgressFunc &progress, const FinishFunc &finish);
+
+    // Однопоточный путь в вызывающем потоке
+    static Summary runSerial(const QString &path, const CheckFunc &check, const ProcessFunc &process, std::vector<QString> &keys);
+
+private:
+
+    struct Job {
+        QString path;
+        CheckFunc check;
+        ProcessFunc process;
+        ProgressFunc progress;
+        FinishFunc finish;
+
+        std::vector<QString> files;
+        std::vector<char> isKeys;
+        std::vector<QString> results;
+
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> processed{0};
+        std::atomic<size_t> activeWorkers{0};
+        std::atomic<bool> isFailed{false};
+        std::exception_ptr exception;
+
+        std::mutex progressMut;
+        size_t reportedProgress = 0;
+    };
+
+    struct Task {
+        std::shared_ptr<Job> job;
+        // Задача чтения папки, иначе место одного потока в обработке файлов
+        bool isList;
+    };
+
+private:
+
+    void work();
+
+    void startJob(const std::shared_ptr<Job> &job);
+
+    void processJob(Job &job);
+
+    void finishJob(Job &job);
+
+    void reportProgress(Job &job, size_t processed);
+
+private:
+
+    const size_t minFilesForParallel;
+
+    std::vector<std::thread> threads;
+
+    std::mutex mut;
+
+    std::condition_variable cond;
+
+    std::deque<Task> queue;
+
+    std::atomic<bool> isStopped{false};
+
+};
+
+} // namespace wallets
+
+#endif // KEYSIMPORTER_H
@@ -20,6 +20,7 @@
 #include "ethtx/utils2.h"
 #include "ethtx/rlp.h"
 #include "ethtx/cert.h"
+#include "ethtx/ethtx.h"
 
 #include "check.h"
 #include "Log.h"
@@ -41,6 +42,43 @@ const std::string PRIV_KEY_SUFFIX = "\n-----END EC PRIVATE KEY-----";
 const std::string COMPACT_FORMAT = "f:";
 const std::string CURRENT_COMPACT_FORMAT = "1";
 
+// SubjectPublicKeyInfo ключа secp256k1 перед несжатой точкой, как его кодирует CryptoPP
+const std::string PUBLIC_KEY_K1_PREFIX = "3056301006072A8648CE3D020106052B8104000A034200";
+
+const size_t PUBLIC_KEY_K1_SIZE = 65;
+
+static bool isSecp256k1(const CryptoPP::ECDSA<CryptoPP::ECP, CryptoPP::SHA256>::PrivateKey &privateKey) {
+    static const CryptoPP::DL_GroupParameters_EC<CryptoPP::ECP> secp256k1Params(CryptoPP::ASN1::secp256k1());
+    return privateKey.GetGroupParameters() == secp256k1Params;
+}
+
+static SecureBytes getRawPrivateKey(const CryptoPP::ECDSA<CryptoPP::ECP, CryptoPP::SHA256>::PrivateKey &privateKey) {
+    SecureBytes result(32, 0);
+    privateKey.GetPrivateExponent().Encode(result.data(), result.size());
+    return result;
+}
+
+// Несжатая точка 04 x y
+static std::string getPublicKeyBinaryK1(const SecureBytes &rawPrivateKey) {
+    secp256k1_pubkey pubkey;
+    CHECK_TYPED(secp256k1_ec_pubkey_create(getCtx(), &pubkey, rawPrivateKey.data()), TypeErrors::PRIVATE_KEY_ERROR, "Incorrect private key");
+    std::string result(PUBLIC_KEY_K1_SIZE, 0);
+    size_t size = result.size();
+    secp256k1_ec_pubkey_serialize(getCtx(), (unsigned char*)&result[0], &size, &pubkey, SECP256K1_EC_UNCOMPRESSED);
+    CHECK_TYPED(size == PUBLIC_KEY_K1_SIZE, TypeErrors::DONT_CREATE_KEY, "Incorrect public key size");
+    return result;
+}
+
+static std::string getPublicKeyK1(const SecureBytes &rawPrivateKey) {
+    return PUBLIC_KEY_K1_PREFIX + QString::fromStdString(toHex(getPublicKeyBinaryK1(rawPrivateKey))).toUpper().toStdString();
+}
+
+static std::string sha256(const std::string &message) {
+    std::string hash(CryptoPP::SHA256::DIGESTSIZE, 0);
+    CryptoPP::SHA256().CalculateDigest((byte*)&hash[0], (const byte*)message.data(), message.size());
+    return hash;
+}
+
 QString Wallet::chooseSubfolder(bool isMhc) {
     if (isMhc) {
         return WALLET_PATH_MTH;
@@ -58,6 +96,10 @@ QString Wallet::makeFullWalletWatchPath(const QString &folder, bool isMhc, const
 }
 
 static std::string getPublicKey(const CryptoPP::ECDSA<CryptoPP::ECP, CryptoPP::SHA256>::PrivateKey &privateKey) {
+    if (isSecp256k1(privateKey)) {
+        return getPublicKeyK1(getRawPrivateKey(privateKey));
+    }
+
     CryptoPP::ECDSA<CryptoPP::ECP, CryptoPP::SHA256>::PublicKey publicKey;
     privateKey.MakePublicKey(publicKey);
     publicKey.AccessGroupParameters().SetEncodeAsOID(true);
@@ -134,6 +176,10 @@ static std::string getPrivateKeyK1(const CryptoPP::ECDSA<CryptoPP::ECP, CryptoPP
 }
 
 static std::string getPublicKeyElements(const CryptoPP::ECDSA<CryptoPP::ECP, CryptoPP::SHA256>::PrivateKey &privateKey) {
+    if (isSecp256k1(privateKey)) {
+        return toHex(getPublicKeyBinaryK1(getRawPrivateKey(privateKey)));
+    }
+
     CryptoPP::ECDSA<CryptoPP::ECP, CryptoPP::SHA256>::PublicKey publicKey;
     privateKey.MakePublicKey(publicKey);
 
@@ -394,6 +440,30 @@ std::vector<std::pair<QString, QString>> Wallet::getAllWalletsInFolder(const QSt
     return result;
 }
 
+bool Wallet::getWalletInfoFromFile(const QString &folder, bool isMhc, const QString &fileName, wallets::WalletInfo &info) {
+    if (fileName.endsWith(FILE_METAHASH_PRIV_KEY_SUFFIX)) {
+        info.address = fileName.split(FILE_METAHASH_PRIV_KEY_SUFFIX).first();
+        const std::string address = info.address.toStdString();
+        if (address.size() != 52 || !isHex(address)) {
+            return false;
+        }
+        info.type = wallets::WalletInfo::Type::Key;
+        info.path = makeFullWalletPath(folder, isMhc, address);
+        return true;
+    }
+    if (fileName.endsWith(FILE_METAHASH_WATCH_SUFFIX)) {
+        info.address = fileName.split(FILE_METAHASH_WATCH_SUFFIX).first();
+        const std::string address = info.address.toStdString();
+        if (address.size() != 52 || !isHex(address)) {
+            return false;
+        }
+        info.type = wallets::WalletInfo::Type::Watch;
+        info.path = makeFullWalletPath(folder, isMhc, address); // ??? Watch?
+        return true;
+    }
+    return false;
+}
+
 std::vector<wallets::WalletInfo> Wallet::getAllWalletsInfoInFolder(const QString &folder, bool isMhc) {
     std::vector<wallets::WalletInfo> result;
 
@@ -401,24 +471,7 @@ std::vector<wallets::WalletInfo> Wallet::getAllWalletsInfoInFolder(const QString
     const QStringList allFiles = dir.entryList(QDir::NoDotAndDotDot | QDir::System | QDir::Hidden  | QDir::AllDirs | QDir::Files, QDir::DirsFirst);
     for (const QString &file: allFiles) {
         wallets::WalletInfo info;
-        if (file.endsWith(FILE_METAHASH_PRIV_KEY_SUFFIX)) {
-            info.address = file.split(FILE_METAHASH_PRIV_KEY_SUFFIX).first();
-            const std::string address = info.address.toStdString();
-            if (address.size() != 52 || !isHex(address)) {
-                continue;
-            }
-            info.type = wallets::WalletInfo::Type::Key;
-            info.path = makeFullWalletPath(folder, isMhc, address);
-            result.emplace_back(info);
-        }
-        if (file.endsWith(FILE_METAHASH_WATCH_SUFFIX)) {
-            info.address = file.split(FILE_METAHASH_WATCH_SUFFIX).first();
-            const std::string address = info.address.toStdString();
-            if (address.size() != 52 || !isHex(address)) {
-                continue;
-            }
-            info.type = wallets::WalletInfo::Type::Watch;
-            info.path = makeFullWalletPath(folder, isMhc, address); // ??? Watch?
+        if (getWalletInfoFromFile(folder, isMhc, file, info)) {
             result.emplace_back(info);
         }
     }
@@ -452,6 +505,11 @@ Wallet::Wallet(const QString &folder, bool isMhc, const std::string &name, const
         }
     }
 
+    if (isSecp256k1(privateKey)) {
+        rawPrivateKey = getRawPrivateKey(privateKey);
+    }
+    publicKeyHex = getPublicKey(privateKey);
+
     const std::string pubKeyElements = getPublicKeyElements(privateKey);
     const std::string pubKeyBinary = fromHex(pubKeyElements);
     const std::string hexAddr = createAddress(pubKeyBinary);
@@ -468,6 +526,18 @@ Wallet::Wallet(const QString &folder, bool isMhc, const std::string &name)
 
 std::string Wallet::sign(const std::string &message, std::string &publicKey) const {
     CHECK(type == wallets::WalletInfo::Type::Key, "Possible for wallet with key");
+    if (!rawPrivateKey.empty()) {
+        const std::string hash = sha256(message);
+        secp256k1_ecdsa_signature sig;
+        CHECK_TYPED(secp256k1_ecdsa_sign(getCtx(), &sig, (const unsigned char*)hash.data(), rawPrivateKey.data(), nullptr, nullptr), TypeErrors::DONT_SIGN, "secp256k1_ecdsa_sign error");
+        std::array<unsigned char, 72> der;
+        size_t derSize = der.size();
+        CHECK_TYPED(secp256k1_ecdsa_signature_serialize_der(getCtx(), der.data(), &derSize, &sig), TypeErrors::DONT_SIGN, "secp256k1_ecdsa_signature_serialize_der error");
+
+        publicKey = publicKeyHex;
+        return toHex(std::string((const char*)der.data(), derSize));
+    }
+
     try {
         CryptoPP::AutoSeededRandomPool prng;
         CryptoPP::ECDSA<CryptoPP::ECP, CryptoPP::SHA256>::Signer signer(privateKey);
@@ -478,14 +548,15 @@ std::string Wallet::sign(const std::string &message, std::string &publicKey) con
         siglen = signer.SignMessage(prng, (const byte*)message.data(), message.size(), (byte*)signature.data());
         signature.resize(siglen);
 
-        std::string signature2(signature.size() * 10, 0);
+        // Заголовок последовательности и два целых, каждое с возможным ведущим нулем
+        std::string signature2(signature.size() + 16, 0);
         const size_t resultSize = CryptoPP::DSAConvertSignatureFormat(
             (byte*)signature2.data(), signature2.size(), CryptoPP::DSASignatureFormat::DSA_DER,
             (const byte*)signature.data(), signature.size(), CryptoPP::DSASignatureFormat::DSA_P1363
         );
         signature2.resize(resultSize);
 
-        publicKey = getPublicKey(privateKey);
+        publicKey = publicKeyHex;
 
         return toHex(signature2);
     } catch (const std::exception &e) {
@@ -493,7 +564,38 @@ std::string Wallet::sign(const std::string &message, std::string &publicKey) con
     }
 }
 
+// -1, если ключ или подпись не разбираются libsecp256k1
+static int verifyK1(const std::string &message, const std::string &signatureBinary, const std::string &publicKey) {
+    if (publicKey.size() != PUBLIC_KEY_K1_PREFIX.size() + PUBLIC_KEY_K1_SIZE * 2 || toLower(publicKey.substr(0, PUBLIC_KEY_K1_PREFIX.size())) != toLower(PUBLIC_KEY_K1_PREFIX)) {
+        return -1;
+    }
+    const std::string publicKeyBinary = fromHex(publicKey.substr(PUBLIC_KEY_K1_PREFIX.size()));
+    secp256k1_pubkey pubkey;
+    if (!secp256k1_ec_pubkey_parse(getCtx(), &pubkey, (const unsigned char*)publicKeyBinary.data(), publicKeyBinary.size())) {
+        return -1;
+    }
+    secp256k1_ecdsa_signature sig;
+    if (!secp256k1_ecdsa_signature_parse_der(getCtx(), &sig, (const unsigned char*)signatureBinary.data(), signatureBinary.size())) {
+        return -1;
+    }
+    // CryptoPP подписывает без нормализации, а libsecp256k1 принимает только нижнюю половину s
+    secp256k1_ecdsa_signature_normalize(getCtx(), &sig, &sig);
+    const std::string hash = sha256(message);
+    return secp256k1_ecdsa_verify(getCtx(), &sig, (const unsigned char*)hash.data(), &pubkey) == 1 ? 1 : 0;
+}
+
 bool Wallet::verify(const std::string &message, const std::string &signature, const std::string &publicKey) {
+    try {
+        const int resultK1 = verifyK1(message, fromHex(signature), publicKey);
+        if (resultK1 != -1) {
+            return resultK1 == 1;
+        }
+    } catch (const std::exception &e) {
+        return false;
+    } catch (const TypedException &e) {
+        return false;
+    }
+
     try {
         const std::string signatureBinary = fromHex(signature);
 
@@ -8,6 +8,7 @@
 #include <cryptopp/eccrypto.h>
 
 #include "WalletInfo.h"
+#include "utilites/LockedMemory.h"
 
 class Wallet {
 public:
@@ -38,6 +39,9 @@ public:
 
     static std::vector<wallets::WalletInfo> getAllWalletsInfoInFolder(const QString &folder, bool isMhc);
 
+    // Разбор одного файла из папки кошельков. false, если файл не является ключом
+    static bool getWalletInfoFromFile(const QString &folder, bool isMhc, const QString &fileName, wallets::WalletInfo &info);
+
     static std::string getPrivateKey(const QString &folder, bool isMhc, const std::string &addr, bool isCompact);
 
     static std::string savePrivateKey(const QString &folder, bool isMhc, const std::string &data, const std::string &password);
@@ -94,6 +98,11 @@ private:
     wallets::WalletInfo::Type type;
     CryptoPP::ECDSA<CryptoPP::ECP, CryptoPP::SHA256>::PrivateKey privateKey;
 
+    // Для ключей secp256k1 подпись идет через libsecp256k1. Для остальных кривых пустой
+    SecureBytes rawPrivateKey;
+
+    std::string publicKeyHex;
+
     std::string name;
 
     QString fullPath;
@@ -2,6 +2,11 @@
 
 #include <QStandardPaths>
 
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+
 #include "qt_utilites/SlotWrapper.h"
 #include "qt_utilites/QRegister.h"
 #include "qt_utilites/ManagerWrapperImpl.h"
@@ -16,6 +21,7 @@
 #include "BtcWallet.h"
 #include "EthWallet.h"
 #include "WalletRsa.h"
+#include "KeysImporter.h"
 
 #include "Paths.h"
 
@@ -27,14 +33,27 @@
 
 #include "GetActualWalletsEvent.h"
 
+#include <cryptopp/osrng.h>
+#include <cryptopp/sha.h>
+#include <cryptopp/misc.h>
+
 SET_LOG_NAMESPACE("WLTS");
 
 namespace wallets {
 
+// Импорт упирается в диск, больше потоков не дает выигрыша
+static const size_t MAX_IMPORT_THREADS = 4;
+
+static const size_t MIN_FILES_FOR_PARALLEL_IMPORT = 32;
+
+const seconds Wallets::MAX_UNLOCK_TIME = 1h;
+
 Wallets::Wallets(auth::Auth &auth, utils::Utils &utils, QObject *parent)
     : TimerClass(5s, parent)
     , walletDefaultPath(getWalletPath())
     , utils(utils)
+    , catalogue(getWalletsCataloguePath())
+    , keysImporter(std::make_unique<KeysImporter>(std::max(size_t(1), std::min(size_t(std::thread::hardware_concurrency()), MAX_IMPORT_THREADS)), MIN_FILES_FOR_PARALLEL_IMPORT))
 {
     Q_CONNECT(&auth, &auth::Auth::logined2, this, &Wallets::onLogined);
     Q_CONNECT(&fileSystemWatcher, &QFileSystemWatcher::directoryChanged, this, &Wallets::onDirChanged);
@@ -52,6 +71,7 @@ Wallets::Wallets(auth::Auth &auth, utils::Utils &utils, QObject *parent)
     Q_CONNECT(this, &Wallets::createTokenAddress, this, &Wallets::onCreateTokenAddress);
     Q_CONNECT(this, &Wallets::signMessage, this, &Wallets::onSignMessage);
     Q_CONNECT(this, &Wallets::signMessage2, this, &Wallets::onSignMessage2);
+    Q_CONNECT(this, &Wallets::signMessages2, this, &Wallets::onSignMessages2);
     Q_CONNECT(this, &Wallets::signAndSendMessage, this, &Wallets::onSignAndSendMessage);
     Q_CONNECT(this, &Wallets::signAndSendMessageDelegate, this, &Wallets::onSignAndSendMessageDelegate);
     Q_CONNECT(this, &Wallets::getOnePrivateKey, this, &Wallets::onGetOnePrivateKey);
@@ -73,6 +93,7 @@ Wallets::Wallets(auth::Auth &auth, utils::Utils &utils, QObject *parent)
     Q_CONNECT(this, &Wallets::savePrivateKeyBtc, this, &Wallets::onSavePrivateKeyBtc);
     Q_CONNECT(this, &Wallets::getOnePrivateKeyBtc, this, &Wallets::onGetOnePrivateKeyBtc);
     Q_CONNECT(this, &Wallets::getWalletFolders, this, &Wallets::onGetWalletFolders);
+    Q_CONNECT(this, &Wallets::getWalletsState, this, &Wallets::onGetWalletsState);
     Q_CONNECT(this, &Wallets::backupKeys, this, &Wallets::onBackupKeys);
     Q_CONNECT(this, &Wallets::restoreKeys, this, &Wallets::onRestoreKeys);
     Q_CONNECT(this, &Wallets::openWalletPathInStandartExplorer, this, &Wallets::onOpenWalletPathInStandartExplorer);
@@ -82,6 +103,9 @@ Wallets::Wallets(auth::Auth &auth, utils::Utils &utils, QObject *parent)
     Q_CONNECT(this, &Wallets::calkKeysEth, this, &Wallets::onCalkKeysEth);
     Q_CONNECT(this, &Wallets::importKeysBtc, this, &Wallets::onImportKeysBtc);
     Q_CONNECT(this, &Wallets::calkKeysBtc, this, &Wallets::onCalkKeysBtc);
+    Q_CONNECT(this, &Wallets::unlockKey, this, &Wallets::onUnlockKey);
+    Q_CONNECT(this, &Wallets::lockKeys, this, &Wallets::onLockKeys);
+    Q_CONNECT(this, &Wallets::remainingUnlockTime, this, &Wallets::onRemainingUnlockTime);
 
     Q_REG(WalletsListCallback, "WalletsListCallback");
     Q_REG(wallets::WalletCurrency, "wallets::WalletCurrency");
@@ -97,6 +121,8 @@ Wallets::Wallets(auth::Auth &auth, utils::Utils &utils, QObject *parent)
     Q_REG(CreateTokenAddressCallback, "CreateTokenAddressCallback");
     Q_REG(wallets::Wallets::SignMessageCallback, "wallets::Wallets::SignMessageCallback");
     Q_REG(SignMessage2Callback, "SignMessage2Callback");
+    Q_REG(SignMessages2Callback, "SignMessages2Callback");
+    Q_REG2(std::vector<wallets::Wallets::TxToSign>, "std::vector<wallets::Wallets::TxToSign>", false);
     Q_REG(GettedNonceCallback, "GettedNonceCallback");
     Q_REG(SignAndSendMessageCallback, "SignAndSendMessageCallback");
     Q_REG(GetPrivateKeyCallback, "GetPrivateKeyCallback");
@@ -113,11 +139,18 @@ Wallets::Wallets(auth::Auth &auth, utils::Utils &utils, QObject *parent)
     Q_REG2(std::set<std::string>, "std::set<std::string>", false);
     Q_REG2(std::vector<BtcInput>, "std::vector<BtcInput>", false);
     Q_REG(GetWalletFoldersCallback, "GetWalletFoldersCallback");
+    Q_REG(GetWalletsStateCallback, "GetWalletsStateCallback");
+    Q_REG2(std::vector<wallets::WalletInfo>, "std::vector<wallets::WalletInfo>", false);
+    Q_REG2(size_t, "size_t", false);
     Q_REG(BackupKeysCallback, "BackupKeysCallback");
     Q_REG(RestoreKeysCallback, "RestoreKeysCallback");
     Q_REG(ImportKeysCallback, "ImportKeysCallback");
     Q_REG(CalkKeysCallback, "CalkKeysCallback");
     Q_REG2(WalletsList, "WalletsList", false);
+    Q_REG(UnlockKeyCallback, "UnlockKeyCallback");
+    Q_REG(LockKeysCallback, "LockKeysCallback");
+    Q_REG(RemainingUnlockTimeCallback, "RemainingUnlockTimeCallback");
+    Q_REG2(seconds, "seconds", false);
 
     emit auth.reEmit();
 
@@ -151,7 +184,7 @@ BEGIN_SLOT_WRAPPER
             const QString walletFullPath = wallet.getFullPath();
             created.emplace_back(addr, walletFullPath);
 
-            walletsList[isMhc ? WalletCurrency::Mth : WalletCurrency::Tmh][addr] = WalletInfo(addr, walletFullPath, WalletInfo::Type::Watch);
+            addToWalletsList(isMhc ? WalletCurrency::Mth : WalletCurrency::Tmh, WalletInfo(addr, walletFullPath, WalletInfo::Type::Watch));
         }
 
         if (!created.empty()) {
@@ -179,7 +212,7 @@ BEGIN_SLOT_WRAPPER
 
         const QString walletFullPath = wallet.getFullPath();
 
-        walletsList[isMhc ? WalletCurrency::Mth : WalletCurrency::Tmh][QString::fromStdString(addr)] = WalletInfo(QString::fromStdString(addr), walletFullPath, WalletInfo::Type::Key);
+        addToWalletsList(isMhc ? WalletCurrency::Mth : WalletCurrency::Tmh, WalletInfo(QString::fromStdString(addr), walletFullPath, WalletInfo::Type::Key));
 
         emit mhcWalletCreated(isMhc, QString::fromStdString(addr), userName);
 
@@ -198,7 +231,7 @@ BEGIN_SLOT_WRAPPER
 
         const QString walletFullPath = wallet.getFullPath();
 
-        walletsList[isMhc ? WalletCurrency::Mth : WalletCurrency::Tmh][address] = WalletInfo(address, walletFullPath, WalletInfo::Type::Watch);
+        addToWalletsList(isMhc ? WalletCurrency::Mth : WalletCurrency::Tmh, WalletInfo(address, walletFullPath, WalletInfo::Type::Watch));
 
         emit mhcWatchWalletCreated(isMhc, address, userName);
 
@@ -213,7 +246,7 @@ BEGIN_SLOT_WRAPPER
         CHECK(!walletPath.isEmpty(), "Incorrect path to wallet: empty");
         Wallet::removeWalletWatch(walletPath, isMhc, address.toStdString());
 
-        walletsList[isMhc ? WalletCurrency::Mth : WalletCurrency::Tmh].erase(address);
+        removeFromWalletsList(isMhc ? WalletCurrency::Mth : WalletCurrency::Tmh, address);
 
         emit mhcWatchWalletRemoved(isMhc, address, userName);
     }, callback);
@@ -280,9 +313,9 @@ void Wallets::onSignMessage(bool isMhc, const QString &address, const QString &t
 BEGIN_SLOT_WRAPPER
     runAndEmitCallback([&]{
         CHECK(!walletPath.isEmpty(), "Incorrect path to wallet: empty");
-        Wallet wallet(walletPath, isMhc, address.toStdString(), password.toStdString());
+        const std::shared_ptr<Wallet> wallet = getWallet(isMhc, address, password);
         std::string pubKey;
-        const QString signature = QString::fromStdString(wallet.sign(text.toStdString(), pubKey));
+        const QString signature = QString::fromStdString(wallet->sign(text.toStdString(), pubKey));
         const QString publicKey = QString::fromStdString(pubKey);
         return std::make_tuple(signature, publicKey);
     }, callback);
@@ -299,7 +332,7 @@ BEGIN_SLOT_WRAPPER
             realFee = "0";
         }
 
-        Wallet wallet(walletPath, isMhc, address.toStdString(), password.toStdString());
+        const std::shared_ptr<Wallet> wallet = getWallet(isMhc, address, password);
         std::string publicKey;
         std::string tx;
         std::string signature;
@@ -310,7 +343,7 @@ BEGIN_SLOT_WRAPPER
         CHECK(tmp, "Fee not valid");
         const uint64_t nonceInt = nonce.toULongLong(&tmp, 10);
         CHECK(tmp, "Nonce not valid");
-        wallet.sign(toAddress.toStdString(), valueInt, feeInt, nonceInt, dataHex.toStdString(), tx, signature, publicKey);
+        wallet->sign(toAddress.toStdString(), valueInt, feeInt, nonceInt, dataHex.toStdString(), tx, signature, publicKey);
         const QString publicKey2 = QString::fromStdString(publicKey);
         const QString tx2 = QString::fromStdString(tx);
         const QString signature2 = QString::fromStdString(signature);
@@ -322,6 +355,95 @@ BEGIN_SLOT_WRAPPER
 END_SLOT_WRAPPER
 }
 
+// Вызывает func для каждого индекса из [0, count) в нескольких потоках и ждет завершения.
+// Первое исключение пробрасывается в вызывающий поток
+static void runParallel(size_t count, const std::function<void(size_t index)> &func) {
+    const size_t countThreads = std::min<size_t>(count, std::max(1u, std::thread::hardware_concurrency()));
+    std::atomic<size_t> next{0};
+    std::atomic<bool> isFailed{false};
+    std::exception_ptr exception;
+    std::mutex exceptionMut;
+
+    const auto work = [&]{
+        while (!isFailed.load()) {
+            const size_t index = next++;
+            if (index >= count) {
+                break;
+            }
+            try {
+                func(index);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(exceptionMut);
+                if (!isFailed.exchange(true)) {
+                    exception = std::current_exception();
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < countThreads; i++) {
+        threads.emplace_back(work);
+    }
+    work();
+    for (std::thread &thread: threads) {
+        thread.join();
+    }
+    if (exception) {
+        std::rethrow_exception(exception);
+    }
+}
+
+void Wallets::onSignMessages2(bool isMhc, const QString &address, const QString &password, const std::vector<TxToSign> &txs, const SignMessages2Callback &callback) {
+BEGIN_SLOT_WRAPPER
+    runAndEmitCallback([&]{
+        CHECK(!walletPath.isEmpty(), "Incorrect path to wallet: empty");
+        CHECK(!txs.empty(), "Empty transactions list");
+
+        std::vector<SignedTx> result(txs.size());
+        std::vector<uint64_t> values(txs.size());
+        std::vector<uint64_t> fees(txs.size());
+        for (size_t i = 0; i < txs.size(); i++) {
+            const TxToSign &tx = txs[i];
+            bool tmp;
+            values[i] = tx.value.toULongLong(&tmp, 10);
+            CHECK(tmp, "Value not valid");
+            fees[i] = tx.fee.isEmpty() ? 0 : tx.fee.toULongLong(&tmp, 10);
+            CHECK(tmp, "Fee not valid");
+            if (tx.nonce.isEmpty()) {
+                CHECK(i != 0, "Nonce not set for first transaction");
+                result[i].nonce = result[i - 1].nonce + 1;
+            } else {
+                result[i].nonce = tx.nonce.toULongLong(&tmp, 10);
+                CHECK(tmp, "Nonce not valid");
+            }
+        }
+
+        // Ключ расшифровывается один раз на всю пачку, подпись только читает его
+        const std::shared_ptr<const Wallet> wallet = getWallet(isMhc, address, password);
+        std::string publicKey;
+
+        runParallel(txs.size(), [&](size_t index) {
+            const TxToSign &tx = txs[index];
+            SignedTx &signedTx = result[index];
+            const std::string txBinary = Wallet::genTx(tx.toAddress.toStdString(), values[index], fees[index], signedTx.nonce, tx.dataHex.toStdString(), true);
+            std::string pubkey;
+            const std::string signature = wallet->sign(txBinary, pubkey);
+            const std::string txHex = toHex(txBinary);
+            signedTx.tx = QString::fromStdString(txHex);
+            signedTx.signature = QString::fromStdString(signature);
+            signedTx.hash = QString::fromStdString(Wallet::calcHash(txHex, signature, pubkey));
+            if (index == 0) {
+                publicKey = pubkey;
+            }
+        });
+
+        LOG << "Signed " << result.size() << " txs " << address << " nonce " << result.front().nonce << "-" << result.back().nonce;
+        return std::make_tuple(QString::fromStdString(publicKey), result);
+    }, callback);
+END_SLOT_WRAPPER
+}
+
 void Wallets::findNonceAndProcessWithTxManager(const QString &address, const QString &nonce, const transactions::SendParameters &sendParams, const GettedNonceCallback &callback) {
     const bool isNonce = !nonce.isEmpty();
     if (!isNonce) {
@@ -344,17 +466,15 @@ BEGIN_SLOT_WRAPPER
         CHECK(!walletPath.isEmpty(), "Incorrect path to wallet: empty");
         const transactions::SendParameters sendParams = transactions::parseSendParams(paramsJson);
 
-        Wallet wallet(walletPath, isMhc, address.toStdString(), password.toStdString()); // Проверяем пароль кошелька
+        // Проверяем пароль кошелька. Расшифрованный ключ переиспользуется после получения nonce
+        const std::shared_ptr<Wallet> wallet = getWallet(isMhc, address, password);
 
         QString realFee = fee;
         if (realFee.isEmpty()) {
             realFee = "0";
         }
 
-        const QString walletPathCopy = walletPath;
-
-        const auto signTransaction = [this, walletPathCopy, isMhc, address, password, toAddress, value, realFee, dataHex, sendParams, callback](size_t nonce) {
-            Wallet wallet(walletPathCopy, isMhc, address.toStdString(), password.toStdString());
+        const auto signTransaction = [this, wallet, address, toAddress, value, realFee, dataHex, sendParams, callback](size_t nonce) {
             std::string publicKey;
             std::string tx;
             std::string signature;
@@ -363,7 +483,7 @@ BEGIN_SLOT_WRAPPER
             CHECK(tmp, "Value not valid");
             const uint64_t feeInt = realFee.toULongLong(&tmp, 10);
             CHECK(tmp, "Fee not valid");
-            wallet.sign(toAddress.toStdString(), valueInt, feeInt, nonce, dataHex.toStdString(), tx, signature, publicKey);
+            wallet->sign(toAddress.toStdString(), valueInt, feeInt, nonce, dataHex.toStdString(), tx, signature, publicKey);
 
             CHECK(txs != nullptr, "Transactions manager not setted");
             const QString txHash = QString::fromStdString(Wallet::calcHash(tx, signature, publicKey));
@@ -383,18 +503,15 @@ BEGIN_SLOT_WRAPPER
         CHECK(!walletPath.isEmpty(), "Incorrect path to wallet: empty");
         const transactions::SendParameters sendParams = transactions::parseSendParams(paramsJson);
 
-        Wallet wallet(walletPath, isMhc, address.toStdString(), password.toStdString()); // Проверяем пароль кошелька
+        // Проверяем пароль кошелька. Расшифрованный ключ переиспользуется после получения nonce
+        const std::shared_ptr<Wallet> wallet = getWallet(isMhc, address, password);
 
         QString realFee = fee;
         if (realFee.isEmpty()) {
             realFee = "0";
         }
 
-        const QString walletPathCopy = walletPath;
-
-        const auto signTransaction = [this, walletPathCopy, isMhc, address, password, toAddress, value, realFee, valueDelegate, isDelegate, sendParams, callback](size_t nonce) {
-            Wallet wallet(walletPathCopy, isMhc, address.toStdString(), password.toStdString());
-
+        const auto signTransaction = [this, wallet, address, toAddress, value, realFee, valueDelegate, isDelegate, sendParams, callback](size_t nonce) {
             bool isValid;
             const uint64_t delegValue = valueDelegate.toULongLong(&isValid);
             CHECK(isValid, "delegate value not valid");
@@ -408,7 +525,7 @@ BEGIN_SLOT_WRAPPER
             CHECK(tmp, "Value not valid");
             const uint64_t feeInt = realFee.toULongLong(&tmp, 10);
             CHECK(tmp, "Fee not valid");
-            wallet.sign(toAddress.toStdString(), valueInt, feeInt, nonce, dataHex, tx, signature, publicKey, false);
+            wallet->sign(toAddress.toStdString(), valueInt, feeInt, nonce, dataHex, tx, signature, publicKey, false);
 
             CHECK(txs != nullptr, "Transactions manager not setted");
             const QString txHash = QString::fromStdString(Wallet::calcHash(tx, signature, publicKey));
@@ -470,6 +587,7 @@ void Wallets::onGetRawPrivateKey(bool isMhc, const QString &address, const QStri
 BEGIN_SLOT_WRAPPER
     runAndEmitCallback([&]{
         CHECK(!walletPath.isEmpty(), "Incorrect path to wallet: empty");
+        // Экспорт ключа всегда проверяет пароль, разблокировка на него не действует
         Wallet wallet(walletPath, isMhc, address.toStdString(), password.toStdString());
         return QString::fromStdString(wallet.getNotProtectedKeyHex());
     }, callback);
@@ -478,30 +596,37 @@ END_SLOT_WRAPPER
 
 void Wallets::onImportKeys(bool isMhc, const QString &path, const ImportKeysCallback &callback) {
 BEGIN_SLOT_WRAPPER
-    runAndEmitCallback([&]{
+    runAndEmitErrorCallback([&]{
         CHECK(!walletPath.isEmpty(), "Incorrect path to wallet: empty");
-        const int result = importKeysImpl(path, [](const QString &filePath) {
+        const QString folder = makePath(walletPath, Wallet::chooseSubfolder(isMhc));
+        createFolder(folder);
+        importKeysImpl(isMhc ? WalletCurrency::Mth : WalletCurrency::Tmh, path, [](const QString &filePath) {
             return Wallet::isCorrectFilenameWallet(filePath);
-        }, [this, isMhc](const QString &fileName) {
-            copyToDirectoryFile(fileName, makePath(walletPath, Wallet::chooseSubfolder(isMhc)), true);
+        }, [folder](const QString &filePath) {
+            copyToDirectoryFile(filePath, folder, true);
+            return getFileName(filePath);
+        }, [callback](const std::vector<QString> &keys) {
+            callback.emitCallback(static_cast<int>(keys.size()));
+        }, [callback](const TypedException &exception) {
+            callback.emitException(exception);
         });
-        return result;
     }, callback);
 END_SLOT_WRAPPER
 }
 
-void Wallets::onCalkKeys(bool /*isMhc*/, const QString &path, const CalkKeysCallback &callback) {
+void Wallets::onCalkKeys(bool isMhc, const QString &path, const CalkKeysCallback &callback) {
 BEGIN_SLOT_WRAPPER
-    runAndEmitCallback([&]{
-        std::vector<QString> result;
+    runAndEmitErrorCallback([&]{
         CHECK(!walletPath.isEmpty(), "Incorrect path to wallet: empty");
-        importKeysImpl(path, [](const QString &filePath) {
+        importKeysImpl(isMhc ? WalletCurrency::Mth : WalletCurrency::Tmh, path, [](const QString &filePath) {
             return Wallet::isCorrectFilenameWallet(filePath);
-        }, [&result](const QString &filePath) {
-            const QString fileName = getFileName(filePath);
-            result.emplace_back(fileName);
+        }, [](const QString &filePath) {
+            return getFileName(filePath);
+        }, [callback](const std::vector<QString> &keys) {
+            callback.emitCallback(keys);
+        }, [callback](const TypedException &exception) {
+            callback.emitException(exception);
         });
-        return result;
     }, callback);
 END_SLOT_WRAPPER
 }
@@ -570,7 +695,7 @@ BEGIN_SLOT_WRAPPER
 
         const QString fullPath = EthWallet::getFullPath(walletPath, address.toStdString());
 
-        walletsList[WalletCurrency::Eth][address] = WalletInfo(address, fullPath, WalletInfo::Type::Key);
+        addToWalletsList(WalletCurrency::Eth, WalletInfo(address, fullPath, WalletInfo::Type::Key));
 
         return std::make_tuple(address, fullPath);
     }, callback);
@@ -581,8 +706,8 @@ void Wallets::onSignMessageEth(const QString &address, const QString &password,
 BEGIN_SLOT_WRAPPER
     runAndEmitCallback([&]{
         CHECK(!walletPath.isEmpty(), "Incorrect path to wallet: empty");
-        EthWallet wallet(walletPath, address.toStdString(), password.toStdString());
-        return QString::fromStdString(wallet.SignTransaction(
+        const std::shared_ptr<EthWallet> wallet = getEthWallet(address, password);
+        return QString::fromStdString(wallet->SignTransaction(
             nonce.toStdString(),
             gasPrice.toStdString(),
             gasLimit.toStdString(),
@@ -636,30 +761,37 @@ END_SLOT_WRAPPER
 
 void Wallets::onImportKeysEth(const QString &path, const ImportKeysCallback &callback) {
 BEGIN_SLOT_WRAPPER
-    runAndEmitCallback([&]{
+    runAndEmitErrorCallback([&]{
         CHECK(!walletPath.isEmpty(), "Incorrect path to wallet: empty");
-        const int result = importKeysImpl(path, [](const QString &filePath) {
+        const QString folder = makePath(walletPath, EthWallet::subfolder());
+        createFolder(folder);
+        importKeysImpl(WalletCurrency::Eth, path, [](const QString &filePath) {
             return EthWallet::isCorrectFilenameWallet(filePath);
-        }, [this](const QString &fileName) {
-            copyToDirectoryFile(fileName, makePath(walletPath, EthWallet::subfolder()), true);
+        }, [folder](const QString &filePath) {
+            copyToDirectoryFile(filePath, folder, true);
+            return getFileName(filePath);
+        }, [callback](const std::vector<QString> &keys) {
+            callback.emitCallback(static_cast<int>(keys.size()));
+        }, [callback](const TypedException &exception) {
+            callback.emitException(exception);
         });
-        return result;
     }, callback);
 END_SLOT_WRAPPER
 }
 
 void Wallets::onCalkKeysEth(const QString &path, const CalkKeysCallback &callback) {
 BEGIN_SLOT_WRAPPER
-    runAndEmitCallback([&]{
-        std::vector<QString> result;
+    runAndEmitErrorCallback([&]{
         CHECK(!walletPath.isEmpty(), "Incorrect path to wallet: empty");
-        importKeysImpl(path, [](const QString &filePath) {
+        importKeysImpl(WalletCurrency::Eth, path, [](const QString &filePath) {
             return EthWallet::isCorrectFilenameWallet(filePath);
-        }, [&result](const QString &filePath) {
-            const QString fileName = getFileName(filePath);
-            result.emplace_back(fileName);
+        }, [](const QString &filePath) {
+            return getFileName(filePath);
+        }, [callback](const std::vector<QString> &keys) {
+            callback.emitCallback(keys);
+        }, [callback](const TypedException &exception) {
+            callback.emitException(exception);
         });
-        return result;
     }, callback);
 END_SLOT_WRAPPER
 }
@@ -676,7 +808,7 @@ BEGIN_SLOT_WRAPPER
 
         const QString fullPath = BtcWallet::getFullPath(walletPath, address);
 
-        walletsList[WalletCurrency::Btc][QString::fromStdString(address)] = WalletInfo(QString::fromStdString(address), fullPath, WalletInfo::Type::Key);
+        addToWalletsList(WalletCurrency::Btc, WalletInfo(QString::fromStdString(address), fullPath, WalletInfo::Type::Key));
 
         return std::make_tuple(QString::fromStdString(address), fullPath);
     }, callback);
@@ -705,13 +837,13 @@ BEGIN_SLOT_WRAPPER
         std::vector<BtcInput> btcInputs = BtcWallet::reduceInputs(inputs, usedUtxos);
 
         CHECK(!walletPath.isEmpty(), "Incorrect path to wallet: empty");
-        BtcWallet wallet(walletPath, address.toStdString(), password);
+        const std::shared_ptr<BtcWallet> wallet = getBtcWallet(address, password);
         size_t estimateComissionInSatoshiInt = 0;
         if (!estimateComissionInSatoshi.isEmpty()) {
             CHECK(isDecimal(estimateComissionInSatoshi.toStdString()), "Not hex number value");
             estimateComissionInSatoshiInt = std::stoull(estimateComissionInSatoshi.toStdString());
         }
-        const auto resultPair = wallet.buildTransaction(btcInputs, estimateComissionInSatoshiInt, value.toStdString(), fees.toStdString(), toAddress.toStdString());
+        const auto resultPair = wallet->buildTransaction(btcInputs, estimateComissionInSatoshiInt, value.toStdString(), fees.toStdString(), toAddress.toStdString());
         const std::string result = resultPair.first;
         const std::set<std::string> &thisUsedTxs = resultPair.second;
 
@@ -756,30 +888,37 @@ END_SLOT_WRAPPER
 
 void Wallets::onImportKeysBtc(const QString &path, const ImportKeysCallback &callback) {
 BEGIN_SLOT_WRAPPER
-    runAndEmitCallback([&]{
+    runAndEmitErrorCallback([&]{
         CHECK(!walletPath.isEmpty(), "Incorrect path to wallet: empty");
-        const int result = importKeysImpl(path, [](const QString &filePath) {
+        const QString folder = makePath(walletPath, BtcWallet::subfolder());
+        createFolder(folder);
+        importKeysImpl(WalletCurrency::Btc, path, [](const QString &filePath) {
             return BtcWallet::isCorrectFilenameWallet(filePath);
-        }, [this](const QString &fileName) {
-            copyToDirectoryFile(fileName, makePath(walletPath, BtcWallet::subfolder()), true);
+        }, [folder](const QString &filePath) {
+            copyToDirectoryFile(filePath, folder, true);
+            return getFileName(filePath);
+        }, [callback](const std::vector<QString> &keys) {
+            callback.emitCallback(static_cast<int>(keys.size()));
+        }, [callback](const TypedException &exception) {
+            callback.emitException(exception);
         });
-        return result;
     }, callback);
 END_SLOT_WRAPPER
 }
 
 void Wallets::onCalkKeysBtc(const QString &path, const CalkKeysCallback &callback) {
 BEGIN_SLOT_WRAPPER
-    runAndEmitCallback([&]{
-        std::vector<QString> result;
+    runAndEmitErrorCallback([&]{
         CHECK(!walletPath.isEmpty(), "Incorrect path to wallet: empty");
-        importKeysImpl(path, [](const QString &filePath) {
+        importKeysImpl(WalletCurrency::Btc, path, [](const QString &filePath) {
             return BtcWallet::isCorrectFilenameWallet(filePath);
-        }, [&result](const QString &filePath) {
-            const QString fileName = QString::fromStdString(BtcWallet::getAddress(filePath));
-            result.emplace_back(fileName);
+        }, [](const QString &filePath) {
+            return QString::fromStdString(BtcWallet::getAddress(filePath));
+        }, [callback](const std::vector<QString> &keys) {
+            callback.emitCallback(keys);
+        }, [callback](const TypedException &exception) {
+            callback.emitException(exception);
         });
-        return result;
     }, callback);
 END_SLOT_WRAPPER
 }
@@ -830,6 +969,22 @@ BEGIN_SLOT_WRAPPER
 END_SLOT_WRAPPER
 }
 
+void Wallets::onGetWalletsState(const GetWalletsStateCallback &callback) {
+BEGIN_SLOT_WRAPPER
+    runAndEmitCallback([&]{
+        std::map<WalletCurrency, std::vector<WalletInfo>> result;
+        for (const auto &pair: walletsList) {
+            auto &wallets = result[pair.first];
+            wallets.reserve(pair.second.size());
+            std::transform(pair.second.begin(), pair.second.end(), std::back_inserter(wallets), [](const auto &p) {
+                return p.second;
+            });
+        }
+        return std::make_tuple(walletsListVersion, userName, result);
+    }, callback);
+END_SLOT_WRAPPER
+}
+
 void Wallets::onBackupKeys(const QString &caption, const BackupKeysCallback &callback) {
 BEGIN_SLOT_WRAPPER
     runAndEmitErrorCallback([&]{
@@ -880,6 +1035,140 @@ BEGIN_SLOT_WRAPPER
 END_SLOT_WRAPPER
 }
 
+//////////////
+/// UNLOCK ///
+//////////////
+
+Wallets::UnlockedKeyId Wallets::makeUnlockedKeyId(const WalletCurrency &currency, const QString &address) {
+    // Адреса btc регистрозависимы
+    if (currency == WalletCurrency::Btc) {
+        return std::make_pair(currency, address);
+    } else {
+        return std::make_pair(currency, address.toLower());
+    }
+}
+
+const Wallets::UnlockedKey* Wallets::findUnlockedKey(const WalletCurrency &currency, const QString &address) const {
+    const auto found = unlockedKeys.find(makeUnlockedKeyId(currency, address));
+    if (found == unlockedKeys.end()) {
+        return nullptr;
+    }
+    // timerMethod срабатывает раз в несколько секунд, поэтому время проверяется и здесь
+    if (::now() - found->second.startTime >= found->second.time) {
+        return nullptr;
+    }
+    return &found->second;
+}
+
+SecureBytes Wallets::calcPasswordHash(const SecureBytes &salt, const QString &password) {
+    const QByteArray passwordUtf8 = password.toUtf8();
+    SecureBytes hash(CryptoPP::SHA256::DIGESTSIZE);
+    CryptoPP::SHA256 sha;
+    sha.Update(salt.data(), salt.size());
+    sha.Update((const byte*)passwordUtf8.data(), passwordUtf8.size());
+    sha.Final(hash.data());
+    return hash;
+}
+
+bool Wallets::isPasswordMatch(const UnlockedKey &key, const QString &password) {
+    const SecureBytes hash = calcPasswordHash(key.passwordSalt, password);
+    return hash.size() == key.passwordHash.size() && CryptoPP::VerifyBufsEqual(hash.data(), key.passwordHash.data(), hash.size());
+}
+
+// При несовпавшем пароле ключ расшифровывается из файла, и неверный пароль дает обычную ошибку расшифровки
+std::shared_ptr<Wallet> Wallets::getWallet(bool isMhc, const QString &address, const QString &password) const {
+    const UnlockedKey *unlocked = findUnlockedKey(isMhc ? WalletCurrency::Mth : WalletCurrency::Tmh, address);
+    if (unlocked != nullptr && isPasswordMatch(*unlocked, password)) {
+        return unlocked->mhc;
+    }
+    return std::make_shared<Wallet>(walletPath, isMhc, address.toStdString(), password.toStdString());
+}
+
+std::shared_ptr<EthWallet> Wallets::getEthWallet(const QString &address, const QString &password) const {
+    const UnlockedKey *unlocked = findUnlockedKey(WalletCurrency::Eth, address);
+    if (unlocked != nullptr && isPasswordMatch(*unlocked, password)) {
+        return unlocked->eth;
+    }
+    return std::make_shared<EthWallet>(walletPath, address.toStdString(), password.toStdString());
+}
+
+std::shared_ptr<BtcWallet> Wallets::getBtcWallet(const QString &address, const QString &password) const {
+    const UnlockedKey *unlocked = findUnlockedKey(WalletCurrency::Btc, address);
+    if (unlocked != nullptr && isPasswordMatch(*unlocked, password)) {
+        return unlocked->btc;
+    }
+    return std::make_shared<BtcWallet>(walletPath, address.toStdString(), password);
+}
+
+void Wallets::lockKeysImpl() {
+    if (!unlockedKeys.empty()) {
+        LOG << "Locked keys " << unlockedKeys.size();
+    }
+    unlockedKeys.clear();
+}
+
+void Wallets::lockExpiredKeys() {
+    const time_point now = ::now();
+    for (auto it = unlockedKeys.begin(); it != unlockedKeys.end();) {
+        if (now - it->second.startTime >= it->second.time) {
+            LOG << "Locked key " << it->first.second;
+            it = unlockedKeys.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void Wallets::onUnlockKey(const WalletCurrency &currency, const QString &address, const QString &password, const seconds &time, const UnlockKeyCallback &callback) {
+BEGIN_SLOT_WRAPPER
+    runAndEmitCallback([&]{
+        CHECK(!walletPath.isEmpty(), "Incorrect path to wallet: empty");
+        CHECK_TYPED(time > seconds(0) && time <= MAX_UNLOCK_TIME, TypeErrors::INCORRECT_USER_DATA, "Incorrect unlock time");
+        const UnlockedKeyId id = makeUnlockedKeyId(currency, address);
+        unlockedKeys.erase(id);
+
+        UnlockedKey key;
+        if (currency == WalletCurrency::Mth || currency == WalletCurrency::Tmh) {
+            key.mhc = std::make_shared<Wallet>(walletPath, currency == WalletCurrency::Mth, address.toStdString(), password.toStdString());
+        } else if (currency == WalletCurrency::Eth) {
+            key.eth = std::make_shared<EthWallet>(walletPath, address.toStdString(), password.toStdString());
+        } else if (currency == WalletCurrency::Btc) {
+            key.btc = std::make_shared<BtcWallet>(walletPath, address.toStdString(), password);
+        } else {
+            throwErr("Incorrect type");
+        }
+        key.startTime = ::now();
+        key.time = time;
+        key.passwordSalt.resize(16);
+        CryptoPP::AutoSeededRandomPool().GenerateBlock(key.passwordSalt.data(), key.passwordSalt.size());
+        key.passwordHash = calcPasswordHash(key.passwordSalt, password);
+        unlockedKeys.emplace(id, std::move(key));
+        LOG << "Unlocked key " << address << " " << time.count();
+    }, callback);
+END_SLOT_WRAPPER
+}
+
+void Wallets::onLockKeys(const LockKeysCallback &callback) {
+BEGIN_SLOT_WRAPPER
+    runAndEmitCallback([&]{
+        lockKeysImpl();
+    }, callback);
+END_SLOT_WRAPPER
+}
+
+void Wallets::onRemainingUnlockTime(const WalletCurrency &currency, const QString &address, const RemainingUnlockTimeCallback &callback) {
+BEGIN_SLOT_WRAPPER
+    runAndEmitCallback([&]{
+        const UnlockedKey *unlocked = findUnlockedKey(currency, address);
+        if (unlocked == nullptr) {
+            return 0s;
+        }
+        const milliseconds elapsedTime = std::chrono::duration_cast<milliseconds>(::now() - unlocked->startTime);
+        return std::chrono::duration_cast<seconds>(unlocked->time - elapsedTime);
+    }, callback, 0s);
+END_SLOT_WRAPPER
+}
+
 ///////////////
 /// METHODS ///
 ///////////////
@@ -890,6 +1179,7 @@ void Wallets::startMethod() {
 
 void Wallets::timerMethod() {
     eventWatcher.checkEvents();
+    lockExpiredKeys();
 }
 
 void Wallets::finishMethod() {
@@ -898,53 +1188,33 @@ void Wallets::finishMethod() {
 
 std::vector<WalletInfo> Wallets::readAllWallets(const WalletCurrency &type) {
     CHECK(!walletPath.isEmpty(), "Wallet path not set");
-    if (type == WalletCurrency::Tmh) {
-        return Wallet::getAllWalletsInfoInFolder(walletPath, false);
-    } else if (type == WalletCurrency::Mth) {
-        return Wallet::getAllWalletsInfoInFolder(walletPath, true);
-    } else if (type == WalletCurrency::Btc) {
-        const WalletsList res = BtcWallet::getAllWalletsInFolder(walletPath);
-        std::vector<WalletInfo> result;
-        result.reserve(res.size());
-        std::transform(res.begin(), res.end(), std::back_inserter(result), [](const auto &pair) {
-            return WalletInfo(pair.first, pair.second, WalletInfo::Type::Key);
-        });
-        return result;
-    } else if (type == WalletCurrency::Eth) {
-        const WalletsList res = EthWallet::getAllWalletsInFolder(walletPath);
-        std::vector<WalletInfo> result;
-        result.reserve(res.size());
-        std::transform(res.begin(), res.end(), std::back_inserter(result), [](const auto &pair) {
-            return WalletInfo(pair.first, pair.second, WalletInfo::Type::Key);
-        });
-        return result;
-    } else {
-        throwErr("Incorrect type");
-    }
+    return catalogue.getWallets(walletPath, type);
 }
 
-int Wallets::importKeysImpl(const QString &path, const std::function<bool(const QString &filePath)> &checkFileName, const std::function<void(const QString &path)> &processFile) {
-    if (isDirectory(path)) {
-        const QStringList files = getFilesForDir(path);
-        int countSuccess = 0;
-        for (const QString &fileName: files) {
-            const QString filePath = makePath(path, fileName);
-            const bool isKey = checkFileName(filePath);
-            if (isKey) {
-                processFile(filePath);
-                countSuccess++;
-            }
-        }
-        return countSuccess;
-    } else {
-        const bool isKey = checkFileName(path);
-        if (!isKey) {
-            return 0;
+void Wallets::importKeysImpl(const WalletCurrency &type, const QString &path, const std::function<bool(const QString &filePath)> &checkFileName, const std::function<QString(const QString &filePath)> &processFile, const std::function<void(const std::vector<QString> &keys)> &finish, const std::function<void(const TypedException &exception)> &error) {
+    if (!isDirectory(path)) {
+        std::vector<QString> keys;
+        const KeysImporter::Summary summary = KeysImporter::runSerial(path, checkFileName, processFile, keys);
+        emit importKeysProgress(type, path, summary.countFiles, summary.countFiles);
+        finish(keys);
+        return;
+    }
+
+    keysImporter->run(path, checkFileName, processFile, [this, type, path](size_t processed, size_t total) {
+        emit importKeysProgress(type, path, processed, total);
+    }, [this, type, path, finish, error](const KeysImporter::Summary &summary, const std::vector<QString> &keys, const std::exception_ptr &exception) {
+        if (exception != nullptr) {
+            error(apiVrapper2([&exception]{
+                std::rethrow_exception(exception);
+            }));
         } else {
-            processFile(path);
-            return 1;
+            // По пустой папке пул не сообщает прогресс, а число файлов должно прийти и в этом случае
+            if (summary.countFiles == 0) {
+                emit importKeysProgress(type, path, 0, 0);
+            }
+            finish(keys);
         }
-    }
+    });
 }
 
 static std::map<QString, WalletInfo> walletsToMap(const std::vector<WalletInfo> &wallets) {
@@ -955,6 +1225,57 @@ static std::map<QString, WalletInfo> walletsToMap(const std::vector<WalletInfo>
     return wallets2;
 }
 
+void Wallets::emitWalletsListChanged(const WalletCurrency &type, const std::vector<WalletInfo> &added, const std::vector<QString> &removed, bool isReset) {
+    if (!isReset && added.empty() && removed.empty()) {
+        return;
+    }
+    walletsListVersion++;
+    emit walletsListChanged(walletsListVersion, userName, type, added, removed, isReset);
+}
+
+void Wallets::setWalletsList(const WalletCurrency &type, std::map<QString, WalletInfo> list, bool isReset) {
+    auto &current = walletsList[type];
+    std::vector<WalletInfo> added;
+    std::vector<QString> removed;
+    if (isReset) {
+        added.reserve(list.size());
+        std::transform(list.begin(), list.end(), std::back_inserter(added), [](const auto &pair) {
+            return pair.second;
+        });
+    } else {
+        for (const auto &pair: list) {
+            const auto found = current.find(pair.first);
+            if (found == current.end() || found->second.path != pair.second.path || found->second.type != pair.second.type) {
+                added.emplace_back(pair.second);
+            }
+        }
+        for (const auto &pair: current) {
+            if (list.find(pair.first) == list.end()) {
+                removed.emplace_back(pair.first);
+            }
+        }
+    }
+    current = std::move(list);
+    emitWalletsListChanged(type, added, removed, isReset);
+}
+
+void Wallets::addToWalletsList(const WalletCurrency &type, const WalletInfo &info) {
+    auto &current = walletsList[type];
+    const auto found = current.find(info.address);
+    if (found != current.end() && found->second.path == info.path && found->second.type == info.type) {
+        return;
+    }
+    current[info.address] = info;
+    emitWalletsListChanged(type, {info}, {}, false);
+}
+
+void Wallets::removeFromWalletsList(const WalletCurrency &type, const QString &address) {
+    if (walletsList[type].erase(address) == 0) {
+        return;
+    }
+    emitWalletsListChanged(type, {}, {address}, false);
+}
+
 void Wallets::setPathsImpl(QString newPatch, QString newUserName) {
     userName = newUserName;
 
@@ -964,6 +1285,7 @@ void Wallets::setPathsImpl(QString newPatch, QString newUserName) {
 
     walletPath = newPatch;
     CHECK(!walletPath.isNull() && !walletPath.isEmpty(), "Incorrect path to wallet: empty");
+    lockKeysImpl();
     createFolder(walletPath);
 
     for (const FolderWalletInfo &folderInfo: folderWalletsInfos) {
@@ -978,7 +1300,7 @@ void Wallets::setPathsImpl(QString newPatch, QString newUserName) {
         fileSystemWatcher.addPath(curPath);
 
         const std::vector<WalletInfo> wallets = readAllWallets(type);
-        walletsList[type] = walletsToMap(wallets);
+        setWalletsList(type, walletsToMap(wallets), true);
     };
 
     walletsList.clear();
@@ -1006,6 +1328,8 @@ END_SLOT_WRAPPER
 
 void Wallets::onDirChanged(const QString &dir) {
 BEGIN_SLOT_WRAPPER
+    catalogue.invalidate(dir);
+
     const QDir changedPath = dir;
     WalletCurrency currency;
     if (changedPath == QDir(makePath(walletPath, EthWallet::subfolder()))) {
@@ -1048,7 +1372,7 @@ BEGIN_SLOT_WRAPPER
         }
     }
 
-    walletsList[currency] = currentWallets2;
+    setWalletsList(currency, currentWallets2, false);
 
     const QDir d(dir);
     for (const FolderWalletInfo &folderInfo: folderWalletsInfos) {
@@ -7,12 +7,17 @@
 #include "qt_utilites/ManagerWrapper.h"
 
 #include "WalletInfo.h"
+#include "WalletsCatalogue.h"
+
+#include "utilites/LockedMemory.h"
 
 #include <QDir>
 #include <QFileSystemWatcher>
 
 #include <vector>
 #include <set>
+#include <map>
+#include <memory>
 
 #include "qt_utilites/EventWatcher.h"
 
@@ -31,8 +36,14 @@ class Utils;
 
 struct BtcInput;
 
+class Wallet;
+class EthWallet;
+class BtcWallet;
+
 namespace wallets {
 
+class KeysImporter;
+
 class Wallets: public ManagerWrapper, public TimerClass {
     Q_OBJECT
 public:
@@ -63,6 +74,24 @@ public:
 
     using SignMessage2Callback = CallbackWrapper<void(const QString &signature, const QString &pubkey, const QString &tx, const QString &hash)>;
 
+    // Пустой nonce - на единицу больше предыдущего в пачке
+    struct TxToSign {
+        QString toAddress;
+        QString value;
+        QString fee;
+        QString nonce;
+        QString dataHex;
+    };
+
+    struct SignedTx {
+        QString tx;
+        QString signature;
+        QString hash;
+        uint64_t nonce;
+    };
+
+    using SignMessages2Callback = CallbackWrapper<void(const QString &pubkey, const std::vector<SignedTx> &txs)>;
+
     using GettedNonceCallback = CallbackWrapper<void(size_t nonce)>;
 
     using SignAndSendMessageCallback = CallbackWrapper<void(bool success, const QString &hash)>;
@@ -99,6 +128,17 @@ public:
 
     using CalkKeysCallback = CallbackWrapper<void(const std::vector<QString> &addresses)>;
 
+    using GetWalletsStateCallback = CallbackWrapper<void(size_t version, const QString &userName, const std::map<WalletCurrency, std::vector<WalletInfo>> &wallets)>;
+
+    using UnlockKeyCallback = CallbackWrapper<void()>;
+
+    static const seconds MAX_UNLOCK_TIME;
+
+    using LockKeysCallback = CallbackWrapper<void()>;
+
+    // 0 - ключ не разблокирован
+    using RemainingUnlockTimeCallback = CallbackWrapper<void(const seconds &remaining)>;
+
 public:
 
     explicit Wallets(auth::Auth &auth, utils::Utils &utils, QObject *parent = nullptr);
@@ -107,6 +147,11 @@ public:
 
     void setTransactions(transactions::Transactions *txs);
 
+    // Потокобезопасен, можно вызывать из javascript
+    WalletsCatalogue& getCatalogue() {
+        return catalogue;
+    }
+
 public:
 
     const QString walletDefaultPath;
@@ -125,6 +170,13 @@ signals:
 
     void dirChanged(const QString &absolutePath, const QString &nameCurrency);
 
+    // version увеличивается на каждое изменение. isReset - список валюты полностью перечитан, added содержит его целиком
+    void walletsListChanged(size_t version, const QString &userName, const wallets::WalletCurrency &type, const std::vector<wallets::WalletInfo> &added, const std::vector<QString> &removed, bool isReset);
+
+    // Прогресс importKeys и calkKeys. Вызывается из потоков импорта.
+    // Последнее событие (processed == total, total - число просмотренных файлов) приходит до callback, в том числе для одиночного файла и пустой папки
+    void importKeysProgress(const wallets::WalletCurrency &type, const QString &path, size_t processed, size_t total);
+
 ///////////
 /// MHC ///
 ///////////
@@ -151,6 +203,8 @@ signals:
 
     void signMessage2(bool isMhc, const QString &address, const QString &password, const QString &toAddress, const QString &value, const QString &fee, const QString &nonce, const QString &dataHex, const SignMessage2Callback &callback);
 
+    void signMessages2(bool isMhc, const QString &address, const QString &password, const std::vector<wallets::Wallets::TxToSign> &txs, const SignMessages2Callback &callback);
+
     void signAndSendMessage(bool isMhc, const QString &address, const QString &password, const QString &toAddress, const QString &value, const QString &fee, const QString &nonce, const QString &dataHex, const QString &paramsJson, const SignAndSendMessageCallback &callback);
 
     void signAndSendMessageDelegate(bool isMhc, const QString &address, const QString &password, const QString &toAddress, const QString &value, const QString &fee, const QString &valueDelegate, const QString &nonce, bool isDelegate, const QString &paramsJson, const SignAndSendMessageCallback &callback);
@@ -191,6 +245,8 @@ private slots:
 
     void onSignMessage2(bool isMhc, const QString &address, const QString &password, const QString &toAddress, const QString &value, const QString &fee, const QString &nonce, const QString &dataHex, const SignMessage2Callback &callback);
 
+    void onSignMessages2(bool isMhc, const QString &address, const QString &password, const std::vector<wallets::Wallets::TxToSign> &txs, const SignMessages2Callback &callback);
+
     void onSignAndSendMessage(bool isMhc, const QString &address, const QString &password, const QString &toAddress, const QString &value, const QString &fee, const QString &nonce, const QString &dataHex, const QString &paramsJson, const SignAndSendMessageCallback &callback);
 
     void onSignAndSendMessageDelegate(bool isMhc, const QString &address, const QString &password, const QString &toAddress, const QString &value, const QString &fee, const QString &valueDelegate, const QString &nonce, bool isDelegate, const QString &paramsJson, const SignAndSendMessageCallback &callback);
@@ -305,6 +361,28 @@ private slots:
 
     void onCalkKeysBtc(const QString &path, const CalkKeysCallback &callback);
 
+//////////////
+/// UNLOCK ///
+//////////////
+
+signals:
+
+    // Ключ расшифровывается один раз и держится в памяти time секунд.
+    // Пока ключ разблокирован, подпись не проверяет пароль и не читает файл, как в CryptographicManager
+    void unlockKey(const wallets::WalletCurrency &currency, const QString &address, const QString &password, const seconds &time, const UnlockKeyCallback &callback);
+
+    void lockKeys(const LockKeysCallback &callback);
+
+    void remainingUnlockTime(const wallets::WalletCurrency &currency, const QString &address, const RemainingUnlockTimeCallback &callback);
+
+private slots:
+
+    void onUnlockKey(const wallets::WalletCurrency &currency, const QString &address, const QString &password, const seconds &time, const UnlockKeyCallback &callback);
+
+    void onLockKeys(const LockKeysCallback &callback);
+
+    void onRemainingUnlockTime(const wallets::WalletCurrency &currency, const QString &address, const RemainingUnlockTimeCallback &callback);
+
 //////////////
 /// COMMON ///
 //////////////
@@ -317,6 +395,8 @@ signals:
 
     void getWalletFolders(const GetWalletFoldersCallback &callback);
 
+    void getWalletsState(const GetWalletsStateCallback &callback);
+
     void backupKeys(const QString &caption, const BackupKeysCallback &callback);
 
     void restoreKeys(const QString &caption, const RestoreKeysCallback &callback);
@@ -331,6 +411,8 @@ private slots:
 
     void onGetWalletFolders(const GetWalletFoldersCallback &callback);
 
+    void onGetWalletsState(const GetWalletsStateCallback &callback);
+
     void onBackupKeys(const QString &caption, const BackupKeysCallback &callback);
 
     void onRestoreKeys(const QString &caption, const RestoreKeysCallback &callback);
@@ -367,13 +449,61 @@ private:
         {}
     };
 
+    // Заполнено одно из полей, в зависимости от валюты
+    struct UnlockedKey {
+        std::shared_ptr<Wallet> mhc;
+        std::shared_ptr<EthWallet> eth;
+        std::shared_ptr<BtcWallet> btc;
+
+        time_point startTime;
+        seconds time;
+
+        // Проверка пароля при каждом использовании: sha256(salt + password), соль случайная на каждую разблокировку
+        SecureBytes passwordSalt;
+        SecureBytes passwordHash;
+    };
+
+    using UnlockedKeyId = std::pair<WalletCurrency, QString>;
+
+private:
+
+    static UnlockedKeyId makeUnlockedKeyId(const WalletCurrency &currency, const QString &address);
+
+    // nullptr, если ключ не разблокирован или время вышло
+    const UnlockedKey* findUnlockedKey(const WalletCurrency &currency, const QString &address) const;
+
+    static SecureBytes calcPasswordHash(const SecureBytes &salt, const QString &password);
+
+    static bool isPasswordMatch(const UnlockedKey &key, const QString &password);
+
+    // Разблокированный ключ, если пароль совпал с паролем разблокировки, иначе расшифровка файла паролем. Не использовать для экспорта ключа
+    std::shared_ptr<Wallet> getWallet(bool isMhc, const QString &address, const QString &password) const;
+
+    std::shared_ptr<EthWallet> getEthWallet(const QString &address, const QString &password) const;
+
+    std::shared_ptr<BtcWallet> getBtcWallet(const QString &address, const QString &password) const;
+
+    void lockKeysImpl();
+
+    void lockExpiredKeys();
+
 private:
 
     void setPathsImpl(QString newPatch, QString newUserName);
 
     std::vector<WalletInfo> readAllWallets(const WalletCurrency &type);
 
-    int importKeysImpl(const QString &path, const std::function<bool(const QString &filePath)> &checkFileName, const std::function<void(const QString &path)> &processFile);
+    void setWalletsList(const WalletCurrency &type, std::map<QString, WalletInfo> list, bool isReset);
+
+    void addToWalletsList(const WalletCurrency &type, const WalletInfo &info);
+
+    void removeFromWalletsList(const WalletCurrency &type, const QString &address);
+
+    void emitWalletsListChanged(const WalletCurrency &type, const std::vector<WalletInfo> &added, const std::vector<QString> &removed, bool isReset);
+
+    // Папка разбирается в пуле потоков и finish вызывается из него, одиночный файл - сразу в потоке Wallets.
+    // processFile возвращает имя ключа для списка keys
+    void importKeysImpl(const WalletCurrency &type, const QString &path, const std::function<bool(const QString &filePath)> &checkFileName, const std::function<QString(const QString &filePath)> &processFile, const std::function<void(const std::vector<QString> &keys)> &finish, const std::function<void(const TypedException &exception)> &error);
 
 private:
 
@@ -397,8 +527,17 @@ private:
 
     transactions::Transactions *txs = nullptr;
 
+    WalletsCatalogue catalogue;
+
     std::map<WalletCurrency, std::map<QString, WalletInfo>> walletsList;
 
+    size_t walletsListVersion = 0;
+
+    std::map<UnlockedKeyId, UnlockedKey> unlockedKeys;
+
+    // Последним, чтобы потоки импорта остановились раньше остальных полей
+    std::unique_ptr<KeysImporter> keysImporter;
+
 };
 
 } // namespace wallets
@@ -0,0 +1,198 @@
+#include "WalletsCatalogue.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include "check.h"
+#include "Log.h"
+#include "utilites/utils.h"
+
+#include "Wallet.h"
+#include "BtcWallet.h"
+#include "EthWallet.h"
+
+SET_LOG_NAMESPACE("WLTS");
+
+namespace wallets {
+
+static const quint32 CATALOGUE_FILE_VERSION = 1;
+
+static QString folderKey(const QString &dir) {
+    return QDir(dir).absolutePath();
+}
+
+static qint64 modifiedTime(const QFileInfo &info) {
+    return info.lastModified().toMSecsSinceEpoch();
+}
+
+static bool parseFile(const QString &walletPath, const WalletCurrency &currency, const QString &fileName, WalletInfo &info) {
+    if (currency == WalletCurrency::Mth) {
+        return Wallet::getWalletInfoFromFile(walletPath, true, fileName, info);
+    } else if (currency == WalletCurrency::Tmh) {
+        return Wallet::getWalletInfoFromFile(walletPath, false, fileName, info);
+    } else if (currency == WalletCurrency::Btc) {
+        return BtcWallet::getWalletInfoFromFile(walletPath, fileName, info);
+    } else if (currency == WalletCurrency::Eth) {
+        return EthWallet::getWalletInfoFromFile(walletPath, fileName, info);
+    } else {
+        throwErr("Incorrect type");
+    }
+}
+
+WalletsCatalogue::WalletsCatalogue(const QString &savePath)
+    : savePath(savePath)
+{
+    load();
+}
+
+QString WalletsCatalogue::subfolder(const WalletCurrency &currency) {
+    if (currency == WalletCurrency::Mth) {
+        return Wallet::chooseSubfolder(true);
+    } else if (currency == WalletCurrency::Tmh) {
+        return Wallet::chooseSubfolder(false);
+    } else if (currency == WalletCurrency::Btc) {
+        return BtcWallet::subfolder();
+    } else if (currency == WalletCurrency::Eth) {
+        return EthWallet::subfolder();
+    } else {
+        throwErr("Incorrect type");
+    }
+}
+
+std::vector<WalletInfo> WalletsCatalogue::getWallets(const QString &walletPath, const WalletCurrency &currency) {
+    const QString dir = makePath(walletPath, subfolder(currency));
+
+    std::lock_guard<std::mutex> lock(mut);
+    Folder &folder = folders[folderKey(dir)];
+    // Добавление и удаление файла меняет время модификации папки.
+    // Вотчер нужен для изменений, уложившихся в одну единицу времени файловой системы
+    const QFileInfo dirInfo(dir);
+    const qint64 dirModified = dirInfo.exists() ? modifiedTime(dirInfo) : -1;
+    if (dirModified == -1 || folder.modified != dirModified) {
+        const bool isChanged = rescan(walletPath, currency, folder);
+        folder.modified = dirModified;
+        if (isChanged) {
+            save();
+        }
+    }
+
+    std::vector<WalletInfo> result;
+    result.reserve(folder.files.size());
+    for (const auto &pair: folder.files) {
+        if (pair.second.isWallet) {
+            result.emplace_back(pair.second.info);
+        }
+    }
+    return result;
+}
+
+void WalletsCatalogue::invalidate(const QString &dir) {
+    std::lock_guard<std::mutex> lock(mut);
+    const auto found = folders.find(folderKey(dir));
+    if (found != folders.end()) {
+        found->second.modified = -1;
+    }
+}
+
+bool WalletsCatalogue::rescan(const QString &walletPath, const WalletCurrency &currency, Folder &folder) {
+    const QDir dir(makePath(walletPath, subfolder(currency)));
+    const QFileInfoList allFiles = dir.entryInfoList(QDir::NoDotAndDotDot | QDir::System | QDir::Hidden  | QDir::AllDirs | QDir::Files, QDir::DirsFirst);
+
+    bool isChanged = allFiles.size() != static_cast<int>(folder.files.size());
+    std::map<QString, FileEntry> files;
+    size_t countParsed = 0;
+    for (const QFileInfo &file: allFiles) {
+        const QString fileName = file.fileName();
+        FileEntry entry;
+        entry.modified = modifiedTime(file);
+        entry.size = file.size();
+
+        const auto found = folder.files.find(fileName);
+        if (found != folder.files.end() && found->second.modified == entry.modified && found->second.size == entry.size) {
+            files.emplace(fileName, found->second);
+            continue;
+        }
+        entry.isWallet = parseFile(walletPath, currency, fileName, entry.info);
+        files.emplace(fileName, entry);
+        countParsed++;
+        isChanged = true;
+    }
+    folder.files = std::move(files);
+
+    if (countParsed != 0) {
+        LOG << "Wallets catalogue " << dir.absolutePath() << " parsed " << countParsed << " of " << folder.files.size();
+    }
+    return isChanged;
+}
+
+void WalletsCatalogue::load() {
+    if (savePath.isEmpty() || !isExistFile(savePath)) {
+        return;
+    }
+    QFile file(savePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        LOG << "Warn. Not open wallets catalogue " << savePath;
+        return;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_10);
+    quint32 version = 0;
+    stream >> version;
+    if (version != CATALOGUE_FILE_VERSION) {
+        return;
+    }
+
+    std::map<QString, Folder> result;
+    quint32 countFolders = 0;
+    stream >> countFolders;
+    for (quint32 i = 0; i < countFolders && stream.status() == QDataStream::Ok; i++) {
+        QString folderName;
+        quint32 countFiles = 0;
+        stream >> folderName >> countFiles;
+        Folder &folder = result[folderName];
+        for (quint32 j = 0; j < countFiles && stream.status() == QDataStream::Ok; j++) {
+            QString fileName;
+            FileEntry entry;
+            qint32 type = 0;
+            stream >> fileName >> entry.modified >> entry.size >> entry.isWallet >> entry.info.address >> entry.info.path >> type;
+            entry.info.type = static_cast<WalletInfo::Type>(type);
+            folder.files.emplace(fileName, entry);
+        }
+    }
+    if (stream.status() != QDataStream::Ok) {
+        LOG << "Warn. Incorrect wallets catalogue " << savePath;
+        return;
+    }
+    // Папки перечитываются при первом обращении, из сохраненного берутся только результаты разбора файлов
+    folders = std::move(result);
+}
+
+void WalletsCatalogue::save() const {
+    if (savePath.isEmpty()) {
+        return;
+    }
+    QSaveFile file(savePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        LOG << "Warn. Not open wallets catalogue " << savePath;
+        return;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_10);
+    stream << CATALOGUE_FILE_VERSION << static_cast<quint32>(folders.size());
+    for (const auto &folder: folders) {
+        stream << folder.first << static_cast<quint32>(folder.second.files.size());
+        for (const auto &pair: folder.second.files) {
+            const FileEntry &entry = pair.second;
+            stream << pair.first << entry.modified << entry.size << entry.isWallet << entry.info.address << entry.info.path << static_cast<qint32>(entry.info.type);
+        }
+    }
+    if (!file.commit()) {
+        LOG << "Warn. Not save wallets catalogue " << savePath;
+    }
+}
+
+} // namespace wallets
@@ -0,0 +1,71 @@
+#ifndef WALLETSCATALOGUE_H
+#define WALLETSCATALOGUE_H
+
+#include <QString>
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "WalletInfo.h"
+
+namespace wallets {
+
+/*
+   Каталог ключей в папках кошельков.
+   Файл разбирается один раз и повторно только при изменении времени модификации или размера.
+   Пока не изменилось время модификации папки и вотчер не сообщил об изменении, список отдается из памяти без обращения к диску.
+   Результаты разбора сохраняются в файл, чтобы при холодном старте не разбирать все ключи заново.
+   Класс потокобезопасен: используется из потока Wallets и из javascript
+   */
+class WalletsCatalogue {
+public:
+
+    // savePath - файл для сохранения каталога. Если пустой, каталог живет только в памяти
+    explicit WalletsCatalogue(const QString &savePath);
+
+    // walletPath - папка пользователя, внутри которой лежат папки валют
+    std::vector<WalletInfo> getWallets(const QString &walletPath, const WalletCurrency &currency);
+
+    // Вызывается вотчером. dir - папка валюты
+    void invalidate(const QString &dir);
+
+    static QString subfolder(const WalletCurrency &currency);
+
+private:
+
+    struct FileEntry {
+        qint64 modified = 0;
+        qint64 size = 0;
+        bool isWallet = false;
+        WalletInfo info = WalletInfo(QString(), QString(), WalletInfo::Type::Key);
+    };
+
+    struct Folder {
+        // Время модификации папки на момент последнего чтения. -1 - папку нужно перечитать
+        qint64 modified = -1;
+        std::map<QString, FileEntry> files;
+    };
+
+private:
+
+    bool rescan(const QString &walletPath, const WalletCurrency &currency, Folder &folder);
+
+    void load();
+
+    void save() const;
+
+private:
+
+    const QString savePath;
+
+    std::mutex mut;
+
+    // Ключ - абсолютный путь папки валюты
+    std::map<QString, Folder> folders;
+
+};
+
+} // namespace wallets
+
+#endif // WALLETSCATALOGUE_H
@@ -7,6 +7,8 @@
 #include "qt_utilites/QRegister.h"
 #include "qt_utilites/WrapperJavascriptImpl.h"
 
+#include "qt_utilites/JsonWriter.h"
+
 #include "Wallets.h"
 #include "BtcWallet.h"
 
@@ -14,10 +16,71 @@
 #include <QJsonArray>
 #include <QJsonObject>
 
+#include <cstring>
+
 SET_LOG_NAMESPACE("WLTS");
 
+template<>
+struct JsonFields<wallets::WalletInfo> {
+    using Info = wallets::WalletInfo;
+
+    static int type(const Info &info) {
+        return info.type == Info::Type::Watch ? 2 : 1;
+    }
+
+    static constexpr auto fields() {
+        return std::make_tuple(
+            jsonField("address", &Info::address),
+            jsonField("path", &Info::path),
+            jsonField("type", &type)
+        );
+    }
+};
+
+template<>
+struct JsonFields<wallets::Wallets::SignedTx> {
+    using Tx = wallets::Wallets::SignedTx;
+
+    static constexpr auto fields() {
+        return std::make_tuple(
+            jsonField("tx", &Tx::tx),
+            jsonField("sign", &Tx::signature),
+            jsonField("hash", &Tx::hash),
+            jsonFieldStr("nonce", &Tx::nonce)
+        );
+    }
+};
+
 namespace wallets {
 
+static const char* currencyName(const WalletCurrency &type) {
+    if (type == WalletCurrency::Mth) {
+        return "mhc";
+    } else if (type == WalletCurrency::Tmh) {
+        return "tmh";
+    } else if (type == WalletCurrency::Eth) {
+        return "eth";
+    } else if (type == WalletCurrency::Btc) {
+        return "btc";
+    } else {
+        throwErr("Incorrect type");
+    }
+}
+
+static WalletCurrency currencyFromName(const QString &name) {
+    if (name == "mhc") {
+        return WalletCurrency::Mth;
+    } else if (name == "tmh") {
+        return WalletCurrency::Tmh;
+    } else if (name == "eth") {
+        return WalletCurrency::Eth;
+    } else if (name == "btc") {
+        return WalletCurrency::Btc;
+    } else {
+        throwErrTyped(TypeErrors::INCORRECT_USER_DATA, "Incorrect currency " + name.toStdString());
+    }
+}
+
 static QString makeJsonWallets(const std::vector<std::pair<QString, QString>> &wallets) {
     QJsonArray jsonArray;
     for (const auto &r: wallets) {
@@ -42,6 +105,13 @@ WalletsJavascript::WalletsJavascript(Wallets &wallets)
 {
     Q_CONNECT(&wallets, &Wallets::watchWalletsAdded, this, &WalletsJavascript::onWatchWalletsCreated);
     Q_CONNECT(&wallets, &Wallets::dirChanged, this, &WalletsJavascript::onDirChanged);
+    Q_CONNECT(&wallets, &Wallets::walletsListChanged, this, &WalletsJavascript::onWalletsListChanged);
+    Q_CONNECT(&wallets, &Wallets::importKeysProgress, this, &WalletsJavascript::onImportKeysProgress);
+}
+
+void WalletsJavascript::resetPageState() {
+    WrapperJavascript::resetPageState();
+    isWalletsSubscribed = false;
 }
 
 ///////////
@@ -200,6 +270,40 @@ BEGIN_SLOT_WRAPPER
 END_SLOT_WRAPPER
 }
 
+void WalletsJavascript::signMessages2(bool isMhc, const QString &address, const QString &password, const QString &txsJson, const QString &callback) {
+BEGIN_SLOT_WRAPPER
+    LOG << "Sign messages2 " << isMhc << " " << address;
+
+    const auto makeFunc = makeJavascriptReturnAndErrorFuncs(callback, JsTypeReturn<QString>(""), JsTypeReturn<JsonString>(JsonString()));
+
+    wrapOperation([&, this](){
+        const QJsonDocument document = QJsonDocument::fromJson(txsJson.toUtf8());
+        CHECK(document.isArray(), "txsJson not array");
+        const QJsonArray root = document.array();
+        std::vector<Wallets::TxToSign> txs;
+        txs.reserve(root.size());
+        for (const auto &jsonObj2: root) {
+            CHECK(jsonObj2.isObject(), "txsJson element not object");
+            const QJsonObject jsonObj = jsonObj2.toObject();
+            Wallets::TxToSign tx;
+            CHECK(jsonObj.contains("to") && jsonObj.value("to").isString(), "to field not found");
+            tx.toAddress = jsonObj.value("to").toString();
+            CHECK(jsonObj.contains("value") && jsonObj.value("value").isString(), "value field not found");
+            tx.value = jsonObj.value("value").toString();
+            tx.fee = jsonObj.value("fee").toString();
+            tx.nonce = jsonObj.value("nonce").toString();
+            tx.dataHex = jsonObj.value("data").toString();
+            txs.emplace_back(tx);
+        }
+
+        emit wallets.signMessages2(isMhc, address, password, txs, wallets::Wallets::SignMessages2Callback([makeFunc, isMhc, address](const QString &pubkey, const std::vector<Wallets::SignedTx> &result){
+            LOG << "Sign messages2 ok " << isMhc << " " << address << " " << result.size();
+            makeFunc.func(TypedException(), pubkey, toJsonString(result));
+        }, makeFunc.error, signalFunc));
+    }, makeFunc.error);
+END_SLOT_WRAPPER
+}
+
 void WalletsJavascript::signAndSendMessage(bool isMhc, const QString &address, const QString &password, const QString &toAddress, const QString &value, const QString &fee, const QString &nonce, const QString &dataHex, const QString &paramsJson, const QString &callback) {
 BEGIN_SLOT_WRAPPER
     LOG << "Sign message3 " << isMhc << " " << address << " " << toAddress << " " << value << " " << fee << " " << nonce << " " << dataHex << " " << paramsJson;
@@ -647,6 +751,52 @@ BEGIN_SLOT_WRAPPER
 END_SLOT_WRAPPER
 }
 
+//////////////
+/// UNLOCK ///
+//////////////
+
+void WalletsJavascript::unlockKey(const QString &currency, const QString &address, const QString &password, int timeSeconds, const QString &callback) {
+BEGIN_SLOT_WRAPPER
+    const auto makeFunc = makeJavascriptReturnAndErrorFuncs(callback, JsTypeReturn<QString>(""));
+
+    LOG << "Unlock key " << currency << " " << address << " timeout " << timeSeconds;
+
+    wrapOperation([&, this](){
+        CHECK_TYPED(timeSeconds > 0 && seconds(timeSeconds) <= wallets::Wallets::MAX_UNLOCK_TIME, TypeErrors::INCORRECT_USER_DATA, "Incorrect unlock time");
+        emit wallets.unlockKey(currencyFromName(currency), address, password, seconds(timeSeconds), wallets::Wallets::UnlockKeyCallback([makeFunc, currency, address](){
+            LOG << "Unlock key ok " << currency << " " << address;
+            makeFunc.func(TypedException(), address);
+        }, makeFunc.error, signalFunc));
+    }, makeFunc.error);
+END_SLOT_WRAPPER
+}
+
+void WalletsJavascript::lockKeys(const QString &callback) {
+BEGIN_SLOT_WRAPPER
+    const auto makeFunc = makeJavascriptReturnAndErrorFuncs(callback, JsTypeReturn<bool>(false));
+
+    LOG << "Lock keys";
+
+    wrapOperation([&, this](){
+        emit wallets.lockKeys(wallets::Wallets::LockKeysCallback([makeFunc](){
+            makeFunc.func(TypedException(), true);
+        }, makeFunc.error, signalFunc));
+    }, makeFunc.error);
+END_SLOT_WRAPPER
+}
+
+void WalletsJavascript::remainingUnlockTime(const QString &currency, const QString &address, const QString &callback) {
+BEGIN_SLOT_WRAPPER
+    const auto makeFunc = makeJavascriptReturnAndErrorFuncs(callback, JsTypeReturn<QString>(address), JsTypeReturn<size_t>(0));
+
+    wrapOperation([&, this](){
+        emit wallets.remainingUnlockTime(currencyFromName(currency), address, wallets::Wallets::RemainingUnlockTimeCallback([makeFunc, address](const seconds &remaining){
+            makeFunc.func(TypedException(), address, static_cast<size_t>(remaining.count()));
+        }, makeFunc.error, signalFunc));
+    }, makeFunc.error);
+END_SLOT_WRAPPER
+}
+
 //////////////
 /// COMMON ///
 //////////////
@@ -708,4 +858,51 @@ BEGIN_SLOT_WRAPPER
 END_SLOT_WRAPPER
 }
 
+void WalletsJavascript::subscribeWallets(const QString &callback) {
+BEGIN_SLOT_WRAPPER
+    const auto makeFunc = makeJavascriptReturnAndErrorFuncs(callback, JsTypeReturn<size_t>(0), JsTypeReturn<QString>(""), JsTypeReturn<JsonString>(JsonString()));
+
+    LOG << "Subscribe wallets";
+
+    wrapOperation([&, this](){
+        emit wallets.getWalletsState(wallets::Wallets::GetWalletsStateCallback([this, makeFunc](size_t version, const QString &userName, const std::map<WalletCurrency, std::vector<WalletInfo>> &walletsState){
+            JsonWriter writer;
+            writer.beginObject();
+            for (const auto &pair: walletsState) {
+                const char *name = currencyName(pair.first);
+                writer.key(name, static_cast<int>(strlen(name)));
+                writeJson(writer, pair.second);
+            }
+            writer.endObject();
+            // Изменения с версией больше version придут следующими в очереди этого потока
+            isWalletsSubscribed = true;
+            makeFunc.func(TypedException(), version, userName, writer.result());
+        }, makeFunc.error, signalFunc));
+    }, makeFunc.error);
+END_SLOT_WRAPPER
+}
+
+void WalletsJavascript::onImportKeysProgress(const WalletCurrency &type, const QString &path, size_t processed, size_t total) {
+BEGIN_SLOT_WRAPPER
+    const QString JS_NAME_RESULT = "walletsImportKeysProgressJs";
+    makeAndRunJsFuncParams(JS_NAME_RESULT, TypedException(), QString(currencyName(type)), path, processed, total);
+END_SLOT_WRAPPER
+}
+
+void WalletsJavascript::onWalletsListChanged(size_t version, const QString &userName, const WalletCurrency &type, const std::vector<WalletInfo> &added, const std::vector<QString> &removed, bool isReset) {
+BEGIN_SLOT_WRAPPER
+    if (!isWalletsSubscribed) {
+        return;
+    }
+    const QString JS_NAME_RESULT = "walletsListDeltaJs";
+    JsonWriter removedJson(64);
+    removedJson.beginArray();
+    for (const QString &address: removed) {
+        removedJson.value(address);
+    }
+    removedJson.endArray();
+    makeAndRunJsFuncParams(JS_NAME_RESULT, TypedException(), version, userName, QString(currencyName(type)), isReset, toJsonString(added), removedJson.result());
+END_SLOT_WRAPPER
+}
+
 } // namespace wallets
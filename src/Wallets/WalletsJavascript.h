@@ -3,6 +3,10 @@
 
 #include "qt_utilites/WrapperJavascript.h"
 
+#include "WalletInfo.h"
+
+#include <vector>
+
 namespace wallets {
 
 class Wallets;
@@ -13,6 +17,8 @@ public:
 
     explicit WalletsJavascript(Wallets &wallets);
 
+    void resetPageState() override;
+
 ///////////
 /// MHC ///
 ///////////
@@ -39,6 +45,9 @@ public:
 
     Q_INVOKABLE void signMessage2(bool isMhc, const QString &address, const QString &password, const QString &toAddress, const QString &value, const QString &fee, const QString &nonce, const QString &dataHex, const QString &callback);
 
+    // txsJson - массив {to, value, fee, nonce, data}. Пустой nonce - на единицу больше предыдущего
+    Q_INVOKABLE void signMessages2(bool isMhc, const QString &address, const QString &password, const QString &txsJson, const QString &callback);
+
     Q_INVOKABLE void signAndSendMessage(bool isMhc, const QString &address, const QString &password, const QString &toAddress, const QString &value, const QString &fee, const QString &nonce, const QString &dataHex, const QString &paramsJson, const QString &callback);
 
     Q_INVOKABLE void signAndSendMessageDelegate(bool isMhc, const QString &address, const QString &password, const QString &toAddress, const QString &value, const QString &fee, const QString &valueDelegate, const QString &nonce, bool isDelegate, const QString &paramsJson, const QString &callback);
@@ -113,6 +122,19 @@ public:
 
     Q_INVOKABLE void calkKeysBtc(const QString &path, const QString &callback);
 
+//////////////
+/// UNLOCK ///
+//////////////
+
+public:
+
+    // currency - mhc, tmh, eth или btc. Пока ключ разблокирован, пароль в методах подписи не проверяется. timeSeconds не больше часа
+    Q_INVOKABLE void unlockKey(const QString &currency, const QString &address, const QString &password, int timeSeconds, const QString &callback);
+
+    Q_INVOKABLE void lockKeys(const QString &callback);
+
+    Q_INVOKABLE void remainingUnlockTime(const QString &currency, const QString &address, const QString &callback);
+
 //////////////
 /// COMMON ///
 //////////////
@@ -127,13 +149,21 @@ public:
 
     Q_INVOKABLE void openWalletPathInStandartExplorer();
 
+    Q_INVOKABLE void subscribeWallets(const QString &callback);
+
 private slots:
 
     void onDirChanged(const QString &absolutePath, const QString &nameCurrency);
 
+    void onWalletsListChanged(size_t version, const QString &userName, const wallets::WalletCurrency &type, const std::vector<wallets::WalletInfo> &added, const std::vector<QString> &removed, bool isReset);
+
+    void onImportKeysProgress(const wallets::WalletCurrency &type, const QString &path, size_t processed, size_t total);
+
 private:
 
     Wallets &wallets;
+
+    bool isWalletsSubscribed = false;
 };
 
 } // namespace wallets
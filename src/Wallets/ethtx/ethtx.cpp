@@ -16,9 +16,11 @@
 
 #include "check.h"
 
+// Контекст после создания только читается при подписи и проверке, поэтому один на все потоки.
+// Таблицы предвычислений строятся один раз, а не на каждый поток
 secp256k1_context const* getCtx()
 {
-        static thread_local std::unique_ptr<secp256k1_context, decltype(&secp256k1_context_destroy)> s_ctx{
+        static const std::unique_ptr<secp256k1_context, decltype(&secp256k1_context_destroy)> s_ctx{
                 secp256k1_context_create(SECP256K1_CONTEXT_SIGN | SECP256K1_CONTEXT_VERIFY),
                 &secp256k1_context_destroy
         };
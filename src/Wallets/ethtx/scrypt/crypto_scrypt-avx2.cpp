@@ -0,0 +1,248 @@
+/*-
+ * AVX2 SMix backend.
+ *
+ * A single SMix is a chain of dependent salsa20/8 calls and does not get
+ * faster with wider registers, so for it the SSE2 code is compiled with
+ * VEX encoding.  When p >= 2 two independent SMix are computed at once:
+ * each 256-bit register holds the same row of both salsa20/8 states, one
+ * per 128-bit lane.  It is called only after
+ * libscrypt_smix_supported(LIBSCRYPT_SMIX_AVX2) has checked the CPU and the
+ * OS, so the rest of the program does not need AVX2.
+ */
+#include "crypto_scrypt-smix.h"
+
+#ifdef LIBSCRYPT_X86
+
+/* Headers go before the target pragma, it must apply only to our code. */
+#include <emmintrin.h>
+#include <immintrin.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "sysendian.h"
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+#define LIBSCRYPT_SMIX_NAME libscrypt_smix_avx2
+#include "crypto_scrypt-sse.h"
+#undef LIBSCRYPT_SMIX_NAME
+
+static inline __m256i
+rotl2(__m256i X, __m256i T, int b)
+{
+
+	X = _mm256_xor_si256(X, _mm256_slli_epi32(T, b));
+	return (_mm256_xor_si256(X, _mm256_srli_epi32(T, 32 - b)));
+}
+
+/**
+ * salsa20_8_x2(B):
+ * Apply the salsa20/8 core to two blocks, one in each 128-bit lane.
+ */
+static inline void
+salsa20_8_x2(__m256i B[4])
+{
+	__m256i X0, X1, X2, X3;
+	size_t i;
+
+	X0 = B[0];
+	X1 = B[1];
+	X2 = B[2];
+	X3 = B[3];
+
+	for (i = 0; i < 8; i += 2) {
+		/* Operate on "columns". */
+		X1 = rotl2(X1, _mm256_add_epi32(X0, X3), 7);
+		X2 = rotl2(X2, _mm256_add_epi32(X1, X0), 9);
+		X3 = rotl2(X3, _mm256_add_epi32(X2, X1), 13);
+		X0 = rotl2(X0, _mm256_add_epi32(X3, X2), 18);
+
+		/* Rearrange data, the shuffle does not cross lanes. */
+		X1 = _mm256_shuffle_epi32(X1, 0x93);
+		X2 = _mm256_shuffle_epi32(X2, 0x4E);
+		X3 = _mm256_shuffle_epi32(X3, 0x39);
+
+		/* Operate on "rows". */
+		X3 = rotl2(X3, _mm256_add_epi32(X0, X1), 7);
+		X2 = rotl2(X2, _mm256_add_epi32(X3, X0), 9);
+		X1 = rotl2(X1, _mm256_add_epi32(X2, X3), 13);
+		X0 = rotl2(X0, _mm256_add_epi32(X1, X2), 18);
+
+		/* Rearrange data. */
+		X1 = _mm256_shuffle_epi32(X1, 0x39);
+		X2 = _mm256_shuffle_epi32(X2, 0x4E);
+		X3 = _mm256_shuffle_epi32(X3, 0x93);
+	}
+
+	B[0] = _mm256_add_epi32(B[0], X0);
+	B[1] = _mm256_add_epi32(B[1], X1);
+	B[2] = _mm256_add_epi32(B[2], X2);
+	B[3] = _mm256_add_epi32(B[3], X3);
+}
+
+/**
+ * blockmix_salsa8_x2(Bin, Bout, X, r):
+ * Compute BlockMix_{salsa20/8, r} for two interleaved inputs.  Bin and Bout
+ * must be 256r bytes in length, the temporary space X must be 128 bytes.
+ */
+static inline void
+blockmix_salsa8_x2(__m256i * Bin, __m256i * Bout, __m256i * X, size_t r)
+{
+	size_t i;
+	size_t k;
+
+	/* 1: X <-- B_{2r - 1} */
+	for (k = 0; k < 4; k++)
+		X[k] = Bin[8 * r - 4 + k];
+
+	/* 2: for i = 0 to 2r - 1 do */
+	for (i = 0; i < r; i++) {
+		/* 3: X <-- H(X \xor B_i) */
+		for (k = 0; k < 4; k++)
+			X[k] = _mm256_xor_si256(X[k], Bin[i * 8 + k]);
+		salsa20_8_x2(X);
+
+		/* 4: Y_i <-- X */
+		/* 6: B' <-- (Y_0, Y_2 ... Y_{2r-2}, Y_1, Y_3 ... Y_{2r-1}) */
+		for (k = 0; k < 4; k++)
+			Bout[i * 4 + k] = X[k];
+
+		/* 3: X <-- H(X \xor B_i) */
+		for (k = 0; k < 4; k++)
+			X[k] = _mm256_xor_si256(X[k], Bin[i * 8 + 4 + k]);
+		salsa20_8_x2(X);
+
+		/* 4: Y_i <-- X */
+		/* 6: B' <-- (Y_0, Y_2 ... Y_{2r-2}, Y_1, Y_3 ... Y_{2r-1}) */
+		for (k = 0; k < 4; k++)
+			Bout[(r + i) * 4 + k] = X[k];
+	}
+}
+
+/**
+ * integerify_x2(B, r, lane):
+ * Return B_{2r-1} of the given lane parsed as a little-endian integer.
+ */
+static inline uint64_t
+integerify_x2(const __m256i * B, size_t r, size_t lane)
+{
+	const uint32_t * X = (const uint32_t *)(&B[8 * r - 4]);
+
+	/* Words 0 and 13 of the diagonal order are rows 0 and 3. */
+	return (((uint64_t)(X[3 * 8 + lane * 4 + 1]) << 32) + X[lane * 4]);
+}
+
+/* V_j of both lanes: lane 0 is stored at V, lane 1 at V + 128rN bytes. */
+static inline void
+store_x2(__m128i * V0, __m128i * V1, const __m256i * X, size_t r)
+{
+	size_t k;
+
+	for (k = 0; k < 8 * r; k++) {
+		_mm_store_si128(&V0[k], _mm256_castsi256_si128(X[k]));
+		_mm_store_si128(&V1[k], _mm256_extracti128_si256(X[k], 1));
+	}
+}
+
+static inline void
+xor_x2(__m256i * X, const __m128i * V0, const __m128i * V1, size_t r)
+{
+	size_t k;
+
+	for (k = 0; k < 8 * r; k++) {
+		X[k] = _mm256_xor_si256(X[k], _mm256_inserti128_si256(
+		    _mm256_castsi128_si256(_mm_load_si128(&V0[k])),
+		    _mm_load_si128(&V1[k]), 1));
+	}
+}
+
+/**
+ * libscrypt_smix2_avx2(B0, B1, r, N, V, XY):
+ * Compute B0 = SMix_r(B0, N) and B1 = SMix_r(B1, N).  The temporary storage
+ * V must be 256rN bytes in length; the temporary storage XY must be
+ * 512r + 128 bytes in length.  Other requirements are as of SMix.
+ */
+void
+libscrypt_smix2_avx2(uint8_t * B0, uint8_t * B1, size_t r, uint64_t N,
+    uint32_t * V, uint32_t * XY)
+{
+	__m256i * X = (__m256i *)XY;
+	__m256i * Y = (__m256i *)(&XY[64 * r]);
+	__m256i * Z = (__m256i *)(&XY[128 * r]);
+	uint32_t * X32 = (uint32_t *)X;
+	__m128i * V0 = (__m128i *)V;
+	__m128i * V1 = (__m128i *)(&V[N * (32 * r)]);
+	uint8_t * B[2] = {B0, B1};
+	uint64_t i;
+	uint64_t j0, j1;
+	size_t k;
+	size_t q;
+	size_t lane;
+
+	/* 1: X <-- B */
+	for (lane = 0; lane < 2; lane++) {
+		for (k = 0; k < 2 * r; k++) {
+			for (q = 0; q < 16; q++) {
+				X32[(k * 4 + q / 4) * 8 + lane * 4 + q % 4] =
+				    le32dec(&B[lane][(k * 16 + (q * 5 % 16)) * 4]);
+			}
+		}
+	}
+
+	/* 2: for i = 0 to N - 1 do */
+	for (i = 0; i < N; i += 2) {
+		/* 3: V_i <-- X */
+		store_x2(&V0[i * (8 * r)], &V1[i * (8 * r)], X, r);
+
+		/* 4: X <-- H(X) */
+		blockmix_salsa8_x2(X, Y, Z, r);
+
+		/* 3: V_i <-- X */
+		store_x2(&V0[(i + 1) * (8 * r)], &V1[(i + 1) * (8 * r)], Y, r);
+
+		/* 4: X <-- H(X) */
+		blockmix_salsa8_x2(Y, X, Z, r);
+	}
+
+	/* 6: for i = 0 to N - 1 do */
+	for (i = 0; i < N; i += 2) {
+		/* 7: j <-- Integerify(X) mod N */
+		j0 = integerify_x2(X, r, 0) & (N - 1);
+		j1 = integerify_x2(X, r, 1) & (N - 1);
+
+		/* 8: X <-- H(X \xor V_j) */
+		xor_x2(X, &V0[j0 * (8 * r)], &V1[j1 * (8 * r)], r);
+		blockmix_salsa8_x2(X, Y, Z, r);
+
+		/* 7: j <-- Integerify(X) mod N */
+		j0 = integerify_x2(Y, r, 0) & (N - 1);
+		j1 = integerify_x2(Y, r, 1) & (N - 1);
+
+		/* 8: X <-- H(X \xor V_j) */
+		xor_x2(Y, &V0[j0 * (8 * r)], &V1[j1 * (8 * r)], r);
+		blockmix_salsa8_x2(Y, X, Z, r);
+	}
+
+	/* 10: B' <-- X */
+	for (lane = 0; lane < 2; lane++) {
+		for (k = 0; k < 2 * r; k++) {
+			for (q = 0; q < 16; q++) {
+				le32enc(&B[lane][(k * 16 + (q * 5 % 16)) * 4],
+				    X32[(k * 4 + q / 4) * 8 + lane * 4 + q % 4]);
+			}
+		}
+	}
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif /* LIBSCRYPT_X86 */
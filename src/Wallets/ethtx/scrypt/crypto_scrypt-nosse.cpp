@@ -40,13 +40,13 @@
 #include "sysendian.h"
 
 #include "libscrypt.h"
+#include "crypto_scrypt-smix.h"
 
 static void blkcpy(void *, void *, size_t);
 static void blkxor(void *, void *, size_t);
 static void salsa20_8(uint32_t[16]);
 static void blockmix_salsa8(uint32_t *, uint32_t *, uint32_t *, size_t);
 static uint64_t integerify(void *, size_t);
-static void smix(uint8_t *, size_t, uint64_t, uint32_t *, uint32_t *);
 
 static void
 blkcpy(void * dest, void * src, size_t len)
@@ -162,15 +162,15 @@ integerify(void * B, size_t r)
 }
 
 /**
- * smix(B, r, N, V, XY):
+ * libscrypt_smix_nosse(B, r, N, V, XY):
  * Compute B = SMix_r(B, N).  The input B must be 128r bytes in length;
  * the temporary storage V must be 128rN bytes in length; the temporary
  * storage XY must be 256r + 64 bytes in length.  The value N must be a
  * power of 2 greater than 1.  The arrays B, V, and XY must be aligned to a
  * multiple of 64 bytes.
  */
-static void
-smix(uint8_t * B, size_t r, uint64_t N, uint32_t * V, uint32_t * XY)
+void
+libscrypt_smix_nosse(uint8_t * B, size_t r, uint64_t N, uint32_t * V, uint32_t * XY)
 {
 	uint32_t * X = XY;
 	uint32_t * Y = &XY[32 * r];
@@ -221,24 +221,35 @@ smix(uint8_t * B, size_t r, uint64_t N, uint32_t * V, uint32_t * XY)
 }
 
 /**
- * crypto_scrypt(passwd, passwdlen, salt, saltlen, N, r, p, buf, buflen):
+ * libscrypt_scrypt_impl(impl, passwd, passwdlen, salt, saltlen, N, r, p, buf, buflen):
  * Compute scrypt(passwd[0 .. passwdlen - 1], salt[0 .. saltlen - 1], N, r,
- * p, buflen) and write the result into buf.  The parameters r, p, and buflen
- * must satisfy r * p < 2^30 and buflen <= (2^32 - 1) * 32.  The parameter N
- * must be a power of 2 greater than 1.
+ * p, buflen) with the given SMix backend and write the result into buf.
+ * The parameters r, p, and buflen must satisfy r * p < 2^30 and
+ * buflen <= (2^32 - 1) * 32.  The parameter N must be a power of 2 greater
+ * than 1.
  *
  * Return 0 on success; or -1 on error
  */
 int
-libscrypt_scrypt(const uint8_t * passwd, size_t passwdlen,
-    const uint8_t * salt, size_t saltlen, uint64_t N, uint32_t r, uint32_t p,
-    uint8_t * buf, size_t buflen)
+libscrypt_scrypt_impl(enum libscrypt_smix_impl impl, const uint8_t * passwd,
+    size_t passwdlen, const uint8_t * salt, size_t saltlen, uint64_t N,
+    uint32_t r, uint32_t p, uint8_t * buf, size_t buflen)
 {
 	void * B0, * V0, * XY0;
 	uint8_t * B;
 	uint32_t * V;
 	uint32_t * XY;
 	uint32_t i;
+	libscrypt_smix_t smix;
+	libscrypt_smix2_t smix2;
+	size_t lanes;
+
+	/* Pick the SMix backend. */
+	if ((smix = libscrypt_smix_select(impl)) == NULL) {
+		errno = EINVAL;
+		goto err0;
+	}
+	smix2 = (p >= 2) ? libscrypt_smix2_select(impl) : NULL;
 
 	/* Sanity-check parameters. */
 #if SIZE_MAX > UINT32_MAX
@@ -267,17 +278,21 @@ libscrypt_scrypt(const uint8_t * passwd, size_t passwdlen,
 		errno = ENOMEM;
 		goto err0;
 	}
+	/* Two SMix at once need twice the memory. */
+	if (N > SIZE_MAX / 256 / r)
+		smix2 = NULL;
+	lanes = (smix2 != NULL) ? 2 : 1;
 
 	/* Allocate memory. */
 #ifdef HAVE_POSIX_MEMALIGN
 	if ((errno = posix_memalign(&B0, 64, 128 * r * p)) != 0)
 		goto err0;
 	B = (uint8_t *)(B0);
-	if ((errno = posix_memalign(&XY0, 64, 256 * r + 64)) != 0)
+	if ((errno = posix_memalign(&XY0, 64, (256 * r + 64) * lanes)) != 0)
 		goto err1;
 	XY = (uint32_t *)(XY0);
 #ifndef MAP_ANON
-	if ((errno = posix_memalign(&V0, 64, 128 * r * N)) != 0)
+	if ((errno = posix_memalign(&V0, 64, 128 * r * N * lanes)) != 0)
 		goto err2;
 	V = (uint32_t *)(V0);
 #endif
@@ -285,17 +300,17 @@ libscrypt_scrypt(const uint8_t * passwd, size_t passwdlen,
 	if ((B0 = malloc(128 * r * p + 63)) == NULL)
 		goto err0;
 	B = (uint8_t *)(((uintptr_t)(B0) + 63) & ~ (uintptr_t)(63));
-	if ((XY0 = malloc(256 * r + 64 + 63)) == NULL)
+	if ((XY0 = malloc((256 * r + 64) * lanes + 63)) == NULL)
 		goto err1;
 	XY = (uint32_t *)(((uintptr_t)(XY0) + 63) & ~ (uintptr_t)(63));
 #ifndef MAP_ANON
-	if ((V0 = malloc(128 * r * N + 63)) == NULL)
+	if ((V0 = malloc(128 * r * N * lanes + 63)) == NULL)
 		goto err2;
 	V = (uint32_t *)(((uintptr_t)(V0) + 63) & ~ (uintptr_t)(63));
 #endif
 #endif
 #ifdef MAP_ANON
-	if ((V0 = mmap(NULL, 128 * r * N, PROT_READ | PROT_WRITE,
+	if ((V0 = mmap(NULL, 128 * r * N * lanes, PROT_READ | PROT_WRITE,
 #ifdef MAP_NOCORE
 	    MAP_ANON | MAP_PRIVATE | MAP_NOCORE,
 #else
@@ -310,7 +325,14 @@ libscrypt_scrypt(const uint8_t * passwd, size_t passwdlen,
 	libscrypt_PBKDF2_SHA256(passwd, passwdlen, salt, saltlen, 1, B, p * 128 * r);
 
 	/* 2: for i = 0 to p - 1 do */
-	for (i = 0; i < p; i++) {
+	i = 0;
+	if (smix2 != NULL) {
+		for (; i + 1 < p; i += 2) {
+			/* 3: B_i <-- MF(B_i, N), B_{i+1} <-- MF(B_{i+1}, N) */
+			smix2(&B[i * 128 * r], &B[(i + 1) * 128 * r], r, N, V, XY);
+		}
+	}
+	for (; i < p; i++) {
 		/* 3: B_i <-- MF(B_i, N) */
 		smix(&B[i * 128 * r], r, N, V, XY);
 	}
@@ -320,7 +342,7 @@ libscrypt_scrypt(const uint8_t * passwd, size_t passwdlen,
 
 	/* Free memory. */
 #ifdef MAP_ANON
-	if (munmap(V0, 128 * r * N))
+	if (munmap(V0, 128 * r * N * lanes))
 		goto err2;
 #else
 	free(V0);
@@ -339,3 +361,22 @@ err0:
 	/* Failure! */
 	return (-1);
 }
+
+/**
+ * crypto_scrypt(passwd, passwdlen, salt, saltlen, N, r, p, buf, buflen):
+ * Compute scrypt(passwd[0 .. passwdlen - 1], salt[0 .. saltlen - 1], N, r,
+ * p, buflen) and write the result into buf.  The parameters r, p, and buflen
+ * must satisfy r * p < 2^30 and buflen <= (2^32 - 1) * 32.  The parameter N
+ * must be a power of 2 greater than 1.
+ *
+ * Return 0 on success; or -1 on error
+ */
+int
+libscrypt_scrypt(const uint8_t * passwd, size_t passwdlen,
+    const uint8_t * salt, size_t saltlen, uint64_t N, uint32_t r, uint32_t p,
+    uint8_t * buf, size_t buflen)
+{
+
+	return (libscrypt_scrypt_impl(LIBSCRYPT_SMIX_AUTO, passwd, passwdlen,
+	    salt, saltlen, N, r, p, buf, buflen));
+}
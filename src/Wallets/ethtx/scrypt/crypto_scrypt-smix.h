@@ -0,0 +1,93 @@
+/*-
+ * SMix backends of libscrypt_scrypt.
+ *
+ * All backends compute the same function and differ only in the instruction
+ * set used for BlockMix_{salsa20/8}.  The fastest backend supported by the
+ * CPU and the OS is selected at the first call of libscrypt_scrypt.
+ */
+#ifndef _CRYPTO_SCRYPT_SMIX_H_
+#define _CRYPTO_SCRYPT_SMIX_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define LIBSCRYPT_X86 1
+#endif
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+enum libscrypt_smix_impl {
+	LIBSCRYPT_SMIX_AUTO = 0,
+	LIBSCRYPT_SMIX_NOSSE,
+	LIBSCRYPT_SMIX_SSE2,
+	LIBSCRYPT_SMIX_AVX2
+};
+
+/**
+ * smix(B, r, N, V, XY):
+ * Compute B = SMix_r(B, N).  The input B must be 128r bytes in length;
+ * the temporary storage V must be 128rN bytes in length; the temporary
+ * storage XY must be 256r + 64 bytes in length.  The value N must be a
+ * power of 2 greater than 1.  The arrays B, V, and XY must be aligned to a
+ * multiple of 64 bytes.
+ */
+typedef void (*libscrypt_smix_t)(uint8_t *, size_t, uint64_t, uint32_t *, uint32_t *);
+
+/**
+ * smix2(B0, B1, r, N, V, XY):
+ * Compute B0 = SMix_r(B0, N) and B1 = SMix_r(B1, N) at once.  The temporary
+ * storage V must be 256rN bytes in length; the temporary storage XY must be
+ * 512r + 128 bytes in length.  Other requirements are as of smix.
+ */
+typedef void (*libscrypt_smix2_t)(uint8_t *, uint8_t *, size_t, uint64_t, uint32_t *, uint32_t *);
+
+void libscrypt_smix_nosse(uint8_t *, size_t, uint64_t, uint32_t *, uint32_t *);
+
+#ifdef LIBSCRYPT_X86
+void libscrypt_smix_sse2(uint8_t *, size_t, uint64_t, uint32_t *, uint32_t *);
+
+void libscrypt_smix_avx2(uint8_t *, size_t, uint64_t, uint32_t *, uint32_t *);
+
+void libscrypt_smix2_avx2(uint8_t *, uint8_t *, size_t, uint64_t, uint32_t *, uint32_t *);
+#endif
+
+/**
+ * libscrypt_smix_supported(impl):
+ * Return non-zero if the backend can run on this CPU.  LIBSCRYPT_SMIX_AUTO
+ * is always supported.
+ */
+int libscrypt_smix_supported(enum libscrypt_smix_impl);
+
+/**
+ * libscrypt_smix_select(impl):
+ * Return the backend, or the fastest supported one for LIBSCRYPT_SMIX_AUTO.
+ * Return NULL if the backend is not supported.
+ */
+libscrypt_smix_t libscrypt_smix_select(enum libscrypt_smix_impl);
+
+/**
+ * libscrypt_smix2_select(impl):
+ * Return the two-lane variant of the backend selected by
+ * libscrypt_smix_select, or NULL if it has none.
+ */
+libscrypt_smix2_t libscrypt_smix2_select(enum libscrypt_smix_impl);
+
+/**
+ * libscrypt_scrypt_impl(impl, passwd, passwdlen, salt, saltlen, N, r, p, buf, buflen):
+ * Same as libscrypt_scrypt, with an explicitly chosen backend.  Used by
+ * tests and benchmarks to compare backends.
+ *
+ * Return 0 on success; or -1 on error (errno is EINVAL for an unsupported
+ * backend).
+ */
+int libscrypt_scrypt_impl(enum libscrypt_smix_impl, const uint8_t *, size_t,
+    const uint8_t *, size_t, uint64_t, uint32_t, uint32_t, uint8_t *, size_t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* !_CRYPTO_SCRYPT_SMIX_H_ */
@@ -0,0 +1,176 @@
+/*-
+ * SSE2 SMix backend and the runtime selection of the SMix backend.
+ */
+#include "crypto_scrypt-smix.h"
+
+#ifdef LIBSCRYPT_X86
+
+/* Headers go before the target pragma, it must apply only to our code. */
+#include <emmintrin.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "sysendian.h"
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("sse2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("sse2")
+#endif
+
+#define LIBSCRYPT_SMIX_NAME libscrypt_smix_sse2
+#include "crypto_scrypt-sse.h"
+#undef LIBSCRYPT_SMIX_NAME
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+static void
+cpuid(uint32_t leaf, uint32_t subleaf, uint32_t regs[4])
+{
+#ifdef _MSC_VER
+	int r[4];
+
+	__cpuidex(r, (int)leaf, (int)subleaf);
+	regs[0] = (uint32_t)r[0];
+	regs[1] = (uint32_t)r[1];
+	regs[2] = (uint32_t)r[2];
+	regs[3] = (uint32_t)r[3];
+#else
+	__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+/* XCR0: the OS saves xmm and ymm registers on context switch. */
+static uint64_t
+xgetbv0(void)
+{
+#ifdef _MSC_VER
+	return (_xgetbv(0));
+#else
+	uint32_t eax, edx;
+
+	__asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+	return (((uint64_t)edx << 32) | eax);
+#endif
+}
+
+static int
+has_sse2(void)
+{
+	uint32_t regs[4];
+
+	cpuid(0, 0, regs);
+	if (regs[0] < 1)
+		return (0);
+	cpuid(1, 0, regs);
+	return ((regs[3] >> 26) & 1);
+}
+
+static int
+has_avx2(void)
+{
+	uint32_t regs[4];
+	uint32_t maxleaf;
+
+	cpuid(0, 0, regs);
+	maxleaf = regs[0];
+	if (maxleaf < 7)
+		return (0);
+
+	/* OSXSAVE and AVX. */
+	cpuid(1, 0, regs);
+	if (((regs[2] >> 27) & 1) == 0 || ((regs[2] >> 28) & 1) == 0)
+		return (0);
+	if ((xgetbv0() & 0x6) != 0x6)
+		return (0);
+
+	cpuid(7, 0, regs);
+	return ((regs[1] >> 5) & 1);
+}
+
+int
+libscrypt_smix_supported(enum libscrypt_smix_impl impl)
+{
+	static const int sse2 = has_sse2();
+	static const int avx2 = sse2 && has_avx2();
+
+	switch (impl) {
+	case LIBSCRYPT_SMIX_AUTO:
+	case LIBSCRYPT_SMIX_NOSSE:
+		return (1);
+	case LIBSCRYPT_SMIX_SSE2:
+		return (sse2);
+	case LIBSCRYPT_SMIX_AVX2:
+		return (avx2);
+	}
+	return (0);
+}
+
+libscrypt_smix_t
+libscrypt_smix_select(enum libscrypt_smix_impl impl)
+{
+	if (!libscrypt_smix_supported(impl))
+		return (NULL);
+
+	switch (impl) {
+	case LIBSCRYPT_SMIX_AUTO:
+		if (libscrypt_smix_supported(LIBSCRYPT_SMIX_AVX2))
+			return (libscrypt_smix_avx2);
+		if (libscrypt_smix_supported(LIBSCRYPT_SMIX_SSE2))
+			return (libscrypt_smix_sse2);
+		return (libscrypt_smix_nosse);
+	case LIBSCRYPT_SMIX_NOSSE:
+		return (libscrypt_smix_nosse);
+	case LIBSCRYPT_SMIX_SSE2:
+		return (libscrypt_smix_sse2);
+	case LIBSCRYPT_SMIX_AVX2:
+		return (libscrypt_smix_avx2);
+	}
+	return (NULL);
+}
+
+libscrypt_smix2_t
+libscrypt_smix2_select(enum libscrypt_smix_impl impl)
+{
+	if (libscrypt_smix_select(impl) == libscrypt_smix_avx2)
+		return (libscrypt_smix2_avx2);
+	return (NULL);
+}
+
+#else /* !LIBSCRYPT_X86 */
+
+int
+libscrypt_smix_supported(enum libscrypt_smix_impl impl)
+{
+
+	return (impl == LIBSCRYPT_SMIX_AUTO || impl == LIBSCRYPT_SMIX_NOSSE);
+}
+
+libscrypt_smix_t
+libscrypt_smix_select(enum libscrypt_smix_impl impl)
+{
+	if (!libscrypt_smix_supported(impl))
+		return (NULL);
+
+	return (libscrypt_smix_nosse);
+}
+
+libscrypt_smix2_t
+libscrypt_smix2_select(enum libscrypt_smix_impl impl)
+{
+
+	return (NULL);
+}
+
+#endif /* LIBSCRYPT_X86 */
@@ -5,12 +5,15 @@
 #include <string>
 #include <memory>
 #include <array>
+#include <mutex>
+#include <thread>
 
 #include <openssl/rsa.h>
 #include <openssl/pem.h>
 #include <openssl/aes.h>
 #include <openssl/rand.h>
 #include <openssl/err.h>
+#include <openssl/crypto.h>
 
 #include "check.h"
 #include "utilites/utils.h"
@@ -27,10 +30,33 @@ static bool isInitialized = false;
     } \
 }
 
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+// До 1.1.0 OpenSSL сам не защищает общие структуры (например, blinding у RSA ключа), блокировки должно дать приложение
+static std::vector<std::mutex> *sslMutexes = nullptr;
+
+static void sslLockingCallback(int mode, int n, const char */*file*/, int /*line*/) {
+    if (mode & CRYPTO_LOCK) {
+        (*sslMutexes)[n].lock();
+    } else {
+        (*sslMutexes)[n].unlock();
+    }
+}
+
+static void sslThreadIdCallback(CRYPTO_THREADID *id) {
+    CRYPTO_THREADID_set_numeric(id, static_cast<unsigned long>(std::hash<std::thread::id>()(std::this_thread::get_id())));
+}
+#endif
+
 void InitOpenSSL() {
     CHECK(!isInitialized, "Already initialized");
     /*SSL_load_error_strings();
     SSL_library_init();*/
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+    // Живут до конца программы, так как OpenSSL может вызвать callback из любого потока вплоть до выхода
+    sslMutexes = new std::vector<std::mutex>(CRYPTO_num_locks());
+    CRYPTO_THREADID_set_callback(sslThreadIdCallback);
+    CRYPTO_set_locking_callback(sslLockingCallback);
+#endif
     OpenSSL_add_all_algorithms();
     isInitialized = true;
 }
@@ -59,9 +59,11 @@ protected:
     QSqlDatabase database() const;
     bool dbExist() const;
 
+    // Выполняет dbupdates/<name>_XtoY.sql. Переопределяется, если обновлению нужны шаги, которые не выразить в sql
+    virtual void updateToNewVersion(int vcur, int vnew);
+
 private:
     bool updateDB();
-    void updateToNewVersion(int vcur, int vnew);
     void execFromFile(const QString &filename);
 
     QSqlDatabase m_db;
@@ -0,0 +1,110 @@
+#include "JsDispatcher.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "check.h"
+#include "Log.h"
+#include "QRegister.h"
+#include "SlotWrapper.h"
+
+SET_LOG_NAMESPACE("MW");
+
+static const int MAX_BATCH_SIZE = 4 * 1024 * 1024;
+
+static const size_t METRICS_LOG_PERIOD = 1000;
+
+JsDispatcher::JsDispatcher(const milliseconds &period, const RunFunc &runFunc, QObject *parent)
+    : QObject(parent)
+    , runFunc(runFunc)
+{
+    timer.setSingleShot(true);
+    timer.setInterval(period.count());
+    Q_CONNECT(&timer, &QTimer::timeout, this, &JsDispatcher::onTimeout);
+}
+
+bool JsDispatcher::isScriptComplete(const QString &script) {
+    std::vector<QChar> brackets;
+    QChar quote;
+    bool isEscape = false;
+    for (const QChar c: script) {
+        if (!quote.isNull()) {
+            if (isEscape) {
+                isEscape = false;
+            } else if (c == '\\') {
+                isEscape = true;
+            } else if (c == quote) {
+                quote = QChar();
+            } else if (quote != '`' && (c == '\n' || c == '\r' || c == QChar(0x2028) || c == QChar(0x2029))) {
+                return false;
+            }
+            continue;
+        }
+        if (c == '"' || c == '\'' || c == '`') {
+            quote = c;
+        } else if (c == '(') {
+            brackets.emplace_back(')');
+        } else if (c == '[') {
+            brackets.emplace_back(']');
+        } else if (c == '{') {
+            brackets.emplace_back('}');
+        } else if (c == ')' || c == ']' || c == '}') {
+            if (brackets.empty() || brackets.back() != c) {
+                return false;
+            }
+            brackets.pop_back();
+        }
+    }
+    return quote.isNull() && brackets.empty();
+}
+
+void JsDispatcher::push(const QString &script) {
+    // Перевод строки перед } защищает от комментария в конце скрипта
+    batch += "try {";
+    batch += script;
+    batch += "\n} catch (e) {console.error(e);}\n";
+    countInBatch++;
+
+    if (batch.size() >= MAX_BATCH_SIZE) {
+        flush();
+    } else if (!timer.isActive()) {
+        timer.start();
+    }
+}
+
+void JsDispatcher::flush() {
+    timer.stop();
+    if (countInBatch == 0) {
+        return;
+    }
+
+    const QString script = std::move(batch);
+    batch.clear();
+    const size_t count = countInBatch;
+    countInBatch = 0;
+
+    const time_point beginRun = ::now();
+    runFunc(script);
+    const microseconds runTime = std::chrono::duration_cast<microseconds>(::now() - beginRun);
+
+    const size_t prevScripts = metrics.scripts;
+    metrics.scripts += count;
+    metrics.runs++;
+    metrics.maxBatch = std::max(metrics.maxBatch, count);
+    metrics.runTimeUs += runTime.count();
+    if (prevScripts / METRICS_LOG_PERIOD != metrics.scripts / METRICS_LOG_PERIOD) {
+        LOG << "Js dispatcher: scripts " << metrics.scripts << ", runs " << metrics.runs << ", max batch " << metrics.maxBatch << ", run time " << metrics.runTimeUs / 1000 << " ms";
+    }
+}
+
+void JsDispatcher::clear() {
+    timer.stop();
+    batch.clear();
+    countInBatch = 0;
+}
+
+void JsDispatcher::onTimeout() {
+BEGIN_SLOT_WRAPPER
+    flush();
+END_SLOT_WRAPPER
+}
@@ -0,0 +1,65 @@
+#ifndef JSDISPATCHER_H
+#define JSDISPATCHER_H
+
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+#include <functional>
+
+#include "duration.h"
+
+/*
+   Накапливает скрипты и отправляет их в страницу одним вызовом раз в period.
+   Порядок скриптов сохраняется, каждый скрипт выполняется в своем try, чтобы исключение в одном не ломало остальные.
+   Синтаксическая ошибка ломает всю пачку, поэтому скрипты проверяются isScriptComplete при создании.
+   */
+class JsDispatcher: public QObject {
+    Q_OBJECT
+public:
+
+    using RunFunc = std::function<void(const QString &script)>;
+
+    struct Metrics {
+        size_t scripts = 0;
+        size_t runs = 0;
+        size_t maxBatch = 0;
+        size_t runTimeUs = 0;
+    };
+
+public:
+
+    JsDispatcher(const milliseconds &period, const RunFunc &runFunc, QObject *parent = nullptr);
+
+    // Грубая лексическая проверка: строки закрыты и не содержат переводов строк, скобки сбалансированы
+    static bool isScriptComplete(const QString &script);
+
+    void push(const QString &script);
+
+    void flush();
+
+    void clear();
+
+    const Metrics& getMetrics() const {
+        return metrics;
+    }
+
+private slots:
+
+    void onTimeout();
+
+private:
+
+    const RunFunc runFunc;
+
+    QTimer timer;
+
+    QString batch;
+
+    size_t countInBatch = 0;
+
+    Metrics metrics;
+
+};
+
+#endif // JSDISPATCHER_H
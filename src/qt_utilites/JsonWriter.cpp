@@ -0,0 +1,260 @@
+#include "JsonWriter.h"
+
+#include <cstring>
+#include <algorithm>
+
+static const char HEX_DIGITS[] = "0123456789abcdef";
+
+static char* writeUnicodeEscape(char *out, ushort c) {
+    *out++ = '\\';
+    *out++ = 'u';
+    *out++ = HEX_DIGITS[(c >> 12) & 0xF];
+    *out++ = HEX_DIGITS[(c >> 8) & 0xF];
+    *out++ = HEX_DIGITS[(c >> 4) & 0xF];
+    *out++ = HEX_DIGITS[c & 0xF];
+    return out;
+}
+
+// Экранирование ascii символа. Возвращает nullptr, если символ не требует экранирования
+static char* writeAsciiEscape(char *out, unsigned char c) {
+    switch (c) {
+    case '"':
+        *out++ = '\\';
+        *out++ = '"';
+        return out;
+    case '\\':
+        *out++ = '\\';
+        *out++ = '\\';
+        return out;
+    case '\n':
+        *out++ = '\\';
+        *out++ = 'n';
+        return out;
+    case '\r':
+        *out++ = '\\';
+        *out++ = 'r';
+        return out;
+    case '\t':
+        *out++ = '\\';
+        *out++ = 't';
+        return out;
+    case '\b':
+        *out++ = '\\';
+        *out++ = 'b';
+        return out;
+    case '\f':
+        *out++ = '\\';
+        *out++ = 'f';
+        return out;
+    default:
+        if (c < 0x20) {
+            return writeUnicodeEscape(out, c);
+        }
+        return nullptr;
+    }
+}
+
+JsonWriter::JsonWriter(int reserveSize) {
+    buf.reserve(reserveSize);
+}
+
+void JsonWriter::reserve(int size) {
+    if (buf.capacity() < size) {
+        buf.reserve(std::max(size, buf.capacity() * 2));
+    }
+}
+
+void JsonWriter::beginArray() {
+    separator();
+    buf.append('[');
+    needComma = false;
+}
+
+void JsonWriter::endArray() {
+    buf.append(']');
+    needComma = true;
+}
+
+void JsonWriter::beginObject() {
+    separator();
+    buf.append('{');
+    needComma = false;
+}
+
+void JsonWriter::endObject() {
+    buf.append('}');
+    needComma = true;
+}
+
+void JsonWriter::key(const char *name, int size) {
+    separator();
+    writeEscaped(name, size);
+    buf.append(':');
+    needComma = false;
+}
+
+void JsonWriter::value(const QString &value) {
+    separator();
+    needComma = true;
+
+    // Худший случай - \u00XX на каждый utf16 символ
+    const int oldSize = buf.size();
+    const int maxSize = oldSize + value.size() * 6 + 2;
+    reserve(maxSize);
+    buf.resize(maxSize);
+    char *const begin = buf.data();
+    char *out = begin + oldSize;
+    *out++ = '"';
+
+    const ushort *in = value.utf16();
+    const ushort *const end = in + value.size();
+    while (in != end) {
+        const ushort c = *in++;
+        if (c < 0x80) {
+            char *escaped = writeAsciiEscape(out, c);
+            if (escaped == nullptr) {
+                *out++ = static_cast<char>(c);
+            } else {
+                out = escaped;
+            }
+        } else if (c < 0x800) {
+            *out++ = static_cast<char>(0xC0 | (c >> 6));
+            *out++ = static_cast<char>(0x80 | (c & 0x3F));
+        } else if (QChar::isHighSurrogate(c) && in != end && QChar::isLowSurrogate(*in)) {
+            const uint ucs4 = QChar::surrogateToUcs4(c, *in++);
+            *out++ = static_cast<char>(0xF0 | (ucs4 >> 18));
+            *out++ = static_cast<char>(0x80 | ((ucs4 >> 12) & 0x3F));
+            *out++ = static_cast<char>(0x80 | ((ucs4 >> 6) & 0x3F));
+            *out++ = static_cast<char>(0x80 | (ucs4 & 0x3F));
+        } else if (QChar::isSurrogate(c)) {
+            // Одиночная половинка суррогатной пары недопустима в utf8
+            *out++ = static_cast<char>(0xEF);
+            *out++ = static_cast<char>(0xBF);
+            *out++ = static_cast<char>(0xBD);
+        } else if (c == 0x2028 || c == 0x2029) {
+            // Допустимы в json, но ломают строковый литерал javascript
+            out = writeUnicodeEscape(out, c);
+        } else {
+            *out++ = static_cast<char>(0xE0 | (c >> 12));
+            *out++ = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            *out++ = static_cast<char>(0x80 | (c & 0x3F));
+        }
+    }
+
+    *out++ = '"';
+    buf.resize(static_cast<int>(out - begin));
+}
+
+void JsonWriter::value(const QByteArray &value) {
+    separator();
+    needComma = true;
+    writeEscaped(value.constData(), value.size());
+}
+
+void JsonWriter::value(const char *value) {
+    separator();
+    needComma = true;
+    writeEscaped(value, static_cast<int>(strlen(value)));
+}
+
+void JsonWriter::value(bool value) {
+    separator();
+    needComma = true;
+    if (value) {
+        buf.append("true", 4);
+    } else {
+        buf.append("false", 5);
+    }
+}
+
+void JsonWriter::value(long long value) {
+    separator();
+    needComma = true;
+    writeNumber(value, false);
+}
+
+void JsonWriter::value(unsigned long long value) {
+    separator();
+    needComma = true;
+    writeNumber(value, false, false);
+}
+
+void JsonWriter::valueAsString(long long value) {
+    separator();
+    needComma = true;
+    writeNumber(value, true);
+}
+
+void JsonWriter::valueAsString(unsigned long long value) {
+    separator();
+    needComma = true;
+    writeNumber(value, false, true);
+}
+
+void JsonWriter::valueNull() {
+    separator();
+    needComma = true;
+    buf.append("null", 4);
+}
+
+void JsonWriter::rawValue(const QByteArray &json) {
+    separator();
+    needComma = true;
+    buf.append(json);
+}
+
+void JsonWriter::writeEscaped(const char *value, int size) {
+    // Байты utf8 копируются как есть, экранируются только управляющие символы, кавычки, слеш и разделители строк
+    const int oldSize = buf.size();
+    const int maxSize = oldSize + size * 6 + 2;
+    reserve(maxSize);
+    buf.resize(maxSize);
+    char *const begin = buf.data();
+    char *out = begin + oldSize;
+    *out++ = '"';
+    for (int i = 0; i < size; i++) {
+        const unsigned char c = static_cast<unsigned char>(value[i]);
+        // U+2028 и U+2029 (E2 80 A8, E2 80 A9) допустимы в json, но ломают строковый литерал javascript
+        if (c == 0xE2 && i + 2 < size && static_cast<unsigned char>(value[i + 1]) == 0x80 && (static_cast<unsigned char>(value[i + 2]) & 0xFE) == 0xA8) {
+            out = writeUnicodeEscape(out, static_cast<unsigned char>(value[i + 2]) == 0xA8 ? 0x2028 : 0x2029);
+            i += 2;
+            continue;
+        }
+        char *escaped = c < 0x80 ? writeAsciiEscape(out, c) : nullptr;
+        if (escaped == nullptr) {
+            *out++ = static_cast<char>(c);
+        } else {
+            out = escaped;
+        }
+    }
+    *out++ = '"';
+    buf.resize(static_cast<int>(out - begin));
+}
+
+void JsonWriter::writeNumber(long long value, bool isQuoted) {
+    if (value < 0) {
+        writeNumber(0ull - static_cast<unsigned long long>(value), true, isQuoted);
+    } else {
+        writeNumber(static_cast<unsigned long long>(value), false, isQuoted);
+    }
+}
+
+void JsonWriter::writeNumber(unsigned long long value, bool isNegative, bool isQuoted) {
+    char tmp[24];
+    char *const end = tmp + sizeof(tmp);
+    char *p = end;
+    if (isQuoted) {
+        *--p = '"';
+    }
+    do {
+        *--p = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    if (isNegative) {
+        *--p = '-';
+    }
+    if (isQuoted) {
+        *--p = '"';
+    }
+    buf.append(p, static_cast<int>(end - p));
+}
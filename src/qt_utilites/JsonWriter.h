@@ -0,0 +1,308 @@
+#ifndef JSONWRITER_H
+#define JSONWRITER_H
+
+#include <QString>
+#include <QByteArray>
+
+#include <tuple>
+#include <vector>
+#include <utility>
+
+/*
+   Уже сериализованный json в utf8.
+   Передается в javascript так же, как QJsonDocument, но без промежуточных QJsonObject.
+   */
+struct JsonString {
+    QByteArray json;
+};
+
+/*
+   Запись json напрямую в utf8 буфер.
+   Запятые между элементами расставляются автоматически.
+   */
+class JsonWriter {
+public:
+
+    explicit JsonWriter(int reserveSize = 256);
+
+    void beginArray();
+
+    void endArray();
+
+    void beginObject();
+
+    void endObject();
+
+    void key(const char *name, int size);
+
+    void value(const QString &value);
+
+    // Строка в utf8
+    void value(const QByteArray &value);
+
+    // Строка в utf8, должна заканчиваться нулем
+    void value(const char *value);
+
+    void value(bool value);
+
+    void value(long long value);
+
+    void value(unsigned long long value);
+
+    void valueAsString(long long value);
+
+    void valueAsString(unsigned long long value);
+
+    void valueNull();
+
+    // Уже сериализованное значение
+    void rawValue(const QByteArray &json);
+
+    int size() const {
+        return buf.size();
+    }
+
+    void reserve(int size);
+
+    JsonString result() const {
+        return JsonString{buf};
+    }
+
+private:
+
+    void separator() {
+        if (needComma) {
+            buf.append(',');
+        }
+    }
+
+    void writeEscaped(const char *value, int size);
+
+    void writeNumber(long long value, bool isQuoted);
+
+    void writeNumber(unsigned long long value, bool isNegative, bool isQuoted);
+
+private:
+
+    QByteArray buf;
+
+    bool needComma = false;
+
+};
+
+/*
+   Описание поля структуры: имя, член класса или функция-геттер, и необязательное условие вывода поля.
+   isString - числа выводятся строкой, как это было принято в старых json ответах
+   */
+template<typename T, typename Getter, bool isString>
+struct JsonField {
+    const char *name;
+    int nameSize;
+    Getter getter;
+    bool (*condition)(const T &obj);
+};
+
+template<typename T, typename M, size_t N>
+constexpr JsonField<T, M T::*, false> jsonField(const char (&name)[N], M T::*member, bool (*condition)(const T &obj) = nullptr) {
+    return JsonField<T, M T::*, false>{name, N - 1, member, condition};
+}
+
+template<typename T, typename R, size_t N>
+constexpr JsonField<T, R (*)(const T&), false> jsonField(const char (&name)[N], R (*getter)(const T&), bool (*condition)(const T &obj) = nullptr) {
+    return JsonField<T, R (*)(const T&), false>{name, N - 1, getter, condition};
+}
+
+template<typename T, typename M, size_t N>
+constexpr JsonField<T, M T::*, true> jsonFieldStr(const char (&name)[N], M T::*member, bool (*condition)(const T &obj) = nullptr) {
+    return JsonField<T, M T::*, true>{name, N - 1, member, condition};
+}
+
+/*
+   Специализация должна содержать static constexpr auto fields(), возвращающую std::tuple из jsonField
+   */
+template<typename T>
+struct JsonFields;
+
+inline void writeJson(JsonWriter &writer, const QString &value) {
+    writer.value(value);
+}
+
+inline void writeJson(JsonWriter &writer, const QByteArray &value) {
+    writer.value(value);
+}
+
+inline void writeJson(JsonWriter &writer, const char *value) {
+    writer.value(value);
+}
+
+inline void writeJson(JsonWriter &writer, bool value) {
+    writer.value(value);
+}
+
+inline void writeJson(JsonWriter &writer, int value) {
+    writer.value(static_cast<long long>(value));
+}
+
+inline void writeJson(JsonWriter &writer, long value) {
+    writer.value(static_cast<long long>(value));
+}
+
+inline void writeJson(JsonWriter &writer, long long value) {
+    writer.value(value);
+}
+
+inline void writeJson(JsonWriter &writer, unsigned int value) {
+    writer.value(static_cast<unsigned long long>(value));
+}
+
+inline void writeJson(JsonWriter &writer, unsigned long value) {
+    writer.value(static_cast<unsigned long long>(value));
+}
+
+inline void writeJson(JsonWriter &writer, unsigned long long value) {
+    writer.value(value);
+}
+
+inline void writeJsonAsString(JsonWriter &writer, int value) {
+    writer.valueAsString(static_cast<long long>(value));
+}
+
+inline void writeJsonAsString(JsonWriter &writer, long value) {
+    writer.valueAsString(static_cast<long long>(value));
+}
+
+inline void writeJsonAsString(JsonWriter &writer, long long value) {
+    writer.valueAsString(value);
+}
+
+inline void writeJsonAsString(JsonWriter &writer, unsigned int value) {
+    writer.valueAsString(static_cast<unsigned long long>(value));
+}
+
+inline void writeJsonAsString(JsonWriter &writer, unsigned long value) {
+    writer.valueAsString(static_cast<unsigned long long>(value));
+}
+
+inline void writeJsonAsString(JsonWriter &writer, unsigned long long value) {
+    writer.valueAsString(value);
+}
+
+template<typename T>
+void writeJson(JsonWriter &writer, const T &obj);
+
+template<typename T>
+void writeJson(JsonWriter &writer, const std::vector<T> &values) {
+    writer.beginArray();
+    const int begin = writer.size();
+    for (size_t i = 0; i < values.size(); i++) {
+        writeJson(writer, values[i]);
+        if (i == 0 && values.size() > 1) {
+            // Размер первого элемента используется как оценка размера остальных
+            writer.reserve(writer.size() + (writer.size() - begin + 1) * static_cast<int>(values.size() - 1) * 9 / 8);
+        }
+    }
+    writer.endArray();
+}
+
+namespace json_details {
+
+template<typename T, typename M>
+const M& getValue(const T &obj, M T::*member) {
+    return obj.*member;
+}
+
+template<typename T, typename R>
+R getValue(const T &obj, R (*getter)(const T&)) {
+    return getter(obj);
+}
+
+template<typename V>
+void writeValue(JsonWriter &writer, const V &value, std::false_type /*isString*/) {
+    writeJson(writer, value);
+}
+
+template<typename V>
+void writeValue(JsonWriter &writer, const V &value, std::true_type /*isString*/) {
+    writeJsonAsString(writer, value);
+}
+
+template<typename T, typename Getter, bool isString>
+void writeField(JsonWriter &writer, const T &obj, const JsonField<T, Getter, isString> &field) {
+    if (field.condition != nullptr && !field.condition(obj)) {
+        return;
+    }
+    writer.key(field.name, field.nameSize);
+    writeValue(writer, getValue(obj, field.getter), std::integral_constant<bool, isString>());
+}
+
+template<typename T, typename Tuple, size_t... I>
+void writeFields(JsonWriter &writer, const T &obj, const Tuple &fields, std::index_sequence<I...>) {
+    using expander = int[];
+    (void)expander{0, (writeField(writer, obj, std::get<I>(fields)), 0)...};
+}
+
+template<typename T, typename Getter, bool isString>
+bool writeFieldDelta(JsonWriter &writer, const T &prev, const T &obj, const JsonField<T, Getter, isString> &field) {
+    const bool isPrev = field.condition == nullptr || field.condition(prev);
+    const bool isCurrent = field.condition == nullptr || field.condition(obj);
+    if (!isCurrent) {
+        if (isPrev) {
+            writer.key(field.name, field.nameSize);
+            writer.valueNull();
+        }
+        return isPrev;
+    }
+
+    JsonWriter current(32);
+    writeValue(current, getValue(obj, field.getter), std::integral_constant<bool, isString>());
+    if (isPrev) {
+        JsonWriter previous(32);
+        writeValue(previous, getValue(prev, field.getter), std::integral_constant<bool, isString>());
+        if (previous.result().json == current.result().json) {
+            return false;
+        }
+    }
+    writer.key(field.name, field.nameSize);
+    writer.rawValue(current.result().json);
+    return true;
+}
+
+template<typename T, typename Tuple, size_t... I>
+bool writeFieldsDelta(JsonWriter &writer, const T &prev, const T &obj, const Tuple &fields, std::index_sequence<I...>) {
+    bool isChanged = false;
+    using expander = int[];
+    (void)expander{0, (isChanged |= writeFieldDelta(writer, prev, obj, std::get<I>(fields)), 0)...};
+    return isChanged;
+}
+
+} // namespace json_details
+
+template<typename T>
+void writeJson(JsonWriter &writer, const T &obj) {
+    constexpr auto fields = JsonFields<T>::fields();
+    writer.beginObject();
+    json_details::writeFields(writer, obj, fields, std::make_index_sequence<std::tuple_size<decltype(fields)>::value>());
+    writer.endObject();
+}
+
+/*
+   Объект только из изменившихся полей. Поля, пропавшие по условию, записываются как null.
+   Возвращает false, если ничего не изменилось
+   */
+template<typename T>
+bool writeJsonDelta(JsonWriter &writer, const T &prev, const T &obj) {
+    constexpr auto fields = JsonFields<T>::fields();
+    writer.beginObject();
+    const bool isChanged = json_details::writeFieldsDelta(writer, prev, obj, fields, std::make_index_sequence<std::tuple_size<decltype(fields)>::value>());
+    writer.endObject();
+    return isChanged;
+}
+
+template<typename T>
+JsonString toJsonString(const T &value) {
+    JsonWriter writer;
+    writeJson(writer, value);
+    return writer.result();
+}
+
+#endif // JSONWRITER_H
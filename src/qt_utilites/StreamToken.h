@@ -0,0 +1,75 @@
+#ifndef STREAMTOKEN_H
+#define STREAMTOKEN_H
+
+#include <QString>
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+
+/*
+   Токен потоковой выдачи результата. Читающая сторона проверяет его перед каждой порцией.
+   */
+class StreamToken {
+public:
+
+    void cancel() {
+        cancelled = true;
+    }
+
+    bool isCancelled() const {
+        return cancelled.load();
+    }
+
+private:
+
+    std::atomic<bool> cancelled{false};
+
+};
+
+/*
+   Токены активных потоков по requestId, чтобы javascript мог отменить поток по его идентификатору.
+   */
+class StreamTokens {
+public:
+
+    std::shared_ptr<StreamToken> create(const QString &requestId) {
+        std::lock_guard<std::mutex> lock(mut);
+        auto token = std::make_shared<StreamToken>();
+        const auto found = tokens.find(requestId);
+        if (found != tokens.end()) {
+            found->second->cancel();
+        }
+        tokens[requestId] = token;
+        return token;
+    }
+
+    bool cancel(const QString &requestId) {
+        std::lock_guard<std::mutex> lock(mut);
+        const auto found = tokens.find(requestId);
+        if (found == tokens.end()) {
+            return false;
+        }
+        found->second->cancel();
+        tokens.erase(found);
+        return true;
+    }
+
+    void remove(const QString &requestId, const std::shared_ptr<StreamToken> &token) {
+        std::lock_guard<std::mutex> lock(mut);
+        const auto found = tokens.find(requestId);
+        if (found != tokens.end() && found->second == token) {
+            tokens.erase(found);
+        }
+    }
+
+private:
+
+    std::mutex mut;
+
+    std::map<QString, std::shared_ptr<StreamToken>> tokens;
+
+};
+
+#endif // STREAMTOKEN_H
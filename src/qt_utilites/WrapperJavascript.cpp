@@ -6,6 +6,7 @@
 #include "Log.h"
 
 #include "makeJsFunc.h"
+#include "JsDispatcher.h"
 
 using namespace std::placeholders;
 
@@ -16,10 +17,23 @@ WrapperJavascript::WrapperJavascript(bool printJs, const std::string &cppFileNam
 
 WrapperJavascript::~WrapperJavascript() = default;
 
+void WrapperJavascript::setStructuredResults(bool enabled) {
+    isStructuredResults = enabled;
+}
+
+void WrapperJavascript::resetPageState() {
+    isStructuredResults = false;
+}
+
 void WrapperJavascript::runJs(const QString &script) {
     if (printJs) {
         LOG2(cppFileName) << "Javascript " << script;
     }
+    // Скрипты выполняются пачкой, поэтому синтаксическая ошибка в одном сломала бы остальные
+    if (!JsDispatcher::isScriptComplete(script)) {
+        LOG2(cppFileName) << "Error: incorrect javascript " << script.left(100);
+        return;
+    }
     emit jsRunSig(script);
 }
 
@@ -2,8 +2,10 @@
 #define WRAPPERJAVASCRIPT_H
 
 #include <QObject>
+#include <QVariantList>
 
 #include <functional>
+#include <atomic>
 
 #include "CallbackCallWrapper.h"
 
@@ -61,10 +63,21 @@ public:
 
     virtual ~WrapperJavascript();
 
+public:
+
+    // Вместо текста скрипта результаты приходят в сигнал jsResultSig в виде структурированных данных
+    Q_INVOKABLE void setStructuredResults(bool enabled);
+
+    // Сбрасывает состояние, заданное страницей. Вызывается при начале загрузки новой страницы
+    virtual void resetPageState();
+
 signals:
 
     void jsRunSig(QString jsString);
 
+    // args - аргументы функции function, последние два - код и описание ошибки
+    void jsResultSig(QString function, QVariantList args);
+
 protected:
 
     template<typename ...Args>
@@ -73,6 +86,9 @@ protected:
     template<typename... Args>
     void makeAndRunJsFuncParams(const QString &function, const TypedException &exception, Args&& ...args);
 
+    template<typename... Args>
+    void emitJsResult(const QString &function, const TypedException &exception, Args&& ...args);
+
 protected:
 
     void wrapOperation(const std::function<void()> &f, const std::function<void(const TypedException &e)> &errorFunc);
@@ -87,6 +103,8 @@ protected:
 
     const std::string cppFileName;
 
+    std::atomic<bool> isStructuredResults{false};
+
 };
 
 #endif // WRAPPERJAVASCRIPT_H
@@ -4,6 +4,7 @@
 #include "WrapperJavascript.h"
 
 #include "makeJsFunc.h"
+#include "makeJsVariant.h"
 
 template<typename ...Args>
 auto WrapperJavascript::makeJavascriptReturnAndErrorFuncs(const QString &jsNameResult, Args&& ...args) {
@@ -16,10 +17,25 @@ auto WrapperJavascript::makeJavascriptReturnAndErrorFuncs(const QString &jsNameR
 
 template<typename... Args>
 void WrapperJavascript::makeAndRunJsFuncParams(const QString &function, const TypedException &exception, Args&& ...args) {
+    if (isStructuredResults.load()) {
+        emitJsResult(function, exception, std::forward<Args>(args)...);
+        return;
+    }
     const QString res = makeJsFunc3<false>(function, "", exception, std::forward<Args>(args)...);
     runJs(res);
 }
 
+template<typename... Args>
+void WrapperJavascript::emitJsResult(const QString &function, const TypedException &exception, Args&& ...args) {
+    QVariantList result;
+    result.reserve(sizeof...(Args) + 2);
+    appendJsVariants(result, std::forward<Args>(args)..., (int)exception.numError, exception.description);
+    if (printJs) {
+        LOG2(cppFileName) << "Javascript result " << function;
+    }
+    emit jsResultSig(function, result);
+}
+
 inline QString chooseCallback(const QString &callback, const QString &defaultCallback) {
     if (!callback.isEmpty()) {
         return callback;
@@ -7,6 +7,7 @@
 #include <string>
 
 #include "TypedException.h"
+#include "JsonWriter.h"
 #include "check.h"
 #include "Log.h"
 
@@ -44,12 +45,41 @@ inline QString toJsString(const QString &arg) {
     copy.replace('\"', "\\\"");
     copy.replace("\n", "\\n");
     copy.replace("\r", "");
+    // Старые версии javascript не допускают эти символы внутри строки
+    copy.replace(QChar(0x2028), "\\u2028");
+    copy.replace(QChar(0x2029), "\\u2029");
     return "\"" + copy + "\"";
 }
 
+// Экранирование готового json для вставки в текст скрипта строкой. Compact json не содержит переводов строк,
+// но может содержать U+2028 и U+2029 (E2 80 A8, E2 80 A9), которые старые версии javascript не допускают внутри строки
+inline QString jsonToJsString(const QByteArray &json) {
+    QByteArray result;
+    result.reserve(json.size() + json.size() / 8 + 2);
+    result.append('"');
+    for (int i = 0; i < json.size(); i++) {
+        const char c = json[i];
+        if (c == '\xE2' && i + 2 < json.size() && json[i + 1] == '\x80' && (json[i + 2] == '\xA8' || json[i + 2] == '\xA9')) {
+            result.append(json[i + 2] == '\xA8' ? "\\u2028" : "\\u2029");
+            i += 2;
+            continue;
+        }
+        if (c == '"' || c == '\\') {
+            result.append('\\');
+        }
+        result.append(c);
+    }
+    result.append('"');
+    return QString::fromUtf8(result);
+}
+
+// json аргументы любого типа попадают в javascript строкой с json, см. makeJsVariant.h
 inline QString toJsString(const QJsonDocument &arg) {
-    QString json = arg.toJson(QJsonDocument::Compact);
-    return toJsString(json);
+    return jsonToJsString(arg.toJson(QJsonDocument::Compact));
+}
+
+inline QString toJsString(const JsonString &arg) {
+    return jsonToJsString(arg.json);
 }
 
 inline QString toJsString(const std::string &arg) {
@@ -0,0 +1,83 @@
+#ifndef MAKEJSVARIANT_H
+#define MAKEJSVARIANT_H
+
+#include <QString>
+#include <QVariant>
+#include <QVariantList>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QByteArray>
+
+#include <string>
+
+#include "JsonWriter.h"
+
+/*
+   Преобразование аргументов результата в QVariant для передачи через QWebChannel без сборки текста скрипта.
+   Любые json аргументы (QJsonDocument, JsonString, QJsonArray, QJsonObject) передаются строкой с json, как и в тексте скрипта,
+   чтобы страница разбирала их одинаково через JSON.parse. Бинарные данные передаются строкой base64.
+   */
+
+inline QVariant toJsVariant(const QString &arg) {
+    return arg;
+}
+
+inline QVariant toJsVariant(const std::string &arg) {
+    return QString::fromStdString(arg);
+}
+
+inline QVariant toJsVariant(const QJsonDocument &arg) {
+    return QString::fromUtf8(arg.toJson(QJsonDocument::Compact));
+}
+
+inline QVariant toJsVariant(const JsonString &arg) {
+    return QString::fromUtf8(arg.json);
+}
+
+inline QVariant toJsVariant(const QJsonArray &arg) {
+    return toJsVariant(QJsonDocument(arg));
+}
+
+inline QVariant toJsVariant(const QJsonObject &arg) {
+    return toJsVariant(QJsonDocument(arg));
+}
+
+inline QVariant toJsVariant(const QByteArray &arg) {
+    return QString::fromLatin1(arg.toBase64());
+}
+
+inline QVariant toJsVariant(const int &arg) {
+    return arg;
+}
+
+inline QVariant toJsVariant(const long int &arg) {
+    return static_cast<qlonglong>(arg);
+}
+
+inline QVariant toJsVariant(const long long int &arg) {
+    return static_cast<qlonglong>(arg);
+}
+
+inline QVariant toJsVariant(const size_t &arg) {
+    return static_cast<qulonglong>(arg);
+}
+
+inline QVariant toJsVariant(const double &arg) {
+    return arg;
+}
+
+inline QVariant toJsVariant(bool arg) {
+    return arg;
+}
+
+inline void appendJsVariants(QVariantList &/*result*/) {}
+
+template<typename Arg, typename... Args>
+inline void appendJsVariants(QVariantList &result, const Arg &arg, Args&& ...args) {
+    static_assert(!std::is_same<typename std::decay<Arg>::type, char const*>::value, "const char* not allowed");
+    result.append(toJsVariant(arg));
+    appendJsVariants(result, std::forward<Args>(args)...);
+}
+
+#endif // MAKEJSVARIANT_H
@@ -16,6 +16,8 @@ SOURCES += main.cpp MainWindow.cpp \
     TorProxy.cpp \
     Uploader.cpp \
     Wallets/ethtx/scrypt/crypto_scrypt-nosse.cpp \
+    Wallets/ethtx/scrypt/crypto_scrypt-sse.cpp \
+    Wallets/ethtx/scrypt/crypto_scrypt-avx2.cpp \
     Wallets/ethtx/scrypt/sha256.cpp \
     Wallets/ethtx/cert.cpp \
     Wallets/ethtx/rlp.cpp \
@@ -38,12 +40,16 @@ SOURCES += main.cpp MainWindow.cpp \
     PagesMappings.cpp \
     TorUrlSchemeHandler.cpp \
     MHUrlSchemeHandler.cpp \
+    MHUrlCache.cpp \
     Paths.cpp \
     RunGuard.cpp \
     Messenger/Messenger.cpp \
     Messenger/MessengerMessages.cpp \
     Messenger/MessengerJavascript.cpp \
     Messenger/CryptographicManager.cpp \
+    Messenger/DecryptPool.cpp \
+    Messenger/DecryptedCache.cpp \
+    Messenger/GapTracker.cpp \
     dbstorage.cpp \
     Messenger/MessengerDBStorage.cpp \
     transactions/Transactions.cpp \
@@ -74,6 +80,8 @@ SOURCES += main.cpp MainWindow.cpp \
     Utils/UtilsManager.cpp \
     NsLookup/TaskManager.cpp \
     NsLookup/NslWorker.cpp \
+    NsLookup/PingWindow.cpp \
+    NsLookup/ServerSelector.cpp \
     NsLookup/Workers/FullWorker.cpp \
     NsLookup/Workers/SimpleWorker.cpp \
     NsLookup/Workers/RefreshIpWorker.cpp \
@@ -82,6 +90,7 @@ SOURCES += main.cpp MainWindow.cpp \
     NsLookup/Workers/PrintNodesWorker.cpp \
     NsLookup/Workers/MiddleWorker.cpp \
     utilites/BigNumber.cpp \
+    utilites/LockedMemory.cpp \
     utilites/machine_uid.cpp \
     utilites/machine_uid_unix.cpp \
     utilites/machine_uid_win.cpp \
@@ -98,6 +107,7 @@ SOURCES += main.cpp MainWindow.cpp \
     qt_utilites/TimerClass.cpp \
     qt_utilites/WrapperJavascript.cpp \
     Network/SimpleClient.cpp \
+    Network/ContentDecoder.cpp \
     Network/HttpClient.cpp \
     Network/NetwrokTesting.cpp \
     Network/UdpSocketClient.cpp \
@@ -109,8 +119,12 @@ SOURCES += main.cpp MainWindow.cpp \
     Wallets/Wallets.cpp \
     Wallets/WalletsJavascript.cpp \
     Wallets/WalletInfo.cpp \
+    Wallets/WalletsCatalogue.cpp \
+    Wallets/KeysImporter.cpp \
     Initializer/Inits/InitWallets.cpp \
     qt_utilites/EventWatcher.cpp \
+    qt_utilites/JsDispatcher.cpp \
+    qt_utilites/JsonWriter.cpp \
     Wallets/GetActualWalletsEvent.cpp \
     NsLookup/InfrastructureNsLookup.cpp \
     MetaGate/MetaGate.cpp \
@@ -129,6 +143,8 @@ HEADERS += MainWindow.h \
     TorProxy.h \
     Uploader.h \
     Wallets/ethtx/scrypt/libscrypt.h \
+    Wallets/ethtx/scrypt/crypto_scrypt-smix.h \
+    Wallets/ethtx/scrypt/crypto_scrypt-sse.h \
     Wallets/ethtx/scrypt/sha256.h \
     Wallets/ethtx/scrypt/sysendian.h \
     Wallets/ethtx/cert.h \
@@ -155,17 +171,20 @@ HEADERS += MainWindow.h \
     PagesMappings.h \
     TorUrlSchemeHandler.h \
     MHUrlSchemeHandler.h \
+    MHUrlCache.h \
     Paths.h \
     RunGuard.h \
     Messenger/Messenger.h \
     Messenger/MessengerMessages.h \
     Messenger/MessengerJavascript.h \
     Messenger/Message.h \
+    Messenger/MessageJson.h \
     dbstorage.h \
     Messenger/MessengerDBStorage.h \
     transactions/Transactions.h \
     transactions/TransactionsMessages.h \
     transactions/Transaction.h \
+    transactions/TransactionJson.h \
     transactions/TransactionsDBStorage.h \
     transactions/TransactionsJavascript.h \
     auth/Auth.h \
@@ -181,6 +200,9 @@ HEADERS += MainWindow.h \
     Initializer/Inits/InitJavascriptWrapper.h \
     Initializer/Inits/InitUploader.h \
     Messenger/CryptographicManager.h \
+    Messenger/DecryptPool.h \
+    Messenger/DecryptedCache.h \
+    Messenger/GapTracker.h \
     Initializer/Inits/InitMessenger.h \
     MhPayEventHandler.h \
     WalletNames/WalletNamesDbStorage.h \
@@ -195,6 +217,8 @@ HEADERS += MainWindow.h \
     Utils/UtilsManager.h \
     NsLookup/TaskManager.h \
     NsLookup/NslWorker.h \
+    NsLookup/PingWindow.h \
+    NsLookup/ServerSelector.h \
     NsLookup/Workers/FullWorker.h \
     NsLookup/NsLookupStructs.h \
     NsLookup/Workers/SimpleWorker.h \
@@ -205,6 +229,7 @@ HEADERS += MainWindow.h \
     NsLookup/Workers/MiddleWorker.h \
     utilites/algorithms.h \
     utilites/BigNumber.h \
+    utilites/LockedMemory.h \
     utilites/machine_uid.h \
     utilites/platform.h \
     utilites/qrcoder.h \
@@ -219,6 +244,8 @@ HEADERS += MainWindow.h \
     qt_utilites/CallbackCallWrapper.h \
     qt_utilites/CallbackWrapper.h \
     qt_utilites/makeJsFunc.h \
+    qt_utilites/makeJsVariant.h \
+    qt_utilites/StreamToken.h \
     qt_utilites/ManagerWrapper.h \
     qt_utilites/ManagerWrapperImpl.h \
     qt_utilites/QRegister.h \
@@ -227,6 +254,7 @@ HEADERS += MainWindow.h \
     qt_utilites/WrapperJavascript.h \
     qt_utilites/WrapperJavascriptImpl.h \
     Network/SimpleClient.h \
+    Network/ContentDecoder.h \
     Network/HttpClient.h \
     Network/NetwrokTesting.h \
     Network/UdpSocketClient.h \
@@ -238,8 +266,12 @@ HEADERS += MainWindow.h \
     Wallets/Wallets.h \
     Wallets/WalletsJavascript.h \
     Wallets/WalletInfo.h \
+    Wallets/WalletsCatalogue.h \
+    Wallets/KeysImporter.h \
     Initializer/Inits/InitWallets.h \
     qt_utilites/EventWatcher.h \
+    qt_utilites/JsDispatcher.h \
+    qt_utilites/JsonWriter.h \
     Wallets/GetActualWalletsEvent.h \
     transactions/TransactionsFilter.h \
     NsLookup/InfrastructureNsLookup.h \
@@ -0,0 +1,126 @@
+#ifndef TRANSACTIONJSON_H
+#define TRANSACTIONJSON_H
+
+#include "qt_utilites/JsonWriter.h"
+
+#include "check.h"
+
+#include "Transaction.h"
+
+/*
+   Описание json представления структур transactions для javascript.
+   Формат совпадает с прежним, собранным через QJsonObject
+   */
+
+template<>
+struct JsonFields<transactions::Transaction> {
+    using Tx = transactions::Transaction;
+
+    static bool isDelegateTx(const Tx &tx) {
+        return tx.type == Tx::Type::DELEGATE;
+    }
+
+    static bool hasDelegateHash(const Tx &tx) {
+        return tx.type == Tx::Type::DELEGATE && !tx.delegateHash.isEmpty();
+    }
+
+    static const char* status(const Tx &tx) {
+        if (tx.status == Tx::OK) {
+            return "ok";
+        } else if (tx.status == Tx::PENDING) {
+            return "pending";
+        } else if (tx.status == Tx::ERROR) {
+            return "error";
+        } else if (tx.status == Tx::MODULE_NOT_SET) {
+            return "module_not_set";
+        } else {
+            throwErr("Incorrect transaction status " + std::to_string(tx.status));
+        }
+    }
+
+    static const char* type(const Tx &tx) {
+        if (tx.type == Tx::SIMPLE) {
+            return "simple";
+        } else if (tx.type == Tx::DELEGATE) {
+            return "delegate";
+        } else if (tx.type == Tx::FORGING) {
+            return "forging";
+        } else if (tx.type == Tx::CONTRACT) {
+            return "contract";
+        } else {
+            throwErr("Incorrect transaction type " + std::to_string(tx.type));
+        }
+    }
+
+    static constexpr auto fields() {
+        return std::make_tuple(
+            jsonField("id", &Tx::tx),
+            jsonField("from", &Tx::from),
+            jsonField("to", &Tx::to),
+            jsonField("value", &Tx::value),
+            jsonField("data", &Tx::data),
+            jsonFieldStr("timestamp", &Tx::timestamp),
+            jsonField("fee", &Tx::fee),
+            jsonFieldStr("nonce", &Tx::nonce),
+            jsonFieldStr("blockNumber", &Tx::blockNumber),
+            jsonFieldStr("blockIndex", &Tx::blockIndex),
+            jsonField("intStatus", &Tx::intStatus),
+            jsonField("isDelegate", &Tx::isDelegate, &isDelegateTx),
+            jsonField("delegate_value", &Tx::delegateValue, &isDelegateTx),
+            jsonField("delegate_hash", &Tx::delegateHash, &hasDelegateHash),
+            jsonField("status", &status),
+            jsonField("type", &type)
+        );
+    }
+};
+
+template<>
+struct JsonFields<transactions::BalanceInfo> {
+    using Balance = transactions::BalanceInfo;
+
+    static QByteArray received(const Balance &b) { return b.received.getDecimal(); }
+    static QByteArray spent(const Balance &b) { return b.spent.getDecimal(); }
+    static QByteArray delegate(const Balance &b) { return b.delegate.getDecimal(); }
+    static QByteArray undelegate(const Balance &b) { return b.undelegate.getDecimal(); }
+    static QByteArray delegated(const Balance &b) { return b.delegated.getDecimal(); }
+    static QByteArray undelegated(const Balance &b) { return b.undelegated.getDecimal(); }
+    static QByteArray reserved(const Balance &b) { return b.reserved.getDecimal(); }
+    static QByteArray forged(const Balance &b) { return b.forged.getDecimal(); }
+    static QByteArray balance(const Balance &b) { return b.calcBalance().getDecimal(); }
+
+    static constexpr auto fields() {
+        return std::make_tuple(
+            jsonField("received", &received),
+            jsonField("spent", &spent),
+            jsonFieldStr("countReceived", &Balance::countReceived),
+            jsonFieldStr("countSpent", &Balance::countSpent),
+            jsonFieldStr("countTxs", &Balance::countTxs),
+            jsonFieldStr("savedTxs", &Balance::savedTxs),
+            jsonFieldStr("currBlock", &Balance::currBlockNum),
+            jsonFieldStr("countDelegated", &Balance::countDelegated),
+            jsonField("delegate", &delegate),
+            jsonField("undelegate", &undelegate),
+            jsonField("delegated", &delegated),
+            jsonField("undelegated", &undelegated),
+            jsonField("reserved", &reserved),
+            jsonField("forged", &forged),
+            jsonField("balance", &balance)
+        );
+    }
+};
+
+template<>
+struct JsonFields<transactions::AddressInfo> {
+    using Info = transactions::AddressInfo;
+
+    static constexpr auto fields() {
+        return std::make_tuple(
+            jsonField("address", &Info::address),
+            jsonField("currency", &Info::currency),
+            jsonField("group", &Info::group),
+            jsonField("balance", &Info::balance)
+        );
+    }
+};
+
+#endif // TRANSACTIONJSON_H
@@ -62,6 +62,7 @@ Transactions::Transactions(NsLookup &nsLookup, InfrastructureNsLookup &infrastru
     Q_CONNECT(this, &Transactions::getAddresses, this, &Transactions::onGetAddresses);
     Q_CONNECT(this, &Transactions::setCurrentGroup, this, &Transactions::onSetCurrentGroup);
     Q_CONNECT(this, &Transactions::getTxs2, this, &Transactions::onGetTxs2);
+    Q_CONNECT(this, &Transactions::getTxs2Stream, this, &Transactions::onGetTxs2Stream);
     Q_CONNECT(this, &Transactions::getTxsFilters, this, &Transactions::onGetTxsFilters);
     Q_CONNECT(this, &Transactions::getTxsAll2, this, &Transactions::onGetTxsAll2);
     Q_CONNECT(this, &Transactions::getForgingTxs, this, &Transactions::onGetForgingTxs);
@@ -83,6 +84,9 @@ Transactions::Transactions(NsLookup &nsLookup, InfrastructureNsLookup &infrastru
 
     Q_REG(RegisterAddressCallback, "RegisterAddressCallback");
     Q_REG(GetTxsCallback, "GetTxsCallback");
+    Q_REG(GetTxsChunkCallback, "GetTxsChunkCallback");
+    Q_REG(GetTxsStreamCallback, "GetTxsStreamCallback");
+    Q_REG2(std::shared_ptr<StreamToken>, "std::shared_ptr<StreamToken>", false);
     Q_REG(CalcBalanceCallback, "CalcBalanceCallback");
     Q_REG(SetCurrentGroupCallback, "SetCurrentGroupCallback");
     Q_REG(GetAddressesCallback, "GetAddressesCallback");
@@ -312,6 +316,7 @@ void Transactions::processAddressMth(const std::vector<QString> &addresses, cons
             const auto &exception = r.exception;
             const std::string &response = r.response;
             const QUrl &server = servers[i];
+            emit nsLookup.serverResult(server.toString(), r.time.count(), exception.isSet());
             if (!exception.isSet()) {
                 const std::vector<BalanceInfo> balancesResponse = parseBalancesResponse(QString::fromStdString(response));
                 CHECK(balancesResponse.size() == addresses.size(), "Incorrect balances response");
@@ -625,6 +630,69 @@ BEGIN_SLOT_WRAPPER
 END_SLOT_WRAPPER
 }
 
+void Transactions::onGetTxs2Stream(const QString &address, const QString &currency, int from, int count, bool asc, int chunkSize, const std::shared_ptr<StreamToken> &token, const GetTxsChunkCallback &chunkCallback, const GetTxsStreamCallback &callback) {
+BEGIN_SLOT_WRAPPER
+    runAndEmitErrorCallback([&, this] {
+        CHECK(chunkSize > 0, "Incorrect chunk size");
+        const auto stream = std::make_shared<TxsStream>();
+        stream->address = address;
+        stream->currency = convertCurrency(currency);
+        stream->offset = from;
+        stream->remaining = count;
+        stream->asc = asc;
+        stream->chunkSize = chunkSize;
+        stream->token = token;
+        stream->chunkCallback = chunkCallback;
+        stream->callback = callback;
+        readTxsChunk(stream);
+    }, callback);
+END_SLOT_WRAPPER
+}
+
+void Transactions::readTxsChunk(const std::shared_ptr<TxsStream> &stream) {
+    const TypedException exception = apiVrapper2([&, this] {
+        if (stream->token->isCancelled()) {
+            stream->callback.emitCallback(stream->sent, true);
+            return;
+        }
+
+        const int toRead = stream->remaining < 0 ? stream->chunkSize : std::min(stream->chunkSize, stream->remaining);
+        std::vector<Transaction> txs;
+        if (stream->isFirstChunk) {
+            txs = db.getPaymentsForAddress(stream->address, stream->currency, stream->offset, toRead, stream->asc);
+            stream->isFirstChunk = false;
+        } else {
+            txs = db.getPaymentsForAddressAfter(stream->address, stream->currency, stream->last, toRead, stream->asc);
+        }
+        if (!txs.empty()) {
+            stream->last = txs.back();
+        }
+        stream->sent += txs.size();
+        if (stream->remaining >= 0) {
+            stream->remaining -= txs.size();
+        }
+        if (!txs.empty()) {
+            stream->chunkCallback(txs);
+        }
+
+        if ((int)txs.size() < toRead || stream->remaining == 0) {
+            stream->callback.emitCallback(stream->sent, false);
+            return;
+        }
+
+        // Следующая порция читается в следующем проходе цикла событий, чтобы не блокировать остальные запросы
+        QTimer::singleShot(0, this, [this, stream]{
+            BEGIN_SLOT_WRAPPER
+            readTxsChunk(stream);
+            END_SLOT_WRAPPER
+        });
+    });
+
+    if (exception.isSet()) {
+        stream->callback.emitException(exception);
+    }
+}
+
 void Transactions::onGetTxsFilters(const QString &address, const QString &currency, const Filters &filter, int from, int count, bool asc, const GetTxsCallback &callback) {
 BEGIN_SLOT_WRAPPER
     runAndEmitCallback([&, this] {
@@ -865,6 +933,7 @@ BEGIN_SLOT_WRAPPER
                         QString result;
                         const TypedException exception = apiVrapper2([&] {
                             if (error.isSet()) {
+                                emit nsLookup.serverResult(server, 0, true);
                                 nsLookup.rejectServer(server);
                             }
                             CHECK_TYPED(!error.isSet(), TypeErrors::TRANSACTIONS_SERVER_SEND_ERROR, error.description + ". " + server.toStdString());
@@ -912,8 +981,9 @@ BEGIN_SLOT_WRAPPER
 
             std::shared_ptr<NonceStruct> nonceStruct = std::make_shared<NonceStruct>(servers.size());
 
-            const auto getBalanceCallback = [nonceStruct, from, callback](const QString &server, const SimpleClient::Response &response) {
+            const auto getBalanceCallback = [this, nonceStruct, from, callback](const QString &server, const SimpleClient::Response &response) {
                 nonceStruct->count--;
+                emit nsLookup.serverResult(server, response.time.count(), response.exception.isSet());
 
                 if (!response.exception.isSet()) {
                     const BalanceInfo balanceResponse = parseBalanceResponse(QString::fromStdString(response.response));
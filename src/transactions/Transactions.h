@@ -15,6 +15,7 @@
 
 #include "qt_utilites/CallbackWrapper.h"
 #include "qt_utilites/ManagerWrapper.h"
+#include "qt_utilites/StreamToken.h"
 
 #include "Transaction.h"
 #include "TransactionsFilter.h"
@@ -133,6 +134,11 @@ public:
 
     using GetTxsCallback = CallbackWrapper<void(const std::vector<Transaction> &txs)>;
 
+    // Вызывается в потоке Transactions для каждой прочитанной порции
+    using GetTxsChunkCallback = std::function<void(const std::vector<Transaction> &txs)>;
+
+    using GetTxsStreamCallback = CallbackWrapper<void(size_t count, bool isCancelled)>;
+
     using CalcBalanceCallback = CallbackWrapper<void(const BalanceInfo &txs)>;
 
     using SetCurrentGroupCallback = CallbackWrapper<void()>;
@@ -180,6 +186,8 @@ signals:
 
     void getTxs2(const QString &address, const QString &currency, int from, int count, bool asc, const GetTxsCallback &callback);
 
+    void getTxs2Stream(const QString &address, const QString &currency, int from, int count, bool asc, int chunkSize, const std::shared_ptr<StreamToken> &token, const GetTxsChunkCallback &chunkCallback, const GetTxsStreamCallback &callback);
+
     void getTxsFilters(const QString &address, const QString &currency, const Filters &filter, int from, int count, bool asc, const GetTxsCallback &callback);
 
     void getTxsAll2(const QString &currency, int from, int count, bool asc, const GetTxsCallback &callback);
@@ -218,6 +226,8 @@ public slots:
 
     void onGetTxs2(const QString &address, const QString &currency, int from, int count, bool asc, const GetTxsCallback &callback);
 
+    void onGetTxs2Stream(const QString &address, const QString &currency, int from, int count, bool asc, int chunkSize, const std::shared_ptr<StreamToken> &token, const GetTxsChunkCallback &chunkCallback, const GetTxsStreamCallback &callback);
+
     void onGetTxsFilters(const QString &address, const QString &currency, const Filters &filter, int from, int count, bool asc, const GetTxsCallback &callback);
 
     void onGetTxsAll2(const QString &currency, int from, int count, bool asc, const GetTxsCallback &callback);
@@ -292,6 +302,24 @@ private:
 
     QString convertCurrency(const QString &currency) const;
 
+    struct TxsStream {
+        QString address;
+        QString currency;
+        int offset;
+        // Последняя выданная транзакция. Следующие порции выбираются после нее, а не по offset
+        Transaction last;
+        bool isFirstChunk = true;
+        int remaining; // -1 - читать до конца
+        bool asc;
+        int chunkSize;
+        size_t sent = 0;
+        std::shared_ptr<StreamToken> token;
+        GetTxsChunkCallback chunkCallback;
+        GetTxsStreamCallback callback;
+    };
+
+    void readTxsChunk(const std::shared_ptr<TxsStream> &stream);
+
 private:
 
     NsLookup &nsLookup;
@@ -101,9 +101,16 @@ static const QString selectBalance = "SELECT * FROM balance "
 static const QString selectPaymentsForDestFilter = "SELECT * FROM payments "
                                                     "WHERE address = :address AND  currency = :currency "
                                                     "%filter% "
-                                                    "ORDER BY ts %1, txid %1 "
+                                                    "ORDER BY ts %1, txid %1, id %1 "
                                                     "LIMIT :count OFFSET :offset";
 
+// Следующая порция после транзакции (ts, txid, id) в том же порядке, что и selectPaymentsForDestFilter. %2 - > или <
+static const QString selectPaymentsForDestAfter = "SELECT * FROM payments "
+                                                    "WHERE address = :address AND  currency = :currency "
+                                                    "AND (ts %2 :ts OR (ts = :ts AND (txid %2 :txid OR (txid = :txid AND id %2 :id)))) "
+                                                    "ORDER BY ts %1, txid %1, id %1 "
+                                                    "LIMIT :count";
+
 static const QString selectPaymentsForCurrency = "SELECT * FROM payments "
                                                     "WHERE currency = :currency "
                                                     "AND address in (SELECT address FROM tracked WHERE currency = :currency AND tgroup = :tgroup)"
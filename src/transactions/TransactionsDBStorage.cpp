@@ -126,6 +126,25 @@ std::vector<Transaction> TransactionsDBStorage::getPaymentsForAddress(const QStr
     return res;
 }
 
+std::vector<Transaction> TransactionsDBStorage::getPaymentsForAddressAfter(const QString &address, const QString &currency,
+                                                                           const Transaction &after, qint64 count, bool asc)
+{
+    std::vector<Transaction> res;
+    QSqlQuery query(database());
+    const QString q = selectPaymentsForDestAfter.arg(asc ? QStringLiteral("ASC") : QStringLiteral("DESC"), asc ? QStringLiteral(">") : QStringLiteral("<"));
+    CHECK(query.prepare(q),
+          query.lastError().text().toStdString());
+    query.bindValue(":address", address);
+    query.bindValue(":currency", currency);
+    query.bindValue(":ts", static_cast<qint64>(after.timestamp));
+    query.bindValue(":txid", after.tx);
+    query.bindValue(":id", after.id);
+    query.bindValue(":count", count);
+    CHECK(query.exec(), query.lastError().text().toStdString());
+    createPaymentsList(query, res);
+    return res;
+}
+
 std::vector<Transaction> TransactionsDBStorage::getPaymentsForAddressFilter(const QString &address, const QString &currency, const Filters &filters,
                                                      qint64 offset, qint64 count, bool asc) {
     std::vector<Transaction> res;
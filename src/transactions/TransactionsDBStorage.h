@@ -31,6 +31,9 @@ public:
     std::vector<Transaction> getPaymentsForAddress(const QString &address, const QString &currency,
                                               qint64 offset, qint64 count, bool asc);
 
+    std::vector<Transaction> getPaymentsForAddressAfter(const QString &address, const QString &currency,
+                                              const Transaction &after, qint64 count, bool asc);
+
     std::vector<Transaction> getPaymentsForAddressFilter(const QString &address, const QString &currency, const Filters &filters,
                                               qint64 offset, qint64 count, bool asc);
 
@@ -6,6 +6,7 @@
 #include <QJsonObject>
 
 #include "Transaction.h"
+#include "TransactionJson.h"
 
 #include "qt_utilites/makeJsFunc.h"
 #include "qt_utilites/SlotWrapper.h"
@@ -35,108 +36,25 @@ TransactionsJavascript::TransactionsJavascript()
     Q_REG(Transaction, "Transaction");
 }
 
-static QJsonObject balanceToJson1(const BalanceInfo &balance) {
-    QJsonObject messagesBalanceJson;
-    messagesBalanceJson.insert("received", QString(balance.received.getDecimal()));
-    messagesBalanceJson.insert("spent", QString(balance.spent.getDecimal()));
-    messagesBalanceJson.insert("countReceived", QString::fromStdString(std::to_string(balance.countReceived)));
-    messagesBalanceJson.insert("countSpent", QString::fromStdString(std::to_string(balance.countSpent)));
-    messagesBalanceJson.insert("countTxs", QString::fromStdString(std::to_string(balance.countTxs)));
-    messagesBalanceJson.insert("savedTxs", QString::fromStdString(std::to_string(balance.savedTxs)));
-    messagesBalanceJson.insert("currBlock", QString::fromStdString(std::to_string(balance.currBlockNum)));
-    messagesBalanceJson.insert("countDelegated", QString::fromStdString(std::to_string(balance.countDelegated)));
-    messagesBalanceJson.insert("delegate", QString(balance.delegate.getDecimal()));
-    messagesBalanceJson.insert("undelegate", QString(balance.undelegate.getDecimal()));
-    messagesBalanceJson.insert("delegated", QString(balance.delegated.getDecimal()));
-    messagesBalanceJson.insert("undelegated", QString(balance.undelegated.getDecimal()));
-    messagesBalanceJson.insert("reserved", QString(balance.reserved.getDecimal()));
-    messagesBalanceJson.insert("forged", QString(balance.forged.getDecimal()));
-    messagesBalanceJson.insert("balance", QString(balance.calcBalance().getDecimal()));
-    return messagesBalanceJson;
+void TransactionsJavascript::resetPageState() {
+    WrapperJavascript::resetPageState();
+    isBalancesSubscribed = false;
 }
 
-static QJsonDocument balanceToJson(const BalanceInfo &balance) {
-    return QJsonDocument(balanceToJson1(balance));
+static JsonString balanceToJson(const BalanceInfo &balance) {
+    return toJsonString(balance);
 }
 
-static QJsonObject txToJson(const Transaction &tx) {
-    QJsonObject txJson;
-    txJson.insert("id", tx.tx);
-    txJson.insert("from", tx.from);
-    txJson.insert("to", tx.to);
-    txJson.insert("value", tx.value);
-    txJson.insert("data", tx.data);
-    txJson.insert("timestamp", QString::fromStdString(std::to_string(tx.timestamp)));
-    txJson.insert("fee", tx.fee);
-    txJson.insert("nonce", QString::fromStdString(std::to_string(tx.nonce)));
-    txJson.insert("blockNumber", QString::fromStdString(std::to_string(tx.blockNumber)));
-    txJson.insert("blockIndex", QString::fromStdString(std::to_string(tx.blockIndex)));
-    txJson.insert("intStatus", tx.intStatus);
-    if (tx.type == Transaction::Type::DELEGATE) {
-        txJson.insert("isDelegate", tx.isDelegate);
-        txJson.insert("delegate_value", tx.delegateValue);
-        if (!tx.delegateHash.isEmpty()) {
-            txJson.insert("delegate_hash", tx.delegateHash);
-        }
-    }
-
-    QString statusStr;
-    if (tx.status == Transaction::OK) {
-        statusStr = "ok";
-    } else if (tx.status == Transaction::PENDING) {
-        statusStr = "pending";
-    } else if (tx.status == Transaction::ERROR) {
-        statusStr = "error";
-    } else if (tx.status == Transaction::MODULE_NOT_SET) {
-        statusStr = "module_not_set";
-    } else {
-        throwErr("Incorrect transaction status " + std::to_string(tx.status));
-    }
-    txJson.insert("status", statusStr);
-
-    QString typeStr;
-    if (tx.type == Transaction::SIMPLE) {
-        typeStr = "simple";
-    } else if (tx.type == Transaction::DELEGATE) {
-        typeStr = "delegate";
-    } else if (tx.type == Transaction::FORGING) {
-        typeStr = "forging";
-    } else if (tx.type == Transaction::CONTRACT) {
-        typeStr = "contract";
-    } else {
-        throwErr("Incorrect transaction type " + std::to_string(tx.type));
-    }
-    txJson.insert("type", typeStr);
-    return txJson;
-}
-
-static QJsonDocument txsToJson(const std::vector<Transaction> &txs) {
-    QJsonArray messagesTxsJson;
-    for (const Transaction &tx: txs) {
-        messagesTxsJson.push_back(txToJson(tx));
-    }
-
-    return QJsonDocument(messagesTxsJson);
+static JsonString txsToJson(const std::vector<Transaction> &txs) {
+    return toJsonString(txs);
 }
 
-static QJsonDocument addressInfoToJson(const std::vector<AddressInfo> &infos) {
-    QJsonArray messagesInfosJson;
-    for (const AddressInfo &info: infos) {
-        QJsonObject txJson;
-        txJson.insert("address", info.address);
-        txJson.insert("currency", info.currency);
-        txJson.insert("group", info.group);
-
-        txJson.insert("balance", balanceToJson1(info.balance));
-
-        messagesInfosJson.push_back(txJson);
-    }
-
-    return QJsonDocument(messagesInfosJson);
+static JsonString addressInfoToJson(const std::vector<AddressInfo> &infos) {
+    return toJsonString(infos);
 }
 
-static QJsonDocument txInfoToJson(const Transaction &tx) {
-    return QJsonDocument(txToJson(tx));
+static JsonString txInfoToJson(const Transaction &tx) {
+    return toJsonString(tx);
 }
 
 void TransactionsJavascript::onNewBalance(const QString &address, const QString &currency, const BalanceInfo &balance) {
@@ -145,7 +63,53 @@ BEGIN_SLOT_WRAPPER
 
     LOG << "New balance " << address << " " << currency << " " << balance.countTxs << " " << QString(balance.calcBalance().getDecimal());
 
-    makeAndRunJsFuncParams(JS_NAME_RESULT, TypedException(), address, currency, balanceToJson(balance));
+    const auto key = std::make_pair(address, currency);
+    const auto found = balancesState.find(key);
+    if (!isBalancesSubscribed) {
+        makeAndRunJsFuncParams(JS_NAME_RESULT, TypedException(), address, currency, balanceToJson(balance));
+    } else {
+        JsonWriter delta;
+        bool isChanged = true;
+        if (found == balancesState.end()) {
+            writeJson(delta, balance);
+        } else {
+            isChanged = writeJsonDelta(delta, found->second, balance);
+        }
+        if (isChanged) {
+            balancesVersion++;
+            makeAndRunJsFuncParams("txsBalanceDeltaJs", TypedException(), address, currency, balancesVersion, delta.result());
+        }
+    }
+    if (found == balancesState.end()) {
+        balancesState.emplace(key, balance);
+    } else {
+        found->second = balance;
+    }
+END_SLOT_WRAPPER
+}
+
+void TransactionsJavascript::subscribeBalances() {
+BEGIN_SLOT_WRAPPER
+    const QString JS_NAME_RESULT = "txsSubscribeBalancesJs";
+
+    LOG << "Subscribe balances " << balancesState.size();
+
+    JsonWriter snapshot(static_cast<int>(balancesState.size()) * 512 + 16);
+    snapshot.beginArray();
+    for (const auto &pair: balancesState) {
+        snapshot.beginObject();
+        snapshot.key("address", 7);
+        snapshot.value(pair.first.first);
+        snapshot.key("currency", 8);
+        snapshot.value(pair.first.second);
+        snapshot.key("balance", 7);
+        writeJson(snapshot, pair.second);
+        snapshot.endObject();
+    }
+    snapshot.endArray();
+
+    isBalancesSubscribed = true;
+    makeAndRunJsFuncParams(JS_NAME_RESULT, TypedException(), balancesVersion, snapshot.result());
 END_SLOT_WRAPPER
 }
 
@@ -214,12 +178,12 @@ BEGIN_SLOT_WRAPPER
 
     LOG << "Get addresses " << group;
 
-    const auto makeFunc = makeJavascriptReturnAndErrorFuncs(JS_NAME_RESULT, JsTypeReturn<QJsonDocument>(QJsonDocument()));
+    const auto makeFunc = makeJavascriptReturnAndErrorFuncs(JS_NAME_RESULT, JsTypeReturn<JsonString>(JsonString()));
 
     wrapOperation([&, this](){
         emit transactionsManager->getAddresses(group, Transactions::GetAddressesCallback([makeFunc](const std::vector<AddressInfo> &infos) {
             LOG << "Get addresses ok " << infos.size();
-            const QJsonDocument &result = addressInfoToJson(infos);
+            const JsonString result = addressInfoToJson(infos);
             makeFunc.func(TypedException(), result);
         }, makeFunc.error, signalFunc));
     }, makeFunc.error);
@@ -253,7 +217,7 @@ BEGIN_SLOT_WRAPPER
 
     LOG << "get txs2 address " << address << " " << currency << " " << from << " " << count << " " << asc;
 
-    const auto makeFunc = makeJavascriptReturnAndErrorFuncs(JS_NAME_RESULT, JsTypeReturn<QString>(address), JsTypeReturn<QString>(currency), JsTypeReturn<QJsonDocument>(QJsonDocument()));
+    const auto makeFunc = makeJavascriptReturnAndErrorFuncs(JS_NAME_RESULT, JsTypeReturn<QString>(address), JsTypeReturn<QString>(currency), JsTypeReturn<JsonString>(JsonString()));
 
     wrapOperation([&, this](){
         emit transactionsManager->getTxs2(address, currency, from, count, asc, Transactions::GetTxsCallback([address, currency, makeFunc](const std::vector<Transaction> &txs) {
@@ -264,6 +228,48 @@ BEGIN_SLOT_WRAPPER
 END_SLOT_WRAPPER
 }
 
+void TransactionsJavascript::getTxs2Stream(QString requestId, QString address, QString currency, int from, int count, bool asc, int chunkSize) {
+BEGIN_SLOT_WRAPPER
+    CHECK(transactionsManager != nullptr, "transactions not set");
+
+    const QString JS_NAME_CHUNK = "txsGetTxs2StreamChunkJs";
+    const QString JS_NAME_RESULT = "txsGetTxs2StreamFinishJs";
+
+    LOG << "get txs2 stream " << requestId << " " << address << " " << currency << " " << from << " " << count << " " << asc << " " << chunkSize;
+
+    const auto makeFunc = makeJavascriptReturnAndErrorFuncs(JS_NAME_RESULT, JsTypeReturn<QString>(requestId), JsTypeReturn<QString>(address), JsTypeReturn<QString>(currency), JsTypeReturn<size_t>(0), JsTypeReturn<bool>(false));
+
+    const std::shared_ptr<StreamToken> token = streamTokens.create(requestId);
+
+    // Порции сериализуются в потоке Transactions, а в javascript уходят через signalFunc в том же порядке, что и финальный ответ
+    const auto chunkCallback = [this, requestId, address, currency, JS_NAME_CHUNK](const std::vector<Transaction> &txs) {
+        const JsonString result = txsToJson(txs);
+        signalFunc([this, requestId, address, currency, JS_NAME_CHUNK, result] {
+            makeAndRunJsFuncParams(JS_NAME_CHUNK, TypedException(), requestId, address, currency, result);
+        });
+    };
+
+    const auto errorFunc = [this, requestId, token, makeFunc](const TypedException &exception) {
+        streamTokens.remove(requestId, token);
+        makeFunc.error(exception);
+    };
+
+    wrapOperation([&, this](){
+        emit transactionsManager->getTxs2Stream(address, currency, from, count, asc, chunkSize, token, chunkCallback, Transactions::GetTxsStreamCallback([this, requestId, address, currency, token, makeFunc](size_t count, bool isCancelled) {
+            LOG << "get txs2 stream ok " << requestId << " " << count << " " << isCancelled;
+            streamTokens.remove(requestId, token);
+            makeFunc.func(TypedException(), requestId, address, currency, count, isCancelled);
+        }, errorFunc, signalFunc));
+    }, errorFunc);
+END_SLOT_WRAPPER
+}
+
+void TransactionsJavascript::cancelStream(QString requestId) {
+BEGIN_SLOT_WRAPPER
+    LOG << "cancel stream " << requestId << " " << streamTokens.cancel(requestId);
+END_SLOT_WRAPPER
+}
+
 void TransactionsJavascript::getTxsAll2(QString currency, int from, int count, bool asc) {
 BEGIN_SLOT_WRAPPER
     CHECK(transactionsManager != nullptr, "transactions not set");
@@ -272,7 +278,7 @@ BEGIN_SLOT_WRAPPER
 
     LOG << "get txs2 address " << currency << " " << from << " " << count << " " << asc;
 
-    const auto makeFunc = makeJavascriptReturnAndErrorFuncs(JS_NAME_RESULT, JsTypeReturn<QString>(currency), JsTypeReturn<QJsonDocument>(QJsonDocument()));
+    const auto makeFunc = makeJavascriptReturnAndErrorFuncs(JS_NAME_RESULT, JsTypeReturn<QString>(currency), JsTypeReturn<JsonString>(JsonString()));
 
     wrapOperation([&, this](){
         emit transactionsManager->getTxsAll2(currency, from, count, asc, Transactions::GetTxsCallback([currency, makeFunc](const std::vector<Transaction> &txs) {
@@ -331,7 +337,7 @@ BEGIN_SLOT_WRAPPER
 
     LOG << "get txs filters address " << address << " " << currency << " " << from << " " << count << " " << asc << " " << filtersJson;
 
-    const auto makeFunc = makeJavascriptReturnAndErrorFuncs(JS_NAME_RESULT, JsTypeReturn<QString>(address), JsTypeReturn<QString>(currency), JsTypeReturn<QJsonDocument>(QJsonDocument()));
+    const auto makeFunc = makeJavascriptReturnAndErrorFuncs(JS_NAME_RESULT, JsTypeReturn<QString>(address), JsTypeReturn<QString>(currency), JsTypeReturn<JsonString>(JsonString()));
 
     wrapOperation([&, this](){
         emit transactionsManager->getTxsFilters(address, currency, jsonToFilters(filtersJson), from, count, asc, Transactions::GetTxsCallback([address, currency, makeFunc](const std::vector<Transaction> &txs) {
@@ -350,7 +356,7 @@ BEGIN_SLOT_WRAPPER
 
     LOG << "get forging txs address " << address << " " << currency << " " << from << " " << count << " " << asc;
 
-    const auto makeFunc = makeJavascriptReturnAndErrorFuncs(JS_NAME_RESULT, JsTypeReturn<QString>(address), JsTypeReturn<QString>(currency), JsTypeReturn<QJsonDocument>(QJsonDocument()));
+    const auto makeFunc = makeJavascriptReturnAndErrorFuncs(JS_NAME_RESULT, JsTypeReturn<QString>(address), JsTypeReturn<QString>(currency), JsTypeReturn<JsonString>(JsonString()));
 
     wrapOperation([&, this]() {
         emit transactionsManager->getForgingTxs(address, currency, from, count, asc, Transactions::GetTxsCallback([address, currency, makeFunc](const std::vector<Transaction> &txs) {
@@ -369,7 +375,7 @@ BEGIN_SLOT_WRAPPER
 
     LOG << "get delegate txs address " << address << " " << currency << " " << to << " " << from << " " << count << " " << asc;
 
-    const auto makeFunc = makeJavascriptReturnAndErrorFuncs(JS_NAME_RESULT, JsTypeReturn<QString>(address), JsTypeReturn<QString>(currency), JsTypeReturn<QJsonDocument>(QJsonDocument()));
+    const auto makeFunc = makeJavascriptReturnAndErrorFuncs(JS_NAME_RESULT, JsTypeReturn<QString>(address), JsTypeReturn<QString>(currency), JsTypeReturn<JsonString>(JsonString()));
 
     wrapOperation([&, this]() {
         emit transactionsManager->getDelegateTxs(address, currency, to, from, count, asc, Transactions::GetTxsCallback([address, currency, makeFunc](const std::vector<Transaction> &txs) {
@@ -388,7 +394,7 @@ BEGIN_SLOT_WRAPPER
 
     LOG << "get delegate txs address " << address << " " << currency << " " << from << " " << count << " " << asc;
 
-    const auto makeFunc = makeJavascriptReturnAndErrorFuncs(JS_NAME_RESULT, JsTypeReturn<QString>(address), JsTypeReturn<QString>(currency), JsTypeReturn<QJsonDocument>(QJsonDocument()));
+    const auto makeFunc = makeJavascriptReturnAndErrorFuncs(JS_NAME_RESULT, JsTypeReturn<QString>(address), JsTypeReturn<QString>(currency), JsTypeReturn<JsonString>(JsonString()));
 
     wrapOperation([&, this]() {
         emit transactionsManager->getDelegateTxs2(address, currency, from, count, asc, Transactions::GetTxsCallback([address, currency, makeFunc](const std::vector<Transaction> &txs) {
@@ -407,7 +413,7 @@ BEGIN_SLOT_WRAPPER
 
     LOG << "get forging tx address " << address << " " << currency;
 
-    const auto makeFunc = makeJavascriptReturnAndErrorFuncs(JS_NAME_RESULT, JsTypeReturn<QString>(address), JsTypeReturn<QString>(currency), JsTypeReturn<QJsonDocument>(QJsonDocument()));
+    const auto makeFunc = makeJavascriptReturnAndErrorFuncs(JS_NAME_RESULT, JsTypeReturn<QString>(address), JsTypeReturn<QString>(currency), JsTypeReturn<JsonString>(JsonString()));
 
     wrapOperation([&, this]() {
         emit transactionsManager->getLastForgingTx(address, currency, Transactions::GetTxCallback([address, currency, makeFunc](const Transaction &txs) {
@@ -426,7 +432,7 @@ BEGIN_SLOT_WRAPPER
 
     LOG << "calc balance address " << currency << " " << address;
 
-    const auto makeFunc = makeJavascriptReturnAndErrorFuncs(chooseCallback(callback, JS_NAME_RESULT), JsTypeReturn<QString>(address), JsTypeReturn<QString>(currency), JsTypeReturn<QJsonDocument>(QJsonDocument()));
+    const auto makeFunc = makeJavascriptReturnAndErrorFuncs(chooseCallback(callback, JS_NAME_RESULT), JsTypeReturn<QString>(address), JsTypeReturn<QString>(currency), JsTypeReturn<JsonString>(JsonString()));
 
     wrapOperation([&, this](){
         emit transactionsManager->calcBalance(address, currency, Transactions::CalcBalanceCallback([currency, address, makeFunc](const BalanceInfo &balance) {
@@ -445,7 +451,7 @@ BEGIN_SLOT_WRAPPER
 
     LOG << "getTxFromServer address " << txHash << " " << type;
 
-    const auto makeFunc = makeJavascriptReturnAndErrorFuncs(JS_NAME_RESULT, JsTypeReturn<QString>(txHash), JsTypeReturn<QString>(type), JsTypeReturn<QJsonDocument>(QJsonDocument()));
+    const auto makeFunc = makeJavascriptReturnAndErrorFuncs(JS_NAME_RESULT, JsTypeReturn<QString>(txHash), JsTypeReturn<QString>(type), JsTypeReturn<JsonString>(JsonString()));
 
     wrapOperation([&, this](){
         emit transactionsManager->getTxFromServer(txHash, type, Transactions::GetTxCallback([txHash, type, makeFunc](const Transaction &tx) {
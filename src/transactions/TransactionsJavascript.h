@@ -4,22 +4,25 @@
 #include <QObject>
 
 #include <functional>
+#include <map>
 
 #include "qt_utilites/WrapperJavascript.h"
+#include "qt_utilites/StreamToken.h"
+
+#include "Transaction.h"
 
 namespace transactions {
 
 class Transactions;
 
-struct BalanceInfo;
-struct Transaction;
-
 class TransactionsJavascript: public WrapperJavascript {
     Q_OBJECT
 public:
 
     explicit TransactionsJavascript();
 
+    void resetPageState() override;
+
     void setTransactions(Transactions &trans) {
         transactionsManager = &trans;
     }
@@ -60,6 +63,10 @@ public slots:
 
     Q_INVOKABLE void getTxs2(QString address, QString currency, int from, int count, bool asc);
 
+    Q_INVOKABLE void getTxs2Stream(QString requestId, QString address, QString currency, int from, int count, bool asc, int chunkSize);
+
+    Q_INVOKABLE void cancelStream(QString requestId);
+
     Q_INVOKABLE void getTxsAll2(QString currency, int from, int count, bool asc);
 
     Q_INVOKABLE void getTxsFilters(QString address, QString currency, QString filtersJson, int from, int count, bool asc);
@@ -82,9 +89,20 @@ public slots:
 
     Q_INVOKABLE void clearDb(QString currency);
 
+    Q_INVOKABLE void subscribeBalances();
+
 private:
 
     Transactions *transactionsManager;
+
+    StreamTokens streamTokens;
+
+    // Последние отправленные в javascript балансы, по (address, currency)
+    std::map<std::pair<QString, QString>, BalanceInfo> balancesState;
+
+    size_t balancesVersion = 0;
+
+    bool isBalancesSubscribed = false;
 };
 
 }
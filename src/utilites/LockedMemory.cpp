@@ -0,0 +1,121 @@
+#include "LockedMemory.h"
+
+#include <map>
+#include <mutex>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+static size_t pageSize() {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwPageSize;
+#else
+    return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+/*
+   Блокировки страниц в ОС не вложенные: munlock снимает блокировку со всей страницы, даже если на ней лежит другой ключ.
+   Поэтому для каждой страницы считается число заблокированных участков, и ОС вызывается только при переходе 0 <-> 1.
+   */
+class PageLocks {
+public:
+
+    void lock(void *ptr, size_t size) {
+        std::lock_guard<std::mutex> lock(mut);
+        forEachPage(ptr, size, [](size_t &count) {
+            return count++ == 0;
+        }, [](void *page, size_t size) {
+#ifdef _WIN32
+            VirtualLock(page, size);
+#else
+            mlock(page, size);
+#endif
+        });
+    }
+
+    void unlock(void *ptr, size_t size) {
+        std::lock_guard<std::mutex> lock(mut);
+        forEachPage(ptr, size, [](size_t &count) {
+            return count != 0 && --count == 0;
+        }, [](void *page, size_t size) {
+#ifdef _WIN32
+            VirtualUnlock(page, size);
+#else
+            munlock(page, size);
+#endif
+        });
+    }
+
+private:
+
+    // change меняет счетчик страницы и возвращает true, если ОС нужно вызвать для этой страницы. Соседние такие страницы передаются в osCall одним куском
+    template<typename Change, typename OsCall>
+    void forEachPage(void *ptr, size_t size, const Change &change, const OsCall &osCall) {
+        const uintptr_t begin = reinterpret_cast<uintptr_t>(ptr) / page * page;
+        const uintptr_t end = reinterpret_cast<uintptr_t>(ptr) + size;
+        uintptr_t runBegin = 0;
+        size_t runSize = 0;
+        for (uintptr_t p = begin; p < end; p += page) {
+            size_t &count = counts[p];
+            const bool isCall = change(count);
+            if (count == 0) {
+                counts.erase(p);
+            }
+            if (isCall && runSize != 0 && runBegin + runSize == p) {
+                runSize += page;
+            } else if (isCall) {
+                if (runSize != 0) {
+                    osCall(reinterpret_cast<void*>(runBegin), runSize);
+                }
+                runBegin = p;
+                runSize = page;
+            }
+        }
+        if (runSize != 0) {
+            osCall(reinterpret_cast<void*>(runBegin), runSize);
+        }
+    }
+
+private:
+
+    const size_t page = pageSize();
+
+    std::mutex mut;
+
+    std::map<uintptr_t, size_t> counts;
+
+};
+
+static PageLocks& pageLocks() {
+    static PageLocks locks;
+    return locks;
+}
+
+void lockMemory(void *ptr, size_t size) {
+    if (ptr == nullptr || size == 0) {
+        return;
+    }
+    pageLocks().lock(ptr, size);
+}
+
+void unlockMemory(void *ptr, size_t size) {
+    if (ptr == nullptr || size == 0) {
+        return;
+    }
+    pageLocks().unlock(ptr, size);
+}
+
+void secureZeroMemory(void *ptr, size_t size) {
+    volatile unsigned char *p = static_cast<volatile unsigned char*>(ptr);
+    while (size--) {
+        *p++ = 0;
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef LOCKED_MEMORY_H_
+#define LOCKED_MEMORY_H_
+
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Запрещает выгрузку страниц в swap. Если ОС отказала (лимит RLIMIT_MEMLOCK), память остается обычной
+void lockMemory(void *ptr, size_t size);
+
+void unlockMemory(void *ptr, size_t size);
+
+// Обнуление, которое компилятор не выбросит как мертвую запись
+void secureZeroMemory(void *ptr, size_t size);
+
+// Аллокатор для приватных ключей: память закреплена в RAM и обнуляется перед освобождением
+template<typename T>
+struct LockedAllocator {
+    using value_type = T;
+
+    LockedAllocator() = default;
+
+    template<typename U>
+    LockedAllocator(const LockedAllocator<U> &/*other*/) {}
+
+    T* allocate(size_t n) {
+        T *ptr = std::allocator<T>().allocate(n);
+        lockMemory(ptr, n * sizeof(T));
+        return ptr;
+    }
+
+    void deallocate(T *ptr, size_t n) {
+        secureZeroMemory(ptr, n * sizeof(T));
+        unlockMemory(ptr, n * sizeof(T));
+        std::allocator<T>().deallocate(ptr, n);
+    }
+};
+
+template<typename T, typename U>
+bool operator==(const LockedAllocator<T> &/*first*/, const LockedAllocator<U> &/*second*/) {
+    return true;
+}
+
+template<typename T, typename U>
+bool operator!=(const LockedAllocator<T> &/*first*/, const LockedAllocator<U> &/*second*/) {
+    return false;
+}
+
+using SecureBytes = std::vector<uint8_t, LockedAllocator<uint8_t>>;
+
+#endif // LOCKED_MEMORY_H_
@@ -6,3 +6,4 @@ SUBDIRS += tst_qrcoder
 SUBDIRS += tst_messengerdbstorage
 SUBDIRS += tst_transactionsdbstorage
 SUBDIRS += tst_walletnamesdbstorage
+SUBDIRS += tst_jsonwriter
@@ -0,0 +1,78 @@
+#include "tst_jsonwriter.h"
+
+#include <QTest>
+#include <QJsonDocument>
+#include <QJsonArray>
+
+#include "qt_utilites/JsonWriter.h"
+#include "qt_utilites/makeJsFunc.h"
+
+tst_JsonWriter::tst_JsonWriter(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void tst_JsonWriter::testJsonWriterLineSeparators_data()
+{
+    QTest::addColumn<QByteArray>("utf8");
+    QTest::addColumn<QByteArray>("json");
+    QTest::newRow("JsonWriterLineSeparators 01") << QByteArray("abc") << QByteArray("[\"abc\"]");
+    QTest::newRow("JsonWriterLineSeparators 02") << QByteArray("a\xE2\x80\xA8" "b") << QByteArray("[\"a\\u2028b\"]");
+    QTest::newRow("JsonWriterLineSeparators 03") << QByteArray("\xE2\x80\xA9") << QByteArray("[\"\\u2029\"]");
+    QTest::newRow("JsonWriterLineSeparators 04") << QByteArray("\xE2\x80\xA6\"") << QByteArray("[\"\xE2\x80\xA6\\\"\"]");
+    QTest::newRow("JsonWriterLineSeparators 05") << QByteArray("\xE2\x80") << QByteArray("[\"\xE2\x80\"]");
+}
+
+void tst_JsonWriter::testJsonWriterLineSeparators()
+{
+    QFETCH(QByteArray, utf8);
+    QFETCH(QByteArray, json);
+
+    JsonWriter fromBytes;
+    fromBytes.beginArray();
+    fromBytes.value(utf8);
+    fromBytes.endArray();
+    QCOMPARE(fromBytes.result().json, json);
+
+    JsonWriter fromChars;
+    fromChars.beginArray();
+    fromChars.value(utf8.constData());
+    fromChars.endArray();
+    QCOMPARE(fromChars.result().json, json);
+
+    // Строка из QString и из utf8 должна давать одинаковый json
+    const QString str = QString::fromUtf8(utf8);
+    if (str.toUtf8() == utf8) {
+        JsonWriter fromString;
+        fromString.beginArray();
+        fromString.value(str);
+        fromString.endArray();
+        QCOMPARE(fromString.result().json, json);
+        QCOMPARE(QJsonDocument::fromJson(json).array().at(0).toString(), str);
+    }
+}
+
+void tst_JsonWriter::testJsStringLineSeparators_data()
+{
+    QTest::addColumn<QString>("value");
+    QTest::addColumn<QString>("literal");
+    QTest::newRow("JsStringLineSeparators 01") << QString("abc") << QString("\"abc\"");
+    QTest::newRow("JsStringLineSeparators 02") << (QString("a") + QChar(0x2028) + "b") << QString("\"a\\u2028b\"");
+    QTest::newRow("JsStringLineSeparators 03") << (QString("\"") + QChar(0x2029)) << QString("\"\\\"\\u2029\"");
+}
+
+void tst_JsonWriter::testJsStringLineSeparators()
+{
+    QFETCH(QString, value);
+    QFETCH(QString, literal);
+
+    QCOMPARE(toJsString(value), literal);
+
+    // Готовый json вставляется в скрипт строкой без U+2028 и U+2029
+    const QString jsonLiteral = toJsString(JsonString{QJsonDocument(QJsonArray{value}).toJson(QJsonDocument::Compact)});
+    QVERIFY(!jsonLiteral.contains(QChar(0x2028)));
+    QVERIFY(!jsonLiteral.contains(QChar(0x2029)));
+    QCOMPARE(jsonLiteral, toJsString(QJsonDocument(QJsonArray{value})));
+}
+
+QTEST_MAIN(tst_JsonWriter)
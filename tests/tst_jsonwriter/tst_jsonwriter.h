@@ -0,0 +1,21 @@
+#ifndef TST_JSONWRITER_H
+#define TST_JSONWRITER_H
+
+#include <QObject>
+
+class tst_JsonWriter : public QObject
+{
+    Q_OBJECT
+public:
+    explicit tst_JsonWriter(QObject *parent = nullptr);
+
+private slots:
+
+    void testJsonWriterLineSeparators_data();
+    void testJsonWriterLineSeparators();
+
+    void testJsStringLineSeparators_data();
+    void testJsStringLineSeparators();
+};
+
+#endif // TST_JSONWRITER_H
@@ -0,0 +1,25 @@
+QT       += testlib
+QT       -= gui
+TARGET = tst_jsonwriter
+CONFIG   += testcase
+CONFIG += c++14
+CONFIG += static
+
+TEMPLATE = app
+
+INCLUDEPATH = ../../src ../../src/qt_utilites
+
+SOURCES += \
+    tst_jsonwriter.cpp \
+    ../LogMock.cpp \
+    ../../src/qt_utilites/JsonWriter.cpp
+
+HEADERS += \
+    tst_jsonwriter.h \
+    ../../src/qt_utilites/JsonWriter.h \
+    ../../src/qt_utilites/makeJsFunc.h
+
+QMAKE_LFLAGS += -rdynamic
+unix:!macx: include(../../libs-unix.pri)
+win32: include(../../libs-win.pri)
+macx: include(../../libs-macos.pri)
@@ -1,13 +1,18 @@
 #include "tst_messengerdbstorage.h"
 
 #include <QTest>
+#include <QtSql>
+#include <QRegularExpression>
 
 #include <iostream>
+#include <set>
 
 #include "check.h"
 
 #include "MessengerDBStorage.h"
 #include "MessengerDBRes.h"
+#include "Message.h"
+#include "GapTracker.h"
 
 tst_MessengerDBStorage::tst_MessengerDBStorage(QObject *parent)
     : QObject(parent)
@@ -329,4 +334,278 @@ void tst_MessengerDBStorage::testMessengerDecryptedText()
     }
 }
 
+static messenger::Message makeMessage(bool isInput, const QString &collocutor, messenger::Message::Counter counter, const QString &hash)
+{
+    messenger::Message m;
+    m.username = "1234";
+    m.collocutor = collocutor;
+    m.isInput = isInput;
+    m.timestamp = 1;
+    m.dataHex = "abcd";
+    m.hash = hash;
+    m.counter = counter;
+    m.fee = 1;
+    return m;
+}
+
+void tst_MessengerDBStorage::testMessengerIngestMessages()
+{
+    if (QFile::exists(messenger::databaseFileName))
+        QFile::remove(messenger::databaseFileName);
+    messenger::MessengerDBStorage db;
+    db.init();
+
+    db.setUserPublicKey("1234", "23424", "2345342", "", "");
+    db.addMessage("1234", "3454", "abcd", "", false, 1, 10, false, true, false, "h1", 1);
+    db.addMessage("1234", "3454", "abcd", "", false, 1, 20, false, true, false, "h3", 1);
+
+    {
+        const std::vector<messenger::Message> batch = {
+            makeMessage(true, "3454", 1, "i1"),
+            makeMessage(true, "777", 2, "i2"),
+            makeMessage(false, "3454", 3, "h1"),
+            makeMessage(false, "3454", 4, "h2"),
+            makeMessage(false, "3454", 5, "h2")
+        };
+        const std::vector<messenger::Message::Counter> missed = db.ingestMessages("1234", "", batch);
+        QCOMPARE(missed.size(), 1);
+        QCOMPARE(missed[0], 10);
+    }
+
+    QCOMPARE(db.hasMessageWithCounter("1234", 3), true);
+    QCOMPARE(db.hasMessageWithCounter("1234", 4), true);
+    QCOMPARE(db.hasMessageWithCounter("1234", 5), false);
+    QCOMPARE(db.hasMessageWithCounter("1234", 10), false);
+    QCOMPARE(db.hasUnconfirmedMessageWithHash("1234", "h1"), false);
+    QCOMPARE(db.hasUnconfirmedMessageWithHash("1234", "h3"), true);
+    QCOMPARE(db.getLastReadCounterForUserContact("1234", "777"), -1);
+    QCOMPARE(db.getMessagesForUserAndDestNum("1234", "777", 100, 20).size(), 1);
+
+    {
+        // Старый счетчик занят входящим сообщением из той же пачки
+        const std::vector<messenger::Message> batch = {
+            makeMessage(true, "777", 20, "i3"),
+            makeMessage(false, "3454", 21, "h3")
+        };
+        const std::vector<messenger::Message::Counter> missed = db.ingestMessages("1234", "", batch);
+        QCOMPARE(missed.size(), 0);
+    }
+
+    QCOMPARE(db.hasUnconfirmedMessageWithHash("1234", "h3"), false);
+    QCOMPARE(db.getMessageMaxConfirmedCounter("1234"), 21);
+}
+
+void tst_MessengerDBStorage::testMessengerSearchMessages()
+{
+    if (QFile::exists(messenger::databaseFileName))
+        QFile::remove(messenger::databaseFileName);
+    messenger::MessengerDBStorage db;
+    db.init();
+
+    const auto toHex = [](const QString &text) {
+        return QString(text.toUtf8().toHex());
+    };
+
+    db.setUserPublicKey("1234", "23424", "2345342", "", "");
+    db.setUserPublicKey("5678", "23424", "2345342", "", "");
+    DBStorage::DbId id1 = db.getUserId("1234");
+    db.addChannel(id1, "channel1", "ch1", true, "ktkt", false, true, true);
+    db.addMessage("1234", "3454", "aa", toHex("Привет, как дела?"), true, 1, 1, true, true, true, "h1", 1);
+    db.addMessage("1234", "3454", "bb", toHex("hello world"), true, 1, 2, false, true, true, "h2", 1);
+    db.addMessage("1234", "", "cc", toHex("Hello from channel"), true, 1, 3, true, true, true, "h3", 1, "ch1");
+    db.addMessage("1234", "3454", "dd", "", false, 1, 4, true, true, true, "h4", 1);
+    db.addMessage("5678", "3454", "ee", toHex("hello other user"), true, 1, 1, true, true, true, "h5", 1);
+
+    {
+        std::vector<messenger::Message> r = db.searchMessages("1234", "привет", 0, 10);
+        QCOMPARE(r.size(), 1);
+        QCOMPARE(r[0].counter, 1);
+        QCOMPARE(r[0].collocutor, QStringLiteral("3454"));
+        QCOMPARE(r[0].isChannel, false);
+    }
+
+    {
+        std::vector<messenger::Message> r = db.searchMessages("1234", "HEL", 0, 10);
+        QCOMPARE(r.size(), 2);
+        std::set<messenger::Message::Counter> counters{r[0].counter, r[1].counter};
+        QCOMPARE(counters, (std::set<messenger::Message::Counter>{2, 3}));
+        for (const messenger::Message &m: r) {
+            if (m.counter == 3) {
+                QCOMPARE(m.isChannel, true);
+                QCOMPARE(m.channel, QStringLiteral("ch1"));
+            }
+        }
+    }
+
+    QCOMPARE(db.searchMessages("1234", "hello channel", 0, 10).size(), 1);
+    QCOMPARE(db.searchMessages("1234", "hello (x AND", 0, 10).size(), 0);
+    QCOMPARE(db.searchMessages("1234", "hello", 1, 10).size(), 1);
+    QCOMPARE(db.searchMessages("1234", "hello", 0, 1).size(), 1);
+    QCOMPARE(db.searchMessages("1234", "   ", 0, 10).size(), 0);
+
+    // Расшифровка после сохранения и сброс расшифровки
+    const auto notDecrypted = db.getNotDecryptedMessage("1234");
+    QCOMPARE(notDecrypted.first.size(), 1);
+    db.updateDecryptedMessage({std::make_tuple(notDecrypted.first[0], true, toHex("late world"))});
+    QCOMPARE(db.searchMessages("1234", "world", 0, 10).size(), 2);
+    db.updateDecryptedMessage({std::make_tuple(notDecrypted.first[0], false, QString())});
+    QCOMPARE(db.searchMessages("1234", "world", 0, 10).size(), 1);
+
+    db.removeDecryptedData();
+    QCOMPARE(db.searchMessages("1234", "hello", 0, 10).size(), 0);
+    QCOMPARE(db.searchMessages("5678", "hello", 0, 10).size(), 0);
+}
+
+// План запроса одной строкой. Параметры не важны для выбора индекса, поэтому все заполняются нулями
+static QString queryPlan(const QSqlDatabase &db, const QString &sql) {
+    QSqlQuery query(db);
+    CHECK(query.prepare("EXPLAIN QUERY PLAN " + sql), query.lastError().text().toStdString());
+    QRegularExpressionMatchIterator it = QRegularExpression(":\\w+").globalMatch(sql);
+    while (it.hasNext()) {
+        query.bindValue(it.next().captured(), 0);
+    }
+    CHECK(query.exec(), query.lastError().text().toStdString());
+    QStringList plan;
+    while (query.next()) {
+        plan.append(query.value("detail").toString());
+    }
+    return plan.join("; ");
+}
+
+void tst_MessengerDBStorage::testMessengerQueryPlans()
+{
+    if (QFile::exists(messenger::databaseFileName))
+        QFile::remove(messenger::databaseFileName);
+    {
+        messenger::MessengerDBStorage db;
+        db.init();
+    }
+
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "plans");
+    db.setDatabaseName(messenger::databaseFileName);
+    QVERIFY(db.open());
+
+    const std::vector<std::pair<QString, QString>> queries = {
+        {messenger::selectFirstNotConfirmedMessageWithHash.arg(messenger::selectWhereIsNotChannel), "messagesHashIdx"},
+        {messenger::selectFirstNotConfirmedMessageWithHash.arg(messenger::selectWhereChannel), "messagesHashIdx"},
+        {messenger::selectFirstMessageWithHash.arg(messenger::selectWhereIsNotChannel), "messagesHashIdx"},
+        {messenger::selectFirstMessageWithHash.arg(messenger::selectWhereChannel), "messagesHashIdx"},
+        {messenger::selectCountNotConfirmedMessagesWithHash, "messagesHashIdx"},
+        {messenger::selectMessagesWithHashes.arg(messenger::selectWhereIsNotChannel).arg(":v0, :v1"), "messagesHashIdx"},
+        {messenger::selectMsgMaxCounter.arg(messenger::selectWhereIsNotChannel), "messagesUniqueIdx2"},
+        {messenger::selectMsgMaxCounter.arg(messenger::selectWhereChannel), "messagesUniqueIdx2"},
+        {messenger::selectCountMessagesWithCounter.arg(messenger::selectWhereChannel), "messagesUniqueIdx2"},
+        {messenger::selectMsgMaxConfirmedCounter.arg(messenger::selectWhereIsNotChannel), "messagesConfirmedCounterIdx (userid=? AND channelid=? AND isConfirmed=?)"},
+        {messenger::selectMsgMaxConfirmedCounter.arg(messenger::selectWhereChannel), "messagesConfirmedCounterIdx (userid=? AND channelid=? AND isConfirmed=?)"},
+        {messenger::selectFirstNotConfirmedMessage.arg(messenger::selectWhereIsNotChannel), "messagesConfirmedCounterIdx (userid=? AND channelid=? AND isConfirmed=?)"},
+        {messenger::selectFirstNotConfirmedMessage.arg(messenger::selectWhereChannel), "messagesConfirmedCounterIdx (userid=? AND channelid=? AND isConfirmed=?)"},
+    };
+    const QRegularExpression scanMessages("SCAN (TABLE messages|m\\b)");
+    for (const auto &pair: queries) {
+        const QString plan = queryPlan(db, pair.first);
+        QVERIFY2(plan.contains(pair.second), (pair.first + " -> " + plan).toStdString().c_str());
+        QVERIFY2(!plan.contains(scanMessages), (pair.first + " -> " + plan).toStdString().c_str());
+    }
+
+    db.close();
+    db = QSqlDatabase();
+    QSqlDatabase::removeDatabase("plans");
+}
+
+using GapRanges = std::vector<messenger::GapTracker::Range>;
+
+void tst_MessengerDBStorage::testGapTrackerOverlap()
+{
+    using namespace messenger;
+    const GapTracker::Key key("user", "");
+    const time_point time = ::now();
+    GapTracker gaps(100, 10s, 3);
+
+    QVERIFY(gaps.add(key, 0, 49) == GapRanges({{0, 49}}));
+    gaps.sent(key, {0, 49}, 1, 1, time);
+    // Запрашивается только непокрытая часть
+    QVERIFY(gaps.add(key, 20, 79) == GapRanges({{50, 79}}));
+    QVERIFY(gaps.add(key, 10, 30).empty());
+    QVERIFY(gaps.add(key, 40, GapTracker::END) == GapRanges({{50, GapTracker::END}}));
+    // Другой ключ не пересекается
+    QVERIFY(gaps.add(GapTracker::Key("user", "channel"), 0, 49) == GapRanges({{0, 49}}));
+}
+
+void tst_MessengerDBStorage::testGapTrackerAdjacent()
+{
+    using namespace messenger;
+    const GapTracker::Key key("user", "");
+    const time_point time = ::now();
+    GapTracker gaps(100, 10s, 3);
+
+    gaps.sent(key, {0, 9}, 1, 1, time);
+    gaps.sent(key, {10, 19}, 2, 2, time);
+    QVERIFY(gaps.add(key, 0, 19).empty());
+
+    QVERIFY(gaps.takeExpired(time + 5s).empty());
+    // Соседние куски склеиваются в один перезапрос
+    const std::vector<GapTracker::Gap> expired = gaps.takeExpired(time + 10s);
+    QCOMPARE(expired.size(), size_t(1));
+    QVERIFY(expired[0].range == GapTracker::Range(0, 19));
+    QCOMPARE(expired[0].attempt, 2);
+    QVERIFY(gaps.add(key, 0, 19) == GapRanges({{0, 19}}));
+}
+
+void tst_MessengerDBStorage::testGapTrackerSplit()
+{
+    using namespace messenger;
+    const GapTracker::Key key("user", "");
+    const time_point time = ::now();
+    GapTracker gaps(10, 10s, 3);
+
+    QVERIFY(gaps.add(key, 0, 24) == GapRanges({{0, 9}, {10, 19}, {20, 24}}));
+    gaps.sent(key, {0, 24}, 1, 1, time);
+    // Полученные сообщения разрезают диапазон
+    gaps.received(key, {10, 11});
+    QVERIFY(gaps.add(key, 0, 30) == GapRanges({{10, 11}, {25, 30}}));
+}
+
+void tst_MessengerDBStorage::testGapTrackerDoneTail()
+{
+    using namespace messenger;
+    const GapTracker::Key key("user", "");
+    const time_point time = ::now();
+    GapTracker gaps(100, 10s, 3);
+
+    gaps.sent(key, {0, 99}, 1, 2, time);
+    gaps.received(key, {0, 1, 2, 3, 4, 6, 7, 8, 9});
+    // Хвост после последнего полученного перезапрашивается с той же попыткой
+    const std::vector<GapTracker::Gap> tail = gaps.done(1, 9, false);
+    QCOMPARE(tail.size(), size_t(1));
+    QVERIFY(tail[0].key == key);
+    QVERIFY(tail[0].range == GapTracker::Range(10, 99));
+    QCOMPARE(tail[0].attempt, 2);
+    QVERIFY(gaps.add(key, 0, 99) == GapRanges({{0, 99}}));
+
+    // Сервер сообщил о конце, хвост не нужен
+    gaps.sent(key, {20, GapTracker::END}, 2, 1, time);
+    QVERIFY(gaps.done(2, -1, true).empty());
+    QVERIFY(gaps.add(key, 20, 30) == GapRanges({{20, 30}}));
+    QVERIFY(gaps.done(3, 10, false).empty());
+}
+
+void tst_MessengerDBStorage::testGapTrackerReconnect()
+{
+    using namespace messenger;
+    const GapTracker::Key key("user", "");
+    const time_point time = ::now();
+    GapTracker gaps(100, 10s, 3);
+
+    gaps.sent(key, {0, 49}, 1, 1, time);
+    gaps.sent(key, {50, GapTracker::END}, 2, 1, time);
+    // После переподключения все незакрытые запросы отдаются на перезапрос
+    const std::vector<GapTracker::Gap> all = gaps.takeAll();
+    QCOMPARE(all.size(), size_t(1));
+    QVERIFY(all[0].range == GapTracker::Range(0, GapTracker::END));
+    QVERIFY(gaps.takeAll().empty());
+    // Ответ на старый запрос уже ничего не трогает
+    QVERIFY(gaps.done(1, 10, false).empty());
+    QVERIFY(gaps.add(key, 0, 49) == GapRanges({{0, 49}}));
+}
+
 QTEST_MAIN(tst_MessengerDBStorage)
@@ -17,6 +17,15 @@ private slots:
     void testMessengerDBChannels();
     void testMessengerDBSpeed();
     void testMessengerDecryptedText();
+    void testMessengerIngestMessages();
+    void testMessengerSearchMessages();
+    void testMessengerQueryPlans();
+
+    void testGapTrackerOverlap();
+    void testGapTrackerAdjacent();
+    void testGapTrackerSplit();
+    void testGapTrackerDoneTail();
+    void testGapTrackerReconnect();
 };
 
 #endif // TST_MESSENGERDBSTORAGE_H
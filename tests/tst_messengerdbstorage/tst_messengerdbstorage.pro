@@ -14,13 +14,15 @@ SOURCES += \
     tst_messengerdbstorage.cpp \
     ../../src/dbstorage.cpp \
     ../LogMock.cpp \
-    ../../src/Messenger/MessengerDBStorage.cpp
+    ../../src/Messenger/MessengerDBStorage.cpp \
+    ../../src/Messenger/GapTracker.cpp
 
 
 HEADERS += \
     tst_messengerdbstorage.h \
     ../../src/dbstorage.h \
-    ../../src/Messenger/MessengerDBStorage.h
+    ../../src/Messenger/MessengerDBStorage.h \
+    ../../src/Messenger/GapTracker.h
 
 QMAKE_LFLAGS += -rdynamic
 unix:!macx: include(../../libs-unix.pri)
@@ -0,0 +1,91 @@
+#include "tst_DecryptPool.h"
+
+#include <QTest>
+
+#include <condition_variable>
+#include <mutex>
+
+#include "Wallets/openssl_wrapper/openssl_wrapper.h"
+#include "Messenger/DecryptPool.h"
+
+using namespace messenger;
+
+Q_DECLARE_METATYPE(std::string)
+
+tst_DecryptPool::tst_DecryptPool(QObject *parent)
+    : QObject(parent)
+{
+    if (!isInitOpenSSL()) {
+        InitOpenSSL();
+    }
+}
+
+void tst_DecryptPool::testParallelDecryptSharedKey_data() {
+    QTest::addColumn<std::string>("password");
+    QTest::addColumn<int>("countThreads");
+    QTest::addColumn<int>("countMessages");
+
+    QTest::newRow("DecryptPool 1")
+        << std::string("Password 1")
+        << 1
+        << 20;
+    QTest::newRow("DecryptPool 2")
+        << std::string("Password 1")
+        << 8
+        << 200;
+    QTest::newRow("DecryptPool 3")
+        << std::string("")
+        << 8
+        << 3;
+}
+
+void tst_DecryptPool::testParallelDecryptSharedKey() {
+    QFETCH(std::string, password);
+    QFETCH(int, countThreads);
+    QFETCH(int, countMessages);
+
+    const std::string privateKey = createRsaKey(password);
+    const std::string publicKey = getPublic(privateKey, password);
+    const RsaKey publicKeyRsa = getPublicRsa(publicKey);
+    // Один ключ на все потоки пула, как в CryptographicManager
+    const RsaKey privateKeyRsa = getPrivateRsa(privateKey, password);
+
+    std::vector<std::string> encrypted;
+    for (int i = 0; i < countMessages; i++) {
+        encrypted.emplace_back(encrypt(publicKeyRsa, "Message " + std::to_string(i), publicKey));
+    }
+
+    std::vector<std::string> sequential;
+    for (const std::string &e: encrypted) {
+        sequential.emplace_back(decrypt(privateKeyRsa, e, publicKey));
+    }
+
+    std::vector<std::string> parallel(encrypted.size());
+    std::mutex mut;
+    std::condition_variable cond;
+    bool isFinished = false;
+    std::exception_ptr error;
+    {
+        DecryptPool pool(countThreads);
+        const auto job = std::make_shared<DecryptPool::Job>(encrypted.size(), nullptr, [&](size_t index) {
+            parallel[index] = decrypt(privateKeyRsa, encrypted[index], publicKey);
+        }, [&](const DecryptPool::Job &j) {
+            std::lock_guard<std::mutex> lock(mut);
+            error = j.error();
+            isFinished = true;
+            cond.notify_all();
+        });
+        pool.run(job);
+
+        std::unique_lock<std::mutex> lock(mut);
+        cond.wait(lock, [&isFinished]{
+            return isFinished;
+        });
+    }
+
+    QVERIFY(error == nullptr);
+    QCOMPARE(parallel, sequential);
+    for (int i = 0; i < countMessages; i++) {
+        QCOMPARE(parallel[i], "Message " + std::to_string(i));
+    }
+}
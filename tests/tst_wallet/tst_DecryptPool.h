@@ -0,0 +1,19 @@
+#ifndef TST_DECRYPTPOOL_H
+#define TST_DECRYPTPOOL_H
+
+#include <QObject>
+
+class tst_DecryptPool : public QObject
+{
+    Q_OBJECT
+public:
+    explicit tst_DecryptPool(QObject *parent = nullptr);
+
+private slots:
+
+    void testParallelDecryptSharedKey_data();
+    void testParallelDecryptSharedKey();
+
+};
+
+#endif // TST_DECRYPTPOOL_H
@@ -0,0 +1,93 @@
+#include "tst_KeysImporter.h"
+
+#include <QTest>
+
+#include <future>
+#include <tuple>
+
+#include "check.h"
+#include "utilites/utils.h"
+
+#include "Wallets/KeysImporter.h"
+
+using namespace wallets;
+
+static const QString FOLDER = "./import";
+
+static const int COUNT_FILES = 300;
+
+tst_KeysImporter::tst_KeysImporter(QObject *parent)
+    : QObject(parent)
+{}
+
+static QString prepareFolder() {
+    removeFolder(FOLDER);
+    const QString source = makePath(FOLDER, "source");
+    createFolder(source);
+    createFolder(makePath(FOLDER, "target"));
+    for (int i = 0; i < COUNT_FILES; i++) {
+        const QString name = (i % 3 == 0 ? "readme_" : "key_") + QString::number(i);
+        writeToFile(makePath(source, name), name.toStdString(), false);
+    }
+    return source;
+}
+
+static bool isKey(const QString &filePath) {
+    return getFileName(filePath).startsWith("key_");
+}
+
+void tst_KeysImporter::testParallelImportMatchesSerial() {
+    const QString source = prepareFolder();
+    const QString target = makePath(FOLDER, "target");
+
+    std::vector<QString> expected;
+    const KeysImporter::Summary expectedSummary = KeysImporter::runSerial(source, isKey, [](const QString &filePath) {
+        return getFileName(filePath);
+    }, expected);
+    QCOMPARE(expectedSummary.countFiles, size_t(COUNT_FILES));
+    QCOMPARE(expectedSummary.countKeys, expected.size());
+
+    KeysImporter importer(4, 16);
+    // Вызывается под мьютексом задачи, поэтому пишется без своей синхронизации
+    std::vector<std::pair<size_t, size_t>> progress;
+    std::promise<std::tuple<KeysImporter::Summary, std::vector<QString>, std::exception_ptr>> promise;
+    importer.run(source, isKey, [target](const QString &filePath) {
+        copyToDirectoryFile(filePath, target, true);
+        return getFileName(filePath);
+    }, [&progress](size_t processed, size_t total) {
+        progress.emplace_back(processed, total);
+    }, [&promise](const KeysImporter::Summary &summary, const std::vector<QString> &keys, const std::exception_ptr &error) {
+        promise.set_value(std::make_tuple(summary, keys, error));
+    });
+    const auto result = promise.get_future().get();
+
+    QVERIFY(std::get<2>(result) == nullptr);
+    QCOMPARE(std::get<0>(result).countFiles, expectedSummary.countFiles);
+    QCOMPARE(std::get<0>(result).countKeys, expectedSummary.countKeys);
+    QVERIFY(std::get<1>(result) == expected);
+    QVERIFY(!progress.empty());
+    for (size_t i = 1; i < progress.size(); i++) {
+        QVERIFY(progress[i].first > progress[i - 1].first);
+    }
+    QVERIFY(progress.back() == std::make_pair(size_t(COUNT_FILES), size_t(COUNT_FILES)));
+    QCOMPARE(static_cast<size_t>(getFilesForDir(target).size()), expected.size());
+}
+
+void tst_KeysImporter::testImportError() {
+    const QString source = prepareFolder();
+
+    KeysImporter importer(4, 16);
+    std::promise<std::tuple<KeysImporter::Summary, std::vector<QString>, std::exception_ptr>> promise;
+    importer.run(source, isKey, [](const QString &filePath) {
+        CHECK(getFileName(filePath) != "key_100", "Import error");
+        return getFileName(filePath);
+    }, [](size_t /*processed*/, size_t /*total*/) {
+    }, [&promise](const KeysImporter::Summary &summary, const std::vector<QString> &keys, const std::exception_ptr &error) {
+        promise.set_value(std::make_tuple(summary, keys, error));
+    });
+    const auto result = promise.get_future().get();
+
+    QVERIFY(std::get<2>(result) != nullptr);
+    QCOMPARE(std::get<0>(result).countKeys, size_t(0));
+    QVERIFY(std::get<1>(result).empty());
+}
@@ -0,0 +1,20 @@
+#ifndef TST_KEYSIMPORTER_H
+#define TST_KEYSIMPORTER_H
+
+#include <QObject>
+
+class tst_KeysImporter : public QObject
+{
+    Q_OBJECT
+public:
+    explicit tst_KeysImporter(QObject *parent = nullptr);
+
+private slots:
+
+    void testParallelImportMatchesSerial();
+
+    void testImportError();
+
+};
+
+#endif // TST_KEYSIMPORTER_H
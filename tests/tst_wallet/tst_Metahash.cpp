@@ -147,6 +147,11 @@ void tst_Metahash::testCreateFromRawMth() {
     Wallet wallet("./", true, address, passwd);
     const std::string rawPrivate = wallet.getNotProtectedKeyHex();
     QCOMPARE(rawkey, rawPrivate);
+
+    std::string pubkey;
+    const std::string signature = wallet.sign("message", pubkey);
+    QCOMPARE(toLower(pubkey.substr(pubkey.size() - 130)), rawkey.substr(rawkey.size() - 130));
+    QCOMPARE(Wallet::verify("message", signature, pubkey), true);
 }
 
 void tst_Metahash::testCreateRawMth_data() {
@@ -252,6 +257,24 @@ void tst_Metahash::testHashMth() {
     QCOMPARE(result, answer);
 }
 
+void tst_Metahash::testMthVerify_data() {
+    testHashMth_data();
+}
+
+void tst_Metahash::testMthVerify() {
+    QFETCH(std::string, transaction);
+    QFETCH(std::string, sign);
+    QFETCH(std::string, pubkey);
+
+    const std::string message = fromHex(transaction);
+    QCOMPARE(Wallet::verify(message, sign, pubkey), true);
+    QCOMPARE(Wallet::verify(message, sign, QString::fromStdString(pubkey).toUpper().toStdString()), true);
+
+    std::string changed = message;
+    changed[changed.size() - 1] ^= 1;
+    QCOMPARE(Wallet::verify(changed, sign, pubkey), false);
+}
+
 void tst_Metahash::testCreateV8Address_data() {
     QTest::addColumn<std::string>("address");
     QTest::addColumn<int>("nonce");
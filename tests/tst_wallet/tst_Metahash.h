@@ -34,6 +34,9 @@ private slots:
     void testHashMth_data();
     void testHashMth();
 
+    void testMthVerify_data();
+    void testMthVerify();
+
     void testCreateV8Address_data();
     void testCreateV8Address();
 
@@ -0,0 +1,78 @@
+#include "tst_WalletsCatalogue.h"
+
+#include <QTest>
+
+#include "utilites/utils.h"
+
+#include "Wallets/Wallet.h"
+#include "Wallets/WalletsCatalogue.h"
+
+using namespace wallets;
+
+static const QString FOLDER = "./catalogue";
+
+static const std::string ADDRESS_1 = "0x00033d0f17a49eef544fb841e5624bad2be1e27ca383381df3";
+static const std::string ADDRESS_2 = "0x00667db9f744c760b558eb8f1cf0712f615bc67818d61b617a";
+
+tst_WalletsCatalogue::tst_WalletsCatalogue(QObject *parent)
+    : QObject(parent)
+{}
+
+static void prepareFolder() {
+    removeFolder(FOLDER);
+    createFolder(makePath(FOLDER, Wallet::chooseSubfolder(true)));
+    writeToFile(makePath(FOLDER, Wallet::chooseSubfolder(true), "readme.txt"), "not a key", false);
+}
+
+void tst_WalletsCatalogue::testCatalogueFollowsFolder() {
+    prepareFolder();
+    const QString dir = makePath(FOLDER, Wallet::chooseSubfolder(true));
+    WalletsCatalogue catalogue("");
+
+    QCOMPARE(catalogue.getWallets(FOLDER, WalletCurrency::Mth).size(), size_t(0));
+
+    Wallet::createWalletWatch(FOLDER, true, ADDRESS_1);
+    catalogue.invalidate(dir);
+    std::vector<WalletInfo> result = catalogue.getWallets(FOLDER, WalletCurrency::Mth);
+    QCOMPARE(result.size(), size_t(1));
+    QCOMPARE(result[0].address.toStdString(), ADDRESS_1);
+    QCOMPARE(result[0].type, WalletInfo::Type::Watch);
+
+    Wallet::createWalletWatch(FOLDER, true, ADDRESS_2);
+    catalogue.invalidate(dir);
+    QCOMPARE(catalogue.getWallets(FOLDER, WalletCurrency::Mth).size(), size_t(2));
+
+    Wallet::removeWalletWatch(FOLDER, true, ADDRESS_1);
+    catalogue.invalidate(dir);
+    result = catalogue.getWallets(FOLDER, WalletCurrency::Mth);
+    QCOMPARE(result.size(), size_t(1));
+    QCOMPARE(result[0].address.toStdString(), ADDRESS_2);
+
+    QCOMPARE(catalogue.getWallets(FOLDER, WalletCurrency::Tmh).size(), size_t(0));
+}
+
+void tst_WalletsCatalogue::testCatalogueSaveLoad() {
+    prepareFolder();
+    const QString savePath = makePath(FOLDER, "catalogue.dat");
+    Wallet::createWalletWatch(FOLDER, true, ADDRESS_1);
+    Wallet::createWalletWatch(FOLDER, true, ADDRESS_2);
+
+    std::vector<WalletInfo> expected;
+    {
+        WalletsCatalogue catalogue(savePath);
+        expected = catalogue.getWallets(FOLDER, WalletCurrency::Mth);
+        QCOMPARE(expected.size(), size_t(2));
+    }
+    QVERIFY(isExistFile(savePath));
+
+    WalletsCatalogue catalogue(savePath);
+    const std::vector<WalletInfo> result = catalogue.getWallets(FOLDER, WalletCurrency::Mth);
+    QCOMPARE(result.size(), expected.size());
+    for (size_t i = 0; i < result.size(); i++) {
+        QCOMPARE(result[i].address, expected[i].address);
+        QCOMPARE(result[i].path, expected[i].path);
+        QCOMPARE(result[i].type, expected[i].type);
+    }
+
+    removeFolder(FOLDER);
+}
@@ -0,0 +1,20 @@
+#ifndef TST_WALLETSCATALOGUE_H
+#define TST_WALLETSCATALOGUE_H
+
+#include <QObject>
+
+class tst_WalletsCatalogue : public QObject
+{
+    Q_OBJECT
+public:
+    explicit tst_WalletsCatalogue(QObject *parent = nullptr);
+
+private slots:
+
+    void testCatalogueFollowsFolder();
+
+    void testCatalogueSaveLoad();
+
+};
+
+#endif // TST_WALLETSCATALOGUE_H
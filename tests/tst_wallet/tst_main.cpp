@@ -3,9 +3,13 @@
 #include <iostream>
 
 #include "tst_rsa.h"
+#include "tst_scrypt.h"
 #include "tst_Bitcoin.h"
 #include "tst_Ethereum.h"
 #include "tst_Metahash.h"
+#include "tst_WalletsCatalogue.h"
+#include "tst_KeysImporter.h"
+#include "tst_DecryptPool.h"
 
 int main(int argc, char *argv[]) {
     int status = 0;
@@ -19,8 +23,12 @@ int main(int argc, char *argv[]) {
 
     ASSERT_TEST(new tst_Metahash());
     ASSERT_TEST(new tst_rsa());
+    ASSERT_TEST(new tst_scrypt());
     ASSERT_TEST(new tst_Bitcoin());
     ASSERT_TEST(new tst_Ethereum());
+    ASSERT_TEST(new tst_WalletsCatalogue());
+    ASSERT_TEST(new tst_KeysImporter());
+    ASSERT_TEST(new tst_DecryptPool());
 
     return status;
 }
@@ -0,0 +1,94 @@
+#include "tst_scrypt.h"
+
+#include <QTest>
+
+#include "utilites/utils.h"
+#include "Wallets/ethtx/scrypt/crypto_scrypt-smix.h"
+
+Q_DECLARE_METATYPE(std::string)
+
+static const std::vector<libscrypt_smix_impl> IMPLS = {LIBSCRYPT_SMIX_AUTO, LIBSCRYPT_SMIX_NOSSE, LIBSCRYPT_SMIX_SSE2, LIBSCRYPT_SMIX_AVX2};
+
+static std::string scrypt(libscrypt_smix_impl impl, const std::string &password, const std::string &salt, uint64_t n, uint32_t r, uint32_t p, size_t size) {
+    std::string result(size, 0);
+    const int res = libscrypt_scrypt_impl(impl, (const uint8_t*)password.data(), password.size(), (const uint8_t*)salt.data(), salt.size(), n, r, p, (uint8_t*)&result[0], result.size());
+    if (res != 0) {
+        return "";
+    }
+    return result;
+}
+
+tst_scrypt::tst_scrypt(QObject *parent)
+    : QObject(parent)
+{}
+
+void tst_scrypt::testScrypt_data() {
+    QTest::addColumn<std::string>("password");
+    QTest::addColumn<std::string>("salt");
+    QTest::addColumn<int>("n");
+    QTest::addColumn<int>("r");
+    QTest::addColumn<int>("p");
+    QTest::addColumn<std::string>("answer");
+
+    // RFC 7914
+    QTest::newRow("Scrypt 1")
+        << std::string("")
+        << std::string("")
+        << 16 << 1 << 1
+        << std::string("77d6576238657b203b19ca42c18a0497f16b4844e3074ae8dfdffa3fede21442fcd0069ded0948f8326a753a0fc81f17e8d3e0fb2e0d3628cf35e20c38d18906");
+    QTest::newRow("Scrypt 2")
+        << std::string("password")
+        << std::string("NaCl")
+        << 1024 << 8 << 16
+        << std::string("fdbabe1c9d3472007856e7190d01e9fe7c6ad7cbc8237830e77376634b3731622eaf30d92e22a3886ff109279d9830dac727afb94a83ee6d8360cbdfa2cc0640");
+    QTest::newRow("Scrypt 3")
+        << std::string("pleaseletmein")
+        << std::string("SodiumChloride")
+        << 16384 << 8 << 1
+        << std::string("7023bdcb3afd7348461c06cd81fd38ebfda8fbba904f8e3ea9b543f6545da1f2d5432955613f0fcf62d49705242a9af9e61e85dc0d651e40dfcf017b45575887");
+}
+
+void tst_scrypt::testScrypt() {
+    QFETCH(std::string, password);
+    QFETCH(std::string, salt);
+    QFETCH(int, n);
+    QFETCH(int, r);
+    QFETCH(int, p);
+    QFETCH(std::string, answer);
+
+    for (const libscrypt_smix_impl impl: IMPLS) {
+        if (!libscrypt_smix_supported(impl)) {
+            continue;
+        }
+        QCOMPARE(toHex(scrypt(impl, password, salt, n, r, p, answer.size() / 2)), answer);
+    }
+}
+
+void tst_scrypt::testScryptImplsEqual_data() {
+    QTest::addColumn<int>("r");
+    QTest::addColumn<int>("p");
+
+    // Нечетное p проверяет расчет последнего блока без пары
+    QTest::newRow("ScryptEqual 1") << 1 << 1;
+    QTest::newRow("ScryptEqual 2") << 1 << 2;
+    QTest::newRow("ScryptEqual 3") << 2 << 3;
+    QTest::newRow("ScryptEqual 4") << 3 << 4;
+    QTest::newRow("ScryptEqual 5") << 8 << 5;
+}
+
+void tst_scrypt::testScryptImplsEqual() {
+    QFETCH(int, r);
+    QFETCH(int, p);
+
+    const std::string password = "Password 1";
+    const std::string salt = fromHex("ae3cd4e7013836a3df6bd7241b12db061dbe2c6785853cce422d148a624ce0bd");
+    const std::string expected = scrypt(LIBSCRYPT_SMIX_NOSSE, password, salt, 256, r, p, 32);
+    QVERIFY(!expected.empty());
+    for (const libscrypt_smix_impl impl: IMPLS) {
+        if (!libscrypt_smix_supported(impl)) {
+            QCOMPARE(scrypt(impl, password, salt, 256, r, p, 32), std::string());
+            continue;
+        }
+        QCOMPARE(toHex(scrypt(impl, password, salt, 256, r, p, 32)), toHex(expected));
+    }
+}
@@ -0,0 +1,22 @@
+#ifndef TST_SCRYPT_H
+#define TST_SCRYPT_H
+
+#include <QObject>
+
+class tst_scrypt : public QObject
+{
+    Q_OBJECT
+public:
+    explicit tst_scrypt(QObject *parent = nullptr);
+
+private slots:
+
+    void testScrypt_data();
+    void testScrypt();
+
+    void testScryptImplsEqual_data();
+    void testScryptImplsEqual();
+
+};
+
+#endif // TST_SCRYPT_H
@@ -14,6 +14,8 @@ SOURCES += \
     ../../src/Wallets/Wallet.cpp \
     ../../src/Wallets/EthWallet.cpp \
     ../../src/Wallets/ethtx/scrypt/crypto_scrypt-nosse.cpp \
+    ../../src/Wallets/ethtx/scrypt/crypto_scrypt-sse.cpp \
+    ../../src/Wallets/ethtx/scrypt/crypto_scrypt-avx2.cpp \
     ../../src/Wallets/ethtx/scrypt/sha256.cpp \
     ../../src/Wallets/ethtx/cert.cpp \
     ../../src/Wallets/ethtx/rlp.cpp \
@@ -27,20 +29,32 @@ SOURCES += \
     ../../src/Wallets/BtcWallet.cpp \
     ../../src/Wallets/openssl_wrapper/openssl_wrapper.cpp \
     ../../src/utilites/utils.cpp \
+    ../../src/utilites/LockedMemory.cpp \
     ../../src/Wallets/ethtx/utils2.cpp \
     ../../src/Wallets/WalletInfo.cpp \
+    ../../src/Wallets/WalletsCatalogue.cpp \
+    ../../src/Wallets/KeysImporter.cpp \
+    ../../src/Messenger/DecryptPool.cpp \
     ../LogMock.cpp \
     tst_Metahash.cpp \
     tst_Bitcoin.cpp \
     tst_Ethereum.cpp \
     tst_rsa.cpp \
+    tst_scrypt.cpp \
+    tst_WalletsCatalogue.cpp \
+    tst_KeysImporter.cpp \
+    tst_DecryptPool.cpp \
     tst_main.cpp
 
 HEADERS += \
     tst_Metahash.h \
     tst_Bitcoin.h \
     tst_Ethereum.h \
-    tst_rsa.h
+    tst_rsa.h \
+    tst_scrypt.h \
+    tst_WalletsCatalogue.h \
+    tst_KeysImporter.h \
+    tst_DecryptPool.h
 
 DEFINES += CRYPTOPP_IMPORTS
 DEFINES += QUAZIP_STATIC